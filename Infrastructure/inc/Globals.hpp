@@ -33,8 +33,10 @@
     #define BREAK_API
 #endif
 
+#ifndef __bswap_constant_16
 #define __bswap_constant_16(x) \
      ((((x) >> 8) & 0xff) | (((x) & 0xff) << 8))
+#endif
 
 #if defined __GNUC__ && __GNUC__ >= 2
 # define __bswap_16(x) \
@@ -57,9 +59,11 @@
 
 //ByteSwap.h
 /* Swap bytes in 32 bit value.  */
+#ifndef __bswap_constant_32
 #define __bswap_constant_32(x) \
      ((((x) & 0xff000000) >> 24) | (((x) & 0x00ff0000) >>  8) |		      \
       (((x) & 0x0000ff00) <<  8) | (((x) & 0x000000ff) << 24))
+#endif
 
 #if defined __GNUC__ && __GNUC__ >= 2
 # if __WORDSIZE == 64 || (defined __i486__ || defined __pentium__	      \
@@ -0,0 +1,166 @@
+#include <thread>
+#include "Bench.hpp"
+#include "BlockAllocator.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 liveCount = 4096;
+	const s32 opCount = 1 << 21;
+	const s32 threadCount = 4;
+
+	// Sizes of the objects a world allocates: fixtures, bodies, contacts, shapes.
+	s32 PickSize(Random& random)
+	{
+		static const s32 sizes[] = { 48, 64, 152, 200, 256, 360, 500 };
+		return sizes[random.Next() % 7];
+	}
+
+	// Keeps liveCount blocks and replaces a random one per operation.
+	s64 Churn(BlockAllocator* allocator, u32 seed, s32 ops)
+	{
+		Random random(seed);
+		void* blocks[liveCount];
+		s32 sizes[liveCount];
+		for (s32 i = 0; i < liveCount; ++i)
+		{
+			sizes[i] = PickSize(random);
+			blocks[i] = allocator->Allocate(sizes[i]);
+		}
+
+		s64 checksum = 0;
+		for (s32 i = 0; i < ops; ++i)
+		{
+			s32 slot = random.Next() % liveCount;
+			allocator->Free(blocks[slot], sizes[slot]);
+			sizes[slot] = PickSize(random);
+			blocks[slot] = allocator->Allocate(sizes[slot]);
+			checksum += sizes[slot];
+		}
+
+		for (s32 i = 0; i < liveCount; ++i)
+		{
+			allocator->Free(blocks[i], sizes[i]);
+		}
+		return checksum;
+	}
+
+	// Each thread allocates a batch and the next thread frees it, so every
+	// free goes through the cross-thread path.
+	void Handoff(BlockAllocator* allocator, void** batches, s32 thread, s32 rounds)
+	{
+		const s32 batchSize = 1024;
+		for (s32 r = 0; r < rounds; ++r)
+		{
+			void** mine = batches + (thread * rounds + r) * batchSize;
+			for (s32 i = 0; i < batchSize; ++i)
+			{
+				mine[i] = allocator->Allocate(64 + 64 * (i & 3));
+			}
+		}
+	}
+
+	void FreeHandoff(BlockAllocator* allocator, void** batches, s32 thread, s32 rounds)
+	{
+		const s32 batchSize = 1024;
+		s32 source = (thread + 1) % threadCount;
+		for (s32 r = 0; r < rounds; ++r)
+		{
+			void** theirs = batches + (source * rounds + r) * batchSize;
+			for (s32 i = 0; i < batchSize; ++i)
+			{
+				allocator->Free(theirs[i], 64 + 64 * (i & 3));
+			}
+		}
+	}
+
+	void PrintStats(const BlockAllocator& allocator)
+	{
+		BlockAllocatorStats stats[blockSizes];
+		allocator.GetStats(stats);
+		for (s32 i = 0; i < blockSizes; ++i)
+		{
+			if (stats[i].chunkCount > 0)
+			{
+				printf("  %4d bytes: %4d chunks, %8d live, %8d high water\n",
+					stats[i].blockSize, stats[i].chunkCount, stats[i].liveBytes, stats[i].highWaterBytes);
+			}
+		}
+	}
+
+	void RunAllocatorBench()
+	{
+		{
+			BlockAllocator allocator;
+			Stopwatch timer;
+			s64 checksum = Churn(&allocator, 1, opCount);
+			Report("alloc", "churn/plain", liveCount, opCount, timer.GetMilliseconds(), checksum);
+			PrintStats(allocator);
+		}
+
+		{
+			BlockAllocator allocator;
+			allocator.SetThreadCaching(true);
+			Stopwatch timer;
+			s64 checksum = Churn(&allocator, 1, opCount);
+			Report("alloc", "churn/cached", liveCount, opCount, timer.GetMilliseconds(), checksum);
+			PrintStats(allocator);
+		}
+
+		{
+			BlockAllocator allocator;
+			allocator.SetThreadCaching(true);
+			std::thread threads[threadCount];
+			Stopwatch timer;
+			for (s32 t = 0; t < threadCount; ++t)
+			{
+				threads[t] = std::thread(Churn, &allocator, 1 + t, opCount / threadCount);
+			}
+			for (s32 t = 0; t < threadCount; ++t)
+			{
+				threads[t].join();
+			}
+			Report("alloc", "churn/cached/4t", liveCount, opCount, timer.GetMilliseconds(), 0);
+			PrintStats(allocator);
+		}
+
+		{
+			const s32 rounds = 64;
+			BlockAllocator allocator;
+			allocator.SetThreadCaching(true);
+			void** batches = (void**)malloc(threadCount * rounds * 1024 * sizeof(void*));
+			std::thread threads[threadCount];
+
+			// Two passes so the second one reuses the blocks returned by other threads.
+			Stopwatch timer;
+			for (s32 pass = 0; pass < 2; ++pass)
+			{
+				for (s32 t = 0; t < threadCount; ++t)
+				{
+					threads[t] = std::thread(Handoff, &allocator, batches, t, rounds);
+				}
+				for (s32 t = 0; t < threadCount; ++t)
+				{
+					threads[t].join();
+				}
+				for (s32 t = 0; t < threadCount; ++t)
+				{
+					threads[t] = std::thread(FreeHandoff, &allocator, batches, t, rounds);
+				}
+				for (s32 t = 0; t < threadCount; ++t)
+				{
+					threads[t].join();
+				}
+			}
+			Report("alloc", "handoff/cached/4t", threadCount * rounds * 1024, 4 * threadCount * rounds * 1024, timer.GetMilliseconds(), 0);
+			PrintStats(allocator);
+			free(batches);
+		}
+	}
+
+	BenchEntry s_allocatorBench("alloc", "Block allocator churn, single threaded and with thread caching", RunAllocatorBench);
+}
@@ -0,0 +1,109 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "CircleShape.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 tileColumnCount = 400;
+	const s32 tileRowCount = 40;
+	const s32 regionSize = 50;
+	const s32 dynamicCount = 2000;
+	const s32 settleCount = 60;
+	const s32 stepCount = 60;
+
+	// A tile map level with one static body per tile and dynamic boxes and
+	// circles dropped on top.
+	void BuildLevel(World* world)
+	{
+		Random random;
+
+		PolygonShape tile;
+		tile.SetAsBox(0.5f, 0.5f);
+		for (s32 j = 0; j < tileRowCount; ++j)
+		{
+			for (s32 i = 0; i < tileColumnCount; ++i)
+			{
+				if (j > 0 && (random.Next() >> 8) % 4 == 0)
+				{
+					continue;
+				}
+
+				BodyDef bd;
+				bd.position = glm::vec2((real32)i, (real32)-j);
+				Body* body = world->CreateBody(&bd);
+				body->CreateFixture(&tile, 0.0f);
+			}
+		}
+
+		CircleShape circle;
+		circle.m_radius = 0.4f;
+		PolygonShape box;
+		box.SetAsBox(0.4f, 0.4f);
+		for (s32 i = 0; i < dynamicCount; ++i)
+		{
+			BodyDef bd;
+			bd.type = dynamicBody;
+			bd.position = glm::vec2(random.Range(0.0f, (real32)tileColumnCount), random.Range(1.0f, 20.0f));
+			Body* b = world->CreateBody(&bd);
+			b->CreateFixture(i % 2 ? (const Shape*)&circle : (const Shape*)&box, 1.0f);
+		}
+	}
+
+	void Run(const char* variant, bool bake)
+	{
+		World world(glm::vec2(0.0f, -10.0f));
+		world.BeginBulkLoad();
+		BuildLevel(&world);
+		world.EndBulkLoad();
+
+		real64 bakeTime = 0.0;
+		if (bake)
+		{
+			// Bake the level in square regions, as a streaming level would.
+			Stopwatch timer;
+			for (s32 x = 0; x < tileColumnCount; x += regionSize)
+			{
+				for (s32 y = 0; y < tileRowCount; y += regionSize)
+				{
+					AABB region;
+					region.lowerBound = glm::vec2(x - 1.0f, -y - regionSize);
+					region.upperBound = glm::vec2(x + regionSize, -y + 1.0f);
+					world.BakeStaticGeometry(region);
+				}
+			}
+			bakeTime = timer.GetMilliseconds();
+		}
+
+		for (s32 i = 0; i < settleCount; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+		}
+
+		Stopwatch timer;
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+		}
+
+		Report("bake", variant, world.GetProxyCount(), stepCount, timer.GetMilliseconds(), world.GetContactCount());
+		printf("  bake %.2f ms, tree height %d\n", bakeTime, world.GetTreeHeight());
+	}
+
+	// Step a tile level with every tile in the broad-phase and with the tiles
+	// baked into one mesh per region.
+	void RunBakeBench()
+	{
+		Run("tiles", false);
+		Run("baked", true);
+	}
+
+	BenchEntry s_bakeBench("bake", "Static tiles as separate bodies and baked into meshes", RunBakeBench);
+}
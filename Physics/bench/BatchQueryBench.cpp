@@ -0,0 +1,170 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "CircleShape.hpp"
+#include "ThreadPool.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	class ClosestHitCallback : public RayCastCallback
+	{
+	public:
+		real32 ReportFixture(Fixture* fixture, const glm::vec2& point, const glm::vec2& normal, real32 fraction)
+		{
+			NOT_USED(point);
+			NOT_USED(normal);
+			if (fixture->IsSensor())
+			{
+				return -1.0f;
+			}
+			m_fixture = fixture;
+			return fraction;
+		}
+
+		Fixture* m_fixture;
+	};
+
+	class CountingQueryCallback : public QueryCallback
+	{
+	public:
+		bool ReportFixture(Fixture* fixture)
+		{
+			NOT_USED(fixture);
+			++m_count;
+			return true;
+		}
+
+		s64 m_count;
+	};
+
+	const s32 bodyCount = 100000;
+	const s32 rayCount = 20000;
+
+	void RunBatchQueryBench()
+	{
+		World world(glm::vec2(0.0f, -10.0f));
+		real32 extent = 2.0f * sqrtf((real32)bodyCount);
+
+		Random random;
+		CircleShape circle;
+		circle.m_radius = 0.5f;
+		for (s32 i = 0; i < bodyCount; ++i)
+		{
+			BodyDef bd;
+			bd.position = glm::vec2(random.Range(0.0f, extent), random.Range(0.0f, extent));
+			Body* body = world.CreateBody(&bd);
+			body->CreateFixture(&circle, 0.0f);
+		}
+
+		RayCastInput* rays = (RayCastInput*)malloc(rayCount * sizeof(RayCastInput));
+		AABB* boxes = (AABB*)malloc(rayCount * sizeof(AABB));
+		RayCastHit* hits = (RayCastHit*)malloc(rayCount * sizeof(RayCastHit));
+		ShapeCastQuery* sweeps = (ShapeCastQuery*)malloc(rayCount * sizeof(ShapeCastQuery));
+		CircleShape probe;
+		probe.m_radius = 0.3f;
+		const s32 maxResults = 32;
+		Fixture** results = (Fixture**)malloc(rayCount * maxResults * sizeof(Fixture*));
+		s32* counts = (s32*)malloc(rayCount * sizeof(s32));
+
+		for (s32 i = 0; i < rayCount; ++i)
+		{
+			glm::vec2 p(random.Range(0.0f, extent), random.Range(0.0f, extent));
+			rays[i].p1 = p;
+			rays[i].p2 = p + glm::vec2(random.Range(-30.0f, 30.0f), random.Range(-30.0f, 30.0f));
+			rays[i].maxFraction = 1.0f;
+			boxes[i].lowerBound = p;
+			boxes[i].upperBound = p + glm::vec2(3.0f, 3.0f);
+			sweeps[i].shape = &probe;
+			sweeps[i].transform.Set(p, 0.0f);
+			sweeps[i].translation = rays[i].p2 - p;
+		}
+
+		// Step once so every variant sees a current wide tree.
+		world.Step(1.0f / 60.0f, 8, 3);
+
+		Stopwatch timer;
+		s64 checksum = 0;
+		ClosestHitCallback rayCallback;
+		for (s32 i = 0; i < rayCount; ++i)
+		{
+			rayCallback.m_fixture = NULL;
+			world.RayCast(&rayCallback, rays[i].p1, rays[i].p2);
+			checksum += rayCallback.m_fixture != NULL;
+		}
+		Report("batch", "ray/single", bodyCount, rayCount, timer.GetMilliseconds(), checksum);
+
+		CountingQueryCallback queryCallback;
+		queryCallback.m_count = 0;
+		timer.Reset();
+		for (s32 i = 0; i < rayCount; ++i)
+		{
+			world.QueryAABB(&queryCallback, boxes[i]);
+		}
+		Report("batch", "aabb/single", bodyCount, rayCount, timer.GetMilliseconds(), queryCallback.m_count);
+
+		timer.Reset();
+		checksum = 0;
+		for (s32 i = 0; i < rayCount; ++i)
+		{
+			rayCallback.m_fixture = NULL;
+			world.ShapeCast(&rayCallback, sweeps[i].shape, sweeps[i].transform, sweeps[i].translation);
+			checksum += rayCallback.m_fixture != NULL;
+		}
+		Report("batch", "shape/single", bodyCount, rayCount, timer.GetMilliseconds(), checksum);
+
+		const s32 workerCounts[] = { 0, 3 };
+		for (s32 w = 0; w < 2; ++w)
+		{
+			ThreadPool pool(workerCounts[w]);
+			world.SetThreadPool(&pool);
+
+			char name[64];
+			timer.Reset();
+			world.RayCastBatch(rays, rayCount, hits);
+			checksum = 0;
+			for (s32 i = 0; i < rayCount; ++i)
+			{
+				checksum += hits[i].fixture != NULL;
+			}
+			sprintf(name, "ray/batch/%dt", pool.GetThreadCount());
+			Report("batch", name, bodyCount, rayCount, timer.GetMilliseconds(), checksum);
+
+			timer.Reset();
+			world.QueryAABBBatch(boxes, rayCount, results, maxResults, counts);
+			checksum = 0;
+			for (s32 i = 0; i < rayCount; ++i)
+			{
+				checksum += counts[i];
+			}
+			sprintf(name, "aabb/batch/%dt", pool.GetThreadCount());
+			Report("batch", name, bodyCount, rayCount, timer.GetMilliseconds(), checksum);
+
+			timer.Reset();
+			world.ShapeCastBatch(sweeps, rayCount, hits);
+			checksum = 0;
+			for (s32 i = 0; i < rayCount; ++i)
+			{
+				checksum += hits[i].fixture != NULL;
+			}
+			sprintf(name, "shape/batch/%dt", pool.GetThreadCount());
+			Report("batch", name, bodyCount, rayCount, timer.GetMilliseconds(), checksum);
+
+			world.SetThreadPool(NULL);
+		}
+
+		free(rays);
+		free(boxes);
+		free(hits);
+		free(sweeps);
+		free(results);
+		free(counts);
+	}
+
+	BenchEntry s_batchQueryBench("batch", "World ray casts, AABB queries and shape casts, one at a time vs batched", RunBatchQueryBench);
+}
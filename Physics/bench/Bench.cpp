@@ -0,0 +1,67 @@
+#include "Bench.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+static BenchEntry* s_benchList = NULL;
+
+BenchEntry::BenchEntry(const char* name, const char* description, BenchFunction function)
+{
+	this->name = name;
+	this->description = description;
+	this->function = function;
+	this->next = s_benchList;
+	s_benchList = this;
+}
+
+BenchEntry* Bench::GetBenchList()
+{
+	return s_benchList;
+}
+
+void Bench::Report(const char* bench, const char* variant, s32 size, s32 ops, real64 milliseconds, s64 checksum)
+{
+	real64 perOp = ops > 0 ? milliseconds * 1.0e6 / ops : 0.0;
+	printf("%-12s %-20s %9d %9d %12.3f ms %12.1f ns/op  %lld\n", bench, variant, size, ops, milliseconds, perOp, (long long)checksum);
+	fflush(stdout);
+}
+
+// Runs every benchmark whose name matches one of the arguments, or all of them.
+int main(int argc, char** argv)
+{
+	s32 ran = 0;
+	for (BenchEntry* entry = s_benchList; entry; entry = entry->next)
+	{
+		bool selected = argc < 2;
+		for (s32 i = 1; i < argc; ++i)
+		{
+			if (strcmp(argv[i], entry->name) == 0)
+			{
+				selected = true;
+			}
+		}
+
+		if (selected == false)
+		{
+			continue;
+		}
+
+		printf("# %s: %s\n", entry->name, entry->description);
+		entry->function();
+		++ran;
+	}
+
+	if (ran == 0)
+	{
+		printf("available benchmarks:\n");
+		for (BenchEntry* entry = s_benchList; entry; entry = entry->next)
+		{
+			printf("  %-12s %s\n", entry->name, entry->description);
+		}
+		return 1;
+	}
+
+	return 0;
+}
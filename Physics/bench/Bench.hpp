@@ -0,0 +1,87 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include "Globals.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+		namespace Bench
+		{
+
+			typedef void (*BenchFunction)();
+
+			/// A named benchmark. Instances register themselves on construction
+			/// so each bench file only has to declare one at namespace scope.
+			struct BenchEntry
+			{
+				BenchEntry(const char* name, const char* description, BenchFunction function);
+
+				const char* name;
+				const char* description;
+				BenchFunction function;
+				BenchEntry* next;
+			};
+
+			/// Get the head of the registered benchmark list.
+			BenchEntry* GetBenchList();
+
+			/// Wall clock stopwatch with nanosecond resolution.
+			class Stopwatch
+			{
+			public:
+				Stopwatch()
+				{
+					Reset();
+				}
+
+				void Reset()
+				{
+					m_start = std::chrono::high_resolution_clock::now();
+				}
+
+				/// Elapsed time in milliseconds since construction or the last Reset.
+				real64 GetMilliseconds() const
+				{
+					std::chrono::duration<real64, std::milli> d = std::chrono::high_resolution_clock::now() - m_start;
+					return d.count();
+				}
+
+			private:
+				std::chrono::high_resolution_clock::time_point m_start;
+			};
+
+			/// Small deterministic generator so runs are repeatable across platforms.
+			class Random
+			{
+			public:
+				explicit Random(u32 seed = 12345)
+				{
+					m_state = seed;
+				}
+
+				u32 Next()
+				{
+					m_state = m_state * 1664525u + 1013904223u;
+					return m_state;
+				}
+
+				/// Uniform value in [lo, hi).
+				real32 Range(real32 lo, real32 hi)
+				{
+					return lo + (hi - lo) * ((Next() >> 8) * (1.0f / 16777216.0f));
+				}
+
+			private:
+				u32 m_state;
+			};
+
+			/// Print one result row. ops is the number of timed operations and is
+			/// used to derive the per-operation cost.
+			void Report(const char* bench, const char* variant, s32 size, s32 ops, real64 milliseconds, s64 checksum);
+
+		}
+	}
+}
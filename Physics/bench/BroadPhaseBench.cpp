@@ -0,0 +1,144 @@
+#include "Bench.hpp"
+#include "BroadPhase.hpp"
+#include "SweepAndPrune.hpp"
+#include "SpatialHash.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	struct PairCounter : public BroadPhasePairCallback
+	{
+		void AddPair(void* proxyUserDataA, void* proxyUserDataB)
+		{
+			NOT_USED(proxyUserDataA);
+			NOT_USED(proxyUserDataB);
+			++count;
+		}
+
+		s64 count;
+	};
+
+	struct OverlapCounter : public BroadPhaseQueryCallback
+	{
+		bool QueryCallback(s32 proxyId)
+		{
+			NOT_USED(proxyId);
+			++count;
+			return true;
+		}
+
+		s64 count;
+	};
+
+	const s32 proxyCount = 20000;
+	const s32 stepCount = 60;
+	const real32 timeStep = 1.0f / 60.0f;
+
+	struct Scene
+	{
+		const char* name;
+		real32 width;
+		real32 height;
+		real32 speed;
+		real32 minHalfSize;
+		real32 maxHalfSize;
+	};
+
+	// Step every proxy along its own velocity, bouncing off the scene bounds.
+	void RunScene(const char* variant, IBroadPhase* broadPhase, const Scene& scene)
+	{
+		Random random;
+		AABB* boxes = (AABB*)malloc(proxyCount * sizeof(AABB));
+		glm::vec2* velocities = (glm::vec2*)malloc(proxyCount * sizeof(glm::vec2));
+		s32* proxies = (s32*)malloc(proxyCount * sizeof(s32));
+
+		for (s32 i = 0; i < proxyCount; ++i)
+		{
+			glm::vec2 p(random.Range(0.0f, scene.width), random.Range(0.0f, scene.height));
+			real32 h = random.Range(scene.minHalfSize, scene.maxHalfSize);
+			boxes[i].lowerBound = p - glm::vec2(h, h);
+			boxes[i].upperBound = p + glm::vec2(h, h);
+			velocities[i] = glm::vec2(random.Range(-scene.speed, scene.speed), random.Range(-scene.speed, scene.speed));
+			proxies[i] = broadPhase->CreateProxy(boxes[i], NULL);
+		}
+
+		PairCounter pairs;
+		pairs.count = 0;
+		broadPhase->UpdatePairs(&pairs);
+
+		Stopwatch timer;
+		for (s32 step = 0; step < stepCount; ++step)
+		{
+			for (s32 i = 0; i < proxyCount; ++i)
+			{
+				glm::vec2 d = timeStep * velocities[i];
+				boxes[i].lowerBound += d;
+				boxes[i].upperBound += d;
+				if (boxes[i].lowerBound.x < 0.0f || boxes[i].upperBound.x > scene.width)
+				{
+					velocities[i].x = -velocities[i].x;
+				}
+				if (boxes[i].lowerBound.y < 0.0f || boxes[i].upperBound.y > scene.height)
+				{
+					velocities[i].y = -velocities[i].y;
+				}
+				broadPhase->MoveProxy(proxies[i], boxes[i], d);
+			}
+
+			broadPhase->UpdatePairs(&pairs);
+		}
+		real64 milliseconds = timer.GetMilliseconds();
+
+		// Both algorithms fatten the same way, so the final overlaps must match.
+		OverlapCounter overlaps;
+		overlaps.count = 0;
+		for (s32 i = 0; i < proxyCount; ++i)
+		{
+			broadPhase->Query(&overlaps, broadPhase->GetFatAABB(proxies[i]));
+		}
+
+		char name[64];
+		sprintf(name, "%s/%s", scene.name, variant);
+		Report("broadphase", name, proxyCount, stepCount, milliseconds, overlaps.count);
+
+		for (s32 i = 0; i < proxyCount; ++i)
+		{
+			broadPhase->DestroyProxy(proxies[i]);
+		}
+
+		free(boxes);
+		free(velocities);
+		free(proxies);
+	}
+
+	void RunBroadPhaseBench()
+	{
+		// Everything piled into one square, a long level spread along x and
+		// fast particles of one size.
+		const Scene scenes[] =
+		{
+			{ "dense", 150.0f, 150.0f, 4.0f, 0.25f, 0.75f },
+			{ "sparse", 20000.0f, 20.0f, 4.0f, 0.25f, 0.75f },
+			{ "particles", 60.0f, 60.0f, 20.0f, 0.1f, 0.1f }
+		};
+
+		for (s32 i = 0; i < 3; ++i)
+		{
+			BroadPhase tree;
+			RunScene("tree", &tree, scenes[i]);
+
+			SweepAndPrune sweepAndPrune;
+			RunScene("sap", &sweepAndPrune, scenes[i]);
+
+			// About the size of a fat proxy.
+			SpatialHash hash(2.0f * scenes[i].maxHalfSize + 2.0f * aabbExtension);
+			RunScene("hash", &hash, scenes[i]);
+		}
+	}
+
+	BenchEntry s_broadPhaseBench("broadphase", "Tree vs sweep-and-prune vs spatial hash pair updates", RunBroadPhaseBench);
+}
@@ -0,0 +1,136 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "CircleShape.hpp"
+#include "CapsuleShape.hpp"
+#include "Collision.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 bodyCount = 1000;
+	const s32 stepCount = 300;
+	const s32 pairCount = 100000;
+	const real32 halfLength = 0.4f;
+	const real32 radius = 0.25f;
+	const real32 pi = glm::pi<float>();
+
+	// The polygon a game would use for a capsule without a capsule shape: the
+	// side segments plus the end circles rounded to maxPolygonVertices.
+	void SetRoundedBox(PolygonShape* polygon)
+	{
+		glm::vec2 vertices[maxPolygonVertices];
+		s32 half = maxPolygonVertices / 2;
+		for (s32 i = 0; i < half; ++i)
+		{
+			real32 angle = -0.5f * pi + pi * i / (half - 1);
+			glm::vec2 d(radius * glm::cos(angle), radius * glm::sin(angle));
+			vertices[i] = glm::vec2(halfLength, 0.0f) + d;
+			vertices[half + i] = glm::vec2(-halfLength, 0.0f) - d;
+		}
+		polygon->Set(vertices, 2 * half);
+	}
+
+	// A pile of pills in a box.
+	real64 RunPile(bool capsules, s64* checksum)
+	{
+		World world(glm::vec2(0.0f, -10.0f));
+		{
+			BodyDef bd;
+			Body* ground = world.CreateBody(&bd);
+			PolygonShape wall;
+			wall.SetAsBox(20.0f, 0.5f, glm::vec2(0.0f, -0.5f), 0.0f);
+			ground->CreateFixture(&wall, 0.0f);
+			wall.SetAsBox(0.5f, 40.0f, glm::vec2(-20.5f, 40.0f), 0.0f);
+			ground->CreateFixture(&wall, 0.0f);
+			wall.SetAsBox(0.5f, 40.0f, glm::vec2(20.5f, 40.0f), 0.0f);
+			ground->CreateFixture(&wall, 0.0f);
+		}
+
+		CapsuleShape capsule;
+		capsule.Set(glm::vec2(-halfLength, 0.0f), glm::vec2(halfLength, 0.0f), radius);
+		PolygonShape polygon;
+		SetRoundedBox(&polygon);
+
+		Random random(5);
+		for (s32 i = 0; i < bodyCount; ++i)
+		{
+			BodyDef bd;
+			bd.type = dynamicBody;
+			bd.position = glm::vec2(random.Range(-19.0f, 19.0f), random.Range(1.0f, 60.0f));
+			bd.angle = random.Range(-pi, pi);
+			Body* body = world.CreateBody(&bd);
+			body->CreateFixture(capsules ? (const Shape*)&capsule : (const Shape*)&polygon, 1.0f);
+		}
+
+		Stopwatch timer;
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+		}
+		real64 ms = timer.GetMilliseconds();
+
+		*checksum = world.GetContactCount();
+		return ms;
+	}
+
+	// The narrow phase alone on the same random pairs.
+	real64 RunPairs(bool capsules, s64* checksum)
+	{
+		CapsuleShape capsule;
+		capsule.Set(glm::vec2(-halfLength, 0.0f), glm::vec2(halfLength, 0.0f), radius);
+		PolygonShape polygon;
+		SetRoundedBox(&polygon);
+
+		Random random(9);
+		Transform2D* xfs = (Transform2D*)malloc(2 * pairCount * sizeof(Transform2D));
+		for (s32 i = 0; i < 2 * pairCount; ++i)
+		{
+			xfs[i].Set(glm::vec2(random.Range(-1.0f, 1.0f), random.Range(-1.0f, 1.0f)), random.Range(-pi, pi));
+		}
+
+		s64 points = 0;
+		Stopwatch timer;
+		for (s32 i = 0; i < pairCount; ++i)
+		{
+			Manifold manifold;
+			if (capsules)
+			{
+				CollideCapsules(&manifold, &capsule, xfs[2 * i], &capsule, xfs[2 * i + 1]);
+			}
+			else
+			{
+				CollidePolygons(&manifold, &polygon, xfs[2 * i], &polygon, xfs[2 * i + 1]);
+			}
+			points += manifold.pointCount;
+		}
+		real64 ms = timer.GetMilliseconds();
+
+		free(xfs);
+		*checksum = points;
+		return ms;
+	}
+
+	// Capsules against the rounded polygon a capsule is usually faked with.
+	void RunCapsuleBench()
+	{
+		s64 checksum;
+		real64 ms = RunPile(false, &checksum);
+		Report("capsule", "pile/polygon", bodyCount, stepCount, ms, checksum);
+		ms = RunPile(true, &checksum);
+		Report("capsule", "pile/capsule", bodyCount, stepCount, ms, checksum);
+
+		ms = RunPairs(false, &checksum);
+		Report("capsule", "collide/polygon", pairCount, pairCount, ms, checksum);
+		ms = RunPairs(true, &checksum);
+		Report("capsule", "collide/capsule", pairCount, pairCount, ms, checksum);
+	}
+
+	BenchEntry s_capsuleBench("capsule", "Capsule shapes against a rounded polygon approximation", RunCapsuleBench);
+}
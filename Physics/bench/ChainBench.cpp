@@ -0,0 +1,132 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "CircleShape.hpp"
+#include "EdgeShape.hpp"
+#include "ChainShape.hpp"
+#include "WorldCallBacks.hpp"
+#include <vector>
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 vertexCount = 20000;
+	const real32 spacing = 0.5f;
+	const s32 bodyCount = 1000;
+	const s32 stepCount = 300;
+	const s32 rayCount = 10000;
+
+	real32 GetHeight(real32 x)
+	{
+		return 2.0f * glm::sin(0.05f * x) + 0.5f * glm::sin(0.7f * x);
+	}
+
+	struct ClosestRayCallback : public RayCastCallback
+	{
+		real32 ReportFixture(Fixture* fixture, const glm::vec2& point, const glm::vec2& normal, real32 fraction)
+		{
+			NOT_USED(fixture);
+			NOT_USED(point);
+			NOT_USED(normal);
+			hit = true;
+			return fraction;
+		}
+
+		bool hit;
+	};
+
+	// Rolling terrain with bodies dropped along it, made of one chain fixture
+	// or of one edge fixture per segment.
+	void RunTerrain(bool chain)
+	{
+		World world(glm::vec2(0.0f, -10.0f));
+
+		std::vector<glm::vec2> vertices(vertexCount);
+		for (s32 i = 0; i < vertexCount; ++i)
+		{
+			real32 x = spacing * (i - 0.5f * vertexCount);
+			vertices[i] = glm::vec2(x, GetHeight(x));
+		}
+
+		Stopwatch createTimer;
+		BodyDef bd;
+		Body* ground = world.CreateBody(&bd);
+		if (chain)
+		{
+			ChainShape shape;
+			shape.CreateChain(&vertices[0], vertexCount);
+			ground->CreateFixture(&shape, 0.0f);
+		}
+		else
+		{
+			EdgeShape shape;
+			for (s32 i = 0; i + 1 < vertexCount; ++i)
+			{
+				shape.Set(vertices[i], vertices[i + 1]);
+				ground->CreateFixture(&shape, 0.0f);
+			}
+		}
+		real64 createMs = createTimer.GetMilliseconds();
+
+		CircleShape circle;
+		circle.m_radius = 0.4f;
+		PolygonShape box;
+		box.SetAsBox(0.4f, 0.4f);
+
+		Random random(9);
+		real32 halfWidth = 0.5f * spacing * vertexCount - 10.0f;
+		for (s32 i = 0; i < bodyCount; ++i)
+		{
+			bd.type = dynamicBody;
+			bd.position.x = random.Range(-halfWidth, halfWidth);
+			bd.position.y = GetHeight(bd.position.x) + random.Range(2.0f, 10.0f);
+			Body* body = world.CreateBody(&bd);
+			body->CreateFixture((i & 1) ? (const Shape*)&box : (const Shape*)&circle, 1.0f);
+		}
+
+		Stopwatch stepTimer;
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+		}
+		real64 stepMs = stepTimer.GetMilliseconds();
+
+		// Vertical rays down onto the terrain.
+		ClosestRayCallback callback;
+		s64 hits = 0;
+		Stopwatch rayTimer;
+		for (s32 i = 0; i < rayCount; ++i)
+		{
+			real32 x = random.Range(-halfWidth, halfWidth);
+			callback.hit = false;
+			world.RayCast(&callback, glm::vec2(x, 20.0f), glm::vec2(x, -20.0f));
+			hits += callback.hit;
+		}
+		real64 rayMs = rayTimer.GetMilliseconds();
+
+		const char* name = chain ? "chain" : "edges";
+		char variant[64];
+		sprintf(variant, "%s/create", name);
+		Report("chain", variant, vertexCount, 1, createMs, world.GetProxyCount());
+		sprintf(variant, "%s/step", name);
+		Report("chain", variant, bodyCount, stepCount, stepMs, world.GetContactCount());
+		sprintf(variant, "%s/ray", name);
+		Report("chain", variant, vertexCount, rayCount, rayMs, hits);
+	}
+
+	// A large terrain as one chain with its edge tree against the same terrain
+	// as separate edge fixtures, each with its own broad-phase proxy.
+	void RunChainBench()
+	{
+		RunTerrain(false);
+		RunTerrain(true);
+	}
+
+	BenchEntry s_chainBench("chain", "A large terrain chain against the same terrain as edge fixtures", RunChainBench);
+}
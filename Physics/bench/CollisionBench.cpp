@@ -0,0 +1,233 @@
+#include "Bench.hpp"
+#include "CollisionWorld.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "CircleShape.hpp"
+#include "WorldCallBacks.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 objectCount = 4000;
+	const s32 rayCount = 500;
+	const s32 stepCount = 60;
+	const real32 extent = 250.0f;
+
+	// Trigger volumes wandering over a field. Both variants move them on the
+	// same paths, look for overlapping pairs and cast the same rays.
+	struct Scene
+	{
+		Scene()
+		{
+			Random random(77);
+			for (s32 i = 0; i < objectCount; ++i)
+			{
+				start[i] = glm::vec2(random.Range(-extent, extent), random.Range(-extent, extent));
+				velocity[i] = glm::vec2(random.Range(-3.0f, 3.0f), random.Range(-3.0f, 3.0f));
+			}
+			for (s32 i = 0; i < rayCount; ++i)
+			{
+				rayStart[i] = glm::vec2(random.Range(-extent, extent), random.Range(-extent, extent));
+				rayEnd[i] = rayStart[i] + glm::vec2(random.Range(-30.0f, 30.0f), random.Range(-30.0f, 30.0f));
+			}
+
+			circle.m_radius = 1.0f;
+			box.SetAsBox(0.8f, 0.8f);
+		}
+
+		const Shape* GetShape(s32 i) const
+		{
+			return i % 2 ? (const Shape*)&circle : (const Shape*)&box;
+		}
+
+		glm::vec2 GetPosition(s32 i, s32 step) const
+		{
+			return start[i] + (step / 60.0f) * velocity[i];
+		}
+
+		glm::vec2 start[objectCount];
+		glm::vec2 velocity[objectCount];
+		glm::vec2 rayStart[rayCount];
+		glm::vec2 rayEnd[rayCount];
+		CircleShape circle;
+		PolygonShape box;
+	};
+
+	struct ClosestRay : public RayCastCallback, public CollisionCastCallback
+	{
+		real32 ReportFixture(Fixture* fixture, const glm::vec2& point, const glm::vec2& normal, real32 fraction)
+		{
+			NOT_USED(fixture);
+			NOT_USED(point);
+			NOT_USED(normal);
+			closest = fraction;
+			return fraction;
+		}
+
+		real32 ReportObject(CollisionObject* object, const glm::vec2& point, const glm::vec2& normal, real32 fraction)
+		{
+			NOT_USED(object);
+			NOT_USED(point);
+			NOT_USED(normal);
+			closest = fraction;
+			return fraction;
+		}
+
+		real32 closest;
+	};
+
+	// What triggers cost today: the fixtures are tested against the AABB of
+	// every other fixture through World::QueryAABB after a step.
+	struct FixturePairs : public QueryCallback
+	{
+		bool ReportFixture(Fixture* fixture)
+		{
+			if (fixture <= self)
+			{
+				return true;
+			}
+
+			if (TestOverlap(self->GetShape(), 0, fixture->GetShape(), 0, self->GetBody()->GetTransform2D(), fixture->GetBody()->GetTransform2D()))
+			{
+				++count;
+			}
+			return true;
+		}
+
+		Fixture* self;
+		s64 count;
+	};
+
+	struct CountPairs : public CollisionPairCallback
+	{
+		void ReportPair(CollisionObject* objectA, s32 childIndexA, CollisionObject* objectB, s32 childIndexB)
+		{
+			NOT_USED(objectA);
+			NOT_USED(childIndexA);
+			NOT_USED(objectB);
+			NOT_USED(childIndexB);
+			++count;
+		}
+
+		s64 count;
+	};
+
+	real64 RunWorld(const Scene& scene, s64* pairs, real64* rays)
+	{
+		World world(glm::vec2(0.0f, 0.0f));
+		Fixture** fixtures = (Fixture**)malloc(objectCount * sizeof(Fixture*));
+		for (s32 i = 0; i < objectCount; ++i)
+		{
+			BodyDef bd;
+			bd.type = kinematicBody;
+			bd.position = scene.start[i];
+			bd.linearVelocity = scene.velocity[i];
+			Body* body = world.CreateBody(&bd);
+
+			FixtureDef fd;
+			fd.shape = scene.GetShape(i);
+			fd.isSensor = true;
+			fixtures[i] = body->CreateFixture(&fd);
+		}
+
+		*pairs = 0;
+		*rays = 0.0;
+		Stopwatch timer;
+		for (s32 step = 1; step <= stepCount; ++step)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+
+			FixturePairs query;
+			query.count = 0;
+			for (s32 i = 0; i < objectCount; ++i)
+			{
+				AABB aabb;
+				fixtures[i]->GetShape()->ComputeAABB(&aabb, fixtures[i]->GetBody()->GetTransform2D(), 0);
+				query.self = fixtures[i];
+				world.QueryAABB(&query, aabb);
+			}
+			*pairs += query.count;
+
+			ClosestRay callback;
+			for (s32 i = 0; i < rayCount; ++i)
+			{
+				callback.closest = 1.0f;
+				world.RayCast(&callback, scene.rayStart[i], scene.rayEnd[i]);
+				*rays += callback.closest;
+			}
+		}
+		real64 ms = timer.GetMilliseconds();
+
+		free(fixtures);
+		return ms;
+	}
+
+	real64 RunCollisionWorld(const Scene& scene, s64* pairs, real64* rays)
+	{
+		CollisionWorld world;
+		CollisionObject** objects = (CollisionObject**)malloc(objectCount * sizeof(CollisionObject*));
+		for (s32 i = 0; i < objectCount; ++i)
+		{
+			Transform2D xf;
+			xf.Set(scene.start[i], 0.0f);
+			objects[i] = world.CreateObject(scene.GetShape(i), xf, NULL);
+		}
+
+		*pairs = 0;
+		*rays = 0.0;
+		Stopwatch timer;
+		for (s32 step = 1; step <= stepCount; ++step)
+		{
+			for (s32 i = 0; i < objectCount; ++i)
+			{
+				Transform2D xf;
+				xf.Set(scene.GetPosition(i, step), 0.0f);
+				world.SetTransform(objects[i], xf);
+			}
+
+			CountPairs callback;
+			callback.count = 0;
+			world.ComputeOverlapPairs(&callback);
+			*pairs += callback.count;
+
+			ClosestRay ray;
+			for (s32 i = 0; i < rayCount; ++i)
+			{
+				ray.closest = 1.0f;
+				world.RayCast(&ray, scene.rayStart[i], scene.rayEnd[i]);
+				*rays += ray.closest;
+			}
+		}
+		real64 ms = timer.GetMilliseconds();
+
+		free(objects);
+		return ms;
+	}
+
+	// The same triggers and rays on a World kept current by stepping and on a
+	// collision world. Pair counts and ray sums should agree.
+	void RunCollisionBench()
+	{
+		Scene* scene = new Scene;
+
+		s64 pairs;
+		real64 rays;
+		real64 ms = RunWorld(*scene, &pairs, &rays);
+		Report("collision", "world", objectCount, stepCount, ms, pairs);
+		printf("  pairs %lld, ray sum %.4f\n", (long long)pairs, rays);
+
+		ms = RunCollisionWorld(*scene, &pairs, &rays);
+		Report("collision", "collision world", objectCount, stepCount, ms, pairs);
+		printf("  pairs %lld, ray sum %.4f\n", (long long)pairs, rays);
+
+		delete scene;
+	}
+
+	BenchEntry s_collisionBench("collision", "Trigger pairs and rays on a stepped World and on a CollisionWorld", RunCollisionBench);
+}
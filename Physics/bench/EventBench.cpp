@@ -0,0 +1,169 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "CircleShape.hpp"
+#include "WorldCallBacks.hpp"
+#include "ProfileHistory.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 bodyCount = 1500;
+	const s32 settleCount = 60;
+	const s32 stepCount = 300;
+
+	// What a game typically does with contact events: count the touches and
+	// total the impact impulses.
+	struct Totals
+	{
+		s32 beginCount;
+		s32 endCount;
+		s32 impulseCount;
+		real64 normalImpulse;
+	};
+
+	class CountingListener : public ContactListener
+	{
+	public:
+		void BeginContact(Contact* contact)
+		{
+			NOT_USED(contact);
+			++totals.beginCount;
+		}
+
+		void EndContact(Contact* contact)
+		{
+			NOT_USED(contact);
+			++totals.endCount;
+		}
+
+		void PostSolve(Contact* contact, const ContactImpulse* impulse)
+		{
+			NOT_USED(contact);
+			++totals.impulseCount;
+			for (s32 i = 0; i < impulse->count; ++i)
+			{
+				totals.normalImpulse += impulse->normalImpulses[i];
+			}
+		}
+
+		Totals totals;
+	};
+
+	// Bodies bouncing around a closed box, so contacts keep beginning and ending.
+	void BuildScene(World* world)
+	{
+		{
+			BodyDef bd;
+			Body* ground = world->CreateBody(&bd);
+			PolygonShape wall;
+			wall.SetAsBox(40.0f, 1.0f, glm::vec2(0.0f, -1.0f), 0.0f);
+			ground->CreateFixture(&wall, 0.0f);
+			wall.SetAsBox(1.0f, 40.0f, glm::vec2(-41.0f, 39.0f), 0.0f);
+			ground->CreateFixture(&wall, 0.0f);
+			wall.SetAsBox(1.0f, 40.0f, glm::vec2(41.0f, 39.0f), 0.0f);
+			ground->CreateFixture(&wall, 0.0f);
+		}
+
+		Random random;
+		CircleShape circle;
+		circle.m_radius = 0.4f;
+		PolygonShape box;
+		box.SetAsBox(0.4f, 0.4f);
+
+		FixtureDef fd;
+		fd.density = 1.0f;
+		fd.restitution = 0.6f;
+		for (s32 i = 0; i < bodyCount; ++i)
+		{
+			BodyDef bd;
+			bd.type = dynamicBody;
+			bd.position = glm::vec2(random.Range(-38.0f, 38.0f), random.Range(1.0f, 60.0f));
+			bd.linearVelocity = glm::vec2(random.Range(-10.0f, 10.0f), random.Range(-10.0f, 10.0f));
+			Body* body = world->CreateBody(&bd);
+			fd.shape = i % 2 ? (const Shape*)&circle : (const Shape*)&box;
+			body->CreateFixture(&fd);
+		}
+	}
+
+	void Run(const char* variant, bool listen, bool record)
+	{
+		WorldDef def;
+		def.profileHistorySize = stepCount;
+		if (record)
+		{
+			def.contactEventFlags = beginContactEvents | endContactEvents | impulseContactEvents;
+		}
+		World world(&def);
+		world.SetAllowSleeping(false);
+
+		CountingListener listener;
+		memset(&listener.totals, 0, sizeof(Totals));
+		if (listen)
+		{
+			world.SetContactListener(&listener);
+		}
+
+		BuildScene(&world);
+		for (s32 i = 0; i < settleCount; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+		}
+		memset(&listener.totals, 0, sizeof(Totals));
+
+		Totals totals;
+		memset(&totals, 0, sizeof(Totals));
+
+		Stopwatch timer;
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+
+			if (record)
+			{
+				const ContactEvents& events = world.GetContactEvents();
+				totals.beginCount += events.GetBeginEventCount();
+				totals.endCount += events.GetEndEventCount();
+
+				const ContactImpulseEvent* impulses = events.GetImpulseEvents();
+				s32 impulseCount = events.GetImpulseEventCount();
+				totals.impulseCount += impulseCount;
+				for (s32 j = 0; j < impulseCount; ++j)
+				{
+					totals.normalImpulse += impulses[j].normalImpulse;
+				}
+			}
+		}
+		real64 milliseconds = timer.GetMilliseconds();
+
+		if (listen)
+		{
+			totals = listener.totals;
+		}
+
+		Report("events", variant, bodyCount, stepCount, milliseconds, world.GetContactCount());
+
+		const ProfileHistory& history = world.GetProfileHistory();
+		printf("  narrow-phase avg %.0f ns, solve avg %.0f ns\n",
+			history.GetStats(profileNarrowphase).avg, history.GetStats(profileSolve).avg);
+		printf("  begin %d, end %d, impulse %d, normal impulse %.3f\n",
+			totals.beginCount, totals.endCount, totals.impulseCount, totals.normalImpulse);
+	}
+
+	// Consume begin, end and impulse events through a listener and through the
+	// event arrays, against a world with neither.
+	void RunEventBench()
+	{
+		Run("none", false, false);
+		Run("listener", true, false);
+		Run("events", false, true);
+	}
+
+	BenchEntry s_eventBench("events", "Contact listener callbacks against the buffered event stream", RunEventBench);
+}
@@ -0,0 +1,107 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "WorldGroup.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "CircleShape.hpp"
+#include "ThreadPool.hpp"
+#include <thread>
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 bodyCount = 200;
+	const s32 stepCount = 120;
+
+	// One match: a small arena with a pile of boxes and circles.
+	void BuildMatch(World* world, u32 seed)
+	{
+		{
+			BodyDef bd;
+			Body* ground = world->CreateBody(&bd);
+			PolygonShape wall;
+			wall.SetAsBox(15.0f, 0.5f, glm::vec2(0.0f, -0.5f), 0.0f);
+			ground->CreateFixture(&wall, 0.0f);
+			wall.SetAsBox(0.5f, 15.0f, glm::vec2(-15.5f, 15.0f), 0.0f);
+			ground->CreateFixture(&wall, 0.0f);
+			wall.SetAsBox(0.5f, 15.0f, glm::vec2(15.5f, 15.0f), 0.0f);
+			ground->CreateFixture(&wall, 0.0f);
+		}
+
+		Random random(seed);
+		CircleShape circle;
+		circle.m_radius = 0.5f;
+		PolygonShape box;
+		box.SetAsBox(0.5f, 0.5f);
+		for (s32 i = 0; i < bodyCount; ++i)
+		{
+			BodyDef bd;
+			bd.type = dynamicBody;
+			bd.position = glm::vec2(random.Range(-14.0f, 14.0f), random.Range(1.0f, 30.0f));
+			Body* body = world->CreateBody(&bd);
+			body->CreateFixture(i % 2 ? (const Shape*)&circle : (const Shape*)&box, 1.0f);
+		}
+	}
+
+	void Run(s32 worldCount, s32 workerCount)
+	{
+		WorldGroup group;
+		WorldDef def;
+		def.profileHistorySize = 0;
+		for (s32 i = 0; i < worldCount; ++i)
+		{
+			BuildMatch(group.CreateWorld(&def), 1000 + i);
+		}
+
+		ThreadPool pool(workerCount);
+		group.SetThreadPool(&pool);
+
+		real64 latencyAvg = 0.0;
+		real64 latencyMax = 0.0;
+		real64 stepTime = 0.0;
+		s64 gjkIterations = 0;
+
+		Stopwatch timer;
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			group.Step(1.0f / 60.0f, 8, 3);
+
+			ProfileStats latency = group.GetLatencyStats();
+			latencyAvg += latency.avg;
+			latencyMax = glm::max(latencyMax, latency.max);
+			for (s32 w = 0; w < worldCount; ++w)
+			{
+				stepTime += (real64)group.GetStepTime(w);
+				gjkIterations += group.GetWorld(w)->GetProfile().gjkIterations;
+			}
+		}
+		real64 ms = timer.GetMilliseconds();
+
+		char name[64];
+		sprintf(name, "%dw/%dt", worldCount, pool.GetThreadCount());
+		// Each world counts only its own GJK work, so this does not depend on
+		// how the worlds were spread over the threads.
+		Report("group", name, worldCount * bodyCount, stepCount, ms, gjkIterations);
+		printf("  world step avg %.3f ms, latency avg %.3f ms, max %.3f ms\n",
+			stepTime / (worldCount * stepCount) * 1.0e-6, latencyAvg / stepCount * 1.0e-6, latencyMax * 1.0e-6);
+	}
+
+	// Step 1, 8 and 64 independent matches one after another and on all cores.
+	void RunGroupBench()
+	{
+		s32 workerCount = glm::max((s32)std::thread::hardware_concurrency() - 1, 1);
+		const s32 worldCounts[] = { 1, 8, 64 };
+		for (s32 i = 0; i < 3; ++i)
+		{
+			Run(worldCounts[i], 0);
+			Run(worldCounts[i], workerCount);
+		}
+	}
+
+	BenchEntry s_groupBench("group", "Independent worlds stepped serially and on a thread pool", RunGroupBench);
+}
@@ -0,0 +1,207 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "RevoluteJoint.hpp"
+#include "DistanceJoint.hpp"
+#include "ProfileHistory.hpp"
+#include "WorldSnapshot.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 ropeCount = 60;
+	const s32 linkCount = 40;
+	const s32 stepCount = 300;
+
+	// Ropes of revolute joints and chains of distance joints hanging from a
+	// ceiling and swinging. Links do not collide, so the joints are all the
+	// solver works on.
+	void BuildScene(World* world, Body** bodies)
+	{
+		BodyDef groundDef;
+		Body* ground = world->CreateBody(&groundDef);
+
+		PolygonShape link;
+		link.SetAsBox(0.25f, 0.05f);
+
+		FixtureDef fd;
+		fd.shape = &link;
+		fd.density = 20.0f;
+		fd.filter.groupIndex = -1;
+
+		s32 bodyCount = 0;
+		for (s32 r = 0; r < ropeCount; ++r)
+		{
+			real32 x = 2.0f * r;
+			real32 y = 30.0f;
+			bool revolute = r % 2 == 0;
+
+			Body* prev = ground;
+			for (s32 i = 0; i < linkCount; ++i)
+			{
+				BodyDef bd;
+				bd.type = dynamicBody;
+				bd.position = glm::vec2(x + 0.5f * i + 0.25f, y);
+				Body* body = world->CreateBody(&bd);
+				body->CreateFixture(&fd);
+				bodies[bodyCount++] = body;
+
+				glm::vec2 anchor(x + 0.5f * i, y);
+				if (revolute)
+				{
+					RevoluteJointDef jd;
+					jd.Initialize(prev, body, anchor);
+					world->CreateJoint(&jd);
+				}
+				else
+				{
+					DistanceJointDef jd;
+					jd.Initialize(prev, body, prev == ground ? anchor : prev->GetWorldCenter(), body->GetWorldCenter());
+					world->CreateJoint(&jd);
+				}
+
+				prev = body;
+			}
+		}
+	}
+
+	// The largest position error of a joint: the gap between the anchors of a
+	// revolute joint or the stretch of a distance joint.
+	real32 GetMaxJointError(World* world)
+	{
+		real32 error = 0.0f;
+		for (Joint* j = world->GetJointList(); j; j = j->GetNext())
+		{
+			real32 gap = glm::length(j->GetAnchorB() - j->GetAnchorA());
+			if (j->GetType() == distanceJoint)
+			{
+				gap = glm::abs(gap - ((DistanceJoint*)j)->GetLength());
+			}
+			error = glm::max(error, gap);
+		}
+		return error;
+	}
+
+	void Run(const char* variant, bool batch, glm::vec2* positions)
+	{
+		Body** bodies = (Body**)malloc(ropeCount * linkCount * sizeof(Body*));
+
+		WorldDef def;
+		def.profileHistorySize = stepCount;
+		World world(&def);
+		world.SetAllowSleeping(false);
+		world.SetJointBatching(batch);
+		BuildScene(&world, bodies);
+
+		Stopwatch timer;
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+		}
+		real64 milliseconds = timer.GetMilliseconds();
+
+		Report("joints", variant, world.GetJointCount(), stepCount, milliseconds, world.GetBodyCount());
+
+		const ProfileHistory& history = world.GetProfileHistory();
+		printf("  velocity solve avg %.0f ns, position solve avg %.0f ns, max joint error %.5f\n",
+			history.GetStats(profileSolveVelocity).avg, history.GetStats(profileSolvePosition).avg, GetMaxJointError(&world));
+
+		for (s32 i = 0; i < ropeCount * linkCount; ++i)
+		{
+			positions[i] = bodies[i]->GetPosition();
+		}
+		free(bodies);
+	}
+
+	// Step the ropes with both paths from the same state every step and carry
+	// on from the batched result. Neither path converges fully in 8 iterations,
+	// so the one-step difference is compared with the joint error the paths
+	// leave behind in the same step. A ratio below one means the paths agree
+	// within the tolerance of the solver itself.
+	void RunAgreement()
+	{
+		s32 count = ropeCount * linkCount;
+		Body** bodies = (Body**)malloc(count * sizeof(Body*));
+		glm::vec2* scalar = (glm::vec2*)malloc(count * sizeof(glm::vec2));
+
+		WorldDef def;
+		World world(&def);
+		world.SetAllowSleeping(false);
+		BuildScene(&world, bodies);
+
+		WorldSnapshot snapshot;
+		real32 maxDifference = 0.0f;
+		real32 maxError = 0.0f;
+		real32 maxRatio = 0.0f;
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			snapshot.Clear();
+			world.SaveSnapshot(&snapshot);
+
+			world.SetJointBatching(false);
+			world.Step(1.0f / 60.0f, 8, 3);
+			real32 error = GetMaxJointError(&world);
+			for (s32 j = 0; j < count; ++j)
+			{
+				scalar[j] = bodies[j]->GetPosition();
+			}
+
+			world.RestoreSnapshot(&snapshot);
+			world.SetJointBatching(true);
+			world.Step(1.0f / 60.0f, 8, 3);
+			error = glm::max(error, GetMaxJointError(&world));
+
+			real32 difference = 0.0f;
+			for (s32 j = 0; j < count; ++j)
+			{
+				difference = glm::max(difference, glm::length(bodies[j]->GetPosition() - scalar[j]));
+			}
+
+			maxDifference = glm::max(maxDifference, difference);
+			maxError = glm::max(maxError, error);
+			if (error > 0.0f)
+			{
+				maxRatio = glm::max(maxRatio, difference / error);
+			}
+		}
+
+		printf("  max one-step position difference %.5f, max joint error %.5f, max difference to error ratio %.3f\n",
+			maxDifference, maxError, maxRatio);
+
+		free(bodies);
+		free(scalar);
+	}
+
+	// Solve the same ropes with every joint on its own and with the joints in
+	// bundles. Only the relaxation order differs, so each step agrees within
+	// solver tolerance. Over the whole run a swinging rope amplifies those
+	// differences, so the final positions drift further apart.
+	void RunJointBench()
+	{
+		s32 count = ropeCount * linkCount;
+		glm::vec2* scalar = (glm::vec2*)malloc(count * sizeof(glm::vec2));
+		glm::vec2* batched = (glm::vec2*)malloc(count * sizeof(glm::vec2));
+		Run("scalar", false, scalar);
+		Run("batched", true, batched);
+
+		real32 difference = 0.0f;
+		for (s32 i = 0; i < count; ++i)
+		{
+			difference = glm::max(difference, glm::length(batched[i] - scalar[i]));
+		}
+		printf("  max position difference after %d steps %.5f\n", stepCount, difference);
+
+		free(scalar);
+		free(batched);
+
+		RunAgreement();
+	}
+
+	BenchEntry s_jointBench("joints", "Revolute and distance joint ropes solved one by one and in bundles", RunJointBench);
+}
@@ -0,0 +1,116 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "CircleShape.hpp"
+#include "WorldFile.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 tileColumnCount = 400;
+	const s32 tileRowCount = 150;
+	const s32 tilesPerBody = 100;
+	const s32 dynamicCount = 2000;
+	const s32 stepCount = 10;
+
+	// A tile map level: rows of static box tiles with holes, grouped into
+	// bodies, and a few thousand dynamic circles resting on top.
+	void BuildLevel(World* world)
+	{
+		Random random;
+
+		PolygonShape tile;
+		Body* body = NULL;
+		s32 tileCount = 0;
+		for (s32 j = 0; j < tileRowCount; ++j)
+		{
+			for (s32 i = 0; i < tileColumnCount; ++i)
+			{
+				if (j > 0 && (random.Next() >> 8) % 4 == 0)
+				{
+					continue;
+				}
+
+				if (tileCount % tilesPerBody == 0)
+				{
+					BodyDef bd;
+					body = world->CreateBody(&bd);
+				}
+
+				tile.SetAsBox(0.5f, 0.5f, glm::vec2((real32)i, (real32)-j), 0.0f);
+				body->CreateFixture(&tile, 0.0f);
+				++tileCount;
+			}
+		}
+
+		CircleShape circle;
+		circle.m_radius = 0.4f;
+		for (s32 i = 0; i < dynamicCount; ++i)
+		{
+			BodyDef bd;
+			bd.type = dynamicBody;
+			bd.position = glm::vec2(random.Range(0.0f, (real32)tileColumnCount), random.Range(1.0f, 20.0f));
+			Body* b = world->CreateBody(&bd);
+			b->CreateFixture(&circle, 1.0f);
+		}
+	}
+
+	void Finish(const char* variant, World* world, real64 loadTime)
+	{
+		Report("load", variant, world->GetProxyCount(), 1, loadTime, world->GetBodyCount());
+
+		Stopwatch timer;
+		world->Step(1.0f / 60.0f, 8, 3);
+		real64 firstStep = timer.GetMilliseconds();
+
+		timer.Reset();
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			world->Step(1.0f / 60.0f, 8, 3);
+		}
+		real64 stepTime = timer.GetMilliseconds() / stepCount;
+
+		printf("  tree height %d, quality %.2f, first step %.2f ms, step %.2f ms, %d contacts\n", world->GetTreeHeight(),
+			world->GetTreeQuality(), firstStep, stepTime, world->GetContactCount());
+	}
+
+	// Create a large level one fixture at a time, in a bulk load and from a file.
+	void RunLoadBench()
+	{
+		WorldFile file;
+		{
+			World world(glm::vec2(0.0f, -10.0f));
+			Stopwatch timer;
+			BuildLevel(&world);
+			real64 createTime = timer.GetMilliseconds();
+			world.Save(&file);
+			Finish("create", &world, createTime);
+		}
+
+		{
+			World world(glm::vec2(0.0f, -10.0f));
+			Stopwatch timer;
+			world.BeginBulkLoad();
+			BuildLevel(&world);
+			world.EndBulkLoad();
+			Finish("bulk", &world, timer.GetMilliseconds());
+		}
+
+		{
+			World world(glm::vec2(0.0f, -10.0f));
+			Stopwatch timer;
+			bool loaded = world.Load(&file, NULL);
+			real64 loadTime = timer.GetMilliseconds();
+			printf("  file %d bytes, %s\n", file.GetSize(), loaded ? "loaded" : "INVALID");
+			Finish("file", &world, loadTime);
+		}
+	}
+
+	BenchEntry s_loadBench("load", "Level creation, bulk loading and binary file loading", RunLoadBench);
+}
@@ -0,0 +1,142 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "CircleShape.hpp"
+#include "ParticleSystem.hpp"
+#include "ThreadPool.hpp"
+#include <thread>
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 stepCount = 120;
+	const real32 radius = 0.05f;
+	const real32 halfWidth = 20.0f;
+
+	void CreateBox(World* world)
+	{
+		BodyDef bd;
+		Body* ground = world->CreateBody(&bd);
+		PolygonShape wall;
+		wall.SetAsBox(halfWidth, 0.5f, glm::vec2(0.0f, -0.5f), 0.0f);
+		ground->CreateFixture(&wall, 0.0f);
+		wall.SetAsBox(0.5f, 20.0f, glm::vec2(-halfWidth - 0.5f, 20.0f), 0.0f);
+		ground->CreateFixture(&wall, 0.0f);
+		wall.SetAsBox(0.5f, 20.0f, glm::vec2(halfWidth + 0.5f, 20.0f), 0.0f);
+		ground->CreateFixture(&wall, 0.0f);
+	}
+
+	// The left half of the box filled to hold count particles a diameter apart.
+	void GetDamShape(s32 count, PolygonShape* shape)
+	{
+		real32 area = count * 0.5f * sqrtf(3.0f) * 4.0f * radius * radius;
+		real32 height = area / halfWidth;
+		shape->SetAsBox(0.5f * halfWidth, 0.5f * height, glm::vec2(-0.5f * halfWidth, 0.5f * height), 0.0f);
+	}
+
+	// A dam break: a block of particles collapses across the box.
+	void RunParticles(s32 count, ParticleType type, s32 workerCount)
+	{
+		ThreadPool* pool = workerCount > 0 ? new ThreadPool(workerCount) : NULL;
+
+		World world(glm::vec2(0.0f, -10.0f));
+		world.SetThreadPool(pool);
+		CreateBox(&world);
+
+		ParticleSystemDef def;
+		def.radius = radius;
+		ParticleSystem* system = world.CreateParticleSystem(&def);
+
+		PolygonShape dam;
+		GetDamShape(count, &dam);
+		ParticleDef pd;
+		pd.type = type;
+		Transform2D xf;
+		xf.SetIdentity();
+		system->CreateParticlesInShape(&dam, xf, &pd);
+
+		Stopwatch timer;
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+		}
+		real64 ms = timer.GetMilliseconds();
+
+		// The particles still in the box.
+		s64 inside = 0;
+		const glm::vec2* positions = system->GetPositionBuffer();
+		for (s32 i = 0; i < system->GetParticleCount(); ++i)
+		{
+			inside += glm::abs(positions[i].x) < halfWidth && positions[i].y > 0.0f;
+		}
+
+		char name[64];
+		sprintf(name, "%s/%d threads", type == fluidParticle ? "fluid" : "granular", workerCount + 1);
+		Report("particles", name, system->GetParticleCount(), stepCount, ms, inside);
+
+		delete pool;
+	}
+
+	// The same dam made of circle bodies.
+	void RunCircles(s32 count)
+	{
+		World world(glm::vec2(0.0f, -10.0f));
+		CreateBox(&world);
+
+		PolygonShape dam;
+		GetDamShape(count, &dam);
+		CircleShape circle;
+		circle.m_radius = radius;
+
+		real32 rowHeight = 0.5f * sqrtf(3.0f) * 2.0f * radius;
+		Transform2D xf;
+		xf.SetIdentity();
+		AABB aabb;
+		dam.ComputeAABB(&aabb, xf, 0);
+		s32 created = 0;
+		s32 row = 0;
+		for (real32 y = aabb.lowerBound.y + radius; y <= aabb.upperBound.y - radius; y += rowHeight, ++row)
+		{
+			for (real32 x = aabb.lowerBound.x + radius * ((row & 1) ? 2.0f : 1.0f); x <= aabb.upperBound.x - radius; x += 2.0f * radius)
+			{
+				BodyDef bd;
+				bd.type = dynamicBody;
+				bd.position = glm::vec2(x, y);
+				world.CreateBody(&bd)->CreateFixture(&circle, 1.0f);
+				++created;
+			}
+		}
+
+		Stopwatch timer;
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+		}
+		real64 ms = timer.GetMilliseconds();
+
+		Report("particles", "circle bodies", created, stepCount, ms, world.GetContactCount());
+	}
+
+	// Particles against the circle bodies they replace, then the large fluid on
+	// one thread and on all cores.
+	void RunParticleBench()
+	{
+		s32 workerCount = glm::max((s32)std::thread::hardware_concurrency() - 1, 1);
+
+		RunCircles(10000);
+		RunParticles(10000, granularParticle, 0);
+		RunParticles(10000, fluidParticle, 0);
+
+		RunParticles(50000, fluidParticle, 0);
+		RunParticles(50000, fluidParticle, workerCount);
+		RunParticles(50000, granularParticle, workerCount);
+	}
+
+	BenchEntry s_particleBench("particles", "Particle fluid and granular dam breaks against circle bodies", RunParticleBench);
+}
@@ -0,0 +1,114 @@
+#include "Bench.hpp"
+#include "DynamicTree.hpp"
+#include "WideTree.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	// Counts hits and folds proxy ids into a checksum so both trees can be compared.
+	struct CountingCallback
+	{
+		bool QueryCallback(s32 proxyId)
+		{
+			++hits;
+			checksum += proxyId;
+			return true;
+		}
+
+		real32 RayCastCallback(const RayCastInput& input, s32 proxyId)
+		{
+			++hits;
+			checksum += proxyId;
+			return input.maxFraction;
+		}
+
+		s64 hits;
+		s64 checksum;
+	};
+
+	const s32 queryCount = 20000;
+
+	template <typename Tree>
+	void RunQueries(const char* variant, const Tree& tree, s32 proxyCount, const AABB* boxes, const RayCastInput* rays)
+	{
+		CountingCallback callback;
+		callback.hits = 0;
+		callback.checksum = 0;
+
+		Stopwatch timer;
+		for (s32 i = 0; i < queryCount; ++i)
+		{
+			tree.Query(&callback, boxes[i]);
+		}
+		char name[64];
+		sprintf(name, "aabb/%s", variant);
+		Report("query", name, proxyCount, queryCount, timer.GetMilliseconds(), callback.checksum);
+
+		callback.hits = 0;
+		callback.checksum = 0;
+		timer.Reset();
+		for (s32 i = 0; i < queryCount; ++i)
+		{
+			tree.RayCast(&callback, rays[i]);
+		}
+		sprintf(name, "ray/%s", variant);
+		Report("query", name, proxyCount, queryCount, timer.GetMilliseconds(), callback.checksum);
+	}
+
+	void RunQueryBench()
+	{
+		const s32 sizes[] = { 10000, 100000, 1000000 };
+
+		AABB* boxes = (AABB*)malloc(queryCount * sizeof(AABB));
+		RayCastInput* rays = (RayCastInput*)malloc(queryCount * sizeof(RayCastInput));
+
+		for (s32 s = 0; s < 3; ++s)
+		{
+			s32 proxyCount = sizes[s];
+
+			// Keep the density constant so the per-query hit count stays comparable.
+			real32 extent = 2.0f * sqrtf((real32)proxyCount);
+
+			Random random;
+			DynamicTree tree;
+			Stopwatch timer;
+			for (s32 i = 0; i < proxyCount; ++i)
+			{
+				AABB aabb;
+				aabb.lowerBound = glm::vec2(random.Range(0.0f, extent), random.Range(0.0f, extent));
+				aabb.upperBound = aabb.lowerBound + glm::vec2(random.Range(0.2f, 1.0f), random.Range(0.2f, 1.0f));
+				tree.CreateProxy(aabb, NULL);
+			}
+			Report("query", "build/dynamic", proxyCount, proxyCount, timer.GetMilliseconds(), tree.GetHeight());
+
+			WideTree wide;
+			timer.Reset();
+			wide.Build(&tree);
+			Report("query", "build/wide", proxyCount, proxyCount, timer.GetMilliseconds(), wide.GetNodeCount());
+
+			for (s32 i = 0; i < queryCount; ++i)
+			{
+				glm::vec2 p(random.Range(0.0f, extent), random.Range(0.0f, extent));
+				boxes[i].lowerBound = p;
+				boxes[i].upperBound = p + glm::vec2(4.0f, 4.0f);
+
+				glm::vec2 d(random.Range(-20.0f, 20.0f), random.Range(-20.0f, 20.0f));
+				rays[i].p1 = p;
+				rays[i].p2 = p + d;
+				rays[i].maxFraction = 1.0f;
+			}
+
+			RunQueries("dynamic", tree, proxyCount, boxes, rays);
+			RunQueries("wide", wide, proxyCount, boxes, rays);
+		}
+
+		free(boxes);
+		free(rays);
+	}
+
+	BenchEntry s_queryBench("query", "AABB query and ray cast throughput, binary vs wide tree", RunQueryBench);
+}
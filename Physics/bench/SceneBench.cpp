@@ -0,0 +1,324 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "CircleShape.hpp"
+#include "CapsuleShape.hpp"
+#include "RevoluteJoint.hpp"
+#include "ProfileHistory.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 stepCount = 300;
+	const real32 timeStep = 1.0f / 60.0f;
+
+	s32 CountAwakeBodies(World* world)
+	{
+		s32 count = 0;
+		for (Body* b = world->GetBodyList(); b; b = b->GetNext())
+		{
+			if (b->GetType() != staticBody && b->IsAwake())
+			{
+				++count;
+			}
+		}
+		return count;
+	}
+
+	Body* CreateGround(World* world, real32 halfWidth, real32 wallHeight)
+	{
+		BodyDef bd;
+		Body* ground = world->CreateBody(&bd);
+		PolygonShape shape;
+		shape.SetAsBox(halfWidth, 0.5f, glm::vec2(0.0f, -0.5f), 0.0f);
+		ground->CreateFixture(&shape, 0.0f);
+		if (wallHeight > 0.0f)
+		{
+			shape.SetAsBox(0.5f, wallHeight, glm::vec2(-halfWidth - 0.5f, wallHeight), 0.0f);
+			ground->CreateFixture(&shape, 0.0f);
+			shape.SetAsBox(0.5f, wallHeight, glm::vec2(halfWidth + 0.5f, wallHeight), 0.0f);
+			ground->CreateFixture(&shape, 0.0f);
+		}
+		return ground;
+	}
+
+	// Box2D's pyramid: rows of boxes getting one shorter each level.
+	void BuildPyramid(World* world)
+	{
+		const s32 baseCount = 40;
+		CreateGround(world, 40.0f, 0.0f);
+
+		PolygonShape box;
+		box.SetAsBox(0.5f, 0.5f);
+		for (s32 i = 0; i < baseCount; ++i)
+		{
+			for (s32 j = i; j < baseCount; ++j)
+			{
+				BodyDef bd;
+				bd.type = dynamicBody;
+				bd.position = glm::vec2(-0.5f * baseCount + 0.5f * i + 1.0f * (j - i), 0.5f + 1.0f * i);
+				world->CreateBody(&bd)->CreateFixture(&box, 5.0f);
+			}
+		}
+	}
+
+	// Circles poured into a bin.
+	void BuildCircles(World* world)
+	{
+		const s32 columnCount = 100;
+		const s32 rowCount = 50;
+		CreateGround(world, 30.0f, 40.0f);
+
+		CircleShape circle;
+		circle.m_radius = 0.25f;
+		FixtureDef fd;
+		fd.shape = &circle;
+		fd.density = 1.0f;
+		fd.friction = 0.2f;
+
+		Random random(3);
+		for (s32 i = 0; i < rowCount; ++i)
+		{
+			for (s32 j = 0; j < columnCount; ++j)
+			{
+				BodyDef bd;
+				bd.type = dynamicBody;
+				bd.position = glm::vec2(-29.5f + 0.59f * j + random.Range(-0.02f, 0.02f), 1.0f + 0.6f * i);
+				world->CreateBody(&bd)->CreateFixture(&fd);
+			}
+		}
+	}
+
+	Body* CreateLimb(World* world, const Shape* shape, const glm::vec2& position, s16 group)
+	{
+		BodyDef bd;
+		bd.type = dynamicBody;
+		bd.position = position;
+		Body* body = world->CreateBody(&bd);
+		FixtureDef fd;
+		fd.shape = shape;
+		fd.density = 1.0f;
+		fd.friction = 0.6f;
+		fd.filter.groupIndex = group;
+		body->CreateFixture(&fd);
+		return body;
+	}
+
+	void CreateHinge(World* world, Body* a, Body* b, const glm::vec2& anchor, real32 lower, real32 upper)
+	{
+		RevoluteJointDef jd;
+		jd.Initialize(a, b, anchor);
+		jd.enableLimit = true;
+		jd.lowerAngle = lower;
+		jd.upperAngle = upper;
+		world->CreateJoint(&jd);
+	}
+
+	// Ragdolls of ten bodies and nine limited hinges dropped into a bin. Each
+	// ragdoll has its own negative group so its limbs overlap freely.
+	void BuildRagdolls(World* world)
+	{
+		const s32 ragdollCount = 150;
+		const real32 pi = glm::pi<real32>();
+		CreateGround(world, 12.0f, 30.0f);
+
+		PolygonShape torso;
+		torso.SetAsBox(0.2f, 0.35f);
+		CircleShape head;
+		head.m_radius = 0.15f;
+		CapsuleShape arm;
+		arm.SetAsVertical(0.12f, 0.06f);
+		CapsuleShape leg;
+		leg.SetAsVertical(0.12f, 0.08f);
+
+		for (s32 i = 0; i < ragdollCount; ++i)
+		{
+			s16 group = (s16)(-1 - i);
+			glm::vec2 p(-9.0f + 2.0f * (i % 10), 2.0f + 2.5f * (i / 10));
+
+			Body* body = CreateLimb(world, &torso, p, group);
+			Body* skull = CreateLimb(world, &head, p + glm::vec2(0.0f, 0.5f), group);
+			CreateHinge(world, body, skull, p + glm::vec2(0.0f, 0.35f), -0.25f * pi, 0.25f * pi);
+
+			for (s32 side = -1; side <= 1; side += 2)
+			{
+				Body* upperArm = CreateLimb(world, &arm, p + glm::vec2(0.28f * side, 0.12f), group);
+				Body* lowerArm = CreateLimb(world, &arm, p + glm::vec2(0.28f * side, -0.24f), group);
+				CreateHinge(world, body, upperArm, p + glm::vec2(0.28f * side, 0.3f), -0.5f * pi, 0.5f * pi);
+				CreateHinge(world, upperArm, lowerArm, p + glm::vec2(0.28f * side, -0.06f), -0.6f * pi, 0.0f);
+
+				Body* upperLeg = CreateLimb(world, &leg, p + glm::vec2(0.1f * side, -0.55f), group);
+				Body* lowerLeg = CreateLimb(world, &leg, p + glm::vec2(0.1f * side, -0.95f), group);
+				CreateHinge(world, body, upperLeg, p + glm::vec2(0.1f * side, -0.35f), -0.2f * pi, 0.5f * pi);
+				CreateHinge(world, upperLeg, lowerLeg, p + glm::vec2(0.1f * side, -0.75f), -0.6f * pi, 0.0f);
+			}
+		}
+	}
+
+	// A long chain of hinged links held at one end, falling and swinging down
+	// onto the ground.
+	void BuildChain(World* world)
+	{
+		const s32 linkCount = 1000;
+		Body* ground = CreateGround(world, 200.0f, 0.0f);
+
+		PolygonShape link;
+		link.SetAsBox(0.25f, 0.06f);
+		FixtureDef fd;
+		fd.shape = &link;
+		fd.density = 20.0f;
+		fd.friction = 0.2f;
+
+		real32 y = 100.0f;
+		Body* prev = ground;
+		for (s32 i = 0; i < linkCount; ++i)
+		{
+			BodyDef bd;
+			bd.type = dynamicBody;
+			bd.position = glm::vec2(0.5f * i + 0.25f, y);
+			Body* body = world->CreateBody(&bd);
+			body->CreateFixture(&fd);
+
+			RevoluteJointDef jd;
+			jd.Initialize(prev, body, glm::vec2(0.5f * i, y));
+			world->CreateJoint(&jd);
+
+			prev = body;
+		}
+	}
+
+	// Bullets fired in a stream at a wall of boxes, arriving over most of the
+	// run so the TOI solver works every step.
+	void BuildBulletStorm(World* world)
+	{
+		const s32 bulletCount = 400;
+		const s32 wallWidth = 10;
+		const s32 wallHeight = 30;
+		CreateGround(world, 100.0f, 0.0f);
+
+		PolygonShape box;
+		box.SetAsBox(0.25f, 0.25f);
+		for (s32 i = 0; i < wallHeight; ++i)
+		{
+			for (s32 j = 0; j < wallWidth; ++j)
+			{
+				BodyDef bd;
+				bd.type = dynamicBody;
+				bd.position = glm::vec2(10.0f + 0.5f * j, 0.25f + 0.5f * i);
+				world->CreateBody(&bd)->CreateFixture(&box, 1.0f);
+			}
+		}
+
+		CircleShape bullet;
+		bullet.m_radius = 0.1f;
+		Random random(11);
+		for (s32 i = 0; i < bulletCount; ++i)
+		{
+			BodyDef bd;
+			bd.type = dynamicBody;
+			bd.bullet = true;
+			bd.gravityScale = 0.0f;
+			bd.position = glm::vec2(-20.0f - 2.0f * i, random.Range(0.5f, 14.5f));
+			bd.linearVelocity = glm::vec2(300.0f, 0.0f);
+			world->CreateBody(&bd)->CreateFixture(&bullet, 20.0f);
+		}
+	}
+
+	// Stacks of boxes that are left to fall asleep before the run, then a
+	// little rain of circles waking a few of them. Nearly all the bodies sleep
+	// for the whole run.
+	void BuildSleeping(World* world)
+	{
+		const s32 stackCount = 1000;
+		const s32 stackHeight = 10;
+		const s32 rainCount = 200;
+		const s32 settleStepCount = 1000;
+		CreateGround(world, 1000.0f, 0.0f);
+
+		PolygonShape box;
+		box.SetAsBox(0.5f, 0.5f);
+		for (s32 i = 0; i < stackCount; ++i)
+		{
+			for (s32 j = 0; j < stackHeight; ++j)
+			{
+				BodyDef bd;
+				bd.type = dynamicBody;
+				bd.position = glm::vec2(-999.0f + 2.0f * i, 0.5f + 1.0f * j);
+				world->CreateBody(&bd)->CreateFixture(&box, 1.0f);
+			}
+		}
+
+		for (s32 i = 0; i < settleStepCount && CountAwakeBodies(world) > 0; ++i)
+		{
+			world->Step(timeStep, 8, 3);
+		}
+
+		CircleShape circle;
+		circle.m_radius = 0.3f;
+		Random random(5);
+		for (s32 i = 0; i < rainCount; ++i)
+		{
+			BodyDef bd;
+			bd.type = dynamicBody;
+			bd.position = glm::vec2(random.Range(-999.0f, -959.0f), random.Range(30.0f, 60.0f));
+			world->CreateBody(&bd)->CreateFixture(&circle, 1.0f);
+		}
+	}
+
+	typedef void (*BuildFunction)(World* world);
+
+	// Steps one scene and prints a CSV row: the scene size, the steps per
+	// second and the average of every profile field over the run. Times are in
+	// nanoseconds per step.
+	void RunScene(const char* name, BuildFunction build)
+	{
+		WorldDef def;
+		def.profileHistorySize = stepCount;
+		World world(&def);
+		build(&world);
+
+		Stopwatch timer;
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			world.Step(timeStep, 8, 3);
+		}
+		real64 ms = timer.GetMilliseconds();
+
+		const ProfileHistory& history = world.GetProfileHistory();
+		printf("%s,%d,%d,%d,%d,%.3f,%.1f", name, world.GetBodyCount(), CountAwakeBodies(&world), world.GetJointCount(), stepCount, ms, stepCount * 1000.0 / ms);
+		for (s32 field = 0; field < profileFieldCount; ++field)
+		{
+			printf(",%.0f", history.GetStats((ProfileField)field).avg);
+		}
+		ProfileStats step = history.GetStats(profileStep);
+		printf(",%.0f,%.0f\n", step.p99, step.max);
+		fflush(stdout);
+	}
+
+	// The standard scenes, one CSV row each so runs can be diffed and tracked
+	// over time.
+	void RunSceneBench()
+	{
+		printf("scene,bodies,awakeBodies,joints,steps,ms,stepsPerSecond");
+		for (s32 field = 0; field < profileFieldCount; ++field)
+		{
+			printf(",%s", ProfileHistory::GetFieldName((ProfileField)field));
+		}
+		printf(",stepP99,stepMax\n");
+
+		RunScene("pyramid", BuildPyramid);
+		RunScene("circles", BuildCircles);
+		RunScene("ragdolls", BuildRagdolls);
+		RunScene("chain", BuildChain);
+		RunScene("bullets", BuildBulletStorm);
+		RunScene("sleeping", BuildSleeping);
+	}
+
+	BenchEntry s_sceneBench("scenes", "Standard scenes with per-phase profile averages as CSV", RunSceneBench);
+}
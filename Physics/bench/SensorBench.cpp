@@ -0,0 +1,128 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "CircleShape.hpp"
+#include "ContactEvents.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 stepCount = 300;
+	const real32 halfWidth = 50.0f;
+
+	// Bodies bouncing without gravity in a closed box, so they keep entering and
+	// leaving the sensors.
+	void CreateBox(World* world)
+	{
+		BodyDef bd;
+		Body* ground = world->CreateBody(&bd);
+		PolygonShape wall;
+		wall.SetAsBox(halfWidth, 0.5f, glm::vec2(0.0f, -halfWidth - 0.5f), 0.0f);
+		ground->CreateFixture(&wall, 0.0f);
+		wall.SetAsBox(halfWidth, 0.5f, glm::vec2(0.0f, halfWidth + 0.5f), 0.0f);
+		ground->CreateFixture(&wall, 0.0f);
+		wall.SetAsBox(0.5f, halfWidth, glm::vec2(-halfWidth - 0.5f, 0.0f), 0.0f);
+		ground->CreateFixture(&wall, 0.0f);
+		wall.SetAsBox(0.5f, halfWidth, glm::vec2(halfWidth + 0.5f, 0.0f), 0.0f);
+		ground->CreateFixture(&wall, 0.0f);
+	}
+
+	// Static trigger zones tiling the box.
+	void CreateZones(World* world, s32 zonesPerSide)
+	{
+		BodyDef bd;
+		Body* zones = world->CreateBody(&bd);
+		real32 size = 2.0f * halfWidth / zonesPerSide;
+		PolygonShape zone;
+		FixtureDef fd;
+		fd.shape = &zone;
+		fd.isSensor = true;
+		for (s32 i = 0; i < zonesPerSide; ++i)
+		{
+			for (s32 j = 0; j < zonesPerSide; ++j)
+			{
+				glm::vec2 center(-halfWidth + (i + 0.5f) * size, -halfWidth + (j + 0.5f) * size);
+				zone.SetAsBox(0.45f * size, 0.45f * size, center, 0.0f);
+				zones->CreateFixture(&fd);
+			}
+		}
+	}
+
+	// Moving bodies, some with a large sensor circle around them like the
+	// awareness radius of a game agent.
+	void CreateBodies(World* world, s32 count, s32 agentCount)
+	{
+		CircleShape circle;
+		circle.m_radius = 0.3f;
+		PolygonShape box;
+		box.SetAsBox(0.3f, 0.3f);
+		CircleShape awareness;
+		awareness.m_radius = 4.0f;
+
+		FixtureDef fd;
+		fd.friction = 0.0f;
+		fd.restitution = 1.0f;
+		fd.density = 1.0f;
+
+		FixtureDef sensorDef;
+		sensorDef.shape = &awareness;
+		sensorDef.isSensor = true;
+
+		Random random(17);
+		for (s32 i = 0; i < count; ++i)
+		{
+			BodyDef bd;
+			bd.type = dynamicBody;
+			bd.allowSleep = false;
+			bd.position = glm::vec2(random.Range(-halfWidth + 1.0f, halfWidth - 1.0f), random.Range(-halfWidth + 1.0f, halfWidth - 1.0f));
+			bd.linearVelocity = glm::vec2(random.Range(-8.0f, 8.0f), random.Range(-8.0f, 8.0f));
+			Body* body = world->CreateBody(&bd);
+			fd.shape = (i & 1) ? (const Shape*)&box : (const Shape*)&circle;
+			body->CreateFixture(&fd);
+
+			if (i < agentCount)
+			{
+				body->CreateFixture(&sensorDef);
+			}
+		}
+	}
+
+	void RunSensors(const char* name, s32 zonesPerSide, s32 count, s32 agentCount)
+	{
+		World world(glm::vec2(0.0f, 0.0f));
+		world.SetContactEventFlags(beginContactEvents | endContactEvents);
+		CreateBox(&world);
+		CreateZones(&world, zonesPerSide);
+		CreateBodies(&world, count, agentCount);
+
+		s64 events = 0;
+		Stopwatch timer;
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+			events += world.GetContactEvents().GetBeginEventCount() + world.GetContactEvents().GetEndEventCount();
+		}
+		real64 ms = timer.GetMilliseconds();
+
+		Report("sensors", name, count, stepCount, ms, events);
+	}
+
+	// Without sensors for reference, then large trigger zones, then agents with
+	// awareness sensors that overlap many bodies each.
+	void RunSensorBench()
+	{
+		RunSensors("no sensors", 0, 2000, 0);
+		RunSensors("4 zones", 2, 2000, 0);
+		RunSensors("100 zones", 10, 2000, 0);
+		RunSensors("200 agents", 0, 2000, 200);
+		RunSensors("zones + agents", 10, 2000, 200);
+	}
+
+	BenchEntry s_sensorBench("sensors", "Bodies moving through trigger zones and agents with awareness sensors", RunSensorBench);
+}
@@ -0,0 +1,120 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "CircleShape.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 shelfCount = 100;
+	const s32 stackCount = 95;
+	const s32 stackHeight = 5;
+	const s32 ballCount = 2500;
+	const s32 settleStepCount = 600;
+	const s32 stepCount = 200;
+
+	s32 CountAwakeBodies(World* world)
+	{
+		s32 count = 0;
+		for (Body* b = world->GetBodyList(); b; b = b->GetNext())
+		{
+			if (b->GetType() != staticBody && b->IsAwake())
+			{
+				++count;
+			}
+		}
+		return count;
+	}
+
+	// Shelves of box stacks that fall asleep, next to a bin of balls that
+	// are not allowed to sleep: 50k bodies with 5% of them awake.
+	void RunSleepBench()
+	{
+		World world(glm::vec2(0.0f, -10.0f));
+
+		PolygonShape box;
+		box.SetAsBox(0.5f, 0.5f);
+
+		for (s32 i = 0; i < shelfCount; ++i)
+		{
+			real32 y = 20.0f * i;
+
+			BodyDef bd;
+			bd.position = glm::vec2(0.0f, y);
+			Body* shelf = world.CreateBody(&bd);
+			PolygonShape shape;
+			shape.SetAsBox(100.0f, 0.5f);
+			shelf->CreateFixture(&shape, 0.0f);
+
+			for (s32 j = 0; j < stackCount; ++j)
+			{
+				for (s32 k = 0; k < stackHeight; ++k)
+				{
+					BodyDef bd;
+					bd.type = dynamicBody;
+					bd.position = glm::vec2(-95.0f + 2.0f * j, y + 1.0f + 1.0f * k);
+					Body* body = world.CreateBody(&bd);
+					body->CreateFixture(&box, 1.0f);
+				}
+			}
+		}
+
+		{
+			BodyDef bd;
+			bd.position = glm::vec2(400.0f, 0.0f);
+			Body* bin = world.CreateBody(&bd);
+			PolygonShape shape;
+			shape.SetAsBox(40.0f, 0.5f);
+			bin->CreateFixture(&shape, 0.0f);
+			shape.SetAsBox(0.5f, 60.0f, glm::vec2(-40.0f, 60.0f), 0.0f);
+			bin->CreateFixture(&shape, 0.0f);
+			shape.SetAsBox(0.5f, 60.0f, glm::vec2(40.0f, 60.0f), 0.0f);
+			bin->CreateFixture(&shape, 0.0f);
+		}
+
+		CircleShape circle;
+		circle.m_radius = 0.4f;
+
+		Random random;
+		for (s32 i = 0; i < ballCount; ++i)
+		{
+			BodyDef bd;
+			bd.type = dynamicBody;
+			bd.allowSleep = false;
+			bd.position = glm::vec2(400.0f + random.Range(-38.0f, 38.0f), random.Range(2.0f, 110.0f));
+			bd.linearVelocity = glm::vec2(random.Range(-5.0f, 5.0f), random.Range(-5.0f, 5.0f));
+			Body* body = world.CreateBody(&bd);
+			FixtureDef fd;
+			fd.shape = &circle;
+			fd.density = 1.0f;
+			fd.restitution = 0.5f;
+			body->CreateFixture(&fd);
+		}
+
+		// Let the stacks come to rest and fall asleep.
+		Stopwatch settleTimer;
+		s32 settleSteps = 0;
+		while (settleSteps < settleStepCount && CountAwakeBodies(&world) > ballCount)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+			++settleSteps;
+		}
+		printf("  %d bodies, %d awake after %d settle steps (%.1f ms)\n", world.GetBodyCount(),
+			CountAwakeBodies(&world), settleSteps, settleTimer.GetMilliseconds());
+
+		Stopwatch timer;
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+		}
+		Report("sleep", "shelves", world.GetBodyCount(), stepCount, timer.GetMilliseconds(), CountAwakeBodies(&world));
+	}
+
+	BenchEntry s_sleepBench("sleep", "World::Step on 50k bodies with 95% of them asleep", RunSleepBench);
+}
@@ -0,0 +1,147 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "CircleShape.hpp"
+#include "RevoluteJoint.hpp"
+#include "WorldSnapshot.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 columnCount = 40;
+	const s32 rowCount = 25;
+	const s32 linkCount = 30;
+	const s32 warmupStepCount = 120;
+	const s32 replayStepCount = 120;
+	const s32 copyCount = 1000;
+	const s32 rollbackCount = 100;
+	const s32 rollbackDepth = 8;
+
+	void BuildWorld(World* world)
+	{
+		{
+			BodyDef bd;
+			Body* ground = world->CreateBody(&bd);
+			PolygonShape shape;
+			shape.SetAsBox(60.0f, 1.0f);
+			ground->CreateFixture(&shape, 0.0f);
+		}
+
+		PolygonShape box;
+		box.SetAsBox(0.5f, 0.5f);
+		CircleShape circle;
+		circle.m_radius = 0.5f;
+
+		for (s32 i = 0; i < columnCount; ++i)
+		{
+			for (s32 j = 0; j < rowCount; ++j)
+			{
+				BodyDef bd;
+				bd.type = dynamicBody;
+				bd.position = glm::vec2(-40.0f + 2.0f * i + 0.1f * j, 1.5f + 1.05f * j);
+				Body* body = world->CreateBody(&bd);
+				if ((i + j) & 1)
+				{
+					body->CreateFixture(&box, 1.0f);
+				}
+				else
+				{
+					body->CreateFixture(&circle, 1.0f);
+				}
+			}
+		}
+
+		// A chain swinging into the pile so joints are part of the state.
+		PolygonShape link;
+		link.SetAsBox(0.5f, 0.125f);
+
+		BodyDef bd;
+		bd.position = glm::vec2(-50.0f, 40.0f);
+		Body* prev = world->CreateBody(&bd);
+		for (s32 i = 0; i < linkCount; ++i)
+		{
+			BodyDef bd;
+			bd.type = dynamicBody;
+			bd.position = glm::vec2(-49.5f + i, 40.0f);
+			Body* body = world->CreateBody(&bd);
+			body->CreateFixture(&link, 20.0f);
+
+			RevoluteJointDef jd;
+			jd.Initialize(prev, body, glm::vec2(-50.0f + i, 40.0f));
+			world->CreateJoint(&jd);
+			prev = body;
+		}
+	}
+
+	real64 GetPositionSum(World* world)
+	{
+		real64 sum = 0.0;
+		for (Body* b = world->GetBodyList(); b; b = b->GetNext())
+		{
+			sum += b->GetPosition().x + b->GetPosition().y;
+		}
+		return sum;
+	}
+
+	void Simulate(World* world, s32 stepCount)
+	{
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			world->Step(1.0f / 60.0f, 8, 3);
+		}
+	}
+
+	// Save and restore a pile in motion, and check that a replay from the
+	// snapshot ends where the original run did.
+	void RunSnapshotBench()
+	{
+		World world(glm::vec2(0.0f, -10.0f));
+		BuildWorld(&world);
+		Simulate(&world, warmupStepCount);
+
+		WorldSnapshot snapshot;
+		world.SaveSnapshot(&snapshot);
+		Simulate(&world, replayStepCount);
+		real64 expected = GetPositionSum(&world);
+
+		bool restored = world.RestoreSnapshot(&snapshot);
+		Simulate(&world, replayStepCount);
+		real64 replayed = GetPositionSum(&world);
+		printf("  %d bodies, %d contacts, %d bytes, replay %s (%.6f, %.6f)\n", world.GetBodyCount(), world.GetContactCount(),
+			snapshot.GetSize(), restored && replayed == expected ? "matches" : "DIFFERS", expected, replayed);
+
+		Stopwatch timer;
+		for (s32 i = 0; i < copyCount; ++i)
+		{
+			world.SaveSnapshot(&snapshot);
+		}
+		Report("snapshot", "save", world.GetBodyCount(), copyCount, timer.GetMilliseconds(), snapshot.GetSize());
+
+		// Nothing changed since the save, so contacts are overwritten in place.
+		timer.Reset();
+		for (s32 i = 0; i < copyCount; ++i)
+		{
+			world.RestoreSnapshot(&snapshot);
+		}
+		Report("snapshot", "restore", world.GetBodyCount(), copyCount, timer.GetMilliseconds(), world.GetContactCount());
+
+		// A rollback: step ahead, then go back. Contacts have changed and are rebuilt.
+		real64 elapsed = 0.0;
+		for (s32 i = 0; i < rollbackCount; ++i)
+		{
+			Simulate(&world, rollbackDepth);
+			timer.Reset();
+			world.RestoreSnapshot(&snapshot);
+			elapsed += timer.GetMilliseconds();
+		}
+		Report("snapshot", "rollback", world.GetBodyCount(), rollbackCount, elapsed, world.GetContactCount());
+	}
+
+	BenchEntry s_snapshotBench("snapshot", "World snapshot save, restore and replay", RunSnapshotBench);
+}
@@ -0,0 +1,77 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "ProfileHistory.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 pyramidCount = 4;
+	const s32 baseCount = 20;
+	const s32 settleCount = 120;
+	const s32 stepCount = 300;
+
+	// Pyramids of boxes resting on the ground with sleeping disabled, so every
+	// contact stays in the narrow-phase with almost no relative motion.
+	void RunStackBench()
+	{
+		WorldDef def;
+		def.profileHistorySize = stepCount;
+		World world(&def);
+		world.SetAllowSleeping(false);
+
+		{
+			BodyDef bd;
+			Body* ground = world.CreateBody(&bd);
+			PolygonShape shape;
+			shape.SetAsBox(80.0f, 1.0f, glm::vec2(0.0f, -1.0f), 0.0f);
+			ground->CreateFixture(&shape, 0.0f);
+		}
+
+		PolygonShape box;
+		box.SetAsBox(0.5f, 0.5f);
+
+		s32 bodyCount = 0;
+		for (s32 p = 0; p < pyramidCount; ++p)
+		{
+			real32 x0 = -60.0f + 30.0f * p;
+			for (s32 j = 0; j < baseCount; ++j)
+			{
+				for (s32 i = j; i < baseCount; ++i)
+				{
+					BodyDef bd;
+					bd.type = dynamicBody;
+					bd.position = glm::vec2(x0 + 1.05f * i - 0.525f * j, 0.5f + 1.0f * j);
+					Body* body = world.CreateBody(&bd);
+					body->CreateFixture(&box, 1.0f);
+					++bodyCount;
+				}
+			}
+		}
+
+		for (s32 i = 0; i < settleCount; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+		}
+
+		Stopwatch timer;
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+		}
+		Report("stack", "pyramids", bodyCount, stepCount, timer.GetMilliseconds(), world.GetContactCount());
+
+		const ProfileHistory& history = world.GetProfileHistory();
+		ProfileStats narrowphase = history.GetStats(profileNarrowphase);
+		ProfileStats step = history.GetStats(profileStep);
+		printf("  narrow-phase avg %.0f ns, p99 %.0f ns, step avg %.0f ns\n", narrowphase.avg, narrowphase.p99, step.avg);
+	}
+
+	BenchEntry s_stackBench("stack", "Narrow-phase cost of resting box pyramids", RunStackBench);
+}
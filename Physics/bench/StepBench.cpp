@@ -0,0 +1,88 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "CircleShape.hpp"
+#include "ProfileHistory.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 columnCount = 40;
+	const s32 rowCount = 25;
+	const s32 stepCount = 300;
+
+	// A ground box with columns of boxes and circles falling onto it.
+	void RunStepBench()
+	{
+		WorldDef def;
+		def.profileHistorySize = stepCount;
+		World world(&def);
+
+		{
+			BodyDef bd;
+			Body* ground = world.CreateBody(&bd);
+			PolygonShape shape;
+			shape.SetAsBox(60.0f, 1.0f);
+			ground->CreateFixture(&shape, 0.0f);
+		}
+
+		PolygonShape box;
+		box.SetAsBox(0.5f, 0.5f);
+		CircleShape circle;
+		circle.m_radius = 0.5f;
+
+		for (s32 i = 0; i < columnCount; ++i)
+		{
+			for (s32 j = 0; j < rowCount; ++j)
+			{
+				BodyDef bd;
+				bd.type = dynamicBody;
+				bd.position = glm::vec2(-40.0f + 2.0f * i + 0.1f * j, 1.5f + 1.05f * j);
+				Body* body = world.CreateBody(&bd);
+				if ((i + j) & 1)
+				{
+					body->CreateFixture(&box, 1.0f);
+				}
+				else
+				{
+					body->CreateFixture(&circle, 1.0f);
+				}
+			}
+		}
+
+		Stopwatch timer;
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+		}
+		Report("step", "pile", columnCount * rowCount, stepCount, timer.GetMilliseconds(), world.GetContactCount());
+
+		const ProfileHistory& history = world.GetProfileHistory();
+		printf("%-16s %14s %14s %14s %14s\n", "field", "min", "avg", "max", "p99");
+		for (s32 field = 0; field < profileFieldCount; ++field)
+		{
+			ProfileStats stats = history.GetStats((ProfileField)field);
+			printf("%-16s %14.0f %14.0f %14.0f %14.0f\n", ProfileHistory::GetFieldName((ProfileField)field),
+				stats.min, stats.avg, stats.max, stats.p99);
+		}
+
+		const StackAllocatorStats& stackStats = world.GetStackAllocatorStats();
+		printf("stack allocator: %d bytes, peak %d, %d overflows (%d bytes), grown %d times\n",
+			stackStats.capacity, stackStats.maxAllocation, stackStats.overflowCount, stackStats.overflowBytes, stackStats.growCount);
+
+		// Set BREAK_PROFILE_CSV to keep the per-step numbers.
+		const char* path = getenv("BREAK_PROFILE_CSV");
+		if (path != NULL && history.DumpCSV(path) == false)
+		{
+			printf("could not write %s\n", path);
+		}
+	}
+
+	BenchEntry s_stepBench("step", "World::Step on a pile of boxes and circles, with the per-step profile", RunStepBench);
+}
@@ -0,0 +1,117 @@
+#include "Bench.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "PolygonShape.hpp"
+#include "CircleShape.hpp"
+#include "ThreadPool.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+using namespace Break::Physics::Bench;
+
+
+namespace
+{
+	const s32 gridSize = 40;
+	const real32 arenaExtent = 30.0f;
+	const s32 stepCount = 120;
+
+	// A closed arena with a packed grid of boxes, so there are many contacts that
+	// never produce a TOI event, and bullets fired through it.
+	void RunScene(s32 bulletCount, s32 workerCount)
+	{
+		WorldDef def;
+		def.gravity = glm::vec2(0.0f, 0.0f);
+		def.profileHistorySize = stepCount;
+		World world(&def);
+
+		{
+			BodyDef bd;
+			Body* ground = world.CreateBody(&bd);
+			PolygonShape wall;
+			wall.SetAsBox(arenaExtent, 0.5f, glm::vec2(0.0f, -arenaExtent), 0.0f);
+			ground->CreateFixture(&wall, 0.0f);
+			wall.SetAsBox(arenaExtent, 0.5f, glm::vec2(0.0f, arenaExtent), 0.0f);
+			ground->CreateFixture(&wall, 0.0f);
+			wall.SetAsBox(0.5f, arenaExtent, glm::vec2(-arenaExtent, 0.0f), 0.0f);
+			ground->CreateFixture(&wall, 0.0f);
+			wall.SetAsBox(0.5f, arenaExtent, glm::vec2(arenaExtent, 0.0f), 0.0f);
+			ground->CreateFixture(&wall, 0.0f);
+		}
+
+		PolygonShape box;
+		box.SetAsBox(0.25f, 0.25f);
+		for (s32 i = 0; i < gridSize; ++i)
+		{
+			for (s32 j = 0; j < gridSize; ++j)
+			{
+				BodyDef bd;
+				bd.type = dynamicBody;
+				bd.position = glm::vec2(-0.6f * gridSize * 0.5f + 0.6f * i, -0.6f * gridSize * 0.5f + 0.6f * j);
+				bd.linearDamping = 2.0f;
+				world.CreateBody(&bd)->CreateFixture(&box, 1.0f);
+			}
+		}
+
+		Random random;
+		CircleShape bullet;
+		bullet.m_radius = 0.05f;
+		for (s32 i = 0; i < bulletCount; ++i)
+		{
+			real32 angle = random.Range(0.0f, 2.0f * glm::pi<real32>());
+			glm::vec2 direction(cosf(angle), sinf(angle));
+
+			BodyDef bd;
+			bd.type = dynamicBody;
+			bd.bullet = true;
+			bd.position = -0.8f * arenaExtent * direction + glm::vec2(random.Range(-2.0f, 2.0f), random.Range(-2.0f, 2.0f));
+			bd.linearVelocity = random.Range(150.0f, 250.0f) * direction;
+			world.CreateBody(&bd)->CreateFixture(&bullet, 5.0f);
+		}
+
+		ThreadPool pool(workerCount);
+		world.SetThreadPool(&pool);
+
+		Stopwatch timer;
+		s32 toiEvents = 0;
+		for (s32 i = 0; i < stepCount; ++i)
+		{
+			world.Step(1.0f / 60.0f, 8, 3);
+			toiEvents += world.GetProfile().toiEventCount;
+		}
+		real64 ms = timer.GetMilliseconds();
+
+		// The positions must not depend on the thread count.
+		real64 positionSum = 0.0;
+		for (Body* b = world.GetBodyList(); b; b = b->GetNext())
+		{
+			positionSum += b->GetPosition().x + b->GetPosition().y;
+		}
+
+		ProfileStats stats = world.GetProfileHistory().GetStats(profileSolveTOI);
+		printf("  %d bullets, %d contacts, %d TOI events, position sum %.6f, solveTOI avg %.3f ms max %.3f ms\n",
+			bulletCount, world.GetContactCount(), toiEvents, positionSum, stats.avg * 1.0e-6, stats.max * 1.0e-6);
+
+		char name[64];
+		sprintf(name, "bullets/%dt", pool.GetThreadCount());
+		Report("toi", name, bulletCount, stepCount, ms, toiEvents);
+
+		world.SetThreadPool(NULL);
+	}
+
+	void RunTOIBench()
+	{
+		const s32 bulletCounts[] = { 25, 100, 400 };
+		const s32 workerCounts[] = { 0, 3 };
+		for (s32 i = 0; i < 3; ++i)
+		{
+			for (s32 w = 0; w < 2; ++w)
+			{
+				RunScene(bulletCounts[i], workerCounts[w]);
+			}
+		}
+	}
+
+	BenchEntry s_toiBench("toi", "Continuous collision with many bullets in a crowded arena", RunTOIBench);
+}
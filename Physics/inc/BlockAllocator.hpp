@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include "Globals.hpp"
 
 namespace Break
@@ -21,7 +22,31 @@ namespace Break
 			Block* blocks;
 		};
 
+		struct ThreadCache;
 
+		/// Occupancy of one block size.
+		struct BREAK_API BlockAllocatorStats
+		{
+			s32 blockSize;
+
+			/// Number of chunks carved into blocks of this size.
+			s32 chunkCount;
+
+			/// Bytes in blocks that are allocated and not yet freed.
+			s32 liveBytes;
+
+			/// The highest liveBytes seen. With thread caching this is the sum of
+			/// the per-thread peaks, so it is an upper bound.
+			s32 highWaterBytes;
+		};
+
+
+		/// This is a small object allocator used for allocating small
+		/// objects that persist for more than one time step.
+		/// By default it is single threaded. With thread caching each thread that
+		/// uses the allocator gets its own free lists and chunks, so any thread may
+		/// allocate. A block freed by another thread than the one that allocated it
+		/// is pushed on a lock-free list and reused by the owning thread.
 		class BREAK_API BlockAllocator
 		{
 		public:
@@ -34,21 +59,58 @@ namespace Break
 			/// Free memory. This will use Free if the size is larger than _maxBlockSize.
 			void Free(void* p, s32 size);
 
+			/// Free all chunks. No other thread may use the allocator during this call.
 			void Clear();
 
+			/// Turn thread caching on or off. This must be done before anything is allocated.
+			void SetThreadCaching(bool flag);
+
+			/// Is thread caching on?
+			bool IsThreadCaching() const;
+
+			/// Get the occupancy of each block size. Blocks larger than maxBlockSize
+			/// are not counted. The numbers are only exact while no other thread
+			/// uses the allocator.
+			/// @param stats an array of blockSizes entries, smallest size first.
+			void GetStats(BlockAllocatorStats* stats) const;
+
 		private:
 
+			void* AllocateCached(s32 size);
+			void FreeCached(void* p, s32 size);
+			void ClearCached();
+			ThreadCache* GetThreadCache();
+
 			Chunk* m_chunks;
 			s32 m_chunkCount;
 			s32 m_chunkSpace;
 
 			Block* m_freeLists[blockSizes];
 
+			s32 m_liveBlocks[blockSizes];
+			s32 m_highWater[blockSizes];
+
+			bool m_threadCaching;
+
+			/// Identifies this allocator in the per-thread lookup.
+			u32 m_id;
+
+			/// The caches of all threads that used this allocator.
+			std::atomic<ThreadCache*> m_caches;
+
 			static s32 s_blockSizes[blockSizes];
 			static u8 s_blockSizeLookup[maxBlockSize + 1];
 			static bool s_blockSizeLookupInitialized;
+
+			/// Fill the size lookup once, whichever thread creates the first allocator.
+			static void InitializeBlockSizeLookup();
 		};
 
+		inline bool BlockAllocator::IsThreadCaching() const
+		{
+			return m_threadCaching;
+		}
+
 	}
 
 }
@@ -2,6 +2,7 @@
 #include "MathUtils.hpp"
 #include "Shape.hpp"
 #include "Sweep.hpp"
+#include "SlotMap.hpp"
 
 namespace Break{namespace Physics{
 	class Transform2D;
@@ -23,6 +24,9 @@ namespace Break
 		struct BREAK_API JointEdge;
 		struct BREAK_API ContactEdge;
 
+		/// A weak reference to a body. World::GetBody returns NULL once the body is destroyed.
+		typedef SlotHandle BodyHandle;
+
 		/// The body type.
 		/// static: zero mass, zero velocity, may be manually moved
 		/// kinematic: zero mass, non-zero velocity set by user, moved by solver
@@ -368,6 +372,9 @@ namespace Break
 			World* GetWorld();
 			const World* GetWorld() const;
 
+			/// Get a handle that stays valid to test after the body is destroyed.
+			BodyHandle GetHandle() const;
+
 			/// Dump this body to a log file
 			void Dump();
 
@@ -400,7 +407,8 @@ namespace Break
 				bulletFlag		  = 0x0008,
 				fixedRotationFlag = 0x0010,
 				activeFlag		  = 0x0020,
-				toiFlag			  = 0x0040
+				toiFlag			  = 0x0040,
+				bulkLoadFlag	  = 0x0080
 			};
 
 			Body(const BodyDef* bd, World* world);
@@ -434,6 +442,15 @@ namespace Break
 			Body* m_prev;
 			Body* m_next;
 
+			// Slot in the world body storage.
+			s32 m_slotIndex;
+
+			// Index in the world awake set, -1 when asleep or static.
+			s32 m_awakeIndex;
+
+			// World TOI stamp of the last step that reset m_sweep.alpha0.
+			u32 m_toiStamp;
+
 			Fixture* m_fixtureList;
 			s32 m_fixtureCount;
 
@@ -16,6 +16,7 @@ namespace Break
 		class BREAK_API Joint;
 		class BREAK_API StackAllocator;
 		class BREAK_API ContactListener;
+		class BREAK_API ContactEvents;
 		struct BREAK_API ContactVelocityConstraint;
 		///struct BREAK_API Profile;
 
@@ -24,7 +25,7 @@ namespace Break
 		{
 		public:
 			Island(s32 bodyCapacity, s32 contactCapacity, s32 jointCapacity,
-				StackAllocator* allocator, ContactListener* listener);
+				StackAllocator* allocator, ContactListener* listener, ContactEvents* events);
 			~Island();
 
 			void Clear()
@@ -62,6 +63,7 @@ namespace Break
 
 			StackAllocator* m_allocator;
 			ContactListener* m_listener;
+			ContactEvents* m_events;
 
 			Body** m_bodies;
 			Contact** m_contacts;
@@ -3,6 +3,8 @@
 #include "Globals.hpp"
 #include "Collision.hpp"
 #include "DynamicTree.hpp"
+#include "WideTree.hpp"
+#include "IBroadPhase.hpp"
 
 namespace Break
 {
@@ -19,15 +21,12 @@ namespace Break
 		/// The broad-phase is used for computing pairs and performing volume queries and ray casts.
 		/// This broad-phase does not persist pairs. Instead, this reports potentially new pairs.
 		/// It is up to the client to consume the new pairs and to track subsequent overlap.
-		class BREAK_API BroadPhase
+		/// This is the dynamic tree implementation of IBroadPhase. The templated members
+		/// can be used directly to avoid the virtual callbacks of the interface.
+		class BREAK_API BroadPhase : public IBroadPhase
 		{
 		public:
 
-			enum
-			{
-				nullProxy = -1
-			};
-
 			BroadPhase();
 			~BroadPhase();
 
@@ -35,6 +34,10 @@ namespace Break
 			/// UpdatePairs is called.
 			s32 CreateProxy(const AABB& aabb, void* userData);
 
+			/// Create count proxies at once without touching them. The tree is rebuilt
+			/// top-down with the new proxies instead of inserting them one by one.
+			void CreateProxies(const AABB* aabbs, void* const* userData, s32 count, s32* proxyIds);
+
 			/// Destroy a proxy. It is up to the client to remove any pairs.
 			void DestroyProxy(s32 proxyId);
 
@@ -48,6 +51,9 @@ namespace Break
 			/// Get the fat AABB for a proxy.
 			const AABB& GetFatAABB(s32 proxyId) const;
 
+			/// Replace the fat AABB of a proxy without buffering a move.
+			void SetFatAABB(s32 proxyId, const AABB& fatAABB);
+
 			/// Get user data from a proxy. Returns NULL if the id is invalid.
 			void* GetUserData(s32 proxyId) const;
 
@@ -60,13 +66,19 @@ namespace Break
 			/// Update the pairs. This results in pair callbacks. This can only add pairs.
 			template <typename T>
 			void UpdatePairs(T* callback);
+			void UpdatePairs(BroadPhasePairCallback* callback);
 
 			/// Query an AABB for overlapping proxies. The callback class
 			/// is called for each proxy that overlaps the supplied AABB.
+			/// Served from the wide tree when it is enabled and up to date, from
+			/// the binary tree otherwise. Only reads the broad-phase, so several
+			/// threads may query at once.
 			template <typename T>
 			void Query(T* callback, const AABB& aabb) const;
+			void Query(BroadPhaseQueryCallback* callback, const AABB& aabb) const;
 
-			/// Ray-cast against the proxies in the tree. This relies on the callback
+			/// Ray-cast against the proxies in the tree. Served from the wide tree
+			/// when it is enabled and up to date. This relies on the callback
 			/// to perform a exact ray-cast in the case were the proxy contains a shape.
 			/// The callback also performs the any collision filtering. This has performance
 			/// roughly equal to k * log(n), where k is the number of collisions and n is the
@@ -75,6 +87,7 @@ namespace Break
 			/// @param callback a callback class that is called for each proxy that is hit by the ray.
 			template <typename T>
 			void RayCast(T* callback, const RayCastInput& input) const;
+			void RayCast(BroadPhaseRayCastCallback* callback, const RayCastInput& input) const;
 
 			/// Get the height of the embedded tree.
 			s32 GetTreeHeight() const;
@@ -90,9 +103,24 @@ namespace Break
 			/// @param newOrigin the new origin with respect to the old origin
 			void ShiftOrigin(const glm::vec2& newOrigin);
 
+			/// Enable/disable serving Query and RayCast from a read-only 4-wide copy
+			/// of the tree. The copy is rebuilt at the end of UpdatePairs. Queries
+			/// issued after the proxies changed use the binary tree until then.
+			/// On by default.
+			void SetWideTreeEnabled(bool flag);
+			bool IsWideTreeEnabled() const;
+
+			/// Rebuild the wide tree now if it is stale. Call this after changing
+			/// proxies between steps to serve the following queries from it.
+			void UpdateWideTree();
+
 		private:
 
 			friend class DynamicTree;
+			friend class WideTree;
+
+			/// Is the wide tree enabled and built from the current tree?
+			bool IsWideTreeCurrent() const;
 
 			void BufferMove(s32 proxyId);
 			void UnBufferMove(s32 proxyId);
@@ -112,6 +140,10 @@ namespace Break
 			s32 m_pairCount;
 
 			s32 m_queryProxyId;
+
+			WideTree m_wideTree;
+			u32 m_wideTreeRevision;
+			bool m_wideTreeEnabled;
 		};
 
 		/// This is used to sort pairs.
@@ -221,18 +253,45 @@ namespace Break
 
 			// Try to keep the tree balanced.
 			//m_tree.Rebalance(4);
+
+			// The tree is settled for this step.
+			UpdateWideTree();
+		}
+
+		inline bool BroadPhase::IsWideTreeEnabled() const
+		{
+			return m_wideTreeEnabled;
+		}
+
+		inline bool BroadPhase::IsWideTreeCurrent() const
+		{
+			return m_wideTreeEnabled && m_wideTreeRevision == m_tree.GetRevision();
 		}
 
 		template <typename T>
 		inline void BroadPhase::Query(T* callback, const AABB& aabb) const
 		{
-			m_tree.Query(callback, aabb);
+			if (IsWideTreeCurrent())
+			{
+				m_wideTree.Query(callback, aabb);
+			}
+			else
+			{
+				m_tree.Query(callback, aabb);
+			}
 		}
 
 		template <typename T>
 		inline void BroadPhase::RayCast(T* callback, const RayCastInput& input) const
 		{
-			m_tree.RayCast(callback, input);
+			if (IsWideTreeCurrent())
+			{
+				m_wideTree.RayCast(callback, input);
+			}
+			else
+			{
+				m_tree.RayCast(callback, input);
+			}
 		}
 
 		inline void BroadPhase::ShiftOrigin(const glm::vec2& newOrigin)
@@ -0,0 +1,36 @@
+#pragma once
+#include "BroadPhase.hpp"
+#include "SweepAndPrune.hpp"
+#include "SpatialHash.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		/// Call op with the broad-phase cast to its concrete type. The op has a
+		/// templated operator() taking a const pointer to each broad-phase type;
+		/// it runs the templated Query or RayCast of that type, so the callback
+		/// and GetUserData are direct calls for every proxy instead of virtual
+		/// ones. The switch happens once per query.
+		template <typename Op>
+		inline void DispatchBroadPhase(const IBroadPhase* broadPhase, Op& op)
+		{
+			switch (broadPhase->GetType())
+			{
+			case sweepAndPruneBroadPhase:
+				op(static_cast<const SweepAndPrune*>(broadPhase));
+				break;
+
+			case spatialHashBroadPhase:
+				op(static_cast<const SpatialHash*>(broadPhase));
+				break;
+
+			default:
+				op(static_cast<const BroadPhase*>(broadPhase));
+				break;
+			}
+		}
+
+	}
+}
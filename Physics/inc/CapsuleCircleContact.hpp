@@ -0,0 +1,27 @@
+#pragma once
+#include "Contact2D.hpp"
+
+namespace Break
+{
+
+	namespace Physics
+	{
+
+		class BREAK_API BlockAllocator;
+
+		class BREAK_API CapsuleAndCircleContact : public Contact
+		{
+		public:
+			static Contact* Create(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB, BlockAllocator* allocator);
+
+			static void Destroy(Contact* contact, BlockAllocator* allocator);
+
+			CapsuleAndCircleContact(Fixture* fixtureA, Fixture* fixtureB);
+			~CapsuleAndCircleContact() {}
+
+			void Evaluate(Manifold* manifold, const Transform2D& xfA, const Transform2D& xfB);
+		};
+
+
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "Shape.hpp"
+
+namespace Break
+{
+
+	namespace Physics
+	{
+
+		class BREAK_API PolygonShape;
+
+		/// A capsule: a segment with a radius, or the convex hull of two circles
+		/// of the same radius. Capsules collide with circles and other capsules
+		/// analytically and with polygons and edges as a two sided polygon, which
+		/// is much cheaper than a rounded body built from a full PolygonShape.
+		class BREAK_API CapsuleShape : public Shape
+		{
+		public:
+			CapsuleShape();
+
+			/// Set the segment and the radius.
+			void Set(const glm::vec2& v1, const glm::vec2& v2, real32 radius);
+
+			/// Build a capsule along the y-axis centered on the local origin.
+			/// @param halfHeight the half distance between the circle centers.
+			/// @param radius the radius.
+			void SetAsVertical(real32 halfHeight, real32 radius);
+
+			/// Implement Shape.
+			Shape* Clone(BlockAllocator* allocator) const;
+
+			/// @see Shape::GetChildCount
+			s32 GetChildCount() const;
+
+			/// @see Shape::TestPoint
+			bool TestPoint(const Transform2D& xf, const glm::vec2& p) const;
+
+			/// Implement Shape. Rays starting inside the capsule do not hit it.
+			bool RayCast(RayCastOutput* output, const RayCastInput& input, const Transform2D& xf, s32 childIndex) const;
+
+			/// @see Shape::ComputeDistance
+			void ComputeDistance(const Transform2D& xf, const glm::vec2& p, real32* distance, glm::vec2* normal, s32 childIndex) const;
+
+			/// @see Shape::ComputeAABB
+			void ComputeAABB(AABB* aabb, const Transform2D& xf, s32 childIndex) const;
+
+			/// @see Shape::ComputeMass
+			void ComputeMass(MassData* massData, real32 density) const;
+
+			/// Get the capsule as a polygon with the two sides of the segment and
+			/// the capsule radius. Used to collide with polygons and edges.
+			void GetPolygon(PolygonShape* polygon) const;
+
+			/// The segment vertices. They are kept together for DistanceProxy.
+			glm::vec2 m_vertex1, m_vertex2;
+		};
+
+		inline CapsuleShape::CapsuleShape()
+		{
+			m_type = capsule;
+			m_radius = 0.0f;
+			m_vertex1 = glm::vec2(0.0f, 0.0f);
+			m_vertex2 = glm::vec2(0.0f, 0.0f);
+		}
+
+	}
+
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "Shape.hpp"
+#include "StaticTree.hpp"
 
 namespace Break
 {
@@ -14,6 +15,9 @@ namespace Break
 		/// Therefore, you may use any winding order.
 		/// Since there may be many vertices, they are allocated using Alloc.
 		/// Connectivity information is used to create smooth collisions.
+		/// Like a mesh, a chain has one child and one broad-phase proxy. Its edges are
+		/// elements in a tree built with the chain, and the contact manager creates
+		/// one contact per edge under each overlapping proxy.
 		/// WARNING: The chain will not collide properly if there are self-intersections.
 		class BREAK_API ChainShape : public Shape
 		{
@@ -44,19 +48,41 @@ namespace Break
 			/// Implement Shape. Vertices are cloned using Alloc.
 			Shape* Clone(BlockAllocator* allocator) const;
 
+			/// A chain has one child, the whole chain.
 			/// @see Shape::GetChildCount
 			s32 GetChildCount() const;
 
-			/// Get a child edge.
+			/// Get the number of edges.
+			s32 GetEdgeCount() const;
+
+			/// Get an edge with its neighbor vertices.
 			void GetChildEdge(EdgeShape* edge, s32 index) const;
 
+			/// Query the edges whose bounds overlap a world AABB. The callback
+			/// class is called with the index of each edge.
+			/// @param xf the world transform of the chain.
+			template <typename T>
+			void Query(T* callback, const AABB& aabb, const Transform2D& xf) const;
+
+			/// @see Shape::GetElementTree
+			const StaticTree* GetElementTree() const;
+
+			/// Compute the bounding box of an edge.
+			/// @see Shape::ComputeElementAABB
+			void ComputeElementAABB(AABB* aabb, const Transform2D& xf, s32 index) const;
+
 			/// This always return false.
 			/// @see Shape::TestPoint
 			bool TestPoint(const Transform2D& Transform2D, const glm::vec2& p) const;
 
-			/// Implement Shape.
+			/// Cast a ray against all edges and report the closest hit.
 			bool RayCast(RayCastOutput* output, const RayCastInput& input,const Transform2D& Transform2D, s32 childIndex) const;
 
+			/// Compute the distance to one edge. Here childIndex is an edge index.
+			/// @see Shape::ComputeDistance
+			void ComputeDistance(const Transform2D& xf, const glm::vec2& p, real32* distance, glm::vec2* normal, s32 childIndex) const;
+
+			/// Compute the bounds of the whole chain.
 			/// @see Shape::ComputeAABB
 			void ComputeAABB(AABB* aabb, const Transform2D& Transform2D, s32 childIndex) const;
 
@@ -72,6 +98,16 @@ namespace Break
 
 			glm::vec2 m_prevVertex, m_nextVertex;
 			bool m_hasPrevVertex, m_hasNextVertex;
+
+			/// The tree over the edges, built by CreateLoop and CreateChain.
+			StaticTree m_tree;
+
+		private:
+
+			ChainShape(const ChainShape&);
+			ChainShape& operator=(const ChainShape&);
+
+			void BuildTree();
 		};
 
 		inline ChainShape::ChainShape()
@@ -84,6 +120,22 @@ namespace Break
 			m_hasNextVertex = false;
 		}
 
+		inline s32 ChainShape::GetEdgeCount() const
+		{
+			return m_count - 1;
+		}
+
+		inline const StaticTree* ChainShape::GetElementTree() const
+		{
+			return &m_tree;
+		}
+
+		template <typename T>
+		inline void ChainShape::Query(T* callback, const AABB& aabb, const Transform2D& xf) const
+		{
+			m_tree.Query(callback, aabb, xf);
+		}
+
 
 
 
@@ -14,6 +14,8 @@ namespace Break
 		class BREAK_API CircleShape;
 		class BREAK_API EdgeShape;
 		class BREAK_API PolygonShape;
+		class BREAK_API CapsuleShape;
+		struct BREAK_API SimplexCache;
 
 
 		const u8 nullFeature = UCHAR_MAX;
@@ -204,6 +206,26 @@ namespace Break
 			glm::vec2 upperBound;	///< the upper vertex
 		};
 
+		/// Used to warm start CollidePolygons. A contact keeps one across steps. It
+		/// remembers the separating axis or the reference face of the last full
+		/// separating axis test and where polygon B was relative to polygon A.
+		/// Set type to none on first call.
+		struct BREAK_API SeparationCache
+		{
+			enum Type
+			{
+				none = 0,
+				separatedA,		///< index is an edge of A that separates the polygons
+				separatedB,		///< index is an edge of B that separates the polygons
+				faceA,			///< index is the reference edge on A
+				faceB			///< index is the reference edge on B
+			};
+
+			Transform2D xf;		///< the transform of B relative to A
+			u8 type;
+			u8 index;
+		};
+
 		/// Compute the collision manifold between two circles.
 		void BREAK_API CollideCircles(Manifold* manifold,const CircleShape* circleA, const Transform2D& xfA,const CircleShape* circleB, const Transform2D& xfB);
 
@@ -213,18 +235,49 @@ namespace Break
 		/// Compute the collision manifold between two polygons.
 		void BREAK_API CollidePolygons(Manifold* manifold,const PolygonShape* polygonA, const Transform2D& xfA,const PolygonShape* polygonB, const Transform2D& xfB);
 
+		/// Compute the collision manifold between two polygons. A cached separating axis
+		/// is checked first, and a cached reference face is reused without the separating
+		/// axis test while polygon B has moved less than a small fraction of linearSlop
+		/// relative to polygon A. The cache is input/output.
+		void BREAK_API CollidePolygons(Manifold* manifold, SeparationCache* cache, const PolygonShape* polygonA, const Transform2D& xfA, const PolygonShape* polygonB, const Transform2D& xfB);
+
 		/// Compute the collision manifold between an edge and a circle.
 		void BREAK_API CollideEdgeAndCircle(Manifold* manifold,const EdgeShape* polygonA, const Transform2D& xfA,const CircleShape* circleB, const Transform2D& xfB);
 
 		/// Compute the collision manifold between an edge and a circle.
 		void BREAK_API CollideEdgeAndPolygon(Manifold* manifold,const EdgeShape* edgeA, const Transform2D& xfA,const PolygonShape* circleB, const Transform2D& xfB);
 
+		/// Compute the collision manifold between a capsule and a circle.
+		void BREAK_API CollideCapsuleAndCircle(Manifold* manifold, const CapsuleShape* capsuleA, const Transform2D& xfA, const CircleShape* circleB, const Transform2D& xfB);
+
+		/// Compute the collision manifold between two capsules. Segments that lie
+		/// side by side get two points, so a capsule can rest on another.
+		void BREAK_API CollideCapsules(Manifold* manifold, const CapsuleShape* capsuleA, const Transform2D& xfA, const CapsuleShape* capsuleB, const Transform2D& xfB);
+
+		/// Compute the collision manifold between a polygon and a capsule. The capsule
+		/// is collided as a two sided polygon. The cache works as in CollidePolygons.
+		void BREAK_API CollidePolygonAndCapsule(Manifold* manifold, SeparationCache* cache, const PolygonShape* polygonA, const Transform2D& xfA, const CapsuleShape* capsuleB, const Transform2D& xfB);
+
+		/// Compute the collision manifold between an edge and a capsule, taking the
+		/// edge adjacency into account.
+		void BREAK_API CollideEdgeAndCapsule(Manifold* manifold, const EdgeShape* edgeA, const Transform2D& xfA, const CapsuleShape* capsuleB, const Transform2D& xfB);
+
 		/// Clipping for contact manifolds.
 		s32 BREAK_API ClipSegmentToLine(ClipVertex vOut[2], const ClipVertex vIn[2],const glm::vec2& normal, real32 offset, s32 vertexIndexA);
 
 		/// Determine if two generic shapes overlap.
 		bool BREAK_API TestOverlap(const Shape* shapeA, s32 indexA,const Shape* shapeB, s32 indexB,const Transform2D& xfA, const Transform2D& xfB);
 
+		/// Determine if two generic shapes overlap, warm starting GJK from a simplex cache.
+		/// The cache is input/output. On the first call set SimplexCache.count to zero.
+		/// A circle is tested against the other shape with Shape::ComputeDistance.
+		bool BREAK_API TestOverlap(SimplexCache* cache, const Shape* shapeA, s32 indexA, const Shape* shapeB, s32 indexB, const Transform2D& xfA, const Transform2D& xfB);
+
+		/// Determine if a box moving by a translation touches another box at some
+		/// fraction of the translation in [0, maxFraction]. Used to prune shape
+		/// cast candidates before running TimeOfImpact on them.
+		bool BREAK_API TestSweptOverlap(const AABB& moving, const glm::vec2& translation, real32 maxFraction, const AABB& box);
+
 		// ---------------- Inline Functions ------------------------------------------
 		
 		inline bool AABB::IsValid() const
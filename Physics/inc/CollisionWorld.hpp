@@ -0,0 +1,241 @@
+#pragma once
+#include "Globals.hpp"
+#include "MathUtils.hpp"
+#include "BlockAllocator.hpp"
+#include "DynamicTree.hpp"
+#include "Fixture.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		class BREAK_API Shape;
+		class BREAK_API CollisionObject;
+		class BREAK_API CollisionWorld;
+
+		/// Callback class for CollisionWorld::QueryAABB.
+		class BREAK_API CollisionQueryCallback
+		{
+		public:
+			virtual ~CollisionQueryCallback() {}
+
+			/// Called for each object child whose AABB overlaps the query AABB.
+			/// @return false to terminate the query.
+			virtual bool ReportObject(CollisionObject* object, s32 childIndex) = 0;
+		};
+
+		/// Callback class for CollisionWorld::RayCast and CollisionWorld::ShapeCast.
+		/// The return value works as in RayCastCallback::ReportFixture.
+		class BREAK_API CollisionCastCallback
+		{
+		public:
+			virtual ~CollisionCastCallback() {}
+
+			/// Called for each object hit by the ray or the cast shape.
+			/// @param object the object that was hit
+			/// @param point the point of initial contact
+			/// @param normal the surface normal of the object at the point
+			/// @param fraction the fraction of the cast travelled at the hit
+			/// @return -1 to filter, 0 to terminate, fraction to clip the cast for
+			/// closest hit, 1 to continue
+			virtual real32 ReportObject(CollisionObject* object, const glm::vec2& point, const glm::vec2& normal, real32 fraction) = 0;
+		};
+
+		/// Callback class for CollisionWorld::ComputeOverlapPairs.
+		class BREAK_API CollisionPairCallback
+		{
+		public:
+			virtual ~CollisionPairCallback() {}
+
+			/// Called for each pair of overlapping object children. For a mesh the
+			/// child index is the index of the overlapping element.
+			virtual void ReportPair(CollisionObject* objectA, s32 childIndexA, CollisionObject* objectB, s32 childIndexB) = 0;
+		};
+
+		/// This proxy is used internally to connect object children to the tree.
+		struct BREAK_API CollisionProxy
+		{
+			AABB aabb;
+			CollisionObject* object;
+			s32 childIndex;
+			s32 proxyId;
+		};
+
+		/// A shape placed in a collision world. Created with CollisionWorld::CreateObject.
+		class BREAK_API CollisionObject
+		{
+		public:
+			/// Get the shape. The shape is a copy owned by the world.
+			const Shape* GetShape() const;
+
+			/// Get the world transform of the shape.
+			const Transform2D& GetTransform() const;
+
+			/// Get the collision filter.
+			const Filter& GetFilterData() const;
+
+			/// Set the collision filter. It takes effect on the next query.
+			void SetFilterData(const Filter& filter);
+
+			/// Get the user data that was assigned when the object was created.
+			void* GetUserData() const;
+
+			/// Set the user data.
+			void SetUserData(void* data);
+
+			/// Get the next object in the world object list.
+			CollisionObject* GetNext();
+			const CollisionObject* GetNext() const;
+
+		private:
+
+			friend class CollisionWorld;
+
+			CollisionObject() {}
+			~CollisionObject() {}
+
+			Shape* m_shape;
+			Transform2D m_xf;
+			Filter m_filter;
+			void* m_userData;
+
+			CollisionProxy* m_proxies;
+			s32 m_proxyCount;
+
+			CollisionObject* m_prev;
+			CollisionObject* m_next;
+		};
+
+		/// A collision world holds shapes with transforms in a dynamic tree and
+		/// answers spatial queries: AABB queries, ray casts, shape casts and the
+		/// pairs of overlapping shapes. It has no bodies, contacts, islands or
+		/// solvers and nothing needs to be stepped; moving an object updates the
+		/// tree right away. Use it for triggers, sensing and picking, where a
+		/// World would do a lot of work that is thrown away.
+		class BREAK_API CollisionWorld
+		{
+		public:
+			CollisionWorld();
+
+			/// Destroys all objects.
+			~CollisionWorld();
+
+			/// Create an object. The shape is cloned.
+			CollisionObject* CreateObject(const Shape* shape, const Transform2D& xf, void* userData);
+			CollisionObject* CreateObject(const Shape* shape, const Transform2D& xf, void* userData, const Filter& filter);
+
+			/// Destroy an object.
+			void DestroyObject(CollisionObject* object);
+
+			/// Move an object. Its proxies are only re-inserted in the tree once the
+			/// object leaves their fattened AABBs.
+			void SetTransform(CollisionObject* object, const Transform2D& xf);
+
+			/// Get the object list. Use CollisionObject::GetNext to walk it.
+			CollisionObject* GetObjectList();
+			const CollisionObject* GetObjectList() const;
+
+			/// Get the number of objects.
+			s32 GetObjectCount() const;
+
+			/// Query the world for all object children whose AABB overlaps the
+			/// provided AABB.
+			void QueryAABB(CollisionQueryCallback* callback, const AABB& aabb) const;
+
+			/// Ray-cast the world for all objects in the path of the ray. Shapes
+			/// that contain the starting point are ignored.
+			/// @param point1 the ray starting point
+			/// @param point2 the ray ending point
+			void RayCast(CollisionCastCallback* callback, const glm::vec2& point1, const glm::vec2& point2) const;
+
+			/// Sweep a convex shape along a translation without rotating it and report
+			/// the objects it hits. Objects the shape overlaps at the start are reported
+			/// at fraction zero.
+			/// @param shape a circle, polygon, edge or capsule.
+			/// @param xf the start transform of the shape.
+			/// @param translation the sweep translation.
+			void ShapeCast(CollisionCastCallback* callback, const Shape* shape, const Transform2D& xf, const glm::vec2& translation) const;
+
+			/// Report every pair of overlapping object children whose filters let them
+			/// collide. Each pair is reported once. Pairs are found in the tree and
+			/// then tested exactly with GJK.
+			void ComputeOverlapPairs(CollisionPairCallback* callback) const;
+
+			/// Get the dynamic tree, for statistics.
+			const DynamicTree& GetTree() const;
+
+		private:
+
+			CollisionWorld(const CollisionWorld&);
+			CollisionWorld& operator=(const CollisionWorld&);
+
+			BlockAllocator m_blockAllocator;
+			DynamicTree m_tree;
+
+			CollisionObject* m_objectList;
+			s32 m_objectCount;
+		};
+
+		inline const Shape* CollisionObject::GetShape() const
+		{
+			return m_shape;
+		}
+
+		inline const Transform2D& CollisionObject::GetTransform() const
+		{
+			return m_xf;
+		}
+
+		inline const Filter& CollisionObject::GetFilterData() const
+		{
+			return m_filter;
+		}
+
+		inline void CollisionObject::SetFilterData(const Filter& filter)
+		{
+			m_filter = filter;
+		}
+
+		inline void* CollisionObject::GetUserData() const
+		{
+			return m_userData;
+		}
+
+		inline void CollisionObject::SetUserData(void* data)
+		{
+			m_userData = data;
+		}
+
+		inline CollisionObject* CollisionObject::GetNext()
+		{
+			return m_next;
+		}
+
+		inline const CollisionObject* CollisionObject::GetNext() const
+		{
+			return m_next;
+		}
+
+		inline CollisionObject* CollisionWorld::GetObjectList()
+		{
+			return m_objectList;
+		}
+
+		inline const CollisionObject* CollisionWorld::GetObjectList() const
+		{
+			return m_objectList;
+		}
+
+		inline s32 CollisionWorld::GetObjectCount() const
+		{
+			return m_objectCount;
+		}
+
+		inline const DynamicTree& CollisionWorld::GetTree() const
+		{
+			return m_tree;
+		}
+
+	}
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "MathUtils.hpp"
 #include "Collision.hpp"
+#include "Distance.hpp"
 #include "Shape.hpp"
 #include "Fixture.hpp"
 
@@ -16,6 +17,7 @@ namespace Break
 		class BREAK_API BlockAllocator;
 		class BREAK_API StackAllocator;
 		class BREAK_API ContactListener;
+		class BREAK_API ContactEvents;
 
 		/// Friction mixing law. The idea is to allow either fixture to drive the restitution to zero.
 		/// For example, anything slides on ice.
@@ -134,6 +136,7 @@ namespace Break
 			friend class ContactSolver;
 			friend class Body;
 			friend class Fixture;
+			friend class TOIQueue;
 
 			// Flags stored in m_flags
 			enum
@@ -157,7 +160,8 @@ namespace Break
 				toiFlag			= 0x0020
 			};
 
-			/// Flag this contact for filtering. Filtering will occur the next time step.
+			/// Flag this contact for filtering. Filtering will occur the next time step,
+			/// even if both bodies are asleep.
 			void FlagForFiltering();
 
 			static void AddType(ContactCreateFcn* createFcn, ContactDestroyFcn* destroyFcn,Shape::Type typeA, Shape::Type typeB);
@@ -170,7 +174,7 @@ namespace Break
 			Contact(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB);
 			virtual ~Contact() {}
 
-			void Update(ContactListener* listener);
+			void Update(ContactListener* listener, ContactEvents* events);
 
 			static ContactRegister s_registers[Shape::typeCount][Shape::typeCount];
 			static bool s_initialized;
@@ -181,6 +185,12 @@ namespace Break
 			Contact* m_prev;
 			Contact* m_next;
 
+			// Index in ContactManager::m_contacts.
+			s32 m_managerIndex;
+
+			// Index in ContactManager::m_filterContacts, -1 unless flagged for filtering.
+			s32 m_filterIndex;
+
 			// Nodes for connecting bodies.
 			ContactEdge m_nodeA;
 			ContactEdge m_nodeB;
@@ -193,9 +203,23 @@ namespace Break
 
 			Manifold m_manifold;
 
+			// Narrow-phase state kept across steps. The separating axis or reference
+			// face of polygon pairs, and the GJK simplex of time of impact queries.
+			SeparationCache m_separationCache;
+			SimplexCache m_simplexCache;
+
 			s32 m_toiCount;
 			real32 m_toi;
 
+			// Slot in the world TOI queue, -1 when not queued.
+			s32 m_toiIndex;
+
+			// World TOI stamp of the last step that reset the TOI state above.
+			u32 m_toiStamp;
+
+			// Stamp of the last World::Collide pass that updated this contact.
+			u32 m_collideStamp;
+
 			real32 m_friction;
 			real32 m_restitution;
 
@@ -284,11 +308,6 @@ namespace Break
 			return m_indexB;
 		}
 
-		inline void Contact::FlagForFiltering()
-		{
-			m_flags |= filterFlag;
-		}
-
 		inline void Contact::SetFriction(real32 friction)
 		{
 			m_friction = friction;
@@ -0,0 +1,195 @@
+#pragma once
+#include "MathUtils.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		class BREAK_API Fixture;
+		class BREAK_API Contact;
+		struct BREAK_API ContactVelocityConstraint;
+		struct BREAK_API SensorOverlap;
+
+		/// The kinds of contact events a world can record. Kinds that are not
+		/// enabled are never produced.
+		enum ContactEventFlags
+		{
+			beginContactEvents	= 0x0001,
+			endContactEvents	= 0x0002,
+			impulseContactEvents	= 0x0004
+		};
+
+		/// Two fixture children that began or ceased to touch. For a sensor
+		/// overlap fixtureA is the sensor.
+		struct BREAK_API ContactTouchEvent
+		{
+			Fixture* fixtureA;
+			Fixture* fixtureB;
+			s32 childIndexA;
+			s32 childIndexB;
+
+			/// Set on the end event of a contact destroyed with one of its
+			/// fixtures or bodies. The fixture pointers then only identify the
+			/// pair and must not be dereferenced.
+			bool destroyed;
+		};
+
+		/// A summary of the impulses the solver applied to a touching contact.
+		struct BREAK_API ContactImpulseEvent
+		{
+			Fixture* fixtureA;
+			Fixture* fixtureB;
+			s32 childIndexA;
+			s32 childIndexB;
+
+			/// The world contact normal, pointing from A to B.
+			glm::vec2 normal;
+
+			/// The sum of the normal impulses over the contact points.
+			real32 normalImpulse;
+
+			/// The largest normal impulse of one contact point.
+			real32 maxNormalImpulse;
+
+			/// The sum of the tangent impulses over the contact points.
+			real32 tangentImpulse;
+
+			s32 pointCount;
+		};
+
+		/// Flat arrays of the contact events of the last time step. This is the
+		/// bulk alternative to ContactListener: the world appends to plain arrays
+		/// during the step and you read them after World::Step returns, instead of
+		/// taking one virtual call per contact in the middle of the step.
+		/// The arrays are cleared when the next step starts.
+		/// Like PostSolve, a contact may get several impulse events in a step when
+		/// it is solved again in a sub-step.
+		/// Touching contacts destroyed between steps, by destroying a body or
+		/// fixture, deactivating a body or changing its type, are reported as end
+		/// events of the next step.
+		/// @see World::SetContactEventFlags
+		class BREAK_API ContactEvents
+		{
+		public:
+			ContactEvents();
+			~ContactEvents();
+
+			/// Choose the kinds of events to record, a combination of ContactEventFlags.
+			/// Zero records nothing.
+			void SetFlags(u32 flags);
+			u32 GetFlags() const;
+
+			/// Only record impulse events whose largest point impulse reaches this value.
+			void SetImpulseThreshold(real32 threshold);
+			real32 GetImpulseThreshold() const;
+
+			/// Forget all events.
+			void Clear();
+
+			/// Forget the events of the last step, keeping the end events recorded
+			/// since it returned so they are reported with the coming step.
+			void BeginStep();
+
+			/// Mark the end of a step. End events recorded after this are kept by
+			/// the next BeginStep.
+			void EndStep();
+
+			/// Get the contacts that began to touch.
+			const ContactTouchEvent* GetBeginEvents() const;
+			s32 GetBeginEventCount() const;
+
+			/// Get the contacts that ceased to touch.
+			const ContactTouchEvent* GetEndEvents() const;
+			s32 GetEndEventCount() const;
+
+			/// Get the impulse summaries.
+			const ContactImpulseEvent* GetImpulseEvents() const;
+			s32 GetImpulseEventCount() const;
+
+			/// Record that a contact began to touch if begin events are enabled.
+			void AddBegin(Contact* contact);
+
+			/// Record that a contact ceased to touch if end events are enabled.
+			/// @param destroyed the contact is destroyed with a fixture or body.
+			void AddEnd(Contact* contact, bool destroyed);
+
+			/// Record that a sensor overlap began if begin events are enabled.
+			void AddBegin(const SensorOverlap* overlap);
+
+			/// Record that a sensor overlap ended if end events are enabled.
+			/// @param destroyed the overlap is destroyed with a fixture or body.
+			void AddEnd(const SensorOverlap* overlap, bool destroyed);
+
+			/// Record the impulses of a solved contact if impulse events are enabled
+			/// and the impulse reaches the threshold.
+			void AddImpulse(Contact* contact, const ContactVelocityConstraint* vc);
+
+		private:
+
+			ContactEvents(const ContactEvents&);
+			ContactEvents& operator=(const ContactEvents&);
+
+			void AddTouch(ContactTouchEvent** events, s32* count, s32* capacity, Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB, bool destroyed);
+
+			u32 m_flags;
+			real32 m_impulseThreshold;
+
+			ContactTouchEvent* m_beginEvents;
+			s32 m_beginCount;
+			s32 m_beginCapacity;
+
+			ContactTouchEvent* m_endEvents;
+			s32 m_endCount;
+			s32 m_endCapacity;
+
+			/// The number of end events when the last step returned.
+			s32 m_stepEndCount;
+
+			ContactImpulseEvent* m_impulseEvents;
+			s32 m_impulseCount;
+			s32 m_impulseCapacity;
+		};
+
+		inline u32 ContactEvents::GetFlags() const
+		{
+			return m_flags;
+		}
+
+		inline real32 ContactEvents::GetImpulseThreshold() const
+		{
+			return m_impulseThreshold;
+		}
+
+		inline const ContactTouchEvent* ContactEvents::GetBeginEvents() const
+		{
+			return m_beginEvents;
+		}
+
+		inline s32 ContactEvents::GetBeginEventCount() const
+		{
+			return m_beginCount;
+		}
+
+		inline const ContactTouchEvent* ContactEvents::GetEndEvents() const
+		{
+			return m_endEvents;
+		}
+
+		inline s32 ContactEvents::GetEndEventCount() const
+		{
+			return m_endCount;
+		}
+
+		inline const ContactImpulseEvent* ContactEvents::GetImpulseEvents() const
+		{
+			return m_impulseEvents;
+		}
+
+		inline s32 ContactEvents::GetImpulseEventCount() const
+		{
+			return m_impulseCount;
+		}
+
+	}
+}
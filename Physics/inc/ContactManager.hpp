@@ -1,5 +1,6 @@
 #pragma once
-#include "BroadPhase.hpp"
+#include "IBroadPhase.hpp"
+#include "SensorOverlap.hpp"
 
 namespace Break
 {
@@ -7,30 +8,123 @@ namespace Break
 	{
 
 		class BREAK_API Contact;
+		class BREAK_API Fixture;
+		class BREAK_API Body;
+		struct BREAK_API FixtureProxy;
 		class BREAK_API ContactFilter;
 		class BREAK_API ContactListener;
+		class BREAK_API ContactEvents;
 		class BREAK_API BlockAllocator;
 
 		// Delegate of World.
-		class BREAK_API ContactManager
+		class BREAK_API ContactManager : public BroadPhasePairCallback
 		{
 		public:
 			ContactManager();
+			~ContactManager();
 
 			// Broad-phase callback.
 			void AddPair(void* proxyUserDataA, void* proxyUserDataB);
 
+			// Add the pairs between the mesh elements or chain edges under a proxy and that proxy.
+			void AddElementPairs(FixtureProxy* treeProxy, FixtureProxy* proxy);
+
+			// Is there a contact between these fixture children?
+			bool FindContact(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB) const;
+
+			// Create, link and wake a new contact. The factory may refuse the pair.
+			void CreateContact(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB);
+
 			void FindNewContacts();
 
-			void Destroy(Contact* c);
+			// Destroy a contact, reporting its end if it was touching. Pass
+			// destroyed when a fixture of the contact is being destroyed.
+			void Destroy(Contact* c, bool destroyed);
+
+			// Link a new contact into the world and body contact lists.
+			void Insert(Contact* c);
+
+			// Destroy all contacts without calling the listener or waking bodies.
+			void Clear();
+
+			// Filter and update one contact. This may destroy the contact.
+			void Collide(Contact* c);
+
+			// Flag a contact for filtering and queue it, so World::Collide filters
+			// it even if both of its bodies sleep.
+			void FlagForFiltering(Contact* c);
+
+			// Take a contact off the filter queue.
+			void UnqueueFilter(Contact* c);
+
+			// Rebuild the filter queue from the contact flags, after they were
+			// overwritten by a snapshot.
+			void RequeueFiltering();
+
+			// Do the fat AABBs of two fixture children overlap? A mesh or chain
+			// child is an element, tested with its own AABB.
+			bool TestChildOverlap(const Fixture* fixtureA, s32 indexA, const Fixture* fixtureB, s32 indexB) const;
+
+			// Get the index of the sensor overlap between these fixture children, or -1.
+			s32 FindOverlap(const Fixture* fixtureA, s32 indexA, const Fixture* fixtureB, s32 indexB) const;
 
-			void Collide();
+			// Create a sensor overlap for a pair where at least one fixture is a sensor.
+			void CreateOverlap(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB);
 
-			BroadPhase m_broadPhase;
+			// Add both sides of a new overlap to the lists of their fixtures, or
+			// point the lists at an overlap that moved. With remove set the
+			// overlap is taken out of the lists instead.
+			void LinkOverlap(s32 index);
+			void RelinkOverlap(s32 index, bool remove);
+
+			// Destroy a sensor overlap. The last overlap moves into its index.
+			void DestroyOverlap(s32 index, bool destroyed);
+
+			// Destroy the sensor overlaps of a body or of a fixture. Pass destroyed
+			// when the body or fixture is being destroyed.
+			void DestroyOverlaps(const Body* body, bool destroyed);
+			void DestroyOverlaps(const Fixture* fixture, bool destroyed);
+
+			// Destroy all sensor overlaps without calling the listener.
+			void ClearOverlaps();
+
+			// Flag the sensor overlaps of a fixture, or between two bodies, for filtering.
+			void FlagOverlapsForFiltering(const Fixture* fixture);
+			void FlagOverlapsForFiltering(const Body* bodyA, const Body* bodyB);
+
+			// Filter and test the sensor overlaps that involve an awake body.
+			void UpdateOverlaps();
+
+			// Owned, created by World from its WorldDef.
+			IBroadPhase* m_broadPhase;
 			Contact* m_contactList;
 			s32 m_contactCount;
+
+			// All contacts packed in [0, m_contactCount) for linear passes. Destroy
+			// moves the last contact into the hole, so the order is not stable.
+			Contact** m_contacts;
+			s32 m_contactCapacity;
+
+			// The contacts flagged for filtering, packed like m_contacts.
+			Contact** m_filterContacts;
+			s32 m_filterCount;
+			s32 m_filterCapacity;
+
+			// Pairs reported by the broad-phase since World::Step last reset it.
+			s32 m_pairCount;
 			ContactFilter* m_contactFilter;
 			ContactListener* m_contactListener;
+
+			// Sensor overlaps packed in [0, m_overlapCount). The buckets hold the
+			// first overlap of each hash chain, -1 when empty.
+			SensorOverlap* m_overlaps;
+			s32 m_overlapCount;
+			s32 m_overlapCapacity;
+			s32* m_overlapBuckets;
+			s32 m_overlapBucketCount;
+
+			// Set by World::Step while contact events are recorded, NULL otherwise.
+			ContactEvents* m_contactEvents;
 			BlockAllocator* m_allocator;
 		};
 
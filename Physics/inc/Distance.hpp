@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include "Globals.hpp"
 #include "MathUtils.hpp"
 #include "Transform2D.hpp"
@@ -72,6 +73,25 @@ namespace Break
 			s32 iterations;	///< number of GJK iterations used
 		};
 
+		/// GJK statistics, accumulated over all calls to Distance. These are atomic
+		/// because Distance and TimeOfImpact may run on several threads.
+		extern std::atomic<s32> _gjkCalls, _gjkIters, _gjkMaxIters;
+
+		/// Get the number of GJK iterations run so far on the calling thread. The
+		/// globals above mix the work of every world stepping at the same time,
+		/// a world takes the difference of this around its own step instead.
+		BREAK_API s32 GetThreadGJKIterations();
+
+		/// Raise an atomic statistic to at least value.
+		template <typename T>
+		inline void AtomicMax(std::atomic<T>& stat, T value)
+		{
+			T current = stat.load(std::memory_order_relaxed);
+			while (current < value && stat.compare_exchange_weak(current, value, std::memory_order_relaxed) == false)
+			{
+			}
+		}
+
 		/// Compute the closest points between two shapes. Supports any combination of:
 		/// CircleShape, PolygonShape, EdgeShape. The simplex cache is input/output.
 		/// On the first call set SimplexCache.count to zero.
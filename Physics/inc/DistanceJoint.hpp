@@ -85,9 +85,16 @@ namespace Break
 			/// Dump joint to dmLog
 			void Dump();
 
+			/// Implement Joint::SaveState
+			void SaveState(JointState* state) const;
+
+			/// Implement Joint::LoadState
+			void LoadState(const JointState* state);
+
 		protected:
 
 			friend class Joint;
+			friend class JointSolver;
 			DistanceJoint(const DistanceJointDef* data);
 
 			void InitVelocityConstraints(const SolverData& data);
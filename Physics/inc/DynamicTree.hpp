@@ -55,6 +55,12 @@ namespace Break
 			/// Create a proxy. Provide a tight fitting AABB and a userData pointer.
 			s32 CreateProxy(const AABB& aabb, void* userData);
 
+			/// Create count proxies at once and rebuild the whole tree top-down. This is
+			/// much faster than count calls to CreateProxy for large batches, such as
+			/// loading a level, and gives a better tree.
+			/// @param proxyIds receives the ids of the new proxies.
+			void CreateProxies(const AABB* aabbs, void* const* userData, s32 count, s32* proxyIds);
+
 			/// Destroy a proxy. This asserts if the id is invalid.
 			void DestroyProxy(s32 proxyId);
 
@@ -64,6 +70,9 @@ namespace Break
 			/// @return true if the proxy was re-inserted.
 			bool MoveProxy(s32 proxyId, const AABB& aabb1, const glm::vec2& displacement);
 
+			/// Replace the fattened AABB of a proxy. The proxy is re-inserted if the AABB changed.
+			void SetFatAABB(s32 proxyId, const AABB& fatAABB);
+
 			/// Get proxy user data.
 			/// @return the proxy user data or 0 if the id is invalid.
 			void* GetUserData(s32 proxyId) const;
@@ -103,16 +112,34 @@ namespace Break
 			/// Build an optimal tree. Very expensive. For testing.
 			void RebuildBottomUp();
 
+			/// Rebuild the tree top-down from its leaves, splitting each node where the
+			/// binned surface area heuristic is lowest. O(n log n).
+			void RebuildTopDown();
+
 			/// Shift the world origin. Useful for large worlds.
 			/// The shift formula is: position -= newOrigin
 			/// @param newOrigin the new origin with respect to the old origin
 			void ShiftOrigin(const glm::vec2& newOrigin);
 
+			/// Get a counter that changes whenever the tree structure or a node AABB changes.
+			/// Used to tell when derived structures such as a WideTree are stale.
+			u32 GetRevision() const;
+
 		private:
 
+			friend class WideTree;
+
+			struct BuildLeaf;
+
 			s32 AllocateNode();
 			void FreeNode(s32 node);
 
+			/// Grow the node pool to hold at least capacity nodes.
+			void Reserve(s32 capacity);
+
+			/// Build a subtree over the given leaves and return its root.
+			s32 BuildTopDown(BuildLeaf* leaves, s32 count, s32 depth);
+
 			void InsertLeaf(s32 node);
 			void RemoveLeaf(s32 node);
 
@@ -136,6 +163,8 @@ namespace Break
 			u32 m_path;
 
 			s32 m_insertionCount;
+
+			u32 m_revision;
 		};
 
 
@@ -152,6 +181,11 @@ namespace Break
 			return m_nodes[proxyId].aabb;
 		}
 
+		inline u32 DynamicTree::GetRevision() const
+		{
+			return m_revision;
+		}
+
 		template <typename T>
 		inline void DynamicTree::Query(T* callback, const AABB& aabb) const
 		{
@@ -193,11 +227,11 @@ namespace Break
 			glm::vec2 p1 = input.p1;
 			glm::vec2 p2 = input.p2;
 			glm::vec2 r = p2 - p1;
-			assert( MathUtils::LengthSquared(r) > 0.0f);
+			assert( Infrastructure::MathUtils::LengthSquared(r) > 0.0f);
 			r = glm::normalize(r);
 
 			// v is perpendicular to the segment.
-			glm::vec2 v = MathUtils::Cross2(1.0f, r);
+			glm::vec2 v = Infrastructure::MathUtils::Cross2(1.0f, r);
 			glm::vec2 abs_v = glm::abs(v);
 
 			// Separating axis for segment (Gino, p80).
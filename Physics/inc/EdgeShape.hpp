@@ -30,6 +30,9 @@ namespace Break
 			/// Implement Shape.
 			bool RayCast(RayCastOutput* output, const RayCastInput& input,const Transform2D& Transform2D, s32 childIndex) const;
 
+			/// @see Shape::ComputeDistance
+			void ComputeDistance(const Transform2D& xf, const glm::vec2& p, real32* distance, glm::vec2* normal, s32 childIndex) const;
+
 			/// @see Shape::ComputeAABB
 			void ComputeAABB(AABB* aabb, const Transform2D& Transform2D, s32 childIndex) const;
 
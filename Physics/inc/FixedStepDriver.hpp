@@ -0,0 +1,114 @@
+#pragma once
+#include "Globals.hpp"
+#include "Transform2D.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		class BREAK_API World;
+		class BREAK_API Body;
+
+		/// A fixed step driver definition holds the data needed to construct a driver.
+		struct BREAK_API FixedStepDef
+		{
+			FixedStepDef()
+			{
+				timeStep = 1.0f / 60.0f;
+				velocityIterations = 8;
+				positionIterations = 3;
+				maxStepsPerUpdate = 5;
+			}
+
+			/// The duration of one step in seconds.
+			real32 timeStep;
+
+			/// Iterations of the velocity constraint solver.
+			s32 velocityIterations;
+
+			/// Iterations of the position constraint solver.
+			s32 positionIterations;
+
+			/// The most steps one update may take. Time beyond that is dropped so
+			/// that a slow frame does not make the next frame slower.
+			s32 maxStepsPerUpdate;
+		};
+
+		/// Drives World::Step with a fixed time step from a variable frame time.
+		/// Frame time is accumulated and consumed in whole steps, so the simulation
+		/// only depends on the number of steps taken and not on the frame rate.
+		/// The time left over is used to interpolate body transforms between the
+		/// last two steps for rendering.
+		class BREAK_API FixedStepDriver
+		{
+		public:
+			FixedStepDriver(World* world, const FixedStepDef* def);
+			~FixedStepDriver();
+
+			/// Add the frame time and take the steps it completes.
+			/// @param frameTime the time since the last update in seconds.
+			/// @return the number of steps taken.
+			s32 Update(real64 frameTime);
+
+			/// Get the fraction of a step left in the accumulator, in [0,1).
+			real32 GetAlpha() const;
+
+			/// Get the transform of a body between the last two steps at GetAlpha.
+			/// Bodies that were asleep before the last step get their current transform.
+			Transform2D GetInterpolatedTransform(const Body* body) const;
+
+			/// Drop the accumulated time and the previous transforms, for example
+			/// after restoring a world snapshot.
+			void Reset();
+
+			/// Get the number of steps taken since construction.
+			u32 GetStepCount() const;
+
+			/// Get the driven world.
+			World* GetWorld() const;
+
+		private:
+
+			FixedStepDriver(const FixedStepDriver&);
+			FixedStepDriver& operator=(const FixedStepDriver&);
+
+			struct PreviousTransform
+			{
+				glm::vec2 position;
+				real32 angle;
+				u32 generation;
+				u32 step;
+			};
+
+			// Remember where the awake bodies are before the next step.
+			void RecordPrevious();
+
+			World* m_world;
+			FixedStepDef m_def;
+			real64 m_accumulator;
+			u32 m_stepCount;
+
+			// Indexed by body slot.
+			PreviousTransform* m_previous;
+			s32 m_previousCapacity;
+			bool m_hasPrevious;
+		};
+
+		inline real32 FixedStepDriver::GetAlpha() const
+		{
+			return (real32)(m_accumulator / m_def.timeStep);
+		}
+
+		inline u32 FixedStepDriver::GetStepCount() const
+		{
+			return m_stepCount;
+		}
+
+		inline World* FixedStepDriver::GetWorld() const
+		{
+			return m_world;
+		}
+
+	}
+}
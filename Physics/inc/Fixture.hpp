@@ -11,7 +11,7 @@ namespace Break
 
 		class BREAK_API BlockAllocator;
 		class BREAK_API Body;
-		class BREAK_API BroadPhase;
+		class BREAK_API IBroadPhase;
 		class BREAK_API Fixture;
 
 		/// This holds contact filtering data.
@@ -69,7 +69,8 @@ namespace Break
 			real32 density;
 
 			/// A sensor shape collects contact information but never generates a collision
-			/// response.
+			/// response. Sensors report overlaps through ContactListener::BeginSensor
+			/// and have no contacts.
 			bool isSensor;
 
 			/// Contact filtering data.
@@ -103,7 +104,8 @@ namespace Break
 			Shape* GetShape();
 			const Shape* GetShape() const;
 
-			/// Set if this fixture is a sensor.
+			/// Set if this fixture is a sensor. Its contacts or sensor overlaps are
+			/// replaced at the next time step.
 			void SetSensor(bool sensor);
 
 			/// Is this fixture a sensor (non-solid)?
@@ -196,10 +198,14 @@ namespace Break
 			void Destroy(BlockAllocator* allocator);
 
 			// These support body activation/deactivation.
-			void CreateProxies(BroadPhase* broadPhase, const Transform2D& xf);
-			void DestroyProxies(BroadPhase* broadPhase);
+			void CreateProxies(IBroadPhase* broadPhase, const Transform2D& xf);
+			void DestroyProxies(IBroadPhase* broadPhase);
 
-			void Synchronize(BroadPhase* broadPhase, const Transform2D& xf1, const Transform2D& xf2);
+			void Synchronize(IBroadPhase* broadPhase, const Transform2D& xf1, const Transform2D& xf2);
+
+			// Get the proxy of a contact child index. A mesh has one proxy and
+			// its contacts use element indices.
+			s32 GetProxyId(s32 childIndex) const;
 
 			real32 m_density;
 
@@ -214,6 +220,10 @@ namespace Break
 			FixtureProxy* m_proxies;
 			s32 m_proxyCount;
 
+			// The first sensor overlap side of this fixture, -1 when it has none.
+			// @see SensorOverlapEdge
+			s32 m_overlapList;
+
 			Filter m_filter;
 
 			bool m_isSensor;
@@ -328,6 +338,17 @@ namespace Break
 			return m_proxies[childIndex].aabb;
 		}
 
+		inline s32 Fixture::GetProxyId(s32 childIndex) const
+		{
+			if (m_shape->GetElementTree())
+			{
+				return m_proxies[0].proxyId;
+			}
+
+			assert(0 <= childIndex && childIndex < m_proxyCount);
+			return m_proxies[childIndex].proxyId;
+		}
+
 
 
 
@@ -60,6 +60,12 @@ namespace Break
 			/// Dump joint to dmLog
 			void Dump();
 
+			/// Implement Joint::SaveState
+			void SaveState(JointState* state) const;
+
+			/// Implement Joint::LoadState
+			void LoadState(const JointState* state);
+
 		protected:
 
 			friend class Joint;
@@ -0,0 +1,152 @@
+#pragma once
+#include "Globals.hpp"
+#include "Collision.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		/// The broad-phase algorithms a World can be built with.
+		enum BroadPhaseType
+		{
+			/// Dynamic AABB tree. A good default for most scenes.
+			treeBroadPhase,
+
+			/// Incremental sweep-and-prune over sorted endpoint arrays. Cheap per
+			/// step when motion is coherent and bodies are spread out, such as
+			/// side-scrolling levels.
+			sweepAndPruneBroadPhase,
+
+			/// Uniform grid stored in a flat hash table. Best for many bodies of
+			/// about the same size that move every step, such as debris or particles.
+			spatialHashBroadPhase
+		};
+
+		/// Receives potentially new pairs from IBroadPhase::UpdatePairs.
+		class BREAK_API BroadPhasePairCallback
+		{
+		public:
+			virtual ~BroadPhasePairCallback() {}
+
+			/// Called once per new pair with the user data of both proxies.
+			virtual void AddPair(void* proxyUserDataA, void* proxyUserDataB) = 0;
+		};
+
+		/// Receives the proxies found by IBroadPhase::Query. The concrete
+		/// broad-phases also take any class with this method as a template
+		/// parameter, which calls it directly.
+		class BREAK_API BroadPhaseQueryCallback
+		{
+		public:
+			virtual ~BroadPhaseQueryCallback() {}
+
+			/// @return false to terminate the query.
+			virtual bool QueryCallback(s32 proxyId) = 0;
+		};
+
+		/// Receives the proxies found by IBroadPhase::RayCast.
+		class BREAK_API BroadPhaseRayCastCallback
+		{
+		public:
+			virtual ~BroadPhaseRayCastCallback() {}
+
+			/// Perform the exact ray cast against the proxy.
+			/// @return 0 to terminate, a positive fraction to clip the ray, negative to ignore the proxy.
+			virtual real32 RayCastCallback(const RayCastInput& input, s32 proxyId) = 0;
+		};
+
+		/// The interface between the contact manager and a broad-phase algorithm.
+		/// A broad-phase stores a fat AABB per proxy, reports pairs whose fat AABBs
+		/// may have started to overlap and answers volume queries and ray casts.
+		/// It does not persist pairs: it is up to the client to consume the new
+		/// pairs and to track subsequent overlap with TestOverlap.
+		class BREAK_API IBroadPhase
+		{
+		public:
+
+			enum
+			{
+				nullProxy = -1
+			};
+
+			virtual ~IBroadPhase() {}
+
+			/// Get the algorithm of this broad-phase. Queries switch on it once to
+			/// run the templated queries of the concrete type.
+			/// @see DispatchBroadPhase
+			BroadPhaseType GetType() const { return m_type; }
+
+			/// Create a proxy with an initial AABB. Pairs are not reported until
+			/// UpdatePairs is called.
+			virtual s32 CreateProxy(const AABB& aabb, void* userData) = 0;
+
+			/// Create count proxies at once, for example when loading a level. Unlike
+			/// CreateProxy, the new proxies are not reported by UpdatePairs until they
+			/// are touched, so the client can leave out proxies that cannot collide
+			/// with each other.
+			/// @param proxyIds receives the ids of the new proxies.
+			virtual void CreateProxies(const AABB* aabbs, void* const* userData, s32 count, s32* proxyIds) = 0;
+
+			/// Destroy a proxy. It is up to the client to remove any pairs.
+			virtual void DestroyProxy(s32 proxyId) = 0;
+
+			/// Call MoveProxy as many times as you like, then when you are done
+			/// call UpdatePairs to finalized the proxy pairs (for your time step).
+			virtual void MoveProxy(s32 proxyId, const AABB& aabb, const glm::vec2& displacement) = 0;
+
+			/// Call to trigger a re-processing of it's pairs on the next call to UpdatePairs.
+			virtual void TouchProxy(s32 proxyId) = 0;
+
+			/// Get the fat AABB for a proxy.
+			virtual const AABB& GetFatAABB(s32 proxyId) const = 0;
+
+			/// Replace the fat AABB of a proxy without reporting pairs. World snapshots
+			/// use this so that a restored world finds pairs at the same steps.
+			virtual void SetFatAABB(s32 proxyId, const AABB& fatAABB) = 0;
+
+			/// Get user data from a proxy. Returns NULL if the id is invalid.
+			virtual void* GetUserData(s32 proxyId) const = 0;
+
+			/// Test overlap of fat AABBs.
+			virtual bool TestOverlap(s32 proxyIdA, s32 proxyIdB) const = 0;
+
+			/// Get the number of proxies.
+			virtual s32 GetProxyCount() const = 0;
+
+			/// Report every pair that may have started overlapping since the last call,
+			/// including all overlaps of new and touched proxies. This can only add pairs.
+			virtual void UpdatePairs(BroadPhasePairCallback* callback) = 0;
+
+			/// Query an AABB for overlapping proxies. The callback is called for
+			/// each proxy whose fat AABB overlaps the supplied AABB. Query and RayCast
+			/// only read the broad-phase, so several threads may issue them at once
+			/// while no proxy is changed.
+			virtual void Query(BroadPhaseQueryCallback* callback, const AABB& aabb) const = 0;
+
+			/// Ray-cast against the proxies. This relies on the callback to perform
+			/// an exact ray-cast in the case were the proxy contains a shape.
+			/// @param input the ray-cast input data. The ray extends from p1 to p1 + maxFraction * (p2 - p1).
+			virtual void RayCast(BroadPhaseRayCastCallback* callback, const RayCastInput& input) const = 0;
+
+			/// Shift the world origin. Useful for large worlds.
+			/// The shift formula is: position -= newOrigin
+			/// @param newOrigin the new origin with respect to the old origin
+			virtual void ShiftOrigin(const glm::vec2& newOrigin) = 0;
+
+			/// Get the height of the embedded tree, 0 if there is none.
+			virtual s32 GetTreeHeight() const { return 0; }
+
+			/// Get the balance of the embedded tree, 0 if there is none.
+			virtual s32 GetTreeBalance() const { return 0; }
+
+			/// Get the quality metric of the embedded tree, 0 if there is none.
+			virtual real32 GetTreeQuality() const { return 0.0f; }
+
+		protected:
+
+			BroadPhaseType m_type;
+		};
+
+	}
+}
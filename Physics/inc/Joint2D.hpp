@@ -3,6 +3,7 @@
 #include "TimeStep.hpp"
 #include "Profile.hpp"
 #include "PhysicsGlobals.hpp"
+#include <cstdio>
 
 namespace Break
 {
@@ -45,6 +46,14 @@ namespace Break
 			real32 angularB;
 		};
 
+		/// The part of a joint that carries over from one step to the next: the
+		/// accumulated impulses used for warm starting and the limit state.
+		struct BREAK_API JointState
+		{
+			real32 values[4];
+			s32 limitState;
+		};
+
 		/// A joint edge is used to connect bodies and joints together
 		/// in a joint graph where each body is a node and each joint
 		/// is an edge. A joint edge belongs to a doubly linked list
@@ -137,10 +146,17 @@ namespace Break
 			/// Shift the origin for any points stored in world coordinates.
 			virtual void ShiftOrigin(const glm::vec2& newOrigin) { NOT_USED(newOrigin);  }
 
+			/// Save the state this joint carries between steps, for world snapshots.
+			virtual void SaveState(JointState* state) const { NOT_USED(state); }
+
+			/// Restore the state saved by SaveState.
+			virtual void LoadState(const JointState* state) { NOT_USED(state); }
+
 		protected:
 			friend class World;
 			friend class Body;
 			friend class Island;
+			friend class JointSolver;
 			friend class GearJoint;
 
 			static Joint* Create(const JointDef* def, BlockAllocator* allocator);
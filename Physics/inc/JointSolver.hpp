@@ -0,0 +1,102 @@
+#pragma once
+#include "MathUtils.hpp"
+#include "PTimeStep.hpp"
+#include "Profile.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		class BREAK_API Joint;
+		class BREAK_API RevoluteJoint;
+		class BREAK_API DistanceJoint;
+		class BREAK_API StackAllocator;
+		struct BREAK_API RevoluteBundle;
+		struct BREAK_API DistanceBundle;
+
+		/// The number of colors used to batch joints. Joints that do not fit in a
+		/// color are solved one by one.
+		const s32 jointColorCount = 8;
+
+		/// The number of joints solved together in a bundle.
+		const s32 jointBundleWidth = 4;
+
+		struct BREAK_API JointSolverDef
+		{
+			PTimeStep step;
+			Joint** joints;
+			s32 count;
+			s32 bodyCount;
+			Position* positions;
+			Velocity* velocities;
+			StackAllocator* allocator;
+		};
+
+		/// Solves the joints of an island. Revolute joints without limit and motor
+		/// and distance joints are grouped by type and colored so that no two
+		/// joints of a color move the same dynamic body. Each color is cut into
+		/// bundles of four that are solved at once in SIMD lanes, without virtual
+		/// calls. The other joints use the virtual solver functions in island
+		/// order. Each bundle lane does the same arithmetic as the scalar solver,
+		/// so only the order in which the joints are relaxed differs.
+		class BREAK_API JointSolver
+		{
+		public:
+			JointSolver(JointSolverDef* def);
+			~JointSolver();
+
+			/// Initialize all joints, warm start them and build the bundles.
+			void InitializeVelocityConstraints();
+
+			void SolveVelocityConstraints();
+
+			/// Copy the accumulated bundle impulses back to the joints.
+			void StoreImpulses();
+
+			bool SolvePositionConstraints();
+
+			/// Get the number of joints solved in bundles.
+			s32 GetBatchedCount() const;
+
+		private:
+
+			JointSolver(const JointSolver&);
+			JointSolver& operator=(const JointSolver&);
+
+			/// Color the batched joints of a type and pack them into bundles. Joints
+			/// that do not fit in a color move to the scalar joints.
+			void BuildRevoluteBundles();
+			void BuildDistanceBundles();
+
+			PTimeStep m_step;
+			Position* m_positions;
+			Velocity* m_velocities;
+			StackAllocator* m_allocator;
+			Joint** m_joints;
+			s32 m_count;
+			s32 m_bodyCount;
+
+			/// Joints with the virtual solver functions, in island order.
+			Joint** m_scalarJoints;
+			s32 m_scalarCount;
+
+			/// Batched joints by type, for the position solver.
+			RevoluteJoint** m_revoluteJoints;
+			s32 m_revoluteCount;
+			DistanceJoint** m_distanceJoints;
+			s32 m_distanceCount;
+
+			RevoluteBundle* m_revoluteBundles;
+			s32 m_revoluteBundleCount;
+			DistanceBundle* m_distanceBundles;
+			s32 m_distanceBundleCount;
+		};
+
+		inline s32 JointSolver::GetBatchedCount() const
+		{
+			return m_revoluteCount + m_distanceCount;
+		}
+
+	}
+}
@@ -0,0 +1,182 @@
+#pragma once
+#include "Shape.hpp"
+#include "StaticTree.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		class BREAK_API EdgeShape;
+		class BREAK_API PolygonShape;
+		class BREAK_API ChainShape;
+
+		/// An edge or a convex polygon of a mesh.
+		struct BREAK_API MeshElement
+		{
+			enum
+			{
+				edgeFlag	= 0x0001,
+				vertex0Flag	= 0x0002,
+				vertex3Flag	= 0x0004
+			};
+
+			/// The first vertex in the mesh vertex array. Edges take four vertices:
+			/// the ghost vertex before the edge, the edge end points and the ghost
+			/// vertex after the edge.
+			s32 vertexIndex;
+
+			/// The number of polygon vertices, 2 for edges.
+			s16 count;
+
+			u16 flags;
+		};
+
+		/// A mesh is a static collection of edges and convex polygons with a
+		/// bounding volume hierarchy over them. It is meant for baking the static
+		/// geometry of a level region into one fixture with one broad-phase proxy.
+		/// The broad-phase only sees the mesh bounds; the contact manager finds the
+		/// elements under each overlapping proxy in the mesh tree and creates one
+		/// contact per element, with the element index as the child index.
+		/// Meshes have no mass and should only be used on static bodies.
+		/// Dynamic edges and chains do not collide with meshes.
+		/// @see World::BakeStaticGeometry
+		class BREAK_API MeshShape : public Shape
+		{
+		public:
+			MeshShape();
+
+			/// The destructor frees the elements and the tree.
+			~MeshShape();
+
+			/// Add a convex polygon. The polygon is transformed by xf.
+			void AddPolygon(const PolygonShape* polygon, const Transform2D& xf);
+
+			/// Add an edge with its ghost vertices. The edge is transformed by xf.
+			void AddEdge(const EdgeShape* edge, const Transform2D& xf);
+
+			/// Add every edge of a chain. The chain is transformed by xf.
+			void AddChain(const ChainShape* chain, const Transform2D& xf);
+
+			/// Build the tree over the elements. This must be called after adding
+			/// elements and before the mesh is used in a fixture.
+			void Build();
+
+			/// Remove all elements.
+			void Clear();
+
+			/// Replace the elements with copies of raw element data, such as the
+			/// data saved by World::Save, and build the tree.
+			void Set(const MeshElement* elements, s32 elementCount, const glm::vec2* vertices, const glm::vec2* normals, s32 vertexCount);
+
+			/// Get the number of elements.
+			s32 GetElementCount() const;
+
+			/// Get an element.
+			const MeshElement& GetElement(s32 index) const;
+
+			/// Get an edge element as an edge shape.
+			void GetChildEdge(EdgeShape* edge, s32 index) const;
+
+			/// Get a polygon element as a polygon shape.
+			void GetChildPolygon(PolygonShape* polygon, s32 index) const;
+
+			/// Compute the bounding box of an element.
+			/// @see Shape::ComputeElementAABB
+			void ComputeElementAABB(AABB* aabb, const Transform2D& xf, s32 index) const;
+
+			/// Query the elements whose bounds overlap a world AABB. The callback
+			/// class is called with the index of each element.
+			/// @param xf the world transform of the mesh.
+			template <typename T>
+			void Query(T* callback, const AABB& aabb, const Transform2D& xf) const;
+
+			/// Get the tree over the elements.
+			const StaticTree& GetTree() const;
+
+			/// @see Shape::GetElementTree
+			const StaticTree* GetElementTree() const;
+
+			/// Implement Shape.
+			Shape* Clone(BlockAllocator* allocator) const;
+
+			/// A mesh has one child, the whole mesh.
+			/// @see Shape::GetChildCount
+			s32 GetChildCount() const;
+
+			/// Test the point against the polygon elements.
+			/// @see Shape::TestPoint
+			bool TestPoint(const Transform2D& xf, const glm::vec2& p) const;
+
+			/// Cast a ray against all elements and report the closest hit.
+			bool RayCast(RayCastOutput* output, const RayCastInput& input, const Transform2D& xf, s32 childIndex) const;
+
+			/// Compute the distance to one element. Here childIndex is an element index.
+			/// @see Shape::ComputeDistance
+			void ComputeDistance(const Transform2D& xf, const glm::vec2& p, real32* distance, glm::vec2* normal, s32 childIndex) const;
+
+			/// Compute the bounds of the whole mesh.
+			/// @see Shape::ComputeAABB
+			void ComputeAABB(AABB* aabb, const Transform2D& xf, s32 childIndex) const;
+
+			/// Meshes have zero mass.
+			/// @see Shape::ComputeMass
+			void ComputeMass(MassData* massData, real32 density) const;
+
+			/// The vertices of all elements. Owned by this class.
+			glm::vec2* m_vertices;
+
+			/// The edge normals of polygon elements, parallel to m_vertices.
+			glm::vec2* m_normals;
+
+			s32 m_vertexCount;
+			s32 m_vertexCapacity;
+
+			/// The elements. Owned by this class.
+			MeshElement* m_elements;
+			s32 m_elementCount;
+			s32 m_elementCapacity;
+
+			StaticTree m_tree;
+
+		private:
+
+			MeshShape(const MeshShape&);
+			MeshShape& operator=(const MeshShape&);
+
+			/// Grow the arrays to hold at least this many vertices and elements.
+			void Reserve(s32 vertexCount, s32 elementCount);
+
+			/// Make room for an element with vertexCount vertices and return it.
+			MeshElement* AddElement(s32 vertexCount);
+		};
+
+		inline s32 MeshShape::GetElementCount() const
+		{
+			return m_elementCount;
+		}
+
+		inline const MeshElement& MeshShape::GetElement(s32 index) const
+		{
+			assert(0 <= index && index < m_elementCount);
+			return m_elements[index];
+		}
+
+		inline const StaticTree& MeshShape::GetTree() const
+		{
+			return m_tree;
+		}
+
+		inline const StaticTree* MeshShape::GetElementTree() const
+		{
+			return &m_tree;
+		}
+
+		template <typename T>
+		inline void MeshShape::Query(T* callback, const AABB& aabb, const Transform2D& xf) const
+		{
+			m_tree.Query(callback, aabb, xf);
+		}
+
+	}
+}
@@ -80,6 +80,12 @@ namespace Break
 			/// Dump to Log
 			void Dump();
 
+			/// Implement Joint::SaveState
+			void SaveState(JointState* state) const;
+
+			/// Implement Joint::LoadState
+			void LoadState(const JointState* state);
+
 		protected:
 
 			friend class Joint;
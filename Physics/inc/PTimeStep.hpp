@@ -16,6 +16,7 @@ namespace Break
 			s32 velocityIterations;
 			s32 positionIterations;
 			bool warmStarting;
+			bool batchJoints;
 
 			PTimeStep(real64 d=0, real64 e=0)
 				:delta(d), elapsedTime(e)
@@ -0,0 +1,350 @@
+#pragma once
+#include "MathUtils.hpp"
+#include "Collision.hpp"
+#include "Fixture.hpp"
+#include "PTimeStep.hpp"
+#include <Vertex2DPosColorTex.hpp>
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		class BREAK_API World;
+		class BREAK_API Body;
+		class BREAK_API Shape;
+
+		/// The behaviour of a particle.
+		enum ParticleType
+		{
+			/// Keeps its density, so it flows and splashes like water.
+			fluidParticle = 0,
+
+			/// Only resists overlap and sticks by friction, like sand or debris.
+			granularParticle = 1
+		};
+
+		/// A particle definition holds the data needed to create a particle.
+		struct BREAK_API ParticleDef
+		{
+			ParticleDef()
+			{
+				type = fluidParticle;
+				position = glm::vec2(0.0f, 0.0f);
+				velocity = glm::vec2(0.0f, 0.0f);
+				userData = NULL;
+			}
+
+			ParticleType type;
+
+			/// The world position of the particle.
+			glm::vec2 position;
+
+			/// The linear velocity of the particle in world co-ordinates.
+			glm::vec2 velocity;
+
+			/// Use this to store application specific particle data.
+			void* userData;
+		};
+
+		/// A particle system definition holds the data needed to create a particle
+		/// system. All particles of a system have the same size and material.
+		struct BREAK_API ParticleSystemDef
+		{
+			ParticleSystemDef()
+			{
+				radius = 0.05f;
+				density = 1.0f;
+				gravityScale = 1.0f;
+				damping = 0.0f;
+				viscosity = 0.1f;
+				friction = 0.4f;
+				iterations = 4;
+			}
+
+			/// The particle radius. Particles settle about a diameter apart.
+			real32 radius;
+
+			/// The density, used to push the bodies the particles hit.
+			real32 density;
+
+			/// Scale the world gravity applied to the particles.
+			real32 gravityScale;
+
+			/// Linear damping of the particle velocities.
+			real32 damping;
+
+			/// Smooths the velocity of fluid particles towards their neighbors,
+			/// from zero (water) to one (honey).
+			real32 viscosity;
+
+			/// The friction between granular particles and against fixtures, usually in [0,1].
+			real32 friction;
+
+			/// The number of constraint iterations per step. Deep piles of granular
+			/// particles need more to keep from sinking into each other.
+			s32 iterations;
+
+			/// Contact filtering data against fixtures. Sensors are always ignored.
+			Filter filter;
+		};
+
+		/// A particle system simulates many small particles that do not need to be
+		/// bodies: water, sand and debris. It is owned by a World and stepped at the
+		/// end of World::Step, after the bodies moved.
+		///
+		/// Particles live in flat arrays indexed by particle. Each step predicts the
+		/// particle positions, finds neighbors in a hashed grid and then corrects the
+		/// positions: fluid particles towards their rest density (position based
+		/// fluids) and granular particles out of each other with friction. Particles
+		/// collide with the fixtures found by a broad-phase query over the bounds of
+		/// the system and push the dynamic bodies they hit. The passes over the
+		/// particles run on the world thread pool.
+		class BREAK_API ParticleSystem
+		{
+		public:
+			/// Create a particle. Returns its index.
+			/// @warning This function is locked during callbacks.
+			s32 CreateParticle(const ParticleDef* def);
+
+			/// Fill a shape with particles on a hexagonal lattice a diameter apart.
+			/// The position of the definition is ignored.
+			/// @param shape a circle, polygon or capsule.
+			/// @param xf the world transform of the shape.
+			/// @return the number of particles created. They come after the existing ones.
+			s32 CreateParticlesInShape(const Shape* shape, const Transform2D& xf, const ParticleDef* def);
+
+			/// Destroy a particle at the start of the next step. Particle indices
+			/// stay valid until then; the last particles then move into the holes.
+			void DestroyParticle(s32 index);
+
+			/// Get the number of particles.
+			s32 GetParticleCount() const;
+
+			/// Get the particle positions, indexed by particle.
+			glm::vec2* GetPositionBuffer();
+			const glm::vec2* GetPositionBuffer() const;
+
+			/// Get the particle velocities, indexed by particle.
+			glm::vec2* GetVelocityBuffer();
+			const glm::vec2* GetVelocityBuffer() const;
+
+			/// Get the particle user data, indexed by particle.
+			void** GetUserDataBuffer();
+
+			/// Get the type of a particle.
+			ParticleType GetParticleType(s32 index) const;
+
+			/// Get the particle radius.
+			real32 GetRadius() const;
+
+			/// Copy the particle positions into an interleaved buffer, such as a
+			/// vertex buffer.
+			/// @param data receives the position of particle i at data + i * stride.
+			/// @param stride the distance in bytes between two positions.
+			void WritePositions(void* data, s32 stride) const;
+
+			/// Write one textured quad per particle, four vertices each in the order
+			/// used by SpriteBatch, so the same index pattern draws them: 0 1 2, 2 1 3.
+			/// @param vertices receives 4 * GetParticleCount() vertices.
+			/// @param size the width of a quad in world units, usually the diameter.
+			/// @param color the vertex color of all quads.
+			void WriteSprites(Infrastructure::Vertex2DPosColorTex* vertices, real32 size, const glm::vec4& color) const;
+
+			/// Get the world that owns this system.
+			World* GetWorld();
+
+			/// Get the next particle system in the world list.
+			ParticleSystem* GetNext();
+			const ParticleSystem* GetNext() const;
+
+		private:
+
+			friend class World;
+			template <typename B> friend struct ParticleShapeQuery;
+			friend struct ParticleElementQuery;
+
+			// m_flags
+			enum
+			{
+				typeMask		= 0x0001,
+				destroyFlag		= 0x0002
+			};
+
+			/// A fixture child the particles may hit this step. For a mesh or a
+			/// chain the child index is an element index.
+			struct ShapeProxy
+			{
+				const Shape* shape;
+				Body* body;
+				Transform2D xf;
+				s32 childIndex;
+			};
+
+			/// A particle near a shape proxy.
+			struct ShapeContact
+			{
+				s32 particle;
+				s32 proxy;
+
+				/// The impulse given to the body, applied after the iterations.
+				glm::vec2 impulse;
+				glm::vec2 point;
+			};
+
+			ParticleSystem(const ParticleSystemDef* def, World* world);
+			~ParticleSystem();
+
+			ParticleSystem(const ParticleSystem&);
+			ParticleSystem& operator=(const ParticleSystem&);
+
+			void Reserve(s32 capacity);
+			void RemoveDestroyed();
+			void ShiftOrigin(const glm::vec2& newOrigin);
+
+			/// Advance the particles by one step.
+			void Solve(const PTimeStep& step);
+
+			void BuildGrid();
+			void FindShapeContacts();
+			void AddShapeProxy(Fixture* fixture, s32 childIndex, const AABB& aabb);
+			void ApplyImpulses();
+
+			s32 GetCell(real32 value) const;
+			u32 GetBucket(s32 x, s32 y) const;
+
+			static void PredictTask(void* context, s32 begin, s32 end, s32 threadIndex);
+			static void NeighborTask(void* context, s32 begin, s32 end, s32 threadIndex);
+			static void DensityTask(void* context, s32 begin, s32 end, s32 threadIndex);
+			static void ConstraintTask(void* context, s32 begin, s32 end, s32 threadIndex);
+			static void CollideTask(void* context, s32 begin, s32 end, s32 threadIndex);
+			static void VelocityTask(void* context, s32 begin, s32 end, s32 threadIndex);
+			static void ViscosityTask(void* context, s32 begin, s32 end, s32 threadIndex);
+
+			void ParallelFor(s32 count, void (*task)(void*, s32, s32, s32));
+
+			World* m_world;
+			ParticleSystem* m_prev;
+			ParticleSystem* m_next;
+
+			real32 m_radius;
+			real32 m_diameter;
+			real32 m_particleMass;
+			real32 m_gravityScale;
+			real32 m_damping;
+			real32 m_viscosity;
+			real32 m_friction;
+			s32 m_iterations;
+			Filter m_filter;
+
+			/// How far a particle may end up from its predicted path, including its
+			/// radius. Shapes within this distance are collided with.
+			real32 m_reach;
+
+			/// Smoothing kernel radius and constants.
+			real32 m_kernelRadius;
+			real32 m_poly6;
+			real32 m_spikyGradient;
+			real32 m_inverseRestDensity;
+			real32 m_relaxation;
+
+			// Particle data, indexed by particle.
+			glm::vec2* m_positions;
+			glm::vec2* m_velocities;
+			void** m_userData;
+			u32* m_flags;
+			s32 m_count;
+			s32 m_capacity;
+			s32 m_destroyCount;
+
+			// Step data, indexed by particle.
+			glm::vec2* m_predicted;
+			glm::vec2* m_deltas;
+			real32* m_lambdas;
+			s32* m_neighbors;
+			s32* m_neighborCounts;
+			s32* m_contactStart;
+			s32* m_stamps;
+			u32* m_buckets;
+
+			// The grid. Bucket i holds m_cellParticles[m_bucketStart[i], m_bucketStart[i + 1]).
+			s32* m_bucketStart;
+			s32 m_bucketCapacity;
+			s32* m_cellParticles;
+			u32 m_bucketMask;
+			real32 m_inverseCellSize;
+
+			AABB m_bounds;
+			real32 m_maxTravel;
+
+			ShapeProxy* m_shapeProxies;
+			s32 m_shapeProxyCount;
+			s32 m_shapeProxyCapacity;
+
+			ShapeContact* m_shapeContacts;
+			s32 m_shapeContactCount;
+			s32 m_shapeContactCapacity;
+			ShapeContact* m_sortedContacts;
+			s32 m_sortedCapacity;
+
+			PTimeStep m_step;
+		};
+
+		inline s32 ParticleSystem::GetParticleCount() const
+		{
+			return m_count;
+		}
+
+		inline glm::vec2* ParticleSystem::GetPositionBuffer()
+		{
+			return m_positions;
+		}
+
+		inline const glm::vec2* ParticleSystem::GetPositionBuffer() const
+		{
+			return m_positions;
+		}
+
+		inline glm::vec2* ParticleSystem::GetVelocityBuffer()
+		{
+			return m_velocities;
+		}
+
+		inline const glm::vec2* ParticleSystem::GetVelocityBuffer() const
+		{
+			return m_velocities;
+		}
+
+		inline void** ParticleSystem::GetUserDataBuffer()
+		{
+			return m_userData;
+		}
+
+		inline ParticleType ParticleSystem::GetParticleType(s32 index) const
+		{
+			assert(0 <= index && index < m_count);
+			return (ParticleType)(m_flags[index] & typeMask);
+		}
+
+		inline real32 ParticleSystem::GetRadius() const
+		{
+			return m_radius;
+		}
+
+		inline World* ParticleSystem::GetWorld()
+		{
+			return m_world;
+		}
+
+		inline ParticleSystem* ParticleSystem::GetNext()
+		{
+			return m_next;
+		}
+
+		inline const ParticleSystem* ParticleSystem::GetNext() const
+		{
+			return m_next;
+		}
+
+	}
+}
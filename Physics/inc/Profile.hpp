@@ -1,23 +1,59 @@
 #pragma once
 
 #include <Globals.hpp>
+#include <glm/glm.hpp>
 #include "PTimeStep.hpp"
 
 namespace Break
 {
 	namespace Physics
 	{
-		/// Profiling data. Times are in milliseconds.
+		/// Profiling data for one step. Times are in nanoseconds.
 		struct BREAK_API Profile
 		{
-			real32 step;
-			real32 collide;
-			real32 solve;
-			real32 solveInit;
-			real32 solveVelocity;
-			real32 solvePosition;
-			real32 broadphase;
-			real32 solveTOI;
+			/// The whole step.
+			u64 step;
+
+			/// Finding new pairs, including the pairs of new fixtures.
+			u64 broadphase;
+
+			/// Updating the contacts of the existing pairs.
+			u64 narrowphase;
+
+			/// Building the islands, solving them and synchronizing the fixtures.
+			u64 solve;
+
+			/// Walking the constraint graph to build the islands.
+			u64 islands;
+
+			/// Summed over all islands.
+			u64 solveInit;
+			u64 solveVelocity;
+			u64 solvePosition;
+
+			/// Finding and solving time of impact events.
+			u64 solveTOI;
+
+			/// Moving the broad-phase proxies of the bodies that moved.
+			u64 sync;
+
+			/// Stepping the particle systems.
+			u64 particles;
+
+			/// Number of pairs the broad-phase reported.
+			s32 broadphasePairs;
+
+			/// Number of contacts at the end of the step.
+			s32 contactCount;
+
+			/// Number of islands solved.
+			s32 islandCount;
+
+			/// Number of time of impact events solved.
+			s32 toiEventCount;
+
+			/// Number of GJK iterations run by the narrow-phase and the TOI solver.
+			s32 gjkIterations;
 		};
 
 		/// This is an internal structure.
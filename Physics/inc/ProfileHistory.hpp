@@ -0,0 +1,114 @@
+#pragma once
+#include "Globals.hpp"
+#include "Profile.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		/// The values recorded in a Profile.
+		enum ProfileField
+		{
+			profileStep,
+			profileBroadphase,
+			profileNarrowphase,
+			profileSolve,
+			profileIslands,
+			profileSolveInit,
+			profileSolveVelocity,
+			profileSolvePosition,
+			profileSolveTOI,
+			profileSync,
+			profileParticles,
+			profileBroadphasePairs,
+			profileContactCount,
+			profileIslandCount,
+			profileTOIEventCount,
+			profileGJKIterations,
+			profileFieldCount
+		};
+
+		/// Statistics of one profile field over the recorded steps.
+		struct BREAK_API ProfileStats
+		{
+			real64 min;
+			real64 avg;
+			real64 max;
+
+			/// 99th percentile, nearest rank.
+			real64 p99;
+		};
+
+		/// A ring of the last N step profiles. The world pushes one profile per step.
+		class BREAK_API ProfileHistory
+		{
+		public:
+			ProfileHistory();
+			~ProfileHistory();
+
+			/// Set the number of steps to keep. This clears the history.
+			/// Zero disables recording.
+			void SetCapacity(s32 capacity);
+
+			/// Get the number of steps kept.
+			s32 GetCapacity() const;
+
+			/// Get the number of steps recorded, at most the capacity.
+			s32 GetCount() const;
+
+			/// Forget all recorded steps.
+			void Clear();
+
+			/// Record a step, dropping the oldest one when full.
+			void Push(const Profile& profile);
+
+			/// Get a recorded step. Index 0 is the oldest.
+			const Profile& GetProfile(s32 index) const;
+
+			/// Compute min/avg/max/p99 of a field over the recorded steps.
+			/// Times are in nanoseconds. The values are sorted in a temporary
+			/// copy, so a debug overlay and a report may read one history together.
+			ProfileStats GetStats(ProfileField field) const;
+
+			/// Write one row per recorded step, oldest first, with a header line.
+			/// @return false if the file could not be written.
+			bool DumpCSV(const char* path) const;
+
+			/// Get the CSV column name of a field.
+			static const char* GetFieldName(ProfileField field);
+
+			/// Get the value of a field.
+			static real64 GetValue(const Profile& profile, ProfileField field);
+
+		private:
+			Profile* m_profiles;
+			s32 m_capacity;
+			s32 m_count;
+			s32 m_next;
+		};
+
+		inline s32 ProfileHistory::GetCapacity() const
+		{
+			return m_capacity;
+		}
+
+		inline s32 ProfileHistory::GetCount() const
+		{
+			return m_count;
+		}
+
+		inline const Profile& ProfileHistory::GetProfile(s32 index) const
+		{
+			assert(0 <= index && index < m_count);
+			s32 oldest = m_count < m_capacity ? 0 : m_next;
+			s32 slot = oldest + index;
+			if (slot >= m_capacity)
+			{
+				slot -= m_capacity;
+			}
+			return m_profiles[slot];
+		}
+
+	}
+}
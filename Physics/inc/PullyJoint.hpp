@@ -97,6 +97,12 @@ namespace Break
 			/// Implement Joint::ShiftOrigin
 			void ShiftOrigin(const glm::vec2& newOrigin);
 
+			/// Implement Joint::SaveState
+			void SaveState(JointState* state) const;
+
+			/// Implement Joint::LoadState
+			void LoadState(const JointState* state);
+
 		protected:
 
 			friend class Joint;
@@ -139,10 +139,17 @@ namespace Break
 			/// Dump to Log.
 			void Dump();
 
+			/// Implement Joint::SaveState
+			void SaveState(JointState* state) const;
+
+			/// Implement Joint::LoadState
+			void LoadState(const JointState* state);
+
 		protected:
 
 			friend class Joint;
 			friend class GearJoint;
+			friend class JointSolver;
 
 			RevoluteJoint(const RevoluteJointDef* def);
 
@@ -0,0 +1,71 @@
+#pragma once
+#include "Distance.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		class BREAK_API Fixture;
+
+		/// A link in the overlap list of a fixture. Overlaps move when the packed
+		/// array is compacted, so links name an overlap side rather than a pointer:
+		/// twice the overlap index, plus one for the visitor side. -1 ends the list.
+		struct BREAK_API SensorOverlapEdge
+		{
+			s32 prev;
+			s32 next;
+		};
+
+		/// A sensor fixture child and another fixture child whose broad-phase
+		/// proxies overlap. Sensors do not create contacts: the contact manager
+		/// keeps one of these small records per pair in a packed array instead,
+		/// tests it with a warm started overlap test and never computes a manifold.
+		/// Overlaps are not in the body contact lists, so islands and continuous
+		/// collision never visit them.
+		/// @see ContactListener::BeginSensor
+		struct BREAK_API SensorOverlap
+		{
+			// flags
+			enum
+			{
+				// Set when the shapes overlap.
+				touchingFlag	= 0x0001,
+
+				// Set when the pair must be filtered again.
+				filterFlag		= 0x0002
+			};
+
+			/// Do the shapes overlap?
+			bool IsTouching() const;
+
+			/// The sensor fixture. When both fixtures are sensors this is the one
+			/// the broad-phase reported first.
+			Fixture* sensor;
+
+			/// The other fixture.
+			Fixture* visitor;
+
+			/// The child indices. For a mesh or a chain this is an element index.
+			s32 sensorIndex;
+			s32 visitorIndex;
+
+			/// Warm starts the overlap test.
+			SimplexCache simplexCache;
+
+			u32 flags;
+
+			/// The next overlap in the same hash bucket, -1 at the end.
+			s32 next;
+
+			/// The links in the overlap lists of the sensor and of the visitor.
+			SensorOverlapEdge edges[2];
+		};
+
+		inline bool SensorOverlap::IsTouching() const
+		{
+			return (flags & touchingFlag) == touchingFlag;
+		}
+
+	}
+}
@@ -9,6 +9,7 @@ namespace Break
 	namespace Physics
 	{
 		class Transform2D;
+		class BREAK_API StaticTree;
 
 		/// This holds the mass data computed for a shape.
 		//need to hold all mass data and recive maass from here <<------
@@ -38,7 +39,9 @@ namespace Break
 				edge = 1,
 				polygon = 2,
 				chain = 3,
-				typeCount = 4
+				mesh = 4,
+				capsule = 5,
+				typeCount = 6
 			};
 
 			virtual ~Shape() {}
@@ -66,6 +69,14 @@ namespace Break
 			/// @param childIndex the child shape index
 			virtual bool RayCast(RayCastOutput* output, const RayCastInput& input,const Transform2D& Transform2D, s32 childIndex) const = 0;
 
+			/// Compute the distance from a child shape to a point, including the shape radius.
+			/// @param xf the shape world Transform2D.
+			/// @param p a point in world coordinates.
+			/// @param distance returns the distance, negative if the point is inside.
+			/// @param normal returns the direction in which the distance grows.
+			/// @param childIndex the child shape index. For a mesh or a chain this is an element index.
+			virtual void ComputeDistance(const Transform2D& xf, const glm::vec2& p, real32* distance, glm::vec2* normal, s32 childIndex) const = 0;
+
 
 			/// Given a Transform2D, compute the associated axis aligned bounding box for a child shape.
 			///AABB algorithm <<-----
@@ -74,6 +85,18 @@ namespace Break
 			/// @param childIndex the child shape
 			virtual void ComputeAABB(AABB* aabb, const Transform2D& xf, s32 childIndex) const = 0;
 
+			/// Get the tree over the elements of a shape that covers many elements with
+			/// one child, such as a mesh or a chain. Contacts and queries use the element
+			/// index where other shapes use the child index. Other shapes return NULL.
+			virtual const StaticTree* GetElementTree() const;
+
+			/// Compute the bounding box of an element. Shapes without an element tree
+			/// have one element per child.
+			/// @param aabb returns the axis aligned box.
+			/// @param xf the world Transform2D of the shape.
+			/// @param index the element index.
+			virtual void ComputeElementAABB(AABB* aabb, const Transform2D& xf, s32 index) const;
+
 
 
 			/// Compute the mass properties of this shape using its dimensions and density.
@@ -91,6 +114,16 @@ namespace Break
 			return m_type;
 		}
 
+		inline const StaticTree* Shape::GetElementTree() const
+		{
+			return NULL;
+		}
+
+		inline void Shape::ComputeElementAABB(AABB* aabb, const Transform2D& xf, s32 index) const
+		{
+			ComputeAABB(aabb, xf, index);
+		}
+
 	}
 
 }
\ No newline at end of file
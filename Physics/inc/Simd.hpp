@@ -0,0 +1,104 @@
+#pragma once
+#include "Globals.hpp"
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define PHYSICS_SIMD_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		/// Four packed floats. This maps to an SSE register when available and
+		/// falls back to plain scalar code otherwise. Only the handful of operations
+		/// needed by the wide tree and the joint solver are provided.
+		struct Float4
+		{
+#ifdef PHYSICS_SIMD_SSE
+			__m128 v;
+
+			/// Load four floats from an unaligned address.
+			static Float4 Load(const real32* p)
+			{
+				Float4 r; r.v = _mm_loadu_ps(p); return r;
+			}
+
+			/// Broadcast a single value to all lanes.
+			static Float4 Splat(real32 x)
+			{
+				Float4 r; r.v = _mm_set1_ps(x); return r;
+			}
+
+			/// Store the four floats to an unaligned address.
+			void Store(real32* p) const
+			{
+				_mm_storeu_ps(p, v);
+			}
+
+			friend Float4 operator+(const Float4& a, const Float4& b) { Float4 r; r.v = _mm_add_ps(a.v, b.v); return r; }
+			friend Float4 operator-(const Float4& a, const Float4& b) { Float4 r; r.v = _mm_sub_ps(a.v, b.v); return r; }
+			friend Float4 operator*(const Float4& a, const Float4& b) { Float4 r; r.v = _mm_mul_ps(a.v, b.v); return r; }
+
+			static Float4 Min(const Float4& a, const Float4& b) { Float4 r; r.v = _mm_min_ps(a.v, b.v); return r; }
+			static Float4 Max(const Float4& a, const Float4& b) { Float4 r; r.v = _mm_max_ps(a.v, b.v); return r; }
+
+			/// Absolute value by clearing the sign bits.
+			static Float4 Abs(const Float4& a)
+			{
+				Float4 r; r.v = _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); return r;
+			}
+
+			/// Lane mask of a <= b, bit i set for lane i.
+			static s32 LessEqual(const Float4& a, const Float4& b)
+			{
+				return _mm_movemask_ps(_mm_cmple_ps(a.v, b.v));
+			}
+#else
+			real32 v[4];
+
+			static Float4 Load(const real32* p)
+			{
+				Float4 r; r.v[0] = p[0]; r.v[1] = p[1]; r.v[2] = p[2]; r.v[3] = p[3]; return r;
+			}
+
+			static Float4 Splat(real32 x)
+			{
+				Float4 r; r.v[0] = x; r.v[1] = x; r.v[2] = x; r.v[3] = x; return r;
+			}
+
+			void Store(real32* p) const
+			{
+				p[0] = v[0]; p[1] = v[1]; p[2] = v[2]; p[3] = v[3];
+			}
+
+			friend Float4 operator+(const Float4& a, const Float4& b) { Float4 r; for (s32 i = 0; i < 4; ++i) r.v[i] = a.v[i] + b.v[i]; return r; }
+			friend Float4 operator-(const Float4& a, const Float4& b) { Float4 r; for (s32 i = 0; i < 4; ++i) r.v[i] = a.v[i] - b.v[i]; return r; }
+			friend Float4 operator*(const Float4& a, const Float4& b) { Float4 r; for (s32 i = 0; i < 4; ++i) r.v[i] = a.v[i] * b.v[i]; return r; }
+
+			static Float4 Min(const Float4& a, const Float4& b) { Float4 r; for (s32 i = 0; i < 4; ++i) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return r; }
+			static Float4 Max(const Float4& a, const Float4& b) { Float4 r; for (s32 i = 0; i < 4; ++i) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return r; }
+
+			static Float4 Abs(const Float4& a)
+			{
+				Float4 r; for (s32 i = 0; i < 4; ++i) r.v[i] = a.v[i] < 0.0f ? -a.v[i] : a.v[i]; return r;
+			}
+
+			static s32 LessEqual(const Float4& a, const Float4& b)
+			{
+				s32 mask = 0;
+				for (s32 i = 0; i < 4; ++i)
+				{
+					if (a.v[i] <= b.v[i])
+					{
+						mask |= 1 << i;
+					}
+				}
+				return mask;
+			}
+#endif
+		};
+
+	}
+}
@@ -0,0 +1,183 @@
+#pragma once
+#include "Globals.hpp"
+#include <cstring>
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		/// Refers to an object in a SlotMap. The generation tells a live object
+		/// apart from a destroyed one whose slot was reused.
+		struct BREAK_API SlotHandle
+		{
+			s32 index;
+			u32 generation;
+		};
+
+		/// Index-stable storage for objects of type T. Objects live in pages of N,
+		/// so they never move and a scan over the slots reads memory in order.
+		/// Freed slots are reused and get a new generation so stale handles fail.
+		/// The caller constructs and destroys the objects in the returned storage.
+		template <typename T, s32 N>
+		class BREAK_API SlotMap
+		{
+		public:
+			SlotMap()
+			{
+				m_pages = NULL;
+				m_pageCount = 0;
+				m_generations = NULL;
+				m_freeSlots = NULL;
+				m_freeCount = 0;
+				m_slotEnd = 0;
+				m_capacity = 0;
+				m_count = 0;
+			}
+
+			~SlotMap()
+			{
+				for (s32 i = 0; i < m_pageCount; ++i)
+				{
+					free(m_pages[i]);
+				}
+				free(m_pages);
+				free(m_generations);
+				free(m_freeSlots);
+			}
+
+			/// Reserve a slot and return its uninitialized storage.
+			void* Allocate(s32* index)
+			{
+				s32 slot;
+				if (m_freeCount > 0)
+				{
+					--m_freeCount;
+					slot = m_freeSlots[m_freeCount];
+				}
+				else
+				{
+					if (m_slotEnd == m_capacity)
+					{
+						Grow();
+					}
+					slot = m_slotEnd;
+					++m_slotEnd;
+				}
+
+				// Odd generations are live.
+				assert((m_generations[slot] & 1) == 0);
+				++m_generations[slot];
+				++m_count;
+
+				*index = slot;
+				return m_pages[slot / N] + (slot % N);
+			}
+
+			/// Release a slot. The object must be destroyed already.
+			void Free(s32 index)
+			{
+				assert(IsAlive(index));
+				++m_generations[index];
+				m_freeSlots[m_freeCount] = index;
+				++m_freeCount;
+				--m_count;
+			}
+
+			/// Get the handle of a live slot.
+			SlotHandle GetHandle(s32 index) const
+			{
+				assert(IsAlive(index));
+				SlotHandle handle;
+				handle.index = index;
+				handle.generation = m_generations[index];
+				return handle;
+			}
+
+			/// Get the object of a handle, or NULL if it was destroyed.
+			T* Get(SlotHandle handle) const
+			{
+				if (handle.index < 0 || handle.index >= m_slotEnd || m_generations[handle.index] != handle.generation)
+				{
+					return NULL;
+				}
+				return GetObject(handle.index);
+			}
+
+			/// Slots in [0, GetSlotEnd()) may be live.
+			s32 GetSlotEnd() const
+			{
+				return m_slotEnd;
+			}
+
+			bool IsAlive(s32 index) const
+			{
+				assert(0 <= index && index < m_slotEnd);
+				return (m_generations[index] & 1) != 0;
+			}
+
+			T* GetObject(s32 index) const
+			{
+				assert(IsAlive(index));
+				return m_pages[index / N] + (index % N);
+			}
+
+			s32 GetCount() const
+			{
+				return m_count;
+			}
+
+		private:
+
+			SlotMap(const SlotMap&);
+			SlotMap& operator=(const SlotMap&);
+
+			void Grow()
+			{
+				T** oldPages = m_pages;
+				m_pages = (T**)malloc((m_pageCount + 1) * sizeof(T*));
+				if (m_pageCount > 0)
+				{
+					memcpy(m_pages, oldPages, m_pageCount * sizeof(T*));
+				}
+				free(oldPages);
+				m_pages[m_pageCount] = (T*)malloc(N * sizeof(T));
+				++m_pageCount;
+
+				s32 capacity = m_capacity + N;
+
+				u32* oldGenerations = m_generations;
+				m_generations = (u32*)malloc(capacity * sizeof(u32));
+				if (m_capacity > 0)
+				{
+					memcpy(m_generations, oldGenerations, m_capacity * sizeof(u32));
+				}
+				memset(m_generations + m_capacity, 0, N * sizeof(u32));
+				free(oldGenerations);
+
+				s32* oldFreeSlots = m_freeSlots;
+				m_freeSlots = (s32*)malloc(capacity * sizeof(s32));
+				if (m_freeCount > 0)
+				{
+					memcpy(m_freeSlots, oldFreeSlots, m_freeCount * sizeof(s32));
+				}
+				free(oldFreeSlots);
+
+				m_capacity = capacity;
+			}
+
+			T** m_pages;
+			s32 m_pageCount;
+
+			u32* m_generations;
+
+			s32* m_freeSlots;
+			s32 m_freeCount;
+
+			s32 m_slotEnd;
+			s32 m_capacity;
+			s32 m_count;
+		};
+
+	}
+}
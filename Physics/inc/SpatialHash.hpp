@@ -0,0 +1,397 @@
+#pragma once
+#include <float.h>
+#include "IBroadPhase.hpp"
+#include "BroadPhase.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		/// A uniform grid broad-phase for scenes made of many bodies of about the
+		/// same size, such as debris or particles. Moving a proxy only updates its
+		/// fat AABB, so bodies leaving their fat AABB every step cost nothing like
+		/// the remove and insert of the dynamic tree.
+		///
+		/// The grid is a flat hash table rebuilt with a counting sort whenever
+		/// proxies changed: each bucket is a range in one array of proxy ids, so
+		/// there are no per-proxy or per-cell heap nodes. Proxies covering more
+		/// than maxProxyCells cells are kept in a separate list and tested by
+		/// brute force. Choose a cell size of about the size of a common body.
+		class BREAK_API SpatialHash : public IBroadPhase
+		{
+		public:
+
+			enum
+			{
+				maxProxyCells = 64
+			};
+
+			SpatialHash(real32 cellSize);
+			~SpatialHash();
+
+			s32 CreateProxy(const AABB& aabb, void* userData);
+			void CreateProxies(const AABB* aabbs, void* const* userData, s32 count, s32* proxyIds);
+			void DestroyProxy(s32 proxyId);
+			void MoveProxy(s32 proxyId, const AABB& aabb, const glm::vec2& displacement);
+			void TouchProxy(s32 proxyId);
+
+			const AABB& GetFatAABB(s32 proxyId) const;
+			void SetFatAABB(s32 proxyId, const AABB& fatAABB);
+			void* GetUserData(s32 proxyId) const;
+			bool TestOverlap(s32 proxyIdA, s32 proxyIdB) const;
+			s32 GetProxyCount() const;
+
+			void UpdatePairs(BroadPhasePairCallback* callback);
+
+			/// Query an AABB. Scans every proxy if they changed since the grid was
+			/// last built. Only reads the broad-phase, so several threads may query
+			/// at once. The templated version calls the callback directly for each proxy.
+			template <typename T>
+			void Query(T* callback, const AABB& aabb) const;
+			void Query(BroadPhaseQueryCallback* callback, const AABB& aabb) const;
+
+			/// Ray-cast by walking the cells along the ray, or by testing every
+			/// proxy if they changed since the grid was last built.
+			template <typename T>
+			void RayCast(T* callback, const RayCastInput& input) const;
+			void RayCast(BroadPhaseRayCastCallback* callback, const RayCastInput& input) const;
+
+			void ShiftOrigin(const glm::vec2& newOrigin);
+
+			/// Rebuild the grid now if proxies changed. UpdatePairs does this every
+			/// step. Call it after changing proxies between steps so the following
+			/// queries use the grid instead of a scan.
+			void UpdateGrid();
+
+			/// Get the cell size.
+			real32 GetCellSize() const;
+
+		private:
+
+			/// Create a proxy without touching it.
+			s32 AddProxy(const AABB& aabb, void* userData);
+
+			// Proxy flags
+			enum
+			{
+				liveFlag		= 0x0001,
+				touchedFlag		= 0x0002,
+				oversizedFlag	= 0x0004
+			};
+
+			struct Proxy
+			{
+				/// Enlarged AABB
+				AABB aabb;
+				void* userData;
+
+				/// Covered cell range, valid after the grid is built.
+				s32 lowerX, lowerY;
+				s32 upperX, upperY;
+
+				s32 next;
+				s32 flags;
+			};
+
+			s32 GetCell(real32 value) const;
+			u32 GetBucket(s32 x, s32 y) const;
+
+			/// Ray-cast one proxy, shortening the segment on a hit. Returns false
+			/// if the client terminated the ray cast.
+			template <typename T>
+			bool RayCastProxy(T* callback, s32 proxyId, RayCastInput* subInput, AABB* segmentAABB) const;
+
+			void QueryProxy(s32 proxyId);
+
+			void AddPair(s32 proxyIdA, s32 proxyIdB);
+
+			Proxy* m_proxies;
+			s32 m_proxyCapacity;
+			s32 m_proxyCount;
+			s32 m_freeList;
+
+			real32 m_cellSize;
+			real32 m_inverseCellSize;
+
+			/// The grid. Bucket i holds m_cellProxies[m_bucketStart[i], m_bucketStart[i + 1]).
+			s32* m_bucketStart;
+			s32 m_bucketCount;
+			s32* m_cellProxies;
+			s32 m_cellProxyCapacity;
+			s32* m_oversized;
+			s32 m_oversizedCount;
+			s32 m_oversizedCapacity;
+			bool m_gridDirty;
+
+			s32* m_touchBuffer;
+			s32 m_touchCount;
+			s32 m_touchCapacity;
+
+			Pair* m_pairBuffer;
+			s32 m_pairCount;
+			s32 m_pairCapacity;
+		};
+
+		inline const AABB& SpatialHash::GetFatAABB(s32 proxyId) const
+		{
+			assert(0 <= proxyId && proxyId < m_proxyCapacity);
+			return m_proxies[proxyId].aabb;
+		}
+
+		inline void* SpatialHash::GetUserData(s32 proxyId) const
+		{
+			assert(0 <= proxyId && proxyId < m_proxyCapacity);
+			return m_proxies[proxyId].userData;
+		}
+
+		inline bool SpatialHash::TestOverlap(s32 proxyIdA, s32 proxyIdB) const
+		{
+			return Physics::TestOverlap(m_proxies[proxyIdA].aabb, m_proxies[proxyIdB].aabb);
+		}
+
+		inline s32 SpatialHash::GetProxyCount() const
+		{
+			return m_proxyCount;
+		}
+
+		inline real32 SpatialHash::GetCellSize() const
+		{
+			return m_cellSize;
+		}
+
+		inline s32 SpatialHash::GetCell(real32 value) const
+		{
+			// Clamp so far away proxies cannot overflow the cell coordinates.
+			real32 cell = floorf(value * m_inverseCellSize);
+			cell = glm::clamp(cell, -1073741824.0f, 1073741824.0f);
+			return (s32)cell;
+		}
+
+		inline u32 SpatialHash::GetBucket(s32 x, s32 y) const
+		{
+			u32 hash = ((u32)x * 73856093u) ^ ((u32)y * 19349663u);
+			return hash & (u32)(m_bucketCount - 1);
+		}
+
+		template <typename T>
+		inline void SpatialHash::Query(T* callback, const AABB& aabb) const
+		{
+			s32 lowerX = GetCell(aabb.lowerBound.x);
+			s32 lowerY = GetCell(aabb.lowerBound.y);
+			s32 upperX = GetCell(aabb.upperBound.x);
+			s32 upperY = GetCell(aabb.upperBound.y);
+
+			// Large queries are cheaper as a plain scan over the proxies. A stale
+			// grid is scanned too rather than rebuilt from a const query.
+			s64 cellCount = (s64)(upperX - lowerX + 1) * (s64)(upperY - lowerY + 1);
+			if (m_gridDirty || cellCount > m_proxyCount)
+			{
+				for (s32 i = 0; i < m_proxyCapacity; ++i)
+				{
+					const Proxy* proxy = m_proxies + i;
+					if ((proxy->flags & liveFlag) && Physics::TestOverlap(proxy->aabb, aabb))
+					{
+						if (callback->QueryCallback(i) == false)
+						{
+							return;
+						}
+					}
+				}
+				return;
+			}
+
+			for (s32 y = lowerY; y <= upperY; ++y)
+			{
+				for (s32 x = lowerX; x <= upperX; ++x)
+				{
+					u32 bucket = GetBucket(x, y);
+					s32 previousId = nullProxy;
+					for (s32 i = m_bucketStart[bucket]; i < m_bucketStart[bucket + 1]; ++i)
+					{
+						s32 proxyId = m_cellProxies[i];
+						if (proxyId == previousId)
+						{
+							continue;
+						}
+						previousId = proxyId;
+
+						// Report each proxy only from the first cell it shares with the query.
+						const Proxy* proxy = m_proxies + proxyId;
+						if (glm::max(proxy->lowerX, lowerX) != x || glm::max(proxy->lowerY, lowerY) != y)
+						{
+							continue;
+						}
+
+						if (Physics::TestOverlap(proxy->aabb, aabb))
+						{
+							if (callback->QueryCallback(proxyId) == false)
+							{
+								return;
+							}
+						}
+					}
+				}
+			}
+
+			for (s32 i = 0; i < m_oversizedCount; ++i)
+			{
+				s32 proxyId = m_oversized[i];
+				if (Physics::TestOverlap(m_proxies[proxyId].aabb, aabb))
+				{
+					if (callback->QueryCallback(proxyId) == false)
+					{
+						return;
+					}
+				}
+			}
+		}
+
+		template <typename T>
+		inline bool SpatialHash::RayCastProxy(T* callback, s32 proxyId, RayCastInput* subInput, AABB* segmentAABB) const
+		{
+			if (Physics::TestOverlap(m_proxies[proxyId].aabb, *segmentAABB) == false)
+			{
+				return true;
+			}
+
+			real32 value = callback->RayCastCallback(*subInput, proxyId);
+
+			if (value == 0.0f)
+			{
+				// The client has terminated the ray cast.
+				return false;
+			}
+
+			if (value > 0.0f)
+			{
+				// Update segment bounding box.
+				subInput->maxFraction = value;
+				glm::vec2 t = subInput->p1 + value * (subInput->p2 - subInput->p1);
+				segmentAABB->lowerBound = glm::min(subInput->p1, t);
+				segmentAABB->upperBound = glm::max(subInput->p1, t);
+			}
+
+			return true;
+		}
+
+		template <typename T>
+		inline void SpatialHash::RayCast(T* callback, const RayCastInput& input) const
+		{
+			glm::vec2 p1 = input.p1;
+			glm::vec2 p2 = input.p2;
+			glm::vec2 d = p2 - p1;
+			real32 maxFraction = input.maxFraction;
+
+			// Build a bounding box for the segment.
+			AABB segmentAABB;
+			{
+				glm::vec2 t = p1 + maxFraction * d;
+				segmentAABB.lowerBound = glm::min(p1, t);
+				segmentAABB.upperBound = glm::max(p1, t);
+			}
+
+			RayCastInput subInput;
+			subInput.p1 = p1;
+			subInput.p2 = p2;
+
+			subInput.maxFraction = maxFraction;
+
+			if (m_gridDirty)
+			{
+				// The grid is stale until the next UpdatePairs. Test every proxy
+				// rather than rebuild it from a const query.
+				for (s32 i = 0; i < m_proxyCapacity; ++i)
+				{
+					if ((m_proxies[i].flags & liveFlag) && RayCastProxy(callback, i, &subInput, &segmentAABB) == false)
+					{
+						return;
+					}
+				}
+				return;
+			}
+
+			// The oversized proxies are not in the grid.
+			for (s32 i = 0; i < m_oversizedCount; ++i)
+			{
+				if (RayCastProxy(callback, m_oversized[i], &subInput, &segmentAABB) == false)
+				{
+					return;
+				}
+			}
+
+			// Walk the cells along the ray (Amanatides and Woo). Fractions are in
+			// units of p2 - p1 like maxFraction.
+			s32 x = GetCell(p1.x);
+			s32 y = GetCell(p1.y);
+			s32 stepX = d.x > 0.0f ? 1 : -1;
+			s32 stepY = d.y > 0.0f ? 1 : -1;
+			real32 deltaX = d.x != 0.0f ? m_cellSize / glm::abs(d.x) : FLT_MAX;
+			real32 deltaY = d.y != 0.0f ? m_cellSize / glm::abs(d.y) : FLT_MAX;
+			real32 nextX = d.x != 0.0f ? ((x + (stepX > 0 ? 1 : 0)) * m_cellSize - p1.x) / d.x : FLT_MAX;
+			real32 nextY = d.y != 0.0f ? ((y + (stepY > 0 ? 1 : 0)) * m_cellSize - p1.y) / d.y : FLT_MAX;
+
+			bool first = true;
+			s32 previousX = x;
+			s32 previousY = y;
+			for (;;)
+			{
+				u32 bucket = GetBucket(x, y);
+				s32 previousId = nullProxy;
+				for (s32 i = m_bucketStart[bucket]; i < m_bucketStart[bucket + 1]; ++i)
+				{
+					s32 proxyId = m_cellProxies[i];
+					if (proxyId == previousId)
+					{
+						continue;
+					}
+					previousId = proxyId;
+
+					const Proxy* proxy = m_proxies + proxyId;
+					if (x < proxy->lowerX || proxy->upperX < x || y < proxy->lowerY || proxy->upperY < y)
+					{
+						// Another cell that hashes to this bucket.
+						continue;
+					}
+
+					// The ray crosses the cells of a proxy in one run, so it was already
+					// reported if the previous cell belongs to it.
+					if (first == false && proxy->lowerX <= previousX && previousX <= proxy->upperX &&
+						proxy->lowerY <= previousY && previousY <= proxy->upperY)
+					{
+						continue;
+					}
+
+					if (RayCastProxy(callback, proxyId, &subInput, &segmentAABB) == false)
+					{
+						return;
+					}
+				}
+
+				first = false;
+				previousX = x;
+				previousY = y;
+
+				if (nextX < nextY)
+				{
+					if (nextX > subInput.maxFraction)
+					{
+						break;
+					}
+					x += stepX;
+					nextX += deltaX;
+				}
+				else
+				{
+					if (nextY > subInput.maxFraction)
+					{
+						break;
+					}
+					y += stepY;
+					nextY += deltaY;
+				}
+			}
+		}
+
+	}
+}
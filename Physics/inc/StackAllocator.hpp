@@ -9,17 +9,51 @@ namespace Break
 		const s32 stackSize = 100 * 1024;	// 100k
 		const s32 maxStackEntries = 32;
 
+		/// Allocations are rounded up to this so every entry keeps malloc's alignment.
+		const s32 stackAlignment = 16;
+
+		/// A heap block of the stack. Blocks are chained when an allocation does
+		/// not fit in the current one.
+		struct BREAK_API StackBlock
+		{
+			StackBlock* prev;
+			StackBlock* next;
+			char* data;
+			s32 size;
+			s32 index;
+		};
+
 		struct BREAK_API StackEntry
 		{
 			char* data;
 			s32 size;
-			bool usedMalloc;
+		};
+
+		/// Usage of a stack allocator since it was created.
+		struct BREAK_API StackAllocatorStats
+		{
+			/// The size of the first block.
+			s32 capacity;
+
+			/// The most bytes allocated at once.
+			s32 maxAllocation;
+
+			/// Number of allocations that did not fit in the current block.
+			s32 overflowCount;
+
+			/// Bytes requested by those allocations.
+			s32 overflowBytes;
+
+			/// Number of times Reset grew the first block.
+			s32 growCount;
 		};
 
 
 		// This is a stack allocator used for fast per step allocations.
 		// You must nest allocate/free pairs. The code will assert
 		// if you try to interleave multiple allocate/free pairs.
+		// When the first block is full, more heap blocks are chained. Reset
+		// replaces the chain by one block large enough for the peak usage.
 		class BREAK_API StackAllocator
 		{
 		public:
@@ -29,20 +63,44 @@ namespace Break
 			void* Allocate(s32 size);
 			void Free(void* p);
 
+			/// Set the size of the first block. Nothing may be allocated.
+			void SetCapacity(s32 capacity);
+
+			/// Release the chained blocks and grow the first block to the peak usage.
+			/// Nothing may be allocated. The world calls this at the end of each step.
+			void Reset();
+
 			s32 GetMaxAllocation() const;
 
+			const StackAllocatorStats& GetStats() const;
+
 		private:
 
-			char m_data[stackSize];
-			s32 m_index;
+			StackBlock* CreateBlock(s32 size);
+			void DestroyBlocks(StackBlock* block);
+
+			StackBlock* m_first;
+			StackBlock* m_block;
 
 			s32 m_allocation;
-			s32 m_maxAllocation;
 
-			StackEntry m_entries[maxStackEntries];
+			StackEntry* m_entries;
 			s32 m_entryCount;
+			s32 m_entryCapacity;
+
+			StackAllocatorStats m_stats;
 		};
 
+		inline s32 StackAllocator::GetMaxAllocation() const
+		{
+			return m_stats.maxAllocation;
+		}
+
+		inline const StackAllocatorStats& StackAllocator::GetStats() const
+		{
+			return m_stats;
+		}
+
 	}
 
-}
\ No newline at end of file
+}
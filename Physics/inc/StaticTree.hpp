@@ -0,0 +1,223 @@
+#pragma once
+#include "Collision.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		/// A node in a static tree. Nodes are stored in depth-first order, so the
+		/// first child of an internal node is the next node.
+		struct BREAK_API StaticNode
+		{
+			AABB aabb;
+
+			/// The item of a leaf, or -1 for internal nodes.
+			s32 item;
+
+			/// The node that follows this subtree in depth-first order.
+			s32 skip;
+		};
+
+		/// A compact bounding volume hierarchy over a fixed set of items, such as
+		/// the elements of a mesh. It is built once, top-down, and cannot be changed
+		/// afterwards. The nodes sit in one array in depth-first order and are walked
+		/// front to back without a stack: a node that is missed jumps to its skip index.
+		class BREAK_API StaticTree
+		{
+		public:
+			StaticTree();
+			~StaticTree();
+
+			/// Build the tree over count boxes. Leaf items are the indices of the boxes.
+			void Build(const AABB* aabbs, s32 count);
+
+			/// Make this tree a copy of another tree.
+			void Copy(const StaticTree* tree);
+
+			/// Remove all nodes.
+			void Clear();
+
+			/// Get the bounds of all items. Only valid if the tree is not empty.
+			const AABB& GetBounds() const;
+
+			/// Get the number of nodes.
+			s32 GetNodeCount() const;
+
+			/// Get the height of the tree.
+			s32 GetHeight() const;
+
+			/// Query an AABB for overlapping items. The callback class is called
+			/// with the item of each leaf that overlaps the supplied AABB.
+			/// @see DynamicTree::Query
+			template <typename T>
+			void Query(T* callback, const AABB& aabb) const;
+
+			/// Query a world AABB against a tree built in the local frame of a shape.
+			/// @param xf the world transform of the shape.
+			template <typename T>
+			void Query(T* callback, const AABB& aabb, const Transform2D& xf) const;
+
+			/// Ray-cast against the items. The callback is called with the item of
+			/// each leaf that the ray may hit.
+			/// @see DynamicTree::RayCast
+			template <typename T>
+			void RayCast(T* callback, const RayCastInput& input) const;
+
+		private:
+
+			StaticTree(const StaticTree&);
+			StaticTree& operator=(const StaticTree&);
+
+			struct BuildItem;
+
+			s32 BuildNode(BuildItem* items, s32 count, const AABB* aabbs, s32 depth);
+
+			StaticNode* m_nodes;
+			s32 m_nodeCount;
+			s32 m_height;
+		};
+
+		/// Compute the AABB of an AABB moved by a transform.
+		inline void TransformAABB(AABB* out, const AABB& aabb, const Transform2D& xf)
+		{
+			glm::vec2 c = Transform2D::Mul(xf, aabb.GetCenter());
+			glm::vec2 h = aabb.GetExtents();
+			real32 ac = glm::abs(xf.q.c);
+			real32 as = glm::abs(xf.q.s);
+			glm::vec2 e(ac * h.x + as * h.y, as * h.x + ac * h.y);
+			out->lowerBound = c - e;
+			out->upperBound = c + e;
+		}
+
+		inline const AABB& StaticTree::GetBounds() const
+		{
+			assert(m_nodeCount > 0);
+			return m_nodes[0].aabb;
+		}
+
+		inline s32 StaticTree::GetNodeCount() const
+		{
+			return m_nodeCount;
+		}
+
+		inline s32 StaticTree::GetHeight() const
+		{
+			return m_height;
+		}
+
+		template <typename T>
+		inline void StaticTree::Query(T* callback, const AABB& aabb) const
+		{
+			s32 index = 0;
+			while (index < m_nodeCount)
+			{
+				const StaticNode* node = m_nodes + index;
+				if (TestOverlap(node->aabb, aabb) == false)
+				{
+					index = node->skip;
+					continue;
+				}
+
+				if (node->item >= 0)
+				{
+					bool proceed = callback->QueryCallback(node->item);
+					if (proceed == false)
+					{
+						return;
+					}
+				}
+
+				++index;
+			}
+		}
+
+		template <typename T>
+		inline void StaticTree::Query(T* callback, const AABB& aabb, const Transform2D& xf) const
+		{
+			// Move the box into the frame of the tree.
+			Transform2D inverse;
+			inverse.q.s = -xf.q.s;
+			inverse.q.c = xf.q.c;
+			inverse.p = -Rotation2D::MulT(xf.q, xf.p);
+
+			AABB localAABB;
+			TransformAABB(&localAABB, aabb, inverse);
+			Query(callback, localAABB);
+		}
+
+		template <typename T>
+		inline void StaticTree::RayCast(T* callback, const RayCastInput& input) const
+		{
+			glm::vec2 p1 = input.p1;
+			glm::vec2 p2 = input.p2;
+			glm::vec2 r = p2 - p1;
+			assert(Infrastructure::MathUtils::LengthSquared(r) > 0.0f);
+			r = glm::normalize(r);
+
+			// v is perpendicular to the segment.
+			glm::vec2 v = Infrastructure::MathUtils::Cross2(1.0f, r);
+			glm::vec2 abs_v = glm::abs(v);
+
+			real32 maxFraction = input.maxFraction;
+
+			// Build a bounding box for the segment.
+			AABB segmentAABB;
+			{
+				glm::vec2 t = p1 + maxFraction * (p2 - p1);
+				segmentAABB.lowerBound = glm::min(p1, t);
+				segmentAABB.upperBound = glm::max(p1, t);
+			}
+
+			s32 index = 0;
+			while (index < m_nodeCount)
+			{
+				const StaticNode* node = m_nodes + index;
+				if (TestOverlap(node->aabb, segmentAABB) == false)
+				{
+					index = node->skip;
+					continue;
+				}
+
+				// Separating axis for segment (Gino, p80).
+				// |dot(v, p1 - c)| > dot(|v|, h)
+				glm::vec2 c = node->aabb.GetCenter();
+				glm::vec2 h = node->aabb.GetExtents();
+				real32 separation = glm::abs(glm::dot(v, p1 - c)) - glm::dot(abs_v, h);
+				if (separation > 0.0f)
+				{
+					index = node->skip;
+					continue;
+				}
+
+				if (node->item >= 0)
+				{
+					RayCastInput subInput;
+					subInput.p1 = input.p1;
+					subInput.p2 = input.p2;
+					subInput.maxFraction = maxFraction;
+
+					real32 value = callback->RayCastCallback(subInput, node->item);
+
+					if (value == 0.0f)
+					{
+						// The client has terminated the ray cast.
+						return;
+					}
+
+					if (value > 0.0f)
+					{
+						// Update segment bounding box.
+						maxFraction = value;
+						glm::vec2 t = p1 + maxFraction * (p2 - p1);
+						segmentAABB.lowerBound = glm::min(p1, t);
+						segmentAABB.upperBound = glm::max(p1, t);
+					}
+				}
+
+				++index;
+			}
+		}
+
+	}
+}
@@ -0,0 +1,271 @@
+#pragma once
+#include "IBroadPhase.hpp"
+#include "BroadPhase.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		/// An incremental sweep-and-prune broad-phase. The x bounds of all fat
+		/// AABBs are kept in one sorted endpoint array. When a proxy leaves its
+		/// fat AABB its two endpoints are moved into place with insertion sort,
+		/// which only costs a few swaps per step when motion is coherent, and the
+		/// proxy is checked for new pairs on the next UpdatePairs.
+		///
+		/// Only the x axis is sorted. A y array would have to be swept past every
+		/// proxy at the same height, no matter how far away, which is exactly what
+		/// a level laid out along x is full of. Queries walk the endpoints starting
+		/// one maximum proxy width to the left of the query box, so they are fast
+		/// for scenes spread along x but degrade towards O(n) when some proxies are
+		/// very wide or everything is stacked in one column.
+		///
+		/// New proxies are merged into the array in one batch on UpdatePairs and
+		/// destroyed proxies are dropped at the same time.
+		class BREAK_API SweepAndPrune : public IBroadPhase
+		{
+		public:
+			SweepAndPrune();
+			~SweepAndPrune();
+
+			s32 CreateProxy(const AABB& aabb, void* userData);
+			void CreateProxies(const AABB* aabbs, void* const* userData, s32 count, s32* proxyIds);
+			void DestroyProxy(s32 proxyId);
+			void MoveProxy(s32 proxyId, const AABB& aabb, const glm::vec2& displacement);
+			void TouchProxy(s32 proxyId);
+
+			const AABB& GetFatAABB(s32 proxyId) const;
+			void SetFatAABB(s32 proxyId, const AABB& fatAABB);
+			void* GetUserData(s32 proxyId) const;
+			bool TestOverlap(s32 proxyIdA, s32 proxyIdB) const;
+			s32 GetProxyCount() const;
+
+			void UpdatePairs(BroadPhasePairCallback* callback);
+
+			/// The templated queries call the callback directly for each proxy.
+			template <typename T>
+			void Query(T* callback, const AABB& aabb) const;
+			void Query(BroadPhaseQueryCallback* callback, const AABB& aabb) const;
+
+			template <typename T>
+			void RayCast(T* callback, const RayCastInput& input) const;
+			void RayCast(BroadPhaseRayCastCallback* callback, const RayCastInput& input) const;
+
+			void ShiftOrigin(const glm::vec2& newOrigin);
+
+		private:
+
+			/// Create a proxy without touching it.
+			s32 AddProxy(const AABB& aabb, void* userData);
+
+			// Proxy flags
+			enum
+			{
+				liveFlag	= 0x0001,
+				pendingFlag	= 0x0002,
+				touchedFlag	= 0x0004,
+				deadFlag	= 0x0008
+			};
+
+			struct Proxy
+			{
+				/// Enlarged AABB
+				AABB aabb;
+				void* userData;
+
+				/// Endpoint indices while the proxy is in the array.
+				s32 lower;
+				s32 upper;
+
+				s32 next;
+				s32 flags;
+			};
+
+			/// A bound on the x axis. data holds the proxy id times two, plus one for upper bounds.
+			struct Endpoint
+			{
+				real32 value;
+				s32 data;
+			};
+
+			static bool EndpointLessThan(const Endpoint& a, const Endpoint& b);
+
+			s32 AllocateProxy();
+
+			void SetEndpointIndex(const Endpoint& endpoint, s32 index);
+			void SortEndpoint(s32 index);
+
+			void InsertPending();
+			void Compact();
+			void ComputeMaxExtent();
+
+			void QueryTouched(s32 proxyId);
+
+			s32 FindFirstEndpoint(real32 value) const;
+
+			Proxy* m_proxies;
+			s32 m_proxyCapacity;
+			s32 m_proxyCount;
+			s32 m_freeList;
+
+			Endpoint* m_endpoints;
+			s32 m_endpointCount;
+			s32 m_endpointCapacity;
+
+			/// Widest fat AABB on x. Only shrinks when the array is rebuilt.
+			real32 m_maxExtent;
+
+			s32* m_pendingBuffer;
+			s32 m_pendingCount;
+			s32 m_pendingCapacity;
+
+			s32* m_touchBuffer;
+			s32 m_touchCount;
+			s32 m_touchCapacity;
+
+			s32 m_deadCount;
+
+			Pair* m_pairBuffer;
+			s32 m_pairCount;
+			s32 m_pairCapacity;
+		};
+
+		inline const AABB& SweepAndPrune::GetFatAABB(s32 proxyId) const
+		{
+			assert(0 <= proxyId && proxyId < m_proxyCapacity);
+			return m_proxies[proxyId].aabb;
+		}
+
+		inline void* SweepAndPrune::GetUserData(s32 proxyId) const
+		{
+			assert(0 <= proxyId && proxyId < m_proxyCapacity);
+			return m_proxies[proxyId].userData;
+		}
+
+		inline bool SweepAndPrune::TestOverlap(s32 proxyIdA, s32 proxyIdB) const
+		{
+			return Physics::TestOverlap(m_proxies[proxyIdA].aabb, m_proxies[proxyIdB].aabb);
+		}
+
+		inline s32 SweepAndPrune::GetProxyCount() const
+		{
+			return m_proxyCount;
+		}
+
+		template <typename T>
+		inline void SweepAndPrune::Query(T* callback, const AABB& aabb) const
+		{
+			for (s32 i = FindFirstEndpoint(aabb.lowerBound.x - m_maxExtent); i < m_endpointCount; ++i)
+			{
+				const Endpoint& endpoint = m_endpoints[i];
+				if (endpoint.value > aabb.upperBound.x)
+				{
+					break;
+				}
+
+				if (endpoint.data & 1)
+				{
+					continue;
+				}
+
+				s32 proxyId = endpoint.data >> 1;
+				const Proxy* proxy = m_proxies + proxyId;
+				if ((proxy->flags & liveFlag) && Physics::TestOverlap(proxy->aabb, aabb))
+				{
+					if (callback->QueryCallback(proxyId) == false)
+					{
+						return;
+					}
+				}
+			}
+
+			// Proxies created since the last UpdatePairs are not in the array yet.
+			for (s32 i = 0; i < m_pendingCount; ++i)
+			{
+				s32 proxyId = m_pendingBuffer[i];
+				const Proxy* proxy = m_proxies + proxyId;
+				if ((proxy->flags & liveFlag) && Physics::TestOverlap(proxy->aabb, aabb))
+				{
+					if (callback->QueryCallback(proxyId) == false)
+					{
+						return;
+					}
+				}
+			}
+		}
+
+		template <typename T>
+		inline void SweepAndPrune::RayCast(T* callback, const RayCastInput& input) const
+		{
+			glm::vec2 p1 = input.p1;
+			glm::vec2 p2 = input.p2;
+			real32 maxFraction = input.maxFraction;
+
+			// Build a bounding box for the segment.
+			AABB segmentAABB;
+			{
+				glm::vec2 t = p1 + maxFraction * (p2 - p1);
+				segmentAABB.lowerBound = glm::min(p1, t);
+				segmentAABB.upperBound = glm::max(p1, t);
+			}
+
+			RayCastInput subInput;
+			subInput.p1 = p1;
+			subInput.p2 = p2;
+
+			// Walk the sorted endpoints first, then the pending proxies.
+			s32 index = FindFirstEndpoint(segmentAABB.lowerBound.x - m_maxExtent);
+			s32 pendingIndex = 0;
+			for (;;)
+			{
+				s32 proxyId;
+				if (index < m_endpointCount && m_endpoints[index].value <= segmentAABB.upperBound.x)
+				{
+					const Endpoint& endpoint = m_endpoints[index];
+					++index;
+					if (endpoint.data & 1)
+					{
+						continue;
+					}
+
+					proxyId = endpoint.data >> 1;
+				}
+				else if (pendingIndex < m_pendingCount)
+				{
+					index = m_endpointCount;
+					proxyId = m_pendingBuffer[pendingIndex];
+					++pendingIndex;
+				}
+				else
+				{
+					break;
+				}
+
+				const Proxy* proxy = m_proxies + proxyId;
+				if ((proxy->flags & liveFlag) == 0 || Physics::TestOverlap(proxy->aabb, segmentAABB) == false)
+				{
+					continue;
+				}
+
+				subInput.maxFraction = maxFraction;
+				real32 value = callback->RayCastCallback(subInput, proxyId);
+
+				if (value == 0.0f)
+				{
+					// The client has terminated the ray cast.
+					return;
+				}
+
+				if (value > 0.0f)
+				{
+					// Update segment bounding box.
+					maxFraction = value;
+					glm::vec2 t = p1 + maxFraction * (p2 - p1);
+					segmentAABB.lowerBound = glm::min(p1, t);
+					segmentAABB.upperBound = glm::max(p1, t);
+				}
+			}
+		}
+
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "Globals.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		class BREAK_API Contact;
+
+		/// A binary min-heap of contacts keyed by their cached time of impact.
+		/// Each queued contact stores its heap slot in Contact::m_toiIndex so it can be
+		/// re-keyed or removed in O(log n) when its bodies move.
+		class BREAK_API TOIQueue
+		{
+		public:
+			TOIQueue();
+			~TOIQueue();
+
+			/// Insert a contact or re-key it if it is already queued. The key is Contact::m_toi.
+			void Update(Contact* contact);
+
+			/// Remove a contact if it is queued.
+			void Remove(Contact* contact);
+
+			/// Get the contact with the smallest time of impact, or NULL if empty.
+			Contact* GetMin() const;
+
+			/// Remove all contacts.
+			void Clear();
+
+			s32 GetCount() const;
+
+		private:
+			void SiftUp(s32 index);
+			void SiftDown(s32 index);
+			void Set(s32 index, Contact* contact);
+
+			Contact** m_heap;
+			s32 m_count;
+			s32 m_capacity;
+		};
+
+		inline Contact* TOIQueue::GetMin() const
+		{
+			return m_count > 0 ? m_heap[0] : NULL;
+		}
+
+		inline s32 TOIQueue::GetCount() const
+		{
+			return m_count;
+		}
+
+	}
+}
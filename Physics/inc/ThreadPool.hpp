@@ -0,0 +1,72 @@
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "Globals.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		/// A fixed set of worker threads used to split loops across cores. The
+		/// calling thread always takes part, so a pool with zero workers simply
+		/// runs everything inline. Only one loop runs on the pool at a time; a
+		/// ParallelFor issued while another is in flight (for example from inside
+		/// a task) runs inline on the calling thread instead of blocking.
+		class BREAK_API ThreadPool
+		{
+		public:
+			/// A task processes items [begin, end). threadIndex is in [0, GetThreadCount())
+			/// and is unique among the threads running the same loop, so it can index
+			/// per-thread scratch memory.
+			typedef void (*TaskFunction)(void* context, s32 begin, s32 end, s32 threadIndex);
+
+			/// @param workerCount number of threads to spawn besides the caller.
+			explicit ThreadPool(s32 workerCount);
+
+			/// Joins all workers.
+			~ThreadPool();
+
+			/// Get the number of threads that take part in a loop, including the caller.
+			s32 GetThreadCount() const;
+
+			/// Run task over [0, count) in chunks of at most grainSize items and
+			/// return once every chunk is done.
+			void ParallelFor(s32 count, s32 grainSize, TaskFunction task, void* context);
+
+		private:
+
+			ThreadPool(const ThreadPool&);
+			ThreadPool& operator=(const ThreadPool&);
+
+			void WorkerMain(s32 threadIndex);
+			void RunChunks(s32 threadIndex);
+
+			std::thread* m_workers;
+			s32 m_workerCount;
+
+			std::mutex m_loopMutex;
+
+			std::mutex m_mutex;
+			std::condition_variable m_wake;
+			std::condition_variable m_done;
+			u32 m_generation;
+			s32 m_busyCount;
+			bool m_quit;
+
+			TaskFunction m_task;
+			void* m_context;
+			s32 m_count;
+			s32 m_grainSize;
+			std::atomic<s32> m_next;
+		};
+
+		inline s32 ThreadPool::GetThreadCount() const
+		{
+			return m_workerCount + 1;
+		}
+
+	}
+}
@@ -46,6 +46,38 @@ namespace Break
 		/// Note: use Distance to compute the contact point and normal at the time of impact.
 		void BREAK_API TimeOfImpact(TOIOutput* output, const TOIInput* input);
 
+		/// Compute the time of impact, warm starting the first distance query from a
+		/// simplex cache. The cache is input/output and holds the last simplex, so it
+		/// can be kept across steps. On the first call set SimplexCache.count to zero.
+		void BREAK_API TimeOfImpact(TOIOutput* output, SimplexCache* cache, const TOIInput* input);
+
+		/// Input parameters for ShapeCast. Shape A is moved by translationA
+		/// without rotating, shape B stays put.
+		struct BREAK_API ShapeCastInput
+		{
+			DistanceProxy proxyA;
+			DistanceProxy proxyB;
+			Transform2D transformA;
+			Transform2D transformB;
+			glm::vec2 translationA;
+			real32 maxFraction;	// the cast covers [0, maxFraction] of translationA
+		};
+
+		/// Output parameters for ShapeCast.
+		struct BREAK_API ShapeCastOutput
+		{
+			glm::vec2 point;	///< the contact point on the surface of shape B
+			glm::vec2 normal;	///< the surface normal of shape B at the point, towards shape A
+			real32 fraction;	///< the fraction of translationA travelled at the hit
+		};
+
+		/// Cast shape A along a translation against shape B. This runs TimeOfImpact
+		/// over the translation and Distance at the time of impact. Shapes that
+		/// overlap at the start are reported at fraction zero, with the normal
+		/// pointing against the translation if the cores overlap.
+		/// @return true if the shapes touch within maxFraction.
+		bool BREAK_API ShapeCast(ShapeCastOutput* output, const ShapeCastInput* input);
+
 	}
 
 }
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+#include <chrono>
+#include "Globals.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		/// A monotonic high resolution timer used for profiling. It does not
+		/// depend on the platform services so the physics can run headless.
+		class BREAK_API Timer
+		{
+		public:
+
+			/// Constructor starts the timer.
+			Timer();
+
+			/// Reset the timer.
+			void Reset();
+
+			/// Get the time since construction or the last reset.
+			u64 GetNanoseconds() const;
+
+			/// Get the time since construction or the last reset.
+			real32 GetMilliseconds() const;
+
+		private:
+			std::chrono::steady_clock::time_point m_start;
+		};
+
+	}
+}
@@ -0,0 +1,240 @@
+#pragma once
+#include "Collision.hpp"
+#include "GrowableStack.hpp"
+#include "DynamicTree.hpp"
+#include "Simd.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		/// A node in the wide tree. Holds up to four children with their bounds
+		/// stored as structure of arrays so all four can be tested at once.
+		/// Unused slots have inverted bounds and never pass an overlap test.
+		struct BREAK_API WideNode
+		{
+			real32 minX[4];
+			real32 minY[4];
+			real32 maxX[4];
+			real32 maxY[4];
+
+			/// >= 0 is an internal node index, _nullNode is an empty slot and
+			/// anything below that is an encoded proxy id (see WideTree::IsLeaf).
+			s32 children[4];
+		};
+
+		/// A read-only 4-wide bounding volume hierarchy built from a DynamicTree.
+		/// Each binary node is collapsed with its children until it holds up to four
+		/// subtrees and the result is stored in depth-first order, so a query walks
+		/// roughly half as many nodes as the binary tree and touches memory mostly
+		/// front to back. The tree is a snapshot: it must be rebuilt after the
+		/// dynamic tree changes. Callbacks are the same as for DynamicTree.
+		class BREAK_API WideTree
+		{
+		public:
+			WideTree();
+			~WideTree();
+
+			/// Rebuild from the given tree. Node memory is reused between builds.
+			void Build(const DynamicTree* tree);
+
+			/// Drop all nodes but keep the memory around.
+			void Clear();
+
+			/// Get the number of wide nodes.
+			s32 GetNodeCount() const;
+
+			/// Query an AABB for overlapping proxies. The callback class
+			/// is called for each proxy that overlaps the supplied AABB.
+			template <typename T>
+			void Query(T* callback, const AABB& aabb) const;
+
+			/// Ray-cast against the proxies in the tree. Same contract as DynamicTree::RayCast.
+			template <typename T>
+			void RayCast(T* callback, const RayCastInput& input) const;
+
+			static bool IsLeaf(s32 child)
+			{
+				return child < _nullNode;
+			}
+
+			static s32 EncodeLeaf(s32 proxyId)
+			{
+				return _nullNode - 1 - proxyId;
+			}
+
+			static s32 DecodeLeaf(s32 child)
+			{
+				return _nullNode - 1 - child;
+			}
+
+		private:
+
+			s32 BuildNode(const TreeNode* nodes, s32 index);
+
+			WideNode* m_nodes;
+			s32 m_nodeCount;
+			s32 m_nodeCapacity;
+		};
+
+		inline s32 WideTree::GetNodeCount() const
+		{
+			return m_nodeCount;
+		}
+
+		template <typename T>
+		inline void WideTree::Query(T* callback, const AABB& aabb) const
+		{
+			if (m_nodeCount == 0)
+			{
+				return;
+			}
+
+			Float4 qMinX = Float4::Splat(aabb.lowerBound.x);
+			Float4 qMinY = Float4::Splat(aabb.lowerBound.y);
+			Float4 qMaxX = Float4::Splat(aabb.upperBound.x);
+			Float4 qMaxY = Float4::Splat(aabb.upperBound.y);
+
+			GrowableStack<s32, 256> stack;
+			stack.Push(0);
+
+			while (stack.GetCount() > 0)
+			{
+				const WideNode* node = m_nodes + stack.Pop();
+
+				s32 mask = Float4::LessEqual(Float4::Load(node->minX), qMaxX);
+				mask &= Float4::LessEqual(Float4::Load(node->minY), qMaxY);
+				mask &= Float4::LessEqual(qMinX, Float4::Load(node->maxX));
+				mask &= Float4::LessEqual(qMinY, Float4::Load(node->maxY));
+
+				for (s32 i = 0; mask != 0; ++i, mask >>= 1)
+				{
+					if ((mask & 1) == 0)
+					{
+						continue;
+					}
+
+					s32 child = node->children[i];
+					if (IsLeaf(child))
+					{
+						bool proceed = callback->QueryCallback(DecodeLeaf(child));
+						if (proceed == false)
+						{
+							return;
+						}
+					}
+					else
+					{
+						stack.Push(child);
+					}
+				}
+			}
+		}
+
+		template <typename T>
+		inline void WideTree::RayCast(T* callback, const RayCastInput& input) const
+		{
+			if (m_nodeCount == 0)
+			{
+				return;
+			}
+
+			glm::vec2 p1 = input.p1;
+			glm::vec2 p2 = input.p2;
+			glm::vec2 r = p2 - p1;
+			assert(glm::dot(r, r) > 0.0f);
+			r = glm::normalize(r);
+
+			// v is perpendicular to the segment.
+			glm::vec2 v(-r.y, r.x);
+			glm::vec2 abs_v = glm::abs(v);
+
+			real32 maxFraction = input.maxFraction;
+
+			// Build a bounding box for the segment.
+			glm::vec2 t = p1 + maxFraction * (p2 - p1);
+			Float4 sMinX = Float4::Splat(glm::min(p1.x, t.x));
+			Float4 sMinY = Float4::Splat(glm::min(p1.y, t.y));
+			Float4 sMaxX = Float4::Splat(glm::max(p1.x, t.x));
+			Float4 sMaxY = Float4::Splat(glm::max(p1.y, t.y));
+
+			// Separating axis for segment (Gino, p80), scaled by two so we can
+			// work with the sums and differences of the bounds directly.
+			// |dot(v, 2 * p1 - 2 * c)| > dot(|v|, 2 * h)
+			Float4 vx = Float4::Splat(v.x);
+			Float4 vy = Float4::Splat(v.y);
+			Float4 absVx = Float4::Splat(abs_v.x);
+			Float4 absVy = Float4::Splat(abs_v.y);
+			Float4 p1x2 = Float4::Splat(2.0f * p1.x);
+			Float4 p1y2 = Float4::Splat(2.0f * p1.y);
+			Float4 zero = Float4::Splat(0.0f);
+
+			GrowableStack<s32, 256> stack;
+			stack.Push(0);
+
+			while (stack.GetCount() > 0)
+			{
+				const WideNode* node = m_nodes + stack.Pop();
+
+				Float4 minX = Float4::Load(node->minX);
+				Float4 minY = Float4::Load(node->minY);
+				Float4 maxX = Float4::Load(node->maxX);
+				Float4 maxY = Float4::Load(node->maxY);
+
+				s32 mask = Float4::LessEqual(minX, sMaxX);
+				mask &= Float4::LessEqual(minY, sMaxY);
+				mask &= Float4::LessEqual(sMinX, maxX);
+				mask &= Float4::LessEqual(sMinY, maxY);
+				if (mask == 0)
+				{
+					continue;
+				}
+
+				Float4 d = vx * (p1x2 - (minX + maxX)) + vy * (p1y2 - (minY + maxY));
+				Float4 separation = Float4::Abs(d) - (absVx * (maxX - minX) + absVy * (maxY - minY));
+				mask &= Float4::LessEqual(separation, zero);
+
+				for (s32 i = 0; mask != 0; ++i, mask >>= 1)
+				{
+					if ((mask & 1) == 0)
+					{
+						continue;
+					}
+
+					s32 child = node->children[i];
+					if (IsLeaf(child) == false)
+					{
+						stack.Push(child);
+						continue;
+					}
+
+					RayCastInput subInput;
+					subInput.p1 = input.p1;
+					subInput.p2 = input.p2;
+					subInput.maxFraction = maxFraction;
+
+					real32 value = callback->RayCastCallback(subInput, DecodeLeaf(child));
+
+					if (value == 0.0f)
+					{
+						// The client has terminated the ray cast.
+						return;
+					}
+
+					if (value > 0.0f)
+					{
+						// Update segment bounding box.
+						maxFraction = value;
+						t = p1 + maxFraction * (p2 - p1);
+						sMinX = Float4::Splat(glm::min(p1.x, t.x));
+						sMinY = Float4::Splat(glm::min(p1.y, t.y));
+						sMaxX = Float4::Splat(glm::max(p1.x, t.x));
+						sMaxY = Float4::Splat(glm::max(p1.y, t.y));
+					}
+				}
+			}
+		}
+
+	}
+}
@@ -6,6 +6,11 @@
 #include "WorldCallBacks.hpp"
 #include "PTimeStep.hpp"
 #include "Profile.hpp"
+#include "ProfileHistory.hpp"
+#include "ContactEvents.hpp"
+#include "TOIQueue.hpp"
+#include "SlotMap.hpp"
+#include "Body2D.hpp"
 namespace Break
 {
 
@@ -18,6 +23,85 @@ namespace Break
 		class BREAK_API Body;
 		class BREAK_API Fixture;
 		class BREAK_API Joint;
+		class BREAK_API Shape;
+		class BREAK_API ThreadPool;
+		class BREAK_API WorldSnapshot;
+		class BREAK_API WorldFile;
+		class BREAK_API ParticleSystem;
+		struct BREAK_API ParticleSystemDef;
+
+		/// Bodies per page of the world body storage.
+		const s32 bodyPageSize = 64;
+
+		/// The closest hit of one ray in World::RayCastBatch or of one sweep in
+		/// World::ShapeCastBatch.
+		struct BREAK_API RayCastHit
+		{
+			/// The fixture that was hit, or NULL if the ray hit nothing.
+			Fixture* fixture;
+			glm::vec2 point;
+			glm::vec2 normal;
+			real32 fraction;
+		};
+
+		/// One sweep of World::ShapeCastBatch.
+		struct BREAK_API ShapeCastQuery
+		{
+			/// A circle, polygon, edge or capsule. It must remain in scope during the batch.
+			const Shape* shape;
+
+			/// The start transform of the shape.
+			Transform2D transform;
+
+			/// The shape moves by this translation without rotating.
+			glm::vec2 translation;
+		};
+
+		/// A world definition holds the data needed to construct a world.
+		/// You can safely re-use world definitions.
+		struct BREAK_API WorldDef
+		{
+			/// This constructor sets the world definition default values.
+			WorldDef()
+			{
+				gravity = glm::vec2(0.0f, -10.0f);
+				broadPhase = treeBroadPhase;
+				cellSize = 1.0f;
+				profileHistorySize = 256;
+				threadCachingAllocator = false;
+				stackAllocatorSize = stackSize;
+				contactEventFlags = 0;
+				impulseEventThreshold = 0.0f;
+			}
+
+			/// The world gravity vector.
+			glm::vec2 gravity;
+
+			/// The broad-phase algorithm used to find pairs and answer queries.
+			BroadPhaseType broadPhase;
+
+			/// The cell size of the spatial hash broad-phase. Should be about the
+			/// size of the most common body.
+			real32 cellSize;
+
+			/// The number of step profiles kept by the world. Zero disables the history.
+			s32 profileHistorySize;
+
+			/// Give each thread its own block allocator free lists so bodies, fixtures
+			/// and shapes can be allocated and freed from worker threads.
+			bool threadCachingAllocator;
+
+			/// The initial size in bytes of the per-step stack allocator. It grows at the
+			/// end of a step that did not fit.
+			s32 stackAllocatorSize;
+
+			/// The kinds of contact events recorded each step, a combination of
+			/// ContactEventFlags. Zero records none.
+			u32 contactEventFlags;
+
+			/// The smallest point impulse that produces an impulse event.
+			real32 impulseEventThreshold;
+		};
 
 		/// The world class manages all physics entities, dynamic simulation,
 		/// and asynchronous queries. The world also contains efficient memory
@@ -29,6 +113,10 @@ namespace Break
 			/// @param gravity the world gravity vector.
 			World(const glm::vec2& gravity); 
 
+			/// Construct a world object from a definition. No reference to the
+			/// definition is retained.
+			World(const WorldDef* def);
+
 			/// Destruct the world. All physics entities are destroyed and all heap memory is released.
 			~World();
 
@@ -45,6 +133,22 @@ namespace Break
 			/// remain in scope.
 			void SetContactListener(ContactListener* listener);
 
+			/// Choose the kinds of contact events recorded each step, a combination
+			/// of ContactEventFlags. Zero turns the recording off.
+			void SetContactEventFlags(u32 flags);
+
+			/// Only record impulse events whose largest point impulse reaches this value.
+			void SetImpulseEventThreshold(real32 threshold);
+
+			/// Get the contact events of the last step. These include the end events
+			/// of the touching contacts destroyed since the step before.
+			const ContactEvents& GetContactEvents() const;
+
+			/// Register a thread pool used to spread batched queries and other parallel
+			/// work over several threads. The pool is owned by you and must remain in
+			/// scope. Pass NULL to do everything on the calling thread.
+			void SetThreadPool(ThreadPool* pool);
+			ThreadPool* GetThreadPool() const { return m_threadPool; }
 
 			/// Create a rigid body given a definition. No reference to the definition
 			/// is retained.
@@ -57,6 +161,33 @@ namespace Break
 			/// @warning This function is locked during callbacks.
 			void DestroyBody(Body* body);
 
+			/// Get the body of a handle.
+			/// @return NULL if the body was destroyed.
+			Body* GetBody(BodyHandle handle);
+
+			/// Start creating many bodies and fixtures at once, for example when loading
+			/// a level. Until EndBulkLoad, Body::CreateFixture neither creates broad-phase
+			/// proxies nor updates the body mass. Do not step the world in between.
+			/// @warning This function is locked during callbacks.
+			void BeginBulkLoad();
+
+			/// Create the proxies of all fixtures added since BeginBulkLoad in one batch
+			/// and update the mass of their bodies. The tree broad-phase is rebuilt
+			/// top-down instead of inserting the proxies one by one.
+			void EndBulkLoad();
+
+			/// Is a bulk load in progress?
+			bool IsBulkLoading() const;
+
+			/// Merge the polygon, edge and chain fixtures of static bodies that lie inside
+			/// a region into mesh fixtures on a new static body, one mesh per material
+			/// (friction, restitution and filter). Sensors and fixtures with user data
+			/// are left alone. The baked fixtures are destroyed but their bodies are
+			/// kept, and bodies touching them are woken when the mesh contacts form.
+			/// @return the new body, or NULL if nothing was baked.
+			/// @warning This function is locked during callbacks.
+			Body* BakeStaticGeometry(const AABB& region);
+
 			/// Create a joint to constrain bodies together. No reference to the definition
 			/// is retained. This may cause the connected bodies to cease colliding.
 			/// @warning This function is locked during callbacks.
@@ -66,6 +197,18 @@ namespace Break
 			/// @warning This function is locked during callbacks.
 			void DestroyJoint(Joint* joint);
 
+			/// Create a particle system. No reference to the definition is retained.
+			/// @warning This function is locked during callbacks.
+			ParticleSystem* CreateParticleSystem(const ParticleSystemDef* def);
+
+			/// Destroy a particle system and all of its particles.
+			/// @warning This function is locked during callbacks.
+			void DestroyParticleSystem(ParticleSystem* system);
+
+			/// Get the world particle system list. Use ParticleSystem::GetNext to walk it.
+			ParticleSystem* GetParticleSystemList();
+			const ParticleSystem* GetParticleSystemList() const;
+
 			/// Take a time step. This performs collision detection, integration,
 			/// and constraint solution.
 			/// @param timeStep the amount of time to simulate, this should not vary.
@@ -99,6 +242,38 @@ namespace Break
 			/// @param point2 the ray ending point
 			void RayCast(RayCastCallback* callback, const glm::vec2& point1, const glm::vec2& point2) const;
 
+			/// Ray-cast a batch of rays and write the closest hit of ray i to hits[i].
+			/// Rays are traversed in spatially sorted order so consecutive rays share
+			/// tree nodes in cache, and the batch is split across the thread pool if
+			/// one is set. Sensors are skipped, as are fixtures whose category bits
+			/// do not overlap maskBits. Like RayCast, shapes containing the start point are ignored.
+			/// @param inputs the rays. Each extends from p1 to p1 + maxFraction * (p2 - p1).
+			/// @param count the number of rays.
+			/// @param hits receives one result per ray.
+			void RayCastBatch(const RayCastInput* inputs, s32 count, RayCastHit* hits, u16 maskBits = 0xFFFF) const;
+
+			/// Sweep a shape along a translation without rotating it and report the
+			/// fixtures it hits. Your callback controls the cast as in RayCast, with
+			/// the fraction measured along the translation. Fixtures the shape
+			/// overlaps at the start are reported at fraction zero.
+			/// @param callback a user implemented callback class.
+			/// @param shape a circle, polygon, edge or capsule.
+			/// @param xf the start transform of the shape.
+			/// @param translation the sweep translation.
+			void ShapeCast(RayCastCallback* callback, const Shape* shape, const Transform2D& xf, const glm::vec2& translation) const;
+
+			/// Sweep a batch of shapes and write the first hit of sweep i to hits[i].
+			/// Sensors and fixtures whose category bits do not overlap maskBits are
+			/// skipped. Ordering and threading work as in RayCastBatch.
+			void ShapeCastBatch(const ShapeCastQuery* queries, s32 count, RayCastHit* hits, u16 maskBits = 0xFFFF) const;
+
+			/// Query a batch of AABBs. The fixtures whose AABB overlaps aabbs[i] are
+			/// written to fixtures[i * maxResults], at most maxResults of them, and
+			/// their number to counts[i]. Fixtures whose category bits do not overlap
+			/// maskBits are skipped. Threading and ordering work as in RayCastBatch.
+			/// @return false if any query found more than maxResults fixtures.
+			bool QueryAABBBatch(const AABB* aabbs, s32 count, Fixture** fixtures, s32 maxResults, s32* counts, u16 maskBits = 0xFFFF) const;
+
 			/// Get the world body list. With the returned body, use Body::GetNext to get
 			/// the next body in the world list. A NULL body indicates the end of the list.
 			/// @return the head of the world body list.
@@ -119,6 +294,14 @@ namespace Break
 			Contact* GetContactList();
 			const Contact* GetContactList() const;
 
+			/// Get the sensor overlaps, packed in an array. Sensors have no contacts;
+			/// use SensorOverlap::IsTouching to see which shapes are inside a sensor.
+			/// @warning destroying an overlap moves the last one into its place.
+			const SensorOverlap* GetSensorOverlaps() const;
+
+			/// Get the number of sensor overlaps.
+			s32 GetSensorOverlapCount() const;
+
 			/// Enable/disable sleep.
 			void SetAllowSleeping(bool flag);
 			bool GetAllowSleeping() const { return m_allowSleep; }
@@ -127,6 +310,11 @@ namespace Break
 			void SetWarmStarting(bool flag) { m_warmStarting = flag; }
 			bool GetWarmStarting() const { return m_warmStarting; }
 
+			/// Enable/disable solving revolute and distance joints in SIMD bundles.
+			/// Disabling it solves every joint one by one. For testing.
+			void SetJointBatching(bool flag) { m_jointBatching = flag; }
+			bool GetJointBatching() const { return m_jointBatching; }
+
 			/// Enable/disable continuous physics. For testing.
 			void SetContinuousPhysics(bool flag) { m_continuousPhysics = flag; }
 			bool GetContinuousPhysics() const { return m_continuousPhysics; }
@@ -141,6 +329,14 @@ namespace Break
 			/// Get the number of bodies.
 			s32 GetBodyCount() const;
 
+			/// Get the number of awake dynamic and kinematic bodies. Only these
+			/// bodies and their contacts are visited by Step.
+			s32 GetAwakeBodyCount() const;
+
+			/// Get the awake dynamic and kinematic bodies. The order changes as
+			/// bodies fall asleep and wake up.
+			Body* const* GetAwakeBodies() const;
+
 			/// Get the number of joints.
 			s32 GetJointCount() const;
 
@@ -177,12 +373,48 @@ namespace Break
 			/// @param newOrigin the new origin with respect to the old origin
 			void ShiftOrigin(const glm::vec2& newOrigin);
 
+			/// Copy the simulation state into a snapshot. This replaces its contents.
+			/// @warning this should be called outside of a time step.
+			void SaveSnapshot(WorldSnapshot* snapshot) const;
+
+			/// Put the world back into the state of a snapshot taken from this world.
+			/// Stepping a restored world gives the same results as stepping the world
+			/// from where the snapshot was taken. Contact listeners are not called.
+			/// @return false, leaving the world unchanged, if bodies, fixtures or joints
+			/// were created or destroyed since the snapshot was taken.
+			/// @warning this should be called outside of a time step.
+			bool RestoreSnapshot(const WorldSnapshot* snapshot);
+
+			/// Write all bodies and their fixtures into a file. This replaces its contents.
+			/// Bodies are stored oldest first, so loading the file gives the same body
+			/// and fixture order as in this world.
+			/// @warning this should be called outside of a time step.
+			void Save(WorldFile* file) const;
+
+			/// Create the bodies and fixtures of a file in a bulk load. The file is
+			/// checked before anything is created.
+			/// @param bodies receives the new bodies in file order, may be NULL.
+			/// @return false, leaving the world unchanged, if the file is invalid.
+			/// @warning This function is locked during callbacks.
+			bool Load(const WorldFile* file, Body** bodies);
+
 			/// Get the contact manager for testing.
 			const ContactManager& GetContactManager() const;
 
 			/// Get the current profile.
 			const Profile& GetProfile() const;
 
+			/// Get the profiles of the last steps.
+			ProfileHistory& GetProfileHistory();
+			const ProfileHistory& GetProfileHistory() const;
+
+			/// Get the occupancy of the small object allocator.
+			/// @param stats an array of blockSizes entries.
+			void GetAllocatorStats(BlockAllocatorStats* stats) const;
+
+			/// Get the usage of the per-step stack allocator.
+			const StackAllocatorStats& GetStackAllocatorStats() const;
+
 			/// Dump the world into the log file.
 			/// @warning this should be called outside of a time step.
 			void Dump();
@@ -194,16 +426,34 @@ namespace Break
 			{
 				newFixture	= 0x0001,
 				locked		= 0x0002,
-				clearForces	= 0x0004
+				clearForces	= 0x0004,
+				bulkLoad	= 0x0008
 			};
 
 			friend class Body;
 			friend class Fixture;
+			friend class Contact;
 			friend class ContactManager;
 			friend class Controller;
+			friend class ParticleSystem;
+
+			void Initialize(const WorldDef* def);
 
+			void Collide();
 			void Solve(const PTimeStep& step);
 			void SolveTOI(const PTimeStep& step);
+			void ComputeTOI(Contact* contact);
+			void PrepareTOI(Body* body);
+			void PrepareTOI(Contact* contact);
+			static bool IsTOICandidate(Contact* contact);
+			static void UpdateContactTOI(Contact* contact);
+			static void UpdateContactTOITask(void* context, s32 begin, s32 end, s32 threadIndex);
+
+			// Add or remove a body from the awake set after its awake flag or type changed.
+			void UpdateAwakeSet(Body* body);
+
+			// Copy a contact record of a snapshot into a contact.
+			void RestoreContact(Contact* contact, const void* record) const;
 
 			BlockAllocator m_blockAllocator;
 			StackAllocator m_stackAllocator;
@@ -212,29 +462,56 @@ namespace Break
 
 			ContactManager m_contactManager;
 
+			// Bodies live in pages so passes over all bodies read memory in order.
+			// The list is kept for GetBodyList and Body::GetNext.
+			SlotMap<Body, bodyPageSize> m_bodies;
 			Body* m_bodyList;
 			Joint* m_jointList;
+			ParticleSystem* m_particleSystemList;
 
 			s32 m_bodyCount;
 			s32 m_jointCount;
 
+			// The awake dynamic and kinematic bodies. A step only walks these and
+			// their contacts, so sleeping islands cost nothing. Removal swaps the
+			// last body into the hole.
+			Body** m_awakeBodies;
+			s32 m_awakeCount;
+			s32 m_awakeCapacity;
+
+			// Bumped by each Collide pass so contacts shared by two awake bodies
+			// are updated once.
+			u32 m_collideStamp;
+
 			glm::vec2 m_gravity;
 			bool m_allowSleep;
 
 			DestructionListener* m_destructionListener;
 
+			ThreadPool* m_threadPool;
+
 			// This is used to compute the time step ratio to
 			// support a variable time step.
 			real32 m_inv_dt0;
 
 			// These are for debugging the solver.
 			bool m_warmStarting;
+			bool m_jointBatching;
 			bool m_continuousPhysics;
 			bool m_subStepping;
 
 			bool m_stepComplete;
 
+			TOIQueue m_toiQueue;
+
+			// Bumped when a step starts its TOI phase. Bodies and contacts with an
+			// older stamp have stale TOI state and are reset when first touched.
+			u32 m_toiStamp;
+
 			Profile m_profile;
+			ProfileHistory m_profileHistory;
+
+			ContactEvents m_contactEvents;
 		};
 
 		inline Body* World::GetBodyList()
@@ -257,6 +534,16 @@ namespace Break
 			return m_jointList;
 		}
 
+		inline ParticleSystem* World::GetParticleSystemList()
+		{
+			return m_particleSystemList;
+		}
+
+		inline const ParticleSystem* World::GetParticleSystemList() const
+		{
+			return m_particleSystemList;
+		}
+
 		inline Contact* World::GetContactList()
 		{
 			return m_contactManager.m_contactList;
@@ -267,11 +554,31 @@ namespace Break
 			return m_contactManager.m_contactList;
 		}
 
+		inline const SensorOverlap* World::GetSensorOverlaps() const
+		{
+			return m_contactManager.m_overlaps;
+		}
+
+		inline s32 World::GetSensorOverlapCount() const
+		{
+			return m_contactManager.m_overlapCount;
+		}
+
 		inline s32 World::GetBodyCount() const
 		{
 			return m_bodyCount;
 		}
 
+		inline s32 World::GetAwakeBodyCount() const
+		{
+			return m_awakeCount;
+		}
+
+		inline Body* const* World::GetAwakeBodies() const
+		{
+			return m_awakeBodies;
+		}
+
 		inline s32 World::GetJointCount() const
 		{
 			return m_jointCount;
@@ -292,6 +599,11 @@ namespace Break
 			return m_gravity;
 		}
 
+		inline bool World::IsBulkLoading() const
+		{
+			return (m_flags & bulkLoad) == bulkLoad;
+		}
+
 		inline bool World::IsLocked() const
 		{
 			return (m_flags & locked) == locked;
@@ -325,6 +637,26 @@ namespace Break
 			return m_profile;
 		}
 
+		inline const StackAllocatorStats& World::GetStackAllocatorStats() const
+		{
+			return m_stackAllocator.GetStats();
+		}
+
+		inline ProfileHistory& World::GetProfileHistory()
+		{
+			return m_profileHistory;
+		}
+
+		inline const ProfileHistory& World::GetProfileHistory() const
+		{
+			return m_profileHistory;
+		}
+
+		inline const ContactEvents& World::GetContactEvents() const
+		{
+			return m_contactEvents;
+		}
+
 
 
 	}
@@ -13,6 +13,7 @@ namespace Break
 		class BREAK_API Joint;
 		class BREAK_API Contact;
 		struct BREAK_API ContactResult;
+		struct BREAK_API SensorOverlap;
 		struct BREAK_API Manifold;
 
 		/// Joints and fixtures are destroyed when their associated
@@ -73,6 +74,13 @@ namespace Break
 			/// Called when two fixtures cease to touch.
 			virtual void EndContact(Contact* contact) { NOT_USED(contact);}
 
+			/// Called when a fixture begins to overlap a sensor. Sensors do not create
+			/// contacts, so they are reported here and not in BeginContact.
+			virtual void BeginSensor(const SensorOverlap* overlap) { NOT_USED(overlap);}
+			/// Called when a fixture ceases to overlap a sensor, also when either
+			/// fixture is destroyed.
+			virtual void EndSensor(const SensorOverlap* overlap) { NOT_USED(overlap);}
+
 			/// This is called after a contact is updated. This allows you to inspect a
 			/// contact before it goes to the solver. If you are careful, you can modify the
 			/// contact manifold (e.g. disable contact).
@@ -0,0 +1,66 @@
+#pragma once
+#include "Globals.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		/// Bodies and fixtures of a world in a compact binary format, used to store
+		/// levels. Each body is stored with its definition and the fixtures with
+		/// their shapes, so a file can be loaded into any world. User data and
+		/// joints are not stored. The records are stored in the byte order of the
+		/// machine that wrote them.
+		/// @see World::Save, World::Load
+		class BREAK_API WorldFile
+		{
+		public:
+			WorldFile();
+			~WorldFile();
+
+			/// Get the file bytes, for example to write them to disk.
+			const u8* GetData() const;
+
+			/// Get the size of the file in bytes.
+			s32 GetSize() const;
+
+			/// Replace the contents with bytes obtained from GetData.
+			void SetData(const void* data, s32 size);
+
+			/// Get the number of bodies in the file, or -1 if the header is invalid.
+			s32 GetBodyCount() const;
+
+			/// Forget the contents but keep the memory.
+			void Clear();
+
+		private:
+			friend class World;
+
+			WorldFile(const WorldFile&);
+			WorldFile& operator=(const WorldFile&);
+
+			/// Grow the buffer by size bytes and return the new space.
+			void* Append(s32 size);
+
+			u8* m_data;
+			s32 m_size;
+			s32 m_capacity;
+		};
+
+		inline const u8* WorldFile::GetData() const
+		{
+			return m_data;
+		}
+
+		inline s32 WorldFile::GetSize() const
+		{
+			return m_size;
+		}
+
+		inline void WorldFile::Clear()
+		{
+			m_size = 0;
+		}
+
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include "Globals.hpp"
+#include "ProfileHistory.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		class BREAK_API World;
+		class BREAK_API ThreadPool;
+		struct BREAK_API WorldDef;
+
+		/// A set of independent worlds stepped together, such as the matches of a
+		/// game server. Worlds share no state, so the group steps them concurrently
+		/// on a thread pool, one world per task. Each world keeps its own block and
+		/// stack allocators, which only the thread stepping it touches during the
+		/// step. A thread pool set on a world itself is not used while the group
+		/// steps on a pool: loops started inside a pool task run inline.
+		/// Worlds that took longest on the last step are started first.
+		class BREAK_API WorldGroup
+		{
+		public:
+			WorldGroup();
+
+			/// Destroys all worlds created by the group.
+			~WorldGroup();
+
+			/// Create a world owned by the group.
+			World* CreateWorld(const WorldDef* def);
+
+			/// Destroy a world of the group. This changes the world indices.
+			void DestroyWorld(World* world);
+
+			/// Get the number of worlds.
+			s32 GetWorldCount() const;
+
+			/// Get a world by index.
+			World* GetWorld(s32 index);
+			const World* GetWorld(s32 index) const;
+
+			/// Register a thread pool used to step the worlds. The pool is owned by
+			/// you and must remain in scope. Pass NULL to step the worlds one after
+			/// another on the calling thread.
+			void SetThreadPool(ThreadPool* pool);
+
+			/// Step every world with the same settings and wait for all of them.
+			/// @see World::Step
+			void Step(real32 timeStep, s32 velocityIterations, s32 positionIterations);
+
+			/// Get the time the last step of a world took, in nanoseconds.
+			u64 GetStepTime(s32 index) const;
+
+			/// Get the time from the start of the last group step until a world
+			/// finished its step, in nanoseconds. This includes the time the world
+			/// waited for a thread.
+			u64 GetLatency(s32 index) const;
+
+			/// Get min/avg/max/p99 of the world latencies of the last step.
+			ProfileStats GetLatencyStats() const;
+
+			/// Get the time the last group step took, in nanoseconds.
+			u64 GetGroupStepTime() const;
+
+		private:
+
+			WorldGroup(const WorldGroup&);
+			WorldGroup& operator=(const WorldGroup&);
+
+			struct Entry;
+
+			static void StepTask(void* context, s32 begin, s32 end, s32 threadIndex);
+
+			Entry* m_entries;
+			s32 m_count;
+			s32 m_capacity;
+
+			/// Entry indices in the order they are started.
+			s32* m_order;
+
+			ThreadPool* m_threadPool;
+
+			real32 m_timeStep;
+			s32 m_velocityIterations;
+			s32 m_positionIterations;
+			u64 m_groupStepTime;
+		};
+
+		inline s32 WorldGroup::GetWorldCount() const
+		{
+			return m_count;
+		}
+
+		inline void WorldGroup::SetThreadPool(ThreadPool* pool)
+		{
+			m_threadPool = pool;
+		}
+
+		inline u64 WorldGroup::GetGroupStepTime() const
+		{
+			return m_groupStepTime;
+		}
+
+	}
+}
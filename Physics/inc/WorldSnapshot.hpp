@@ -0,0 +1,65 @@
+#pragma once
+#include "Globals.hpp"
+
+namespace Break
+{
+	namespace Physics
+	{
+
+		/// The simulation state of a world in a flat binary buffer: body sweeps and
+		/// velocities, the awake set, the fat AABBs of moving proxies, contacts with
+		/// their warm starting impulses and joint impulses. Bodies, fixtures and
+		/// joints themselves are not stored, so a snapshot can only be restored into
+		/// the world it was taken from. The records are copied as they are, so
+		/// taking and restoring a snapshot is cheap enough to do several times per
+		/// frame for rollback.
+		/// @see World::SaveSnapshot, World::RestoreSnapshot
+		class BREAK_API WorldSnapshot
+		{
+		public:
+			WorldSnapshot();
+			~WorldSnapshot();
+
+			/// Get the snapshot bytes, for example to hash or compare them.
+			const u8* GetData() const;
+
+			/// Get the size of the snapshot in bytes.
+			s32 GetSize() const;
+
+			/// Replace the contents with bytes obtained from GetData.
+			void SetData(const void* data, s32 size);
+
+			/// Forget the contents but keep the memory.
+			void Clear();
+
+		private:
+			friend class World;
+
+			WorldSnapshot(const WorldSnapshot&);
+			WorldSnapshot& operator=(const WorldSnapshot&);
+
+			/// Grow the buffer by size bytes and return the new space.
+			void* Append(s32 size);
+
+			u8* m_data;
+			s32 m_size;
+			s32 m_capacity;
+		};
+
+		inline const u8* WorldSnapshot::GetData() const
+		{
+			return m_data;
+		}
+
+		inline s32 WorldSnapshot::GetSize() const
+		{
+			return m_size;
+		}
+
+		inline void WorldSnapshot::Clear()
+		{
+			m_size = 0;
+		}
+
+	}
+}
@@ -3,10 +3,143 @@
 #include <memory.h>
 #include <stddef.h>
 #include <assert.h>
+#include <stdint.h>
+#include <thread>
+#include <mutex>
+#include <new>
 
 using namespace Break;
 using namespace Break::Physics;
 
+// Chunks of a thread cache are aligned to chunkSize so a block finds the
+// cache that owns it by masking its address. They are carved out of slabs
+// of several chunks to keep the alignment waste small.
+const s32 chunksPerSlab = 32;
+
+// The first bytes of a cached chunk. Blocks start after it.
+struct ChunkHeader
+{
+	ThreadCache* owner;
+	s32 index;
+};
+
+const s32 chunkHeaderSize = 16;
+
+namespace Break
+{
+	namespace Physics
+	{
+		// The free lists and chunks of one thread.
+		struct ThreadCache
+		{
+			std::thread::id thread;
+			ThreadCache* next;
+
+			Block* freeLists[blockSizes];
+
+			// Blocks freed by other threads. Any thread pushes, only the owner
+			// takes the whole list, so there is no ABA problem.
+			std::atomic<Block*> remoteFrees[blockSizes];
+
+			// Live blocks are allocations minus local frees minus remote frees.
+			s32 liveBlocks[blockSizes];
+			std::atomic<s32> remoteFreeCount[blockSizes];
+			s32 highWater[blockSizes];
+			s32 chunkCount[blockSizes];
+
+			void** slabs;
+			s32 slabCount;
+			s32 slabSpace;
+
+			s8* nextChunk;
+			s32 chunksLeft;
+		};
+	}
+}
+
+// Remembers the cache of the allocator this thread used last.
+struct ThreadCacheSlot
+{
+	u32 allocatorId;
+	ThreadCache* cache;
+};
+
+static thread_local ThreadCacheSlot s_threadCacheSlot = { 0, NULL };
+static std::atomic<u32> s_nextAllocatorId(1);
+
+static void ResetThreadCache(ThreadCache* cache)
+{
+	for (s32 i = 0; i < cache->slabCount; ++i)
+	{
+		free(cache->slabs[i]);
+	}
+	cache->slabCount = 0;
+	cache->nextChunk = NULL;
+	cache->chunksLeft = 0;
+
+	for (s32 i = 0; i < blockSizes; ++i)
+	{
+		cache->freeLists[i] = NULL;
+		cache->remoteFrees[i].store(NULL, std::memory_order_relaxed);
+		cache->liveBlocks[i] = 0;
+		cache->remoteFreeCount[i].store(0, std::memory_order_relaxed);
+		cache->highWater[i] = 0;
+		cache->chunkCount[i] = 0;
+	}
+}
+
+// Carve a new chunk into blocks of one size and return the first block.
+static Block* AllocateCachedChunk(ThreadCache* cache, s32 index, s32 blockSize)
+{
+	if (cache->chunksLeft == 0)
+	{
+		if (cache->slabCount == cache->slabSpace)
+		{
+			void** oldSlabs = cache->slabs;
+			cache->slabSpace += chunkArrayIncrement;
+			cache->slabs = (void**)malloc(cache->slabSpace * sizeof(void*));
+			if (cache->slabCount > 0)
+			{
+				memcpy(cache->slabs, oldSlabs, cache->slabCount * sizeof(void*));
+			}
+			free(oldSlabs);
+		}
+
+		// One extra chunk leaves room to align the slab.
+		void* slab = malloc((chunksPerSlab + 1) * chunkSize);
+		cache->slabs[cache->slabCount++] = slab;
+
+		uintptr_t aligned = ((uintptr_t)slab + chunkSize - 1) & ~(uintptr_t)(chunkSize - 1);
+		cache->nextChunk = (s8*)aligned;
+		cache->chunksLeft = chunksPerSlab;
+	}
+
+	s8* chunk = cache->nextChunk;
+	cache->nextChunk += chunkSize;
+	--cache->chunksLeft;
+	++cache->chunkCount[index];
+
+#if defined(_DEBUG)
+	memset(chunk, 0xcd, chunkSize);
+#endif
+
+	ChunkHeader* header = (ChunkHeader*)chunk;
+	header->owner = cache;
+	header->index = index;
+
+	s8* blocks = chunk + chunkHeaderSize;
+	s32 blockCount = (chunkSize - chunkHeaderSize) / blockSize;
+	for (s32 i = 0; i < blockCount - 1; ++i)
+	{
+		Block* block = (Block*)(blocks + blockSize * i);
+		block->next = (Block*)(blocks + blockSize * (i + 1));
+	}
+	Block* last = (Block*)(blocks + blockSize * (blockCount - 1));
+	last->next = NULL;
+
+	return (Block*)blocks;
+}
+
 
 s32 BlockAllocator::s_blockSizes[blockSizes] =
 {
@@ -28,6 +161,30 @@ s32 BlockAllocator::s_blockSizes[blockSizes] =
 u8 BlockAllocator::s_blockSizeLookup[maxBlockSize + 1];
 bool BlockAllocator::s_blockSizeLookupInitialized;
 
+static std::once_flag s_blockSizeLookupOnce;
+
+// Allocators may be created on several threads at once, for example by
+// worlds in a WorldGroup, so this runs under std::call_once.
+void BlockAllocator::InitializeBlockSizeLookup()
+{
+	s32 j = 0;
+	for (s32 i = 1; i <= maxBlockSize; ++i)
+	{
+		assert(j < blockSizes);
+		if (i <= s_blockSizes[j])
+		{
+			s_blockSizeLookup[i] = (u8)j;
+		}
+		else
+		{
+			++j;
+			s_blockSizeLookup[i] = (u8)j;
+		}
+	}
+
+	s_blockSizeLookupInitialized = true;
+}
+
 BlockAllocator::BlockAllocator()
 {
 	assert(blockSizes < UCHAR_MAX);
@@ -38,36 +195,155 @@ BlockAllocator::BlockAllocator()
 
 	memset(m_chunks, 0, m_chunkSpace * sizeof(Chunk));
 	memset(m_freeLists, 0, sizeof(m_freeLists));
+	memset(m_liveBlocks, 0, sizeof(m_liveBlocks));
+	memset(m_highWater, 0, sizeof(m_highWater));
+
+	m_threadCaching = false;
+	m_id = s_nextAllocatorId.fetch_add(1, std::memory_order_relaxed);
+	m_caches.store(NULL, std::memory_order_relaxed);
+
+	std::call_once(s_blockSizeLookupOnce, InitializeBlockSizeLookup);
+}
+
+BlockAllocator::~BlockAllocator()
+{
+	for (s32 i = 0; i < m_chunkCount; ++i)
+	{
+		free(m_chunks[i].blocks);
+	}
+
+	free(m_chunks);
+
+	ThreadCache* cache = m_caches.load(std::memory_order_acquire);
+	while (cache)
+	{
+		ThreadCache* next = cache->next;
+		ResetThreadCache(cache);
+		free(cache->slabs);
+		cache->~ThreadCache();
+		free(cache);
+		cache = next;
+	}
+}
 
-	if (s_blockSizeLookupInitialized == false)
+void BlockAllocator::SetThreadCaching(bool flag)
+{
+	assert(m_chunkCount == 0 && m_caches.load(std::memory_order_relaxed) == NULL);
+	m_threadCaching = flag;
+}
+
+ThreadCache* BlockAllocator::GetThreadCache()
+{
+	if (s_threadCacheSlot.allocatorId == m_id)
+	{
+		return s_threadCacheSlot.cache;
+	}
+
+	std::thread::id self = std::this_thread::get_id();
+	ThreadCache* cache = m_caches.load(std::memory_order_acquire);
+	while (cache && cache->thread != self)
+	{
+		cache = cache->next;
+	}
+
+	if (cache == NULL)
 	{
-		s32 j = 0;
-		for (s32 i = 1; i <= maxBlockSize; ++i)
+		// Only this thread creates its cache, so a push is enough.
+		void* mem = malloc(sizeof(ThreadCache));
+		cache = new (mem) ThreadCache;
+		cache->thread = self;
+		cache->slabs = NULL;
+		cache->slabCount = 0;
+		cache->slabSpace = 0;
+		ResetThreadCache(cache);
+
+		cache->next = m_caches.load(std::memory_order_relaxed);
+		while (m_caches.compare_exchange_weak(cache->next, cache, std::memory_order_release, std::memory_order_relaxed) == false)
 		{
-			assert(j < blockSizes);
-			if (i <= s_blockSizes[j])
-			{
-				s_blockSizeLookup[i] = (u8)j;
-			}
-			else
+		}
+	}
+
+	s_threadCacheSlot.allocatorId = m_id;
+	s_threadCacheSlot.cache = cache;
+	return cache;
+}
+
+void* BlockAllocator::AllocateCached(s32 size)
+{
+	s32 index = s_blockSizeLookup[size];
+	assert(0 <= index && index < blockSizes);
+
+	ThreadCache* cache = GetThreadCache();
+	Block* block = cache->freeLists[index];
+	if (block == NULL)
+	{
+		// Take back the blocks other threads freed before carving a new chunk.
+		block = cache->remoteFrees[index].exchange(NULL, std::memory_order_acquire);
+		if (block == NULL)
+		{
+			block = AllocateCachedChunk(cache, index, s_blockSizes[index]);
+		}
+		else
+		{
+			// The taken blocks are free again. Drop them from both counters so
+			// a steady cross-thread handoff does not grow them without bound.
+			s32 count = 0;
+			for (Block* b = block; b; b = b->next)
 			{
-				++j;
-				s_blockSizeLookup[i] = (u8)j;
+				++count;
 			}
+			cache->liveBlocks[index] -= count;
+			cache->remoteFreeCount[index].fetch_sub(count, std::memory_order_relaxed);
 		}
+	}
+	cache->freeLists[index] = block->next;
 
-		s_blockSizeLookupInitialized = true;
+	++cache->liveBlocks[index];
+	s32 live = cache->liveBlocks[index] - cache->remoteFreeCount[index].load(std::memory_order_relaxed);
+	if (live > cache->highWater[index])
+	{
+		cache->highWater[index] = live;
 	}
+
+	return block;
 }
 
-BlockAllocator::~BlockAllocator()
+void BlockAllocator::FreeCached(void* p, s32 size)
 {
-	for (s32 i = 0; i < m_chunkCount; ++i)
+	s32 index = s_blockSizeLookup[size];
+	assert(0 <= index && index < blockSizes);
+
+	ChunkHeader* header = (ChunkHeader*)((uintptr_t)p & ~(uintptr_t)(chunkSize - 1));
+	assert(header->index == index);
+	ThreadCache* owner = header->owner;
+
+#ifdef _DEBUG
+	memset(p, 0xfd, s_blockSizes[index]);
+#endif
+
+	Block* block = (Block*)p;
+	bool local = s_threadCacheSlot.allocatorId == m_id ? s_threadCacheSlot.cache == owner : owner->thread == std::this_thread::get_id();
+	if (local)
 	{
-		free(m_chunks[i].blocks);
+		--owner->liveBlocks[index];
+		block->next = owner->freeLists[index];
+		owner->freeLists[index] = block;
+		return;
 	}
 
-	free(m_chunks);
+	owner->remoteFreeCount[index].fetch_add(1, std::memory_order_relaxed);
+	block->next = owner->remoteFrees[index].load(std::memory_order_relaxed);
+	while (owner->remoteFrees[index].compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed) == false)
+	{
+	}
+}
+
+void BlockAllocator::ClearCached()
+{
+	for (ThreadCache* cache = m_caches.load(std::memory_order_acquire); cache; cache = cache->next)
+	{
+		ResetThreadCache(cache);
+	}
 }
 
 void* BlockAllocator::Allocate(s32 size)
@@ -82,9 +358,20 @@ void* BlockAllocator::Allocate(s32 size)
 		return malloc(size);
 	}
 
+	if (m_threadCaching)
+	{
+		return AllocateCached(size);
+	}
+
 	s32 index = s_blockSizeLookup[size];
 	assert(0 <= index && index < blockSizes);
 
+	++m_liveBlocks[index];
+	if (m_liveBlocks[index] > m_highWater[index])
+	{
+		m_highWater[index] = m_liveBlocks[index];
+	}
+
 	if (m_freeLists[index])
 	{
 		Block* block = m_freeLists[index];
@@ -143,9 +430,17 @@ void BlockAllocator::Free(void* p, s32 size)
 		return;
 	}
 
+	if (m_threadCaching)
+	{
+		FreeCached(p, size);
+		return;
+	}
+
 	s32 index = s_blockSizeLookup[size];
 	assert(0 <= index && index < blockSizes);
 
+	--m_liveBlocks[index];
+
 #ifdef _DEBUG
 	// Verify the memory address and size is valid.
 	s32 blockSize = s_blockSizes[index];
@@ -188,4 +483,36 @@ void BlockAllocator::Clear()
 	memset(m_chunks, 0, m_chunkSpace * sizeof(Chunk));
 
 	memset(m_freeLists, 0, sizeof(m_freeLists));
+	memset(m_liveBlocks, 0, sizeof(m_liveBlocks));
+	memset(m_highWater, 0, sizeof(m_highWater));
+
+	ClearCached();
+}
+
+void BlockAllocator::GetStats(BlockAllocatorStats* stats) const
+{
+	for (s32 i = 0; i < blockSizes; ++i)
+	{
+		stats[i].blockSize = s_blockSizes[i];
+		stats[i].chunkCount = 0;
+		stats[i].liveBytes = m_liveBlocks[i] * s_blockSizes[i];
+		stats[i].highWaterBytes = m_highWater[i] * s_blockSizes[i];
+	}
+
+	for (s32 i = 0; i < m_chunkCount; ++i)
+	{
+		s32 index = s_blockSizeLookup[m_chunks[i].blockSize];
+		++stats[index].chunkCount;
+	}
+
+	for (const ThreadCache* cache = m_caches.load(std::memory_order_acquire); cache; cache = cache->next)
+	{
+		for (s32 i = 0; i < blockSizes; ++i)
+		{
+			stats[i].chunkCount += cache->chunkCount[i];
+			s32 live = cache->liveBlocks[i] - cache->remoteFreeCount[i].load(std::memory_order_relaxed);
+			stats[i].liveBytes += live * s_blockSizes[i];
+			stats[i].highWaterBytes += cache->highWater[i] * s_blockSizes[i];
+		}
+	}
 }
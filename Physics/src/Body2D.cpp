@@ -60,6 +60,8 @@ Body::Body(const BodyDef* bd, World* world)
 	m_contactList = NULL;
 	m_prev = NULL;
 	m_next = NULL;
+	m_awakeIndex = -1;
+	m_toiStamp = 0;
 
 	m_linearVelocity = bd->linearVelocity;
 	m_angularVelocity = bd->angularVelocity;
@@ -127,6 +129,7 @@ void Body::SetType(BodyType type)
 	}
 
 	SetAwake(true);
+	m_world->UpdateAwakeSet(this);
 
 	m_force = glm::vec2(0,0);
 	m_torque = 0.0f;
@@ -137,12 +140,13 @@ void Body::SetType(BodyType type)
 	{
 		ContactEdge* ce0 = ce;
 		ce = ce->next;
-		m_world->m_contactManager.Destroy(ce0->contact);
+		m_world->m_contactManager.Destroy(ce0->contact, false);
 	}
 	m_contactList = NULL;
+	m_world->m_contactManager.DestroyOverlaps(this, false);
 
 	// Touch the proxies so that new contacts will be created (when appropriate)
-	BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+	IBroadPhase* broadPhase = m_world->m_contactManager.m_broadPhase;
 	for (Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
 		s32 proxyCount = f->m_proxyCount;
@@ -167,9 +171,16 @@ Fixture* Body::CreateFixture(const FixtureDef* def)
 	Fixture* fixture = new (memory) Fixture;
 	fixture->Create(allocator, this, def);
 
-	if (m_flags & activeFlag)
+	// During a bulk load the world creates the proxies and updates the mass
+	// of all new fixtures at once.
+	bool bulkLoad = m_world->IsBulkLoading();
+	if (bulkLoad)
+	{
+		m_flags |= bulkLoadFlag;
+	}
+	else if (m_flags & activeFlag)
 	{
-		BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+		IBroadPhase* broadPhase = m_world->m_contactManager.m_broadPhase;
 		fixture->CreateProxies(broadPhase, m_xf);
 	}
 
@@ -180,7 +191,7 @@ Fixture* Body::CreateFixture(const FixtureDef* def)
 	fixture->m_body = this;
 
 	// Adjust mass properties if needed.
-	if (fixture->m_density > 0.0f)
+	if (fixture->m_density > 0.0f && bulkLoad == false)
 	{
 		ResetMassData();
 	}
@@ -244,15 +255,16 @@ void Body::DestroyFixture(Fixture* fixture)
 		{
 			// This destroys the contact and removes it from
 			// this body's contact list.
-			m_world->m_contactManager.Destroy(c);
+			m_world->m_contactManager.Destroy(c, true);
 		}
 	}
+	m_world->m_contactManager.DestroyOverlaps(fixture, true);
 
 	BlockAllocator* allocator = &m_world->m_blockAllocator;
 
 	if (m_flags & activeFlag)
 	{
-		BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+		IBroadPhase* broadPhase = m_world->m_contactManager.m_broadPhase;
 		fixture->DestroyProxies(broadPhase);
 	}
 
@@ -421,7 +433,7 @@ void Body::SetTransform2D(const glm::vec2& position, real32 angle)
 	m_sweep.c0 = m_sweep.c;
 	m_sweep.a0 = angle;
 
-	BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+	IBroadPhase* broadPhase = m_world->m_contactManager.m_broadPhase;
 	for (Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
 		f->Synchronize(broadPhase, m_xf, m_xf);
@@ -434,7 +446,7 @@ void Body::SynchronizeFixtures()
 	xf1.q.Set(m_sweep.a0);
 	xf1.p = m_sweep.c0 - Rotation2D::Mul(xf1.q, m_sweep.localCenter);
 
-	BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+	IBroadPhase* broadPhase = m_world->m_contactManager.m_broadPhase;
 	for (Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
 		f->Synchronize(broadPhase, xf1, m_xf);
@@ -455,7 +467,7 @@ void Body::SetActive(bool flag)
 		m_flags |= activeFlag;
 
 		// Create all proxies.
-		BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+		IBroadPhase* broadPhase = m_world->m_contactManager.m_broadPhase;
 		for (Fixture* f = m_fixtureList; f; f = f->m_next)
 		{
 			f->CreateProxies(broadPhase, m_xf);
@@ -468,7 +480,7 @@ void Body::SetActive(bool flag)
 		m_flags &= ~activeFlag;
 
 		// Destroy all proxies.
-		BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+		IBroadPhase* broadPhase = m_world->m_contactManager.m_broadPhase;
 		for (Fixture* f = m_fixtureList; f; f = f->m_next)
 		{
 			f->DestroyProxies(broadPhase);
@@ -480,9 +492,10 @@ void Body::SetActive(bool flag)
 		{
 			ContactEdge* ce0 = ce;
 			ce = ce->next;
-			m_world->m_contactManager.Destroy(ce0->contact);
+			m_world->m_contactManager.Destroy(ce0->contact, false);
 		}
 		m_contactList = NULL;
+		m_world->m_contactManager.DestroyOverlaps(this, false);
 	}
 }
 
@@ -539,37 +552,37 @@ void Body::Dump()
 }
 
 
-inline BodyType Body::GetType() const
+BodyType Body::GetType() const
 {
 	return m_type;
 }
 
-inline const Transform2D& Body::GetTransform2D() const
+const Transform2D& Body::GetTransform2D() const
 {
 	return m_xf;
 }
 
-inline const glm::vec2& Body::GetPosition() const
+const glm::vec2& Body::GetPosition() const
 {
 	return m_xf.p;
 }
 
-inline real32 Body::GetAngle() const
+real32 Body::GetAngle() const
 {
 	return m_sweep.a;
 }
 
-inline const glm::vec2& Body::GetWorldCenter() const
+const glm::vec2& Body::GetWorldCenter() const
 {
 	return m_sweep.c;
 }
 
-inline const glm::vec2& Body::GetLocalCenter() const
+const glm::vec2& Body::GetLocalCenter() const
 {
 	return m_sweep.localCenter;
 }
 
-inline void Body::SetLinearVelocity(const glm::vec2& v)
+void Body::SetLinearVelocity(const glm::vec2& v)
 {
 	if (m_type == staticBody)
 	{
@@ -584,12 +597,12 @@ inline void Body::SetLinearVelocity(const glm::vec2& v)
 	m_linearVelocity = v;
 }
 
-inline const glm::vec2& Body::GetLinearVelocity() const
+const glm::vec2& Body::GetLinearVelocity() const
 {
 	return m_linearVelocity;
 }
 
-inline void Body::SetAngularVelocity(real32 w)
+void Body::SetAngularVelocity(real32 w)
 {
 	if (m_type == staticBody)
 	{
@@ -604,89 +617,89 @@ inline void Body::SetAngularVelocity(real32 w)
 	m_angularVelocity = w;
 }
 
-inline real32 Body::GetAngularVelocity() const
+real32 Body::GetAngularVelocity() const
 {
 	return m_angularVelocity;
 }
 
-inline real32 Body::GetMass() const
+real32 Body::GetMass() const
 {
 	return m_mass;
 }
 
-inline real32 Body::GetInertia() const
+real32 Body::GetInertia() const
 {
 	return m_I + m_mass * glm::dot(m_sweep.localCenter, m_sweep.localCenter);
 }
 
-inline void Body::GetMassData(MassData* data) const
+void Body::GetMassData(MassData* data) const
 {
 	data->mass = m_mass;
 	data->I = m_I + m_mass * glm::dot(m_sweep.localCenter, m_sweep.localCenter);
 	data->center = m_sweep.localCenter;
 }
 
-inline glm::vec2 Body::GetWorldPoint(const glm::vec2& localPoint) const
+glm::vec2 Body::GetWorldPoint(const glm::vec2& localPoint) const
 {
 	return Transform2D::Mul(m_xf, localPoint);
 }
 
-inline glm::vec2 Body::GetWorldVector(const glm::vec2& localVector) const
+glm::vec2 Body::GetWorldVector(const glm::vec2& localVector) const
 {
 	return Rotation2D::Mul(m_xf.q, localVector);
 }
 
-inline glm::vec2 Body::GetLocalPoint(const glm::vec2& worldPoint) const
+glm::vec2 Body::GetLocalPoint(const glm::vec2& worldPoint) const
 {
 	return Transform2D::MulT(m_xf, worldPoint);
 }
 
-inline glm::vec2 Body::GetLocalVector(const glm::vec2& worldVector) const
+glm::vec2 Body::GetLocalVector(const glm::vec2& worldVector) const
 {
 	return Rotation2D::MulT(m_xf.q, worldVector);
 }
 
-inline glm::vec2 Body::GetLinearVelocityFromWorldPoint(const glm::vec2& worldPoint) const
+glm::vec2 Body::GetLinearVelocityFromWorldPoint(const glm::vec2& worldPoint) const
 {
 	return m_linearVelocity + MathUtils::Cross2(m_angularVelocity, worldPoint - m_sweep.c);
 }
 
-inline glm::vec2 Body::GetLinearVelocityFromLocalPoint(const glm::vec2& localPoint) const
+glm::vec2 Body::GetLinearVelocityFromLocalPoint(const glm::vec2& localPoint) const
 {
 	return GetLinearVelocityFromWorldPoint(GetWorldPoint(localPoint));
 }
 
-inline real32 Body::GetLinearDamping() const
+real32 Body::GetLinearDamping() const
 {
 	return m_linearDamping;
 }
 
-inline void Body::SetLinearDamping(real32 linearDamping)
+void Body::SetLinearDamping(real32 linearDamping)
 {
 	m_linearDamping = linearDamping;
 }
 
-inline real32 Body::GetAngularDamping() const
+real32 Body::GetAngularDamping() const
 {
 	return m_angularDamping;
 }
 
-inline void Body::SetAngularDamping(real32 angularDamping)
+void Body::SetAngularDamping(real32 angularDamping)
 {
 	m_angularDamping = angularDamping;
 }
 
-inline real32 Body::GetGravityScale() const
+real32 Body::GetGravityScale() const
 {
 	return m_gravityScale;
 }
 
-inline void Body::SetGravityScale(real32 scale)
+void Body::SetGravityScale(real32 scale)
 {
 	m_gravityScale = scale;
 }
 
-inline void Body::SetBullet(bool flag)
+void Body::SetBullet(bool flag)
 {
 	if (flag)
 	{
@@ -698,12 +711,12 @@ inline void Body::SetBullet(bool flag)
 	}
 }
 
-inline bool Body::IsBullet() const
+bool Body::IsBullet() const
 {
 	return (m_flags & bulletFlag) == bulletFlag;
 }
 
-inline void Body::SetAwake(bool flag)
+void Body::SetAwake(bool flag)
 {
 	if (flag)
 	{
@@ -711,6 +724,7 @@ inline void Body::SetAwake(bool flag)
 		{
 			m_flags |= awakeFlag;
 			m_sleepTime = 0.0f;
+			m_world->UpdateAwakeSet(this);
 		}
 	}
 	else
@@ -721,25 +735,26 @@ inline void Body::SetAwake(bool flag)
 		m_angularVelocity = 0.0f;
 		m_force = glm::vec2(0.0f,0.0f);
 		m_torque = 0.0f;
+		m_world->UpdateAwakeSet(this);
 	}
 }
 
-inline bool Body::IsAwake() const
+bool Body::IsAwake() const
 {
 	return (m_flags & awakeFlag) == awakeFlag;
 }
 
-inline bool Body::IsActive() const
+bool Body::IsActive() const
 {
 	return (m_flags & activeFlag) == activeFlag;
 }
 
-inline bool Body::IsFixedRotation() const
+bool Body::IsFixedRotation() const
 {
 	return (m_flags & fixedRotationFlag) == fixedRotationFlag;
 }
 
-inline void Body::SetSleepingAllowed(bool flag)
+void Body::SetSleepingAllowed(bool flag)
 {
 	if (flag)
 	{
@@ -752,62 +767,62 @@ inline void Body::SetSleepingAllowed(bool flag)
 	}
 }
 
-inline bool Body::IsSleepingAllowed() const
+bool Body::IsSleepingAllowed() const
 {
 	return (m_flags & autoSleepFlag) == autoSleepFlag;
 }
 
-inline Fixture* Body::GetFixtureList()
+Fixture* Body::GetFixtureList()
 {
 	return m_fixtureList;
 }
 
-inline const Fixture* Body::GetFixtureList() const
+const Fixture* Body::GetFixtureList() const
 {
 	return m_fixtureList;
 }
 
-inline JointEdge* Body::GetJointList()
+JointEdge* Body::GetJointList()
 {
 	return m_jointList;
 }
 
-inline const JointEdge* Body::GetJointList() const
+const JointEdge* Body::GetJointList() const
 {
 	return m_jointList;
 }
 
-inline ContactEdge* Body::GetContactList()
+ContactEdge* Body::GetContactList()
 {
 	return m_contactList;
 }
 
-inline const ContactEdge* Body::GetContactList() const
+const ContactEdge* Body::GetContactList() const
 {
 	return m_contactList;
 }
 
-inline Body* Body::GetNext()
+Body* Body::GetNext()
 {
 	return m_next;
 }
 
-inline const Body* Body::GetNext() const
+const Body* Body::GetNext() const
 {
 	return m_next;
 }
 
-inline void Body::SetUserData(void* data)
+void Body::SetUserData(void* data)
 {
 	m_userData = data;
 }
 
-inline void* Body::GetUserData() const
+void* Body::GetUserData() const
 {
 	return m_userData;
 }
 
-inline void Body::ApplyForce(const glm::vec2& force, const glm::vec2& point, bool wake)
+void Body::ApplyForce(const glm::vec2& force, const glm::vec2& point, bool wake)
 {
 	if (m_type != dynamicBody)
 	{
@@ -827,7 +842,7 @@ inline void Body::ApplyForce(const glm::vec2& force, const glm::vec2& point, boo
 	}
 }
 
-inline void Body::ApplyForceToCenter(const glm::vec2& force, bool wake)
+void Body::ApplyForceToCenter(const glm::vec2& force, bool wake)
 {
 	if (m_type != dynamicBody)
 	{
@@ -846,7 +861,7 @@ inline void Body::ApplyForceToCenter(const glm::vec2& force, bool wake)
 	}
 }
 
-inline void Body::ApplyTorque(real32 torque, bool wake)
+void Body::ApplyTorque(real32 torque, bool wake)
 {
 	if (m_type != dynamicBody)
 	{
@@ -865,7 +880,7 @@ inline void Body::ApplyTorque(real32 torque, bool wake)
 	}
 }
 
-inline void Body::ApplyLinearImpulse(const glm::vec2& impulse, const glm::vec2& point, bool wake)
+void Body::ApplyLinearImpulse(const glm::vec2& impulse, const glm::vec2& point, bool wake)
 {
 	if (m_type != dynamicBody)
 	{
@@ -885,7 +900,7 @@ inline void Body::ApplyLinearImpulse(const glm::vec2& impulse, const glm::vec2&
 	}
 }
 
-inline void Body::ApplyAngularImpulse(real32 impulse, bool wake)
+void Body::ApplyAngularImpulse(real32 impulse, bool wake)
 {
 	if (m_type != dynamicBody)
 	{
@@ -904,13 +919,13 @@ inline void Body::ApplyAngularImpulse(real32 impulse, bool wake)
 	}
 }
 
-inline void Body::SynchronizeTransform2D()
+void Body::SynchronizeTransform2D()
 {
 	m_xf.q.Set(m_sweep.a);
 	m_xf.p = m_sweep.c - Rotation2D::Mul(m_xf.q, m_sweep.localCenter);
 }
 
-inline void Body::Advance(real32 alpha)
+void Body::Advance(real32 alpha)
 {
 	// Advance to the new safe time. This doesn't sync the broad-phase.
 	m_sweep.Advance(alpha);
@@ -920,12 +935,17 @@ inline void Body::Advance(real32 alpha)
 	m_xf.p = m_sweep.c - Rotation2D::Mul(m_xf.q, m_sweep.localCenter);
 }
 
-inline World* Body::GetWorld()
+BodyHandle Body::GetHandle() const
+{
+	return m_world->m_bodies.GetHandle(m_slotIndex);
+}
+
+World* Body::GetWorld()
 {
 	return m_world;
 }
 
-inline const World* Body::GetWorld() const
+const World* Body::GetWorld() const
 {
 	return m_world;
 }
\ No newline at end of file
@@ -5,12 +5,13 @@
 #include "World2D.hpp"
 #include "Contact2D.hpp"
 #include "ContactSolver.hpp"
+#include "JointSolver.hpp"
+#include "ContactEvents.hpp"
 #include "Joint2D.hpp"
 #include "StackAllocator.hpp"
-#include "TimeManager.hpp"
+#include "Timer.hpp"
 #include <Profile.hpp>
 #include <PTimeStep.hpp>
-#include <Services.hpp>
 #include "PhysicsGlobals.hpp"
 
 using namespace Break;
@@ -137,7 +138,7 @@ This might be faster than computing sin+cos.
 However, we can compute sin+cos of the same angle fast.
 */
 
-Island::Island(s32 bodyCapacity,s32 contactCapacity,s32 jointCapacity,StackAllocator* allocator,ContactListener* listener)
+Island::Island(s32 bodyCapacity,s32 contactCapacity,s32 jointCapacity,StackAllocator* allocator,ContactListener* listener,ContactEvents* events)
 {
 	m_bodyCapacity = bodyCapacity;
 	m_contactCapacity = contactCapacity;
@@ -148,6 +149,7 @@ Island::Island(s32 bodyCapacity,s32 contactCapacity,s32 jointCapacity,StackAlloc
 
 	m_allocator = allocator;
 	m_listener = listener;
+	m_events = events;
 
 	m_bodies = (Body**)m_allocator->Allocate(bodyCapacity * sizeof(Body*));
 	m_contacts = (Contact**)m_allocator->Allocate(contactCapacity	 * sizeof(Contact*));
@@ -169,7 +171,7 @@ Island::~Island()
 
 void Island::Solve(Profile* profile, const PTimeStep& step, const glm::vec2& gravity, bool allowSleep)
 {
-	Time timer;
+	Timer timer;
 
 	real32 h = step.delta;
 
@@ -210,13 +212,7 @@ void Island::Solve(Profile* profile, const PTimeStep& step, const glm::vec2& gra
 		m_velocities[i].w = w;
 	}
 
-	auto captureTimer = Services::getPlatform()->getTime();
-
-	// Solver data
-	SolverData solverData;
-	solverData.step = step;
-	solverData.positions = m_positions;
-	solverData.velocities = m_velocities;
+	timer.Reset();
 
 	// Initialize velocity constraints.
 	ContactSolverDef contactSolverDef;
@@ -235,28 +231,33 @@ void Island::Solve(Profile* profile, const PTimeStep& step, const glm::vec2& gra
 		contactSolver.WarmStart();
 	}
 
-	for (s32 i = 0; i < m_jointCount; ++i)
-	{
-		m_joints[i]->InitVelocityConstraints(solverData);
-	}
+	JointSolverDef jointSolverDef;
+	jointSolverDef.step = step;
+	jointSolverDef.joints = m_joints;
+	jointSolverDef.count = m_jointCount;
+	jointSolverDef.bodyCount = m_bodyCount;
+	jointSolverDef.positions = m_positions;
+	jointSolverDef.velocities = m_velocities;
+	jointSolverDef.allocator = m_allocator;
+
+	JointSolver jointSolver(&jointSolverDef);
+	jointSolver.InitializeVelocityConstraints();
 
-	profile->solveInit = Services::getPlatform()->getTime()-captureTimer;
+	profile->solveInit = timer.GetNanoseconds();
 
 	// Solve velocity constraints
-	captureTimer = Services::getPlatform()->getTime();
+	timer.Reset();
 	for (s32 i = 0; i < step.velocityIterations; ++i)
 	{
-		for (s32 j = 0; j < m_jointCount; ++j)
-		{
-			m_joints[j]->SolveVelocityConstraints(solverData);
-		}
+		jointSolver.SolveVelocityConstraints();
 
 		contactSolver.SolveVelocityConstraints();
 	}
 
 	// Store impulses for warm starting
 	contactSolver.StoreImpulses();
-	profile->solveVelocity = Services::getPlatform()->getTime()-captureTimer;
+	jointSolver.StoreImpulses();
+	profile->solveVelocity = timer.GetNanoseconds();
 
 	// Integrate positions
 	for (s32 i = 0; i < m_bodyCount; ++i)
@@ -270,7 +271,7 @@ void Island::Solve(Profile* profile, const PTimeStep& step, const glm::vec2& gra
 		glm::vec2 translation = h * v;
 		if (glm::dot(translation, translation) > maxTranslationSquared)
 		{
-			real32 ratio = maxTranslation / translation.length();
+			real32 ratio = maxTranslation / glm::length(translation);
 			v *= ratio;
 		}
 
@@ -292,18 +293,13 @@ void Island::Solve(Profile* profile, const PTimeStep& step, const glm::vec2& gra
 	}
 
 	// Solve position constraints
-	captureTimer = Services::getPlatform()->getTime();
+	timer.Reset();
 	bool positionSolved = false;
 	for (s32 i = 0; i < step.positionIterations; ++i)
 	{
 		bool contactsOkay = contactSolver.SolvePositionConstraints();
 
-		bool jointsOkay = true;
-		for (s32 i = 0; i < m_jointCount; ++i)
-		{
-			bool jointOkay = m_joints[i]->SolvePositionConstraints(solverData);
-			jointsOkay = jointsOkay && jointOkay;
-		}
+		bool jointsOkay = jointSolver.SolvePositionConstraints();
 
 		if (contactsOkay && jointsOkay)
 		{
@@ -324,7 +320,7 @@ void Island::Solve(Profile* profile, const PTimeStep& step, const glm::vec2& gra
 		body->SynchronizeTransform2D();
 	}
 
-	profile->solvePosition = Services::getPlatform()->getTime()-captureTimer;
+	profile->solvePosition = timer.GetNanoseconds();
 
 	Report(contactSolver.m_velocityConstraints);
 
@@ -468,7 +464,7 @@ void Island::SolveTOI(const PTimeStep& subStep, s32 toiIndexA, s32 toiIndexB)
 		glm::vec2 translation = h * v;
 		if (glm::dot(translation, translation) > maxTranslationSquared)
 		{
-			real32 ratio = maxTranslation / translation.length();
+			real32 ratio = maxTranslation / glm::length(translation);
 			v *= ratio;
 		}
 
@@ -502,6 +498,14 @@ void Island::SolveTOI(const PTimeStep& subStep, s32 toiIndexA, s32 toiIndexB)
 
 void Island::Report(const ContactVelocityConstraint* constraints)
 {
+	if (m_events)
+	{
+		for (s32 i = 0; i < m_contactCount; ++i)
+		{
+			m_events->AddImpulse(m_contacts[i], constraints + i);
+		}
+	}
+
 	if (m_listener == NULL)
 	{
 		return;
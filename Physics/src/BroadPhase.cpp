@@ -7,6 +7,7 @@ using namespace Break::Physics;
 
 BroadPhase::BroadPhase()
 {
+	m_type = treeBroadPhase;
 	m_proxyCount = 0;
 
 	m_pairCapacity = 16;
@@ -16,6 +17,9 @@ BroadPhase::BroadPhase()
 	m_moveCapacity = 16;
 	m_moveCount = 0;
 	m_moveBuffer = (s32*)malloc(m_moveCapacity * sizeof(s32));
+
+	m_wideTreeEnabled = true;
+	m_wideTreeRevision = m_tree.GetRevision() - 1;
 }
 
 BroadPhase::~BroadPhase()
@@ -32,6 +36,12 @@ s32 BroadPhase::CreateProxy(const AABB& aabb, void* userData)
 	return proxyId;
 }
 
+void BroadPhase::CreateProxies(const AABB* aabbs, void* const* userData, s32 count, s32* proxyIds)
+{
+	m_tree.CreateProxies(aabbs, userData, count, proxyIds);
+	m_proxyCount += count;
+}
+
 void BroadPhase::DestroyProxy(s32 proxyId)
 {
 	UnBufferMove(proxyId);
@@ -48,6 +58,11 @@ void BroadPhase::MoveProxy(s32 proxyId, const AABB& aabb, const glm::vec2& displ
 	}
 }
 
+void BroadPhase::SetFatAABB(s32 proxyId, const AABB& fatAABB)
+{
+	m_tree.SetFatAABB(proxyId, fatAABB);
+}
+
 void BroadPhase::TouchProxy(s32 proxyId)
 {
 	BufferMove(proxyId);
@@ -104,3 +119,37 @@ bool BroadPhase::QueryCallback(s32 proxyId)
 
 	return true;
 }
+
+void BroadPhase::SetWideTreeEnabled(bool flag)
+{
+	m_wideTreeEnabled = flag;
+	if (flag == false)
+	{
+		m_wideTree.Clear();
+		m_wideTreeRevision = m_tree.GetRevision() - 1;
+	}
+}
+
+void BroadPhase::UpdateWideTree()
+{
+	if (m_wideTreeEnabled && m_wideTreeRevision != m_tree.GetRevision())
+	{
+		m_wideTree.Build(&m_tree);
+		m_wideTreeRevision = m_tree.GetRevision();
+	}
+}
+
+void BroadPhase::UpdatePairs(BroadPhasePairCallback* callback)
+{
+	UpdatePairs<BroadPhasePairCallback>(callback);
+}
+
+void BroadPhase::Query(BroadPhaseQueryCallback* callback, const AABB& aabb) const
+{
+	Query<BroadPhaseQueryCallback>(callback, aabb);
+}
+
+void BroadPhase::RayCast(BroadPhaseRayCastCallback* callback, const RayCastInput& input) const
+{
+	RayCast<BroadPhaseRayCastCallback>(callback, input);
+}
@@ -0,0 +1,37 @@
+#include "CapsuleCircleContact.hpp"
+#include "BlockAllocator.hpp"
+#include "Fixture.hpp"
+#include "CapsuleShape.hpp"
+#include "CircleShape.hpp"
+#include <new>
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+
+Contact* CapsuleAndCircleContact::Create(Fixture* fixtureA, s32, Fixture* fixtureB, s32, BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(CapsuleAndCircleContact));
+	return new (mem) CapsuleAndCircleContact(fixtureA, fixtureB);
+}
+
+void CapsuleAndCircleContact::Destroy(Contact* contact, BlockAllocator* allocator)
+{
+	((CapsuleAndCircleContact*)contact)->~CapsuleAndCircleContact();
+	allocator->Free(contact, sizeof(CapsuleAndCircleContact));
+}
+
+CapsuleAndCircleContact::CapsuleAndCircleContact(Fixture* fixtureA, Fixture* fixtureB)
+	: Contact(fixtureA, 0, fixtureB, 0)
+{
+	assert(m_fixtureA->GetType() == Shape::capsule);
+	assert(m_fixtureB->GetType() == Shape::circle);
+}
+
+void CapsuleAndCircleContact::Evaluate(Manifold* manifold, const Transform2D& xfA, const Transform2D& xfB)
+{
+	CollideCapsuleAndCircle(manifold,
+		(CapsuleShape*)m_fixtureA->GetShape(), xfA,
+		(CircleShape*)m_fixtureB->GetShape(), xfB);
+}
@@ -0,0 +1,274 @@
+#include "Collision.hpp"
+#include "CapsuleShape.hpp"
+#include "CircleShape.hpp"
+#include "EdgeShape.hpp"
+#include "PolygonShape.hpp"
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+
+// Like CollideEdgeAndCircle without the adjacency: the end circles give a
+// point-point manifold and the sides give a face manifold.
+void Physics::CollideCapsuleAndCircle(Manifold* manifold, const CapsuleShape* capsuleA, const Transform2D& xfA, const CircleShape* circleB, const Transform2D& xfB)
+{
+	manifold->pointCount = 0;
+
+	// Compute circle in frame of the capsule
+	glm::vec2 Q = Transform2D::MulT(xfA, Transform2D::Mul(xfB, circleB->m_p));
+
+	glm::vec2 A = capsuleA->m_vertex1, B = capsuleA->m_vertex2;
+	glm::vec2 e = B - A;
+
+	// Barycentric coordinates
+	real32 u = glm::dot(e, B - Q);
+	real32 v = glm::dot(e, Q - A);
+
+	real32 radius = capsuleA->m_radius + circleB->m_radius;
+
+	ContactFeature cf;
+	cf.indexB = 0;
+	cf.typeB = ContactFeature::vertex;
+
+	// Region A or region B
+	if (v <= 0.0f || u <= 0.0f)
+	{
+		glm::vec2 P = v <= 0.0f ? A : B;
+		glm::vec2 d = Q - P;
+		if (glm::dot(d, d) > radius * radius)
+		{
+			return;
+		}
+
+		cf.indexA = v <= 0.0f ? 0 : 1;
+		cf.typeA = ContactFeature::vertex;
+		manifold->pointCount = 1;
+		manifold->type = Manifold::circles;
+		manifold->localNormal = glm::vec2(0.0f, 0.0f);
+		manifold->localPoint = P;
+		manifold->points[0].id.key = 0;
+		manifold->points[0].id.cf = cf;
+		manifold->points[0].localPoint = circleB->m_p;
+		return;
+	}
+
+	// Region AB
+	real32 den = glm::dot(e, e);
+	assert(den > 0.0f);
+	glm::vec2 P = (1.0f / den) * (u * A + v * B);
+	glm::vec2 d = Q - P;
+	if (glm::dot(d, d) > radius * radius)
+	{
+		return;
+	}
+
+	glm::vec2 n(-e.y, e.x);
+	if (glm::dot(n, Q - A) < 0.0f)
+	{
+		n = -n;
+	}
+	n = glm::normalize(n);
+
+	cf.indexA = 0;
+	cf.typeA = ContactFeature::face;
+	manifold->pointCount = 1;
+	manifold->type = Manifold::faceA;
+	manifold->localNormal = n;
+	manifold->localPoint = A;
+	manifold->points[0].id.key = 0;
+	manifold->points[0].id.cf = cf;
+	manifold->points[0].localPoint = circleB->m_p;
+}
+
+// Build a face manifold with segment a as the reference face. Segment b is
+// clipped to the extent of segment a and each end within radius of the
+// reference line becomes a point. Both segments are given in the frame of
+// capsule A and xf takes the frame of capsule B to it. With flip set the
+// reference segment belongs to capsule B.
+static void ClipCapsules(Manifold* manifold, const glm::vec2& a1, const glm::vec2& a2, const glm::vec2& b1, const glm::vec2& b2,
+						 const glm::vec2& normal, const Transform2D& xf, real32 radius, bool flip)
+{
+	glm::vec2 d1 = a2 - a1;
+	real32 dd1 = glm::dot(d1, d1);
+
+	// Clip the incident segment to the reference segment along d1.
+	real32 u1 = glm::dot(b1 - a1, d1) / dd1;
+	real32 u2 = glm::dot(b2 - a1, d1) / dd1;
+	glm::vec2 v1 = b1, v2 = b2;
+	if (u1 != u2)
+	{
+		real32 lower = glm::max(glm::min(u1, u2), 0.0f);
+		real32 upper = glm::min(glm::max(u1, u2), 1.0f);
+		real32 t1 = (lower - u1) / (u2 - u1);
+		real32 t2 = (upper - u1) / (u2 - u1);
+		v1 = b1 + t1 * (b2 - b1);
+		v2 = b1 + t2 * (b2 - b1);
+	}
+
+	if (flip)
+	{
+		manifold->type = Manifold::faceB;
+		manifold->localNormal = Rotation2D::MulT(xf.q, normal);
+		manifold->localPoint = Transform2D::MulT(xf, a1);
+	}
+	else
+	{
+		manifold->type = Manifold::faceA;
+		manifold->localNormal = normal;
+		manifold->localPoint = a1;
+	}
+
+	const glm::vec2* clipPoints[2] = { &v1, &v2 };
+	s32 pointCount = 0;
+	for (s32 i = 0; i < 2; ++i)
+	{
+		const glm::vec2& v = *clipPoints[i];
+		if (glm::dot(v - a1, normal) > radius)
+		{
+			continue;
+		}
+
+		if (i == 1 && pointCount == 1 && MathUtils::DistanceSquared(v1, v2) < linearSlop * linearSlop)
+		{
+			// The incident segment is clipped to a point.
+			break;
+		}
+
+		ManifoldPoint* mp = manifold->points + pointCount;
+		mp->localPoint = flip ? v : Transform2D::MulT(xf, v);
+		mp->id.cf.indexA = flip ? (u8)i : 0;
+		mp->id.cf.indexB = flip ? 0 : (u8)i;
+		mp->id.cf.typeA = flip ? ContactFeature::vertex : ContactFeature::face;
+		mp->id.cf.typeB = flip ? ContactFeature::face : ContactFeature::vertex;
+		++pointCount;
+	}
+
+	manifold->pointCount = pointCount;
+}
+
+// Find the closest points of the two segments. When the closest point on one
+// segment is inside it, the pair touches along that side, which is used as the
+// reference face so parallel capsules get two points. When both closest points
+// are segment ends the end circles touch and a point-point manifold is used.
+void Physics::CollideCapsules(Manifold* manifold, const CapsuleShape* capsuleA, const Transform2D& xfA, const CapsuleShape* capsuleB, const Transform2D& xfB)
+{
+	manifold->pointCount = 0;
+
+	// Work in the frame of capsule A.
+	Transform2D xf = Transform2D::MulT(xfA, xfB);
+	glm::vec2 a1 = capsuleA->m_vertex1, a2 = capsuleA->m_vertex2;
+	glm::vec2 b1 = Transform2D::Mul(xf, capsuleB->m_vertex1);
+	glm::vec2 b2 = Transform2D::Mul(xf, capsuleB->m_vertex2);
+
+	glm::vec2 d1 = a2 - a1;
+	glm::vec2 d2 = b2 - b1;
+	glm::vec2 r = a1 - b1;
+	real32 dd1 = glm::dot(d1, d1);
+	real32 dd2 = glm::dot(d2, d2);
+	real32 rd1 = glm::dot(r, d1);
+	real32 rd2 = glm::dot(r, d2);
+	real32 d12 = glm::dot(d1, d2);
+
+	// Closest points a1 + s * d1 and b1 + t * d2, see Real-Time Collision
+	// Detection by Christer Ericson, section 5.1.9.
+	real32 epsilon = FLT_EPSILON * FLT_EPSILON;
+	real32 s = 0.0f, t = 0.0f;
+	if (dd1 > epsilon && dd2 > epsilon)
+	{
+		real32 denominator = dd1 * dd2 - d12 * d12;
+		if (denominator > epsilon)
+		{
+			s = glm::clamp((d12 * rd2 - rd1 * dd2) / denominator, 0.0f, 1.0f);
+		}
+
+		t = (d12 * s + rd2) / dd2;
+		if (t < 0.0f)
+		{
+			t = 0.0f;
+			s = glm::clamp(-rd1 / dd1, 0.0f, 1.0f);
+		}
+		else if (t > 1.0f)
+		{
+			t = 1.0f;
+			s = glm::clamp((d12 - rd1) / dd1, 0.0f, 1.0f);
+		}
+	}
+	else if (dd1 > epsilon)
+	{
+		s = glm::clamp(-rd1 / dd1, 0.0f, 1.0f);
+	}
+	else if (dd2 > epsilon)
+	{
+		t = glm::clamp(rd2 / dd2, 0.0f, 1.0f);
+	}
+
+	glm::vec2 pA = a1 + s * d1;
+	glm::vec2 pB = b1 + t * d2;
+	glm::vec2 d = pB - pA;
+	real32 radius = capsuleA->m_radius + capsuleB->m_radius;
+	if (glm::dot(d, d) > radius * radius)
+	{
+		return;
+	}
+
+	bool insideA = 0.0f < s && s < 1.0f && dd1 > epsilon;
+	bool insideB = 0.0f < t && t < 1.0f && dd2 > epsilon;
+	if (insideA || insideB)
+	{
+		// Both are inside only for parallel or crossing segments, where either
+		// face will do.
+		bool faceA = insideA;
+
+		glm::vec2 e = faceA ? d1 : d2;
+		glm::vec2 normal = glm::normalize(glm::vec2(e.y, -e.x));
+
+		// Point the normal from the reference segment to the other one. Crossing
+		// segments use the center of the other segment instead.
+		glm::vec2 toOther = faceA ? d : -d;
+		if (glm::dot(toOther, toOther) < linearSlop * linearSlop)
+		{
+			toOther = faceA ? 0.5f * (b1 + b2) - pA : 0.5f * (a1 + a2) - pB;
+		}
+
+		if (glm::dot(normal, toOther) < 0.0f)
+		{
+			normal = -normal;
+		}
+
+		if (faceA)
+		{
+			ClipCapsules(manifold, a1, a2, b1, b2, normal, xf, radius, false);
+		}
+		else
+		{
+			ClipCapsules(manifold, b1, b2, a1, a2, normal, xf, radius, true);
+		}
+		return;
+	}
+
+	// The end circles touch.
+	manifold->type = Manifold::circles;
+	manifold->localPoint = pA;
+	manifold->localNormal = glm::vec2(0.0f, 0.0f);
+	manifold->pointCount = 1;
+	manifold->points[0].localPoint = t == 0.0f ? capsuleB->m_vertex1 : capsuleB->m_vertex2;
+	manifold->points[0].id.cf.indexA = s == 0.0f ? 0 : 1;
+	manifold->points[0].id.cf.indexB = t == 0.0f ? 0 : 1;
+	manifold->points[0].id.cf.typeA = ContactFeature::vertex;
+	manifold->points[0].id.cf.typeB = ContactFeature::vertex;
+}
+
+void Physics::CollidePolygonAndCapsule(Manifold* manifold, SeparationCache* cache, const PolygonShape* polygonA, const Transform2D& xfA, const CapsuleShape* capsuleB, const Transform2D& xfB)
+{
+	PolygonShape polygonB;
+	capsuleB->GetPolygon(&polygonB);
+	CollidePolygons(manifold, cache, polygonA, xfA, &polygonB, xfB);
+}
+
+void Physics::CollideEdgeAndCapsule(Manifold* manifold, const EdgeShape* edgeA, const Transform2D& xfA, const CapsuleShape* capsuleB, const Transform2D& xfB)
+{
+	PolygonShape polygonB;
+	capsuleB->GetPolygon(&polygonB);
+	CollideEdgeAndPolygon(manifold, edgeA, xfA, &polygonB, xfB);
+}
@@ -0,0 +1,36 @@
+#include "CapsuleContact.hpp"
+#include "BlockAllocator.hpp"
+#include "Fixture.hpp"
+#include "CapsuleShape.hpp"
+#include <new>
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+
+Contact* CapsuleContact::Create(Fixture* fixtureA, s32, Fixture* fixtureB, s32, BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(CapsuleContact));
+	return new (mem) CapsuleContact(fixtureA, fixtureB);
+}
+
+void CapsuleContact::Destroy(Contact* contact, BlockAllocator* allocator)
+{
+	((CapsuleContact*)contact)->~CapsuleContact();
+	allocator->Free(contact, sizeof(CapsuleContact));
+}
+
+CapsuleContact::CapsuleContact(Fixture* fixtureA, Fixture* fixtureB)
+	: Contact(fixtureA, 0, fixtureB, 0)
+{
+	assert(m_fixtureA->GetType() == Shape::capsule);
+	assert(m_fixtureB->GetType() == Shape::capsule);
+}
+
+void CapsuleContact::Evaluate(Manifold* manifold, const Transform2D& xfA, const Transform2D& xfB)
+{
+	CollideCapsules(manifold,
+		(CapsuleShape*)m_fixtureA->GetShape(), xfA,
+		(CapsuleShape*)m_fixtureB->GetShape(), xfB);
+}
@@ -0,0 +1,220 @@
+#include "CapsuleShape.hpp"
+#include "PolygonShape.hpp"
+#include <new>
+#include <glm/gtc/constants.hpp>
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+
+void CapsuleShape::Set(const glm::vec2& v1, const glm::vec2& v2, real32 radius)
+{
+	// Use a circle for a capsule without length.
+	assert(MathUtils::DistanceSquared(v1, v2) > linearSlop * linearSlop);
+
+	m_vertex1 = v1;
+	m_vertex2 = v2;
+	m_radius = radius;
+}
+
+void CapsuleShape::SetAsVertical(real32 halfHeight, real32 radius)
+{
+	Set(glm::vec2(0.0f, -halfHeight), glm::vec2(0.0f, halfHeight), radius);
+}
+
+Shape* CapsuleShape::Clone(BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(CapsuleShape));
+	CapsuleShape* clone = new (mem) CapsuleShape;
+	*clone = *this;
+	return clone;
+}
+
+s32 CapsuleShape::GetChildCount() const
+{
+	return 1;
+}
+
+// Get the point of segment v1-v2 closest to p.
+static glm::vec2 ClosestPointOnSegment(const glm::vec2& v1, const glm::vec2& v2, const glm::vec2& p)
+{
+	glm::vec2 e = v2 - v1;
+	real32 ee = glm::dot(e, e);
+	if (ee < FLT_EPSILON * FLT_EPSILON)
+	{
+		return v1;
+	}
+
+	real32 t = glm::clamp(glm::dot(p - v1, e) / ee, 0.0f, 1.0f);
+	return v1 + t * e;
+}
+
+bool CapsuleShape::TestPoint(const Transform2D& xf, const glm::vec2& p) const
+{
+	glm::vec2 localP = Transform2D::MulT(xf, p);
+	glm::vec2 d = localP - ClosestPointOnSegment(m_vertex1, m_vertex2, localP);
+	return glm::dot(d, d) <= m_radius * m_radius;
+}
+
+// The first hit is the closest hit on one of the two sides or on one of the
+// two end circles. Entering a side from its back or a circle from inside the
+// body cannot come first, so those are not tested.
+bool CapsuleShape::RayCast(RayCastOutput* output, const RayCastInput& input, const Transform2D& xf, s32 childIndex) const
+{
+	NOT_USED(childIndex);
+
+	// Put the ray into the capsule's frame of reference.
+	glm::vec2 p1 = Rotation2D::MulT(xf.q, input.p1 - xf.p);
+	glm::vec2 p2 = Rotation2D::MulT(xf.q, input.p2 - xf.p);
+	glm::vec2 d = p2 - p1;
+	real32 dd = glm::dot(d, d);
+	if (dd < FLT_EPSILON)
+	{
+		return false;
+	}
+
+	real32 rr = m_radius * m_radius;
+	glm::vec2 s = p1 - ClosestPointOnSegment(m_vertex1, m_vertex2, p1);
+	if (glm::dot(s, s) <= rr)
+	{
+		// The ray starts inside.
+		return false;
+	}
+
+	real32 fraction = input.maxFraction;
+	glm::vec2 normal(0.0f, 0.0f);
+	bool hit = false;
+
+	glm::vec2 e = m_vertex2 - m_vertex1;
+	real32 ee = glm::dot(e, e);
+	if (ee > FLT_EPSILON * FLT_EPSILON)
+	{
+		glm::vec2 side = glm::normalize(glm::vec2(e.y, -e.x));
+		for (s32 i = 0; i < 2; ++i)
+		{
+			// dot(side, p1 + t * d - v1) = radius
+			real32 denominator = glm::dot(side, d);
+			if (denominator < 0.0f)
+			{
+				real32 t = (m_radius - glm::dot(side, p1 - m_vertex1)) / denominator;
+				if (0.0f <= t && t <= fraction)
+				{
+					real32 u = glm::dot(p1 + t * d - m_vertex1, e);
+					if (0.0f <= u && u <= ee)
+					{
+						fraction = t;
+						normal = side;
+						hit = true;
+					}
+				}
+			}
+			side = -side;
+		}
+	}
+
+	// The end circles, as in CircleShape::RayCast.
+	const glm::vec2* centers[2] = { &m_vertex1, &m_vertex2 };
+	for (s32 i = 0; i < 2; ++i)
+	{
+		glm::vec2 c = p1 - *centers[i];
+		real32 b = glm::dot(c, c) - rr;
+		real32 cd = glm::dot(c, d);
+		real32 sigma = cd * cd - dd * b;
+		if (sigma < 0.0f)
+		{
+			continue;
+		}
+
+		real32 a = -(cd + sqrtf(sigma));
+		if (0.0f <= a && a <= fraction * dd)
+		{
+			fraction = a / dd;
+			normal = glm::normalize(c + fraction * d);
+			hit = true;
+		}
+	}
+
+	if (hit == false)
+	{
+		return false;
+	}
+
+	output->fraction = fraction;
+	output->normal = Rotation2D::Mul(xf.q, normal);
+	return true;
+}
+
+void CapsuleShape::ComputeDistance(const Transform2D& xf, const glm::vec2& p, real32* distance, glm::vec2* normal, s32 childIndex) const
+{
+	NOT_USED(childIndex);
+
+	glm::vec2 pLocal = Transform2D::MulT(xf, p);
+	glm::vec2 e = m_vertex2 - m_vertex1;
+	real32 t = glm::clamp(glm::dot(pLocal - m_vertex1, e) / glm::dot(e, e), 0.0f, 1.0f);
+	glm::vec2 d = pLocal - (m_vertex1 + t * e);
+
+	real32 length = glm::length(d);
+	*distance = length - m_radius;
+	if (length > FLT_EPSILON)
+	{
+		*normal = Rotation2D::Mul(xf.q, (1.0f / length) * d);
+	}
+	else
+	{
+		*normal = Rotation2D::Mul(xf.q, glm::normalize(glm::vec2(e.y, -e.x)));
+	}
+}
+
+void CapsuleShape::ComputeAABB(AABB* aabb, const Transform2D& xf, s32 childIndex) const
+{
+	NOT_USED(childIndex);
+
+	glm::vec2 v1 = Transform2D::Mul(xf, m_vertex1);
+	glm::vec2 v2 = Transform2D::Mul(xf, m_vertex2);
+
+	glm::vec2 r(m_radius, m_radius);
+	aabb->lowerBound = glm::min(v1, v2) - r;
+	aabb->upperBound = glm::max(v1, v2) + r;
+}
+
+// A box of the segment length and twice the radius, plus two half circles.
+// Each half circle is moved to its end of the box with the parallel axis
+// theorem, starting from its own centroid 4r / (3 pi) off the flat side.
+void CapsuleShape::ComputeMass(MassData* massData, real32 density) const
+{
+	real32 rr = m_radius * m_radius;
+	real32 length = glm::length(m_vertex2 - m_vertex1);
+	real32 pi = glm::pi<float>();
+
+	real32 boxMass = density * 2.0f * m_radius * length;
+	real32 circleMass = density * pi * rr;
+	massData->mass = boxMass + circleMass;
+	massData->center = 0.5f * (m_vertex1 + m_vertex2);
+
+	real32 lc = 4.0f * m_radius / (3.0f * pi);
+	real32 h = 0.5f * length;
+	real32 circleInertia = circleMass * (0.5f * rr + h * h + 2.0f * h * lc);
+	real32 boxInertia = boxMass * (4.0f * rr + length * length) / 12.0f;
+
+	// inertia about the local origin
+	massData->I = circleInertia + boxInertia + massData->mass * glm::dot(massData->center, massData->center);
+}
+
+void CapsuleShape::GetPolygon(PolygonShape* polygon) const
+{
+	glm::vec2 e = m_vertex2 - m_vertex1;
+	glm::vec2 normal(0.0f, 1.0f);
+	if (glm::dot(e, e) > FLT_EPSILON * FLT_EPSILON)
+	{
+		normal = glm::normalize(glm::vec2(e.y, -e.x));
+	}
+
+	polygon->m_count = 2;
+	polygon->m_vertices[0] = m_vertex1;
+	polygon->m_vertices[1] = m_vertex2;
+	polygon->m_normals[0] = normal;
+	polygon->m_normals[1] = -normal;
+	polygon->m_centroid = 0.5f * (m_vertex1 + m_vertex2);
+	polygon->m_radius = m_radius;
+}
@@ -0,0 +1,40 @@
+#include "ChainCapsuleContact.hpp"
+#include "BlockAllocator.hpp"
+#include "Fixture.hpp"
+#include "CapsuleShape.hpp"
+#include "ChainShape.hpp"
+#include "EdgeShape.hpp"
+#include <new>
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+
+Contact* ChainAndCapsuleContact::Create(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB, BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(ChainAndCapsuleContact));
+	return new (mem) ChainAndCapsuleContact(fixtureA, indexA, fixtureB, indexB);
+}
+
+void ChainAndCapsuleContact::Destroy(Contact* contact, BlockAllocator* allocator)
+{
+	((ChainAndCapsuleContact*)contact)->~ChainAndCapsuleContact();
+	allocator->Free(contact, sizeof(ChainAndCapsuleContact));
+}
+
+ChainAndCapsuleContact::ChainAndCapsuleContact(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB)
+	: Contact(fixtureA, indexA, fixtureB, indexB)
+{
+	assert(m_fixtureA->GetType() == Shape::chain);
+	assert(m_fixtureB->GetType() == Shape::capsule);
+}
+
+void ChainAndCapsuleContact::Evaluate(Manifold* manifold, const Transform2D& xfA, const Transform2D& xfB)
+{
+	ChainShape* chain = (ChainShape*)m_fixtureA->GetShape();
+	EdgeShape edge;
+	chain->GetChildEdge(&edge, m_indexA);
+	CollideEdgeAndCapsule(manifold, &edge, xfA,
+		(CapsuleShape*)m_fixtureB->GetShape(), xfB);
+}
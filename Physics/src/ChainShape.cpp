@@ -35,6 +35,8 @@ void ChainShape::CreateLoop(const glm::vec2* vertices, s32 count)
 	m_nextVertex = m_vertices[1];
 	m_hasPrevVertex = true;
 	m_hasNextVertex = true;
+
+	BuildTree();
 }
 
 void ChainShape::CreateChain(const glm::vec2* vertices, s32 count)
@@ -60,6 +62,24 @@ void ChainShape::CreateChain(const glm::vec2* vertices, s32 count)
 
 	m_prevVertex.x = 0; m_prevVertex.y = 0;
 	m_nextVertex.x = 0; m_nextVertex.y = 0;
+
+	BuildTree();
+}
+
+void ChainShape::BuildTree()
+{
+	Transform2D identity;
+	identity.SetIdentity();
+
+	s32 edgeCount = m_count - 1;
+	AABB* aabbs = (AABB*)malloc(edgeCount * sizeof(AABB));
+	for (s32 i = 0; i < edgeCount; ++i)
+	{
+		ComputeElementAABB(aabbs + i, identity, i);
+	}
+
+	m_tree.Build(aabbs, edgeCount);
+	free(aabbs);
 }
 
 void ChainShape::SetPrevVertex(const glm::vec2& prevVertex)
@@ -88,8 +108,7 @@ Shape* ChainShape::Clone(BlockAllocator* allocator) const
 
 s32 ChainShape::GetChildCount() const
 {
-	// edge count = vertex count - 1
-	return m_count - 1;
+	return 1;
 }
 
 void ChainShape::GetChildEdge(EdgeShape* edge, s32 index) const
@@ -131,41 +150,86 @@ bool ChainShape::TestPoint(const Transform2D& xf, const glm::vec2& p) const
 	return false;
 }
 
+namespace
+{
+	// Casts the ray against each edge the tree reports and keeps the closest hit.
+	// The ray is in chain coordinates.
+	struct ChainRayCastCallback
+	{
+		real32 RayCastCallback(const RayCastInput& input, s32 index)
+		{
+			EdgeShape edge;
+			edge.m_vertex1 = chain->m_vertices[index];
+			edge.m_vertex2 = chain->m_vertices[index + 1];
+
+			RayCastOutput output;
+			if (edge.RayCast(&output, input, identity, 0) == false)
+			{
+				return input.maxFraction;
+			}
+
+			this->hit = true;
+			this->output = output;
+			return output.fraction;
+		}
+
+		const ChainShape* chain;
+		Transform2D identity;
+		RayCastOutput output;
+		bool hit;
+	};
+}
+
 bool ChainShape::RayCast(RayCastOutput* output, const RayCastInput& input,const Transform2D& xf, s32 childIndex) const
 {
-	assert(childIndex < m_count);
+	NOT_USED(childIndex);
+
+	// Put the ray into the chain's frame of reference.
+	RayCastInput localInput;
+	localInput.p1 = Transform2D::MulT(xf, input.p1);
+	localInput.p2 = Transform2D::MulT(xf, input.p2);
+	localInput.maxFraction = input.maxFraction;
 
-	EdgeShape edgeShape;
+	ChainRayCastCallback callback;
+	callback.chain = this;
+	callback.identity.SetIdentity();
+	callback.hit = false;
+	m_tree.RayCast(&callback, localInput);
 
-	s32 i1 = childIndex;
-	s32 i2 = childIndex + 1;
-	if (i2 == m_count)
+	if (callback.hit == false)
 	{
-		i2 = 0;
+		return false;
 	}
 
-	edgeShape.m_vertex1 = m_vertices[i1];
-	edgeShape.m_vertex2 = m_vertices[i2];
+	output->fraction = callback.output.fraction;
+	output->normal = Rotation2D::Mul(xf.q, callback.output.normal);
+	return true;
+}
 
-	return edgeShape.RayCast(output, input, xf, 0);
+void ChainShape::ComputeDistance(const Transform2D& xf, const glm::vec2& p, real32* distance, glm::vec2* normal, s32 childIndex) const
+{
+	EdgeShape edge;
+	GetChildEdge(&edge, childIndex);
+	edge.ComputeDistance(xf, p, distance, normal, 0);
 }
 
 void ChainShape::ComputeAABB(AABB* aabb, const Transform2D& xf, s32 childIndex) const
 {
-	assert(childIndex < m_count);
+	NOT_USED(childIndex);
 
-	s32 i1 = childIndex;
-	s32 i2 = childIndex + 1;
-	if (i2 == m_count)
-	{
-		i2 = 0;
-	}
+	TransformAABB(aabb, m_tree.GetBounds(), xf);
+}
+
+void ChainShape::ComputeElementAABB(AABB* aabb, const Transform2D& xf, s32 index) const
+{
+	assert(0 <= index && index < m_count - 1);
 
-	glm::vec2 v1 = Transform2D::Mul(xf, m_vertices[i1]);
-	glm::vec2 v2 = Transform2D::Mul(xf, m_vertices[i2]);
+	glm::vec2 v1 = Transform2D::Mul(xf, m_vertices[index]);
+	glm::vec2 v2 = Transform2D::Mul(xf, m_vertices[index + 1]);
 
-	aabb->lowerBound = glm::min(v1, v2);
-	aabb->upperBound = glm::max(v1, v2);
+	glm::vec2 r(m_radius, m_radius);
+	aabb->lowerBound = glm::min(v1, v2) - r;
+	aabb->upperBound = glm::max(v1, v2) + r;
 }
 
 void ChainShape::ComputeMass(MassData* massData, real32 density) const
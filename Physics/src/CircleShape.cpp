@@ -67,6 +67,17 @@ bool CircleShape::RayCast(RayCastOutput* output, const RayCastInput& input,const
 	return false;
 }
 
+void CircleShape::ComputeDistance(const Transform2D& xf, const glm::vec2& p, real32* distance, glm::vec2* normal, s32 childIndex) const
+{
+	NOT_USED(childIndex);
+
+	glm::vec2 center = Transform2D::Mul(xf, m_p);
+	glm::vec2 d = p - center;
+	real32 length = glm::length(d);
+	*distance = length - m_radius;
+	*normal = length > FLT_EPSILON ? (1.0f / length) * d : glm::vec2(0.0f, 1.0f);
+}
+
 void CircleShape::ComputeAABB(AABB* aabb, const Transform2D& Transform2D, s32 childIndex) const
 {
 	NOT_USED(childIndex);
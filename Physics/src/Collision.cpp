@@ -1,5 +1,6 @@
 #include "Collision.hpp"
 #include "Distance.hpp"
+#include "CircleShape.hpp"
 
 using namespace Break;
 using namespace Break::Infrastructure;
@@ -219,9 +220,74 @@ s32 Physics::ClipSegmentToLine(ClipVertex vOut[2], const ClipVertex vIn[2], cons
 
 
 
+// Slab test of the moving box center against the other box grown by the moving
+// box extents. Unlike AABB::RayCast a start inside the box counts.
+bool Physics::TestSweptOverlap(const AABB& moving, const glm::vec2& translation, real32 maxFraction, const AABB& box)
+{
+	glm::vec2 extents = moving.GetExtents();
+	glm::vec2 lower = box.lowerBound - extents;
+	glm::vec2 upper = box.upperBound + extents;
+	glm::vec2 p = moving.GetCenter();
+
+	real32 tmin = 0.0f;
+	real32 tmax = maxFraction;
+	for (s32 i = 0; i < 2; ++i)
+	{
+		if (glm::abs(translation[i]) < FLT_EPSILON)
+		{
+			if (p[i] < lower[i] || upper[i] < p[i])
+			{
+				return false;
+			}
+		}
+		else
+		{
+			real32 inv_d = 1.0f / translation[i];
+			real32 t1 = (lower[i] - p[i]) * inv_d;
+			real32 t2 = (upper[i] - p[i]) * inv_d;
+			if (t1 > t2)
+			{
+				MathUtils::Swap(t1, t2);
+			}
+
+			tmin = glm::max(tmin, t1);
+			tmax = glm::min(tmax, t2);
+			if (tmin > tmax)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
 //testing overlaping by calculating distance between two polygons using GJK algorithm..
 bool Physics::TestOverlap(const Shape* shapeA, s32 indexA,const Shape* shapeB, s32 indexB,const Transform2D& xfA, const Transform2D& xfB)
 {
+	SimplexCache cache;
+	cache.count = 0;
+
+	return TestOverlap(&cache, shapeA, indexA, shapeB, indexB, xfA, xfB);
+}
+
+bool Physics::TestOverlap(SimplexCache* cache, const Shape* shapeA, s32 indexA, const Shape* shapeB, s32 indexB, const Transform2D& xfA, const Transform2D& xfB)
+{
+	// A circle overlaps a shape when its center is within its radius of the
+	// shape, which the shape measures without running GJK.
+	if (shapeA->GetType() == Shape::circle || shapeB->GetType() == Shape::circle)
+	{
+		bool circleA = shapeA->GetType() == Shape::circle;
+		const CircleShape* circle = (const CircleShape*)(circleA ? shapeA : shapeB);
+		const Shape* other = circleA ? shapeB : shapeA;
+		glm::vec2 center = Transform2D::Mul(circleA ? xfA : xfB, circle->m_p);
+
+		real32 distance;
+		glm::vec2 normal;
+		other->ComputeDistance(circleA ? xfB : xfA, center, &distance, &normal, circleA ? indexB : indexA);
+		return distance - circle->m_radius < 10.0f * FLT_EPSILON;
+	}
+
 	DistanceInput input;
 	input.proxyA.Set(shapeA, indexA);
 	input.proxyB.Set(shapeB, indexB);
@@ -229,12 +295,9 @@ bool Physics::TestOverlap(const Shape* shapeA, s32 indexA,const Shape* shapeB, s
 	input.Transform2DB = xfB;
 	input.useRadii = true;
 
-	SimplexCache cache;
-	cache.count = 0;
-
 	DistanceOutput output;
 
-	Distance(&output, &cache, &input);
+	Distance(&output, cache, &input);
 
 	return output.distance < 10.0f * FLT_EPSILON;
 }
\ No newline at end of file
@@ -0,0 +1,436 @@
+#include "CollisionWorld.hpp"
+#include "CircleShape.hpp"
+#include "EdgeShape.hpp"
+#include "PolygonShape.hpp"
+#include "ChainShape.hpp"
+#include "MeshShape.hpp"
+#include "CapsuleShape.hpp"
+#include "TimeOfImpact.hpp"
+#include <new>
+
+using namespace Break;
+using namespace Break::Physics;
+
+
+namespace
+{
+	// The same rules as ContactFilter::ShouldCollide.
+	bool ShouldCollide(const Filter& filterA, const Filter& filterB)
+	{
+		if (filterA.groupIndex == filterB.groupIndex && filterA.groupIndex != 0)
+		{
+			return filterA.groupIndex > 0;
+		}
+
+		return (filterA.maskBits & filterB.categoryBits) != 0 && (filterA.categoryBits & filterB.maskBits) != 0;
+	}
+
+	void FreeShape(BlockAllocator* allocator, Shape* shape)
+	{
+		switch (shape->m_type)
+		{
+		case Shape::circle:
+			{
+				CircleShape* s = (CircleShape*)shape;
+				s->~CircleShape();
+				allocator->Free(s, sizeof(CircleShape));
+			}
+			break;
+
+		case Shape::edge:
+			{
+				EdgeShape* s = (EdgeShape*)shape;
+				s->~EdgeShape();
+				allocator->Free(s, sizeof(EdgeShape));
+			}
+			break;
+
+		case Shape::polygon:
+			{
+				PolygonShape* s = (PolygonShape*)shape;
+				s->~PolygonShape();
+				allocator->Free(s, sizeof(PolygonShape));
+			}
+			break;
+
+		case Shape::chain:
+			{
+				ChainShape* s = (ChainShape*)shape;
+				s->~ChainShape();
+				allocator->Free(s, sizeof(ChainShape));
+			}
+			break;
+
+		case Shape::mesh:
+			{
+				MeshShape* s = (MeshShape*)shape;
+				s->~MeshShape();
+				allocator->Free(s, sizeof(MeshShape));
+			}
+			break;
+
+		case Shape::capsule:
+			{
+				CapsuleShape* s = (CapsuleShape*)shape;
+				s->~CapsuleShape();
+				allocator->Free(s, sizeof(CapsuleShape));
+			}
+			break;
+
+		default:
+			assert(false);
+			break;
+		}
+	}
+
+	struct QueryWrapper
+	{
+		bool QueryCallback(s32 proxyId)
+		{
+			CollisionProxy* proxy = (CollisionProxy*)tree->GetUserData(proxyId);
+			return callback->ReportObject(proxy->object, proxy->childIndex);
+		}
+
+		const DynamicTree* tree;
+		CollisionQueryCallback* callback;
+	};
+
+	struct RayCastWrapper
+	{
+		real32 RayCastCallback(const RayCastInput& input, s32 proxyId)
+		{
+			CollisionProxy* proxy = (CollisionProxy*)tree->GetUserData(proxyId);
+			CollisionObject* object = proxy->object;
+
+			RayCastOutput output;
+			bool hit = object->GetShape()->RayCast(&output, input, object->GetTransform(), proxy->childIndex);
+			if (hit)
+			{
+				real32 fraction = output.fraction;
+				glm::vec2 point = (1.0f - fraction) * input.p1 + fraction * input.p2;
+				return callback->ReportObject(object, point, output.normal, fraction);
+			}
+
+			return input.maxFraction;
+		}
+
+		const DynamicTree* tree;
+		CollisionCastCallback* callback;
+	};
+
+	// Casts the shape against one child, or against the mesh elements or chain
+	// edges under the swept box, and keeps the cast clipped to the callback results.
+	struct ShapeCastWrapper
+	{
+		bool QueryCallback(s32 proxyId)
+		{
+			CollisionProxy* proxy = (CollisionProxy*)tree->GetUserData(proxyId);
+			if (Physics::TestOverlap(proxy->aabb, sweptAABB) == false)
+			{
+				return true;
+			}
+
+			CollisionObject* object = proxy->object;
+			const StaticTree* elementTree = object->GetShape()->GetElementTree();
+			if (elementTree == NULL)
+			{
+				return Cast(object, proxy->childIndex, proxy->aabb);
+			}
+
+			ElementQuery query;
+			query.wrapper = this;
+			query.object = object;
+			query.proceed = true;
+			elementTree->Query(&query, sweptAABB, object->GetTransform());
+			return query.proceed;
+		}
+
+		struct ElementQuery
+		{
+			bool QueryCallback(s32 elementIndex)
+			{
+				AABB aabb;
+				object->GetShape()->ComputeElementAABB(&aabb, object->GetTransform(), elementIndex);
+				proceed = wrapper->Cast(object, elementIndex, aabb);
+				return proceed;
+			}
+
+			ShapeCastWrapper* wrapper;
+			CollisionObject* object;
+			bool proceed;
+		};
+
+		bool Cast(CollisionObject* object, s32 childIndex, const AABB& aabb)
+		{
+			if (Physics::TestSweptOverlap(startAABB, input.translationA, input.maxFraction, aabb) == false)
+			{
+				return true;
+			}
+
+			input.proxyB.Set(object->GetShape(), childIndex);
+			input.transformB = object->GetTransform();
+
+			ShapeCastOutput output;
+			if (Physics::ShapeCast(&output, &input) == false)
+			{
+				return true;
+			}
+
+			real32 value = callback->ReportObject(object, output.point, output.normal, output.fraction);
+			if (value == 0.0f)
+			{
+				return false;
+			}
+
+			if (value > 0.0f && value < input.maxFraction)
+			{
+				input.maxFraction = value;
+			}
+
+			return true;
+		}
+
+		const DynamicTree* tree;
+		CollisionCastCallback* callback;
+		ShapeCastInput input;
+		AABB startAABB;
+		AABB sweptAABB;
+	};
+
+	// Finds the pairs of one proxy. Each pair is found from both sides, so it is
+	// only kept from the proxy with the smaller id.
+	struct PairWrapper
+	{
+		bool QueryCallback(s32 proxyId)
+		{
+			if (proxyId < proxy->proxyId)
+			{
+				return true;
+			}
+
+			CollisionProxy* other = (CollisionProxy*)tree->GetUserData(proxyId);
+			if (other->object == proxy->object)
+			{
+				return true;
+			}
+
+			if (Physics::TestOverlap(proxy->aabb, other->aabb) == false)
+			{
+				return true;
+			}
+
+			if (ShouldCollide(proxy->object->GetFilterData(), other->object->GetFilterData()) == false)
+			{
+				return true;
+			}
+
+			const Shape* shapeA = proxy->object->GetShape();
+			const Shape* shapeB = other->object->GetShape();
+			const StaticTree* treeA = shapeA->GetElementTree();
+			const StaticTree* treeB = shapeB->GetElementTree();
+			if (treeA && treeB)
+			{
+				return true;
+			}
+
+			if (treeA || treeB)
+			{
+				ElementQuery query;
+				query.callback = callback;
+				query.mesh = treeA ? proxy : other;
+				query.convex = treeA ? other : proxy;
+				(treeA ? treeA : treeB)->Query(&query, query.convex->aabb, query.mesh->object->GetTransform());
+				return true;
+			}
+
+			if (Physics::TestOverlap(shapeA, proxy->childIndex, shapeB, other->childIndex, proxy->object->GetTransform(), other->object->GetTransform()))
+			{
+				callback->ReportPair(proxy->object, proxy->childIndex, other->object, other->childIndex);
+			}
+
+			return true;
+		}
+
+		struct ElementQuery
+		{
+			bool QueryCallback(s32 elementIndex)
+			{
+				CollisionObject* meshObject = mesh->object;
+				CollisionObject* convexObject = convex->object;
+				if (Physics::TestOverlap(convexObject->GetShape(), convex->childIndex, meshObject->GetShape(), elementIndex,
+					convexObject->GetTransform(), meshObject->GetTransform()))
+				{
+					callback->ReportPair(convexObject, convex->childIndex, meshObject, elementIndex);
+				}
+				return true;
+			}
+
+			CollisionPairCallback* callback;
+			const CollisionProxy* mesh;
+			const CollisionProxy* convex;
+		};
+
+		const DynamicTree* tree;
+		CollisionPairCallback* callback;
+		const CollisionProxy* proxy;
+	};
+}
+
+CollisionWorld::CollisionWorld()
+{
+	m_objectList = NULL;
+	m_objectCount = 0;
+}
+
+CollisionWorld::~CollisionWorld()
+{
+	while (m_objectList)
+	{
+		DestroyObject(m_objectList);
+	}
+}
+
+CollisionObject* CollisionWorld::CreateObject(const Shape* shape, const Transform2D& xf, void* userData)
+{
+	Filter filter;
+	return CreateObject(shape, xf, userData, filter);
+}
+
+CollisionObject* CollisionWorld::CreateObject(const Shape* shape, const Transform2D& xf, void* userData, const Filter& filter)
+{
+	void* mem = m_blockAllocator.Allocate(sizeof(CollisionObject));
+	CollisionObject* object = new (mem) CollisionObject;
+
+	object->m_shape = shape->Clone(&m_blockAllocator);
+	object->m_xf = xf;
+	object->m_filter = filter;
+	object->m_userData = userData;
+
+	object->m_proxyCount = object->m_shape->GetChildCount();
+	object->m_proxies = (CollisionProxy*)m_blockAllocator.Allocate(object->m_proxyCount * sizeof(CollisionProxy));
+	for (s32 i = 0; i < object->m_proxyCount; ++i)
+	{
+		CollisionProxy* proxy = object->m_proxies + i;
+		object->m_shape->ComputeAABB(&proxy->aabb, xf, i);
+		proxy->object = object;
+		proxy->childIndex = i;
+		proxy->proxyId = m_tree.CreateProxy(proxy->aabb, proxy);
+	}
+
+	// Add to the world list.
+	object->m_prev = NULL;
+	object->m_next = m_objectList;
+	if (m_objectList)
+	{
+		m_objectList->m_prev = object;
+	}
+	m_objectList = object;
+	++m_objectCount;
+
+	return object;
+}
+
+void CollisionWorld::DestroyObject(CollisionObject* object)
+{
+	assert(m_objectCount > 0);
+
+	for (s32 i = 0; i < object->m_proxyCount; ++i)
+	{
+		m_tree.DestroyProxy(object->m_proxies[i].proxyId);
+	}
+	m_blockAllocator.Free(object->m_proxies, object->m_proxyCount * sizeof(CollisionProxy));
+
+	FreeShape(&m_blockAllocator, object->m_shape);
+
+	// Remove from the world list.
+	if (object->m_prev)
+	{
+		object->m_prev->m_next = object->m_next;
+	}
+
+	if (object->m_next)
+	{
+		object->m_next->m_prev = object->m_prev;
+	}
+
+	if (object == m_objectList)
+	{
+		m_objectList = object->m_next;
+	}
+	--m_objectCount;
+
+	object->~CollisionObject();
+	m_blockAllocator.Free(object, sizeof(CollisionObject));
+}
+
+void CollisionWorld::SetTransform(CollisionObject* object, const Transform2D& xf)
+{
+	glm::vec2 displacement = xf.p - object->m_xf.p;
+	object->m_xf = xf;
+
+	for (s32 i = 0; i < object->m_proxyCount; ++i)
+	{
+		CollisionProxy* proxy = object->m_proxies + i;
+		object->m_shape->ComputeAABB(&proxy->aabb, xf, i);
+		m_tree.MoveProxy(proxy->proxyId, proxy->aabb, displacement);
+	}
+}
+
+void CollisionWorld::QueryAABB(CollisionQueryCallback* callback, const AABB& aabb) const
+{
+	QueryWrapper wrapper;
+	wrapper.tree = &m_tree;
+	wrapper.callback = callback;
+	m_tree.Query(&wrapper, aabb);
+}
+
+void CollisionWorld::RayCast(CollisionCastCallback* callback, const glm::vec2& point1, const glm::vec2& point2) const
+{
+	RayCastWrapper wrapper;
+	wrapper.tree = &m_tree;
+	wrapper.callback = callback;
+
+	RayCastInput input;
+	input.maxFraction = 1.0f;
+	input.p1 = point1;
+	input.p2 = point2;
+	m_tree.RayCast(&wrapper, input);
+}
+
+void CollisionWorld::ShapeCast(CollisionCastCallback* callback, const Shape* shape, const Transform2D& xf, const glm::vec2& translation) const
+{
+	assert(shape->GetChildCount() == 1 && shape->GetElementTree() == NULL);
+
+	ShapeCastWrapper wrapper;
+	wrapper.tree = &m_tree;
+	wrapper.callback = callback;
+	wrapper.input.proxyA.Set(shape, 0);
+	wrapper.input.transformA = xf;
+	wrapper.input.translationA = translation;
+	wrapper.input.maxFraction = 1.0f;
+
+	// The shape does not rotate, so the swept box is the start box stretched
+	// along the translation.
+	AABB& aabb = wrapper.startAABB;
+	shape->ComputeAABB(&aabb, xf, 0);
+	wrapper.sweptAABB.lowerBound = aabb.lowerBound + glm::min(translation, glm::vec2(0.0f, 0.0f));
+	wrapper.sweptAABB.upperBound = aabb.upperBound + glm::max(translation, glm::vec2(0.0f, 0.0f));
+
+	m_tree.Query(&wrapper, wrapper.sweptAABB);
+}
+
+void CollisionWorld::ComputeOverlapPairs(CollisionPairCallback* callback) const
+{
+	PairWrapper wrapper;
+	wrapper.tree = &m_tree;
+	wrapper.callback = callback;
+
+	for (const CollisionObject* object = m_objectList; object; object = object->m_next)
+	{
+		for (s32 i = 0; i < object->m_proxyCount; ++i)
+		{
+			wrapper.proxy = object->m_proxies + i;
+			m_tree.Query(&wrapper, wrapper.proxy->aabb);
+		}
+	}
+}
@@ -1,4 +1,5 @@
 #include "Contact2D.hpp"
+#include "ContactEvents.hpp"
 #include "CircleContact.hpp"
 #include "PolygonCircleContact.hpp"
 #include "PolygonContact.hpp"
@@ -6,6 +7,14 @@
 #include "EdgePolygonContact.hpp"
 #include "ChainCircleContact.hpp"
 #include "ChainPolygonContact.hpp"
+#include "MeshCircleContact.hpp"
+#include "MeshPolygonContact.hpp"
+#include "CapsuleContact.hpp"
+#include "CapsuleCircleContact.hpp"
+#include "PolygonCapsuleContact.hpp"
+#include "EdgeCapsuleContact.hpp"
+#include "ChainCapsuleContact.hpp"
+#include "MeshCapsuleContact.hpp"
 #include "ContactSolver.hpp"
 
 #include "Collision.hpp"
@@ -15,6 +24,7 @@
 #include "Body2D.hpp"
 #include "Fixture.hpp"
 #include "World2D.hpp"
+#include <mutex>
 
 using namespace Break;
 using namespace Break::Infrastructure;
@@ -24,6 +34,8 @@ using namespace Break::Physics;
 ContactRegister Contact::s_registers[Shape::typeCount][Shape::typeCount];
 bool Contact::s_initialized = false;
 
+static std::once_flag s_registersOnce;
+
 void Contact::InitializeRegisters()
 {
 	AddType(CircleContact::Create, CircleContact::Destroy, Shape::circle, Shape::circle);
@@ -33,6 +45,17 @@ void Contact::InitializeRegisters()
 	AddType(EdgeAndPolygonContact::Create, EdgeAndPolygonContact::Destroy, Shape::edge, Shape::polygon);
 	AddType(ChainAndCircleContact::Create, ChainAndCircleContact::Destroy, Shape::chain, Shape::circle);
 	AddType(ChainAndPolygonContact::Create, ChainAndPolygonContact::Destroy, Shape::chain, Shape::polygon);
+	AddType(MeshAndCircleContact::Create, MeshAndCircleContact::Destroy, Shape::mesh, Shape::circle);
+	AddType(MeshAndPolygonContact::Create, MeshAndPolygonContact::Destroy, Shape::mesh, Shape::polygon);
+	AddType(CapsuleContact::Create, CapsuleContact::Destroy, Shape::capsule, Shape::capsule);
+	AddType(CapsuleAndCircleContact::Create, CapsuleAndCircleContact::Destroy, Shape::capsule, Shape::circle);
+	AddType(PolygonAndCapsuleContact::Create, PolygonAndCapsuleContact::Destroy, Shape::polygon, Shape::capsule);
+	AddType(EdgeAndCapsuleContact::Create, EdgeAndCapsuleContact::Destroy, Shape::edge, Shape::capsule);
+	AddType(ChainAndCapsuleContact::Create, ChainAndCapsuleContact::Destroy, Shape::chain, Shape::capsule);
+	AddType(MeshAndCapsuleContact::Create, MeshAndCapsuleContact::Destroy, Shape::mesh, Shape::capsule);
+
+	// Runs under s_registersOnce, so Destroy can assert on it.
+	s_initialized = true;
 }
 
 void Contact::AddType(ContactCreateFcn* createFcn, ContactDestroyFcn* destoryFcn,
@@ -55,11 +78,9 @@ void Contact::AddType(ContactCreateFcn* createFcn, ContactDestroyFcn* destoryFcn
 
 Contact* Contact::Create(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB, BlockAllocator* allocator)
 {
-	if (s_initialized == false)
-	{
-		InitializeRegisters();
-		s_initialized = true;
-	}
+	// Worlds may be stepped on several threads, so the first one to get here
+	// fills the table and the others wait for it.
+	std::call_once(s_registersOnce, InitializeRegisters);
 
 	Shape::Type type1 = fixtureA->GetType();
 	Shape::Type type2 = fixtureB->GetType();
@@ -92,9 +113,7 @@ void Contact::Destroy(Contact* contact, BlockAllocator* allocator)
 	Fixture* fixtureA = contact->m_fixtureA;
 	Fixture* fixtureB = contact->m_fixtureB;
 
-	if (contact->m_manifold.pointCount > 0 &&
-		fixtureA->IsSensor() == false &&
-		fixtureB->IsSensor() == false)
+	if (contact->m_manifold.pointCount > 0)
 	{
 		fixtureA->GetBody()->SetAwake(true);
 		fixtureB->GetBody()->SetAwake(true);
@@ -120,8 +139,14 @@ Contact::Contact(Fixture* fA, s32 indexA, Fixture* fB, s32 indexB)
 	m_indexA = indexA;
 	m_indexB = indexB;
 
+	// Update copies the manifold before the first evaluation, so give the
+	// type a valid value.
+	m_manifold.type = Manifold::circles;
 	m_manifold.pointCount = 0;
 
+	m_separationCache.type = SeparationCache::none;
+	m_simplexCache.count = 0;
+
 	m_prev = NULL;
 	m_next = NULL;
 
@@ -136,6 +161,11 @@ Contact::Contact(Fixture* fA, s32 indexA, Fixture* fB, s32 indexB)
 	m_nodeB.other = NULL;
 
 	m_toiCount = 0;
+	m_toi = 1.0f;
+	m_toiIndex = -1;
+	m_toiStamp = 0;
+	m_collideStamp = 0;
+	m_filterIndex = -1;
 
 	m_friction = MixFriction(m_fixtureA->m_friction, m_fixtureB->m_friction);
 	m_restitution = MixRestitution(m_fixtureA->m_restitution, m_fixtureB->m_restitution);
@@ -143,9 +173,14 @@ Contact::Contact(Fixture* fA, s32 indexA, Fixture* fB, s32 indexB)
 	m_tangentSpeed = 0.0f;
 }
 
+void Contact::FlagForFiltering()
+{
+	m_fixtureA->GetBody()->GetWorld()->m_contactManager.FlagForFiltering(this);
+}
+
 // Update the contact manifold and touching status.
 // Note: do not assume the fixture AABBs are overlapping or are valid.
-void Contact::Update(ContactListener* listener)
+void Contact::Update(ContactListener* listener, ContactEvents* events)
 {
 	Manifold oldManifold = m_manifold;
 
@@ -155,57 +190,43 @@ void Contact::Update(ContactListener* listener)
 	bool touching = false;
 	bool wasTouching = (m_flags & touchingFlag) == touchingFlag;
 
-	bool sensorA = m_fixtureA->IsSensor();
-	bool sensorB = m_fixtureB->IsSensor();
-	bool sensor = sensorA || sensorB;
+	// Sensors keep a SensorOverlap in the contact manager instead of a contact.
+	assert(m_fixtureA->IsSensor() == false && m_fixtureB->IsSensor() == false);
 
 	Body* bodyA = m_fixtureA->GetBody();
 	Body* bodyB = m_fixtureB->GetBody();
 	const Transform2D& xfA = bodyA->GetTransform2D();
 	const Transform2D& xfB = bodyB->GetTransform2D();
 
-	// Is this contact a sensor?
-	if (sensor)
-	{
-		const Shape* shapeA = m_fixtureA->GetShape();
-		const Shape* shapeB = m_fixtureB->GetShape();
-		touching = TestOverlap(shapeA, m_indexA, shapeB, m_indexB, xfA, xfB);
+	Evaluate(&m_manifold, xfA, xfB);
+	touching = m_manifold.pointCount > 0;
 
-		// Sensors don't generate manifolds.
-		m_manifold.pointCount = 0;
-	}
-	else
+	// Match old contact ids to new contact ids and copy the
+	// stored impulses to warm start the solver.
+	for (s32 i = 0; i < m_manifold.pointCount; ++i)
 	{
-		Evaluate(&m_manifold, xfA, xfB);
-		touching = m_manifold.pointCount > 0;
+		ManifoldPoint* mp2 = m_manifold.points + i;
+		mp2->normalImpulse = 0.0f;
+		mp2->tangentImpulse = 0.0f;
+		ContactID id2 = mp2->id;
 
-		// Match old contact ids to new contact ids and copy the
-		// stored impulses to warm start the solver.
-		for (s32 i = 0; i < m_manifold.pointCount; ++i)
+		for (s32 j = 0; j < oldManifold.pointCount; ++j)
 		{
-			ManifoldPoint* mp2 = m_manifold.points + i;
-			mp2->normalImpulse = 0.0f;
-			mp2->tangentImpulse = 0.0f;
-			ContactID id2 = mp2->id;
+			ManifoldPoint* mp1 = oldManifold.points + j;
 
-			for (s32 j = 0; j < oldManifold.pointCount; ++j)
+			if (mp1->id.key == id2.key)
 			{
-				ManifoldPoint* mp1 = oldManifold.points + j;
-
-				if (mp1->id.key == id2.key)
-				{
-					mp2->normalImpulse = mp1->normalImpulse;
-					mp2->tangentImpulse = mp1->tangentImpulse;
-					break;
-				}
+				mp2->normalImpulse = mp1->normalImpulse;
+				mp2->tangentImpulse = mp1->tangentImpulse;
+				break;
 			}
 		}
+	}
 
-		if (touching != wasTouching)
-		{
-			bodyA->SetAwake(true);
-			bodyB->SetAwake(true);
-		}
+	if (touching != wasTouching)
+	{
+		bodyA->SetAwake(true);
+		bodyB->SetAwake(true);
 	}
 
 	if (touching)
@@ -217,17 +238,33 @@ void Contact::Update(ContactListener* listener)
 		m_flags &= ~touchingFlag;
 	}
 
-	if (wasTouching == false && touching == true && listener)
+	if (wasTouching == false && touching == true)
 	{
-		listener->BeginContact(this);  ///<<<-------
+		if (listener)
+		{
+			listener->BeginContact(this);  ///<<<-------
+		}
+
+		if (events)
+		{
+			events->AddBegin(this);
+		}
 	}
 
-	if (wasTouching == true && touching == false && listener)
+	if (wasTouching == true && touching == false)
 	{
-		listener->EndContact(this);
+		if (listener)
+		{
+			listener->EndContact(this);
+		}
+
+		if (events)
+		{
+			events->AddEnd(this, false);
+		}
 	}
 
-	if (sensor == false && touching && listener)
+	if (touching && listener)
 	{
 		listener->PreSolve(this, &oldManifold);
 	}
@@ -0,0 +1,183 @@
+#include "ContactEvents.hpp"
+#include "Contact2D.hpp"
+#include "ContactSolver.hpp"
+#include "SensorOverlap.hpp"
+#include <memory.h>
+
+using namespace Break;
+using namespace Break::Physics;
+
+
+namespace
+{
+	// Double the capacity of an event array, keeping the events.
+	template <typename T>
+	void Grow(T** events, s32 count, s32* capacity)
+	{
+		*capacity = glm::max(2 * *capacity, 64);
+		T* grown = (T*)malloc(*capacity * sizeof(T));
+		if (count > 0)
+		{
+			memcpy(grown, *events, count * sizeof(T));
+		}
+		free(*events);
+		*events = grown;
+	}
+}
+
+ContactEvents::ContactEvents()
+{
+	m_flags = 0;
+	m_impulseThreshold = 0.0f;
+
+	m_beginEvents = NULL;
+	m_beginCount = 0;
+	m_beginCapacity = 0;
+
+	m_endEvents = NULL;
+	m_endCount = 0;
+	m_endCapacity = 0;
+	m_stepEndCount = 0;
+
+	m_impulseEvents = NULL;
+	m_impulseCount = 0;
+	m_impulseCapacity = 0;
+}
+
+ContactEvents::~ContactEvents()
+{
+	free(m_beginEvents);
+	free(m_endEvents);
+	free(m_impulseEvents);
+}
+
+void ContactEvents::SetFlags(u32 flags)
+{
+	m_flags = flags;
+	Clear();
+}
+
+void ContactEvents::SetImpulseThreshold(real32 threshold)
+{
+	assert(threshold >= 0.0f);
+	m_impulseThreshold = threshold;
+}
+
+void ContactEvents::Clear()
+{
+	m_beginCount = 0;
+	m_endCount = 0;
+	m_impulseCount = 0;
+	m_stepEndCount = 0;
+}
+
+void ContactEvents::BeginStep()
+{
+	s32 keptCount = m_endCount - m_stepEndCount;
+	if (keptCount > 0)
+	{
+		memmove(m_endEvents, m_endEvents + m_stepEndCount, keptCount * sizeof(ContactTouchEvent));
+	}
+
+	m_beginCount = 0;
+	m_endCount = keptCount;
+	m_impulseCount = 0;
+	m_stepEndCount = 0;
+}
+
+void ContactEvents::EndStep()
+{
+	m_stepEndCount = m_endCount;
+}
+
+void ContactEvents::AddTouch(ContactTouchEvent** events, s32* count, s32* capacity, Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB, bool destroyed)
+{
+	if (*count == *capacity)
+	{
+		Grow(events, *count, capacity);
+	}
+
+	ContactTouchEvent* event = *events + *count;
+	event->fixtureA = fixtureA;
+	event->fixtureB = fixtureB;
+	event->childIndexA = indexA;
+	event->childIndexB = indexB;
+	event->destroyed = destroyed;
+	++*count;
+}
+
+void ContactEvents::AddBegin(Contact* contact)
+{
+	if (m_flags & beginContactEvents)
+	{
+		AddTouch(&m_beginEvents, &m_beginCount, &m_beginCapacity,
+			contact->GetFixtureA(), contact->GetChildIndexA(), contact->GetFixtureB(), contact->GetChildIndexB(), false);
+	}
+}
+
+void ContactEvents::AddEnd(Contact* contact, bool destroyed)
+{
+	if (m_flags & endContactEvents)
+	{
+		AddTouch(&m_endEvents, &m_endCount, &m_endCapacity,
+			contact->GetFixtureA(), contact->GetChildIndexA(), contact->GetFixtureB(), contact->GetChildIndexB(), destroyed);
+	}
+}
+
+void ContactEvents::AddBegin(const SensorOverlap* overlap)
+{
+	if (m_flags & beginContactEvents)
+	{
+		AddTouch(&m_beginEvents, &m_beginCount, &m_beginCapacity,
+			overlap->sensor, overlap->sensorIndex, overlap->visitor, overlap->visitorIndex, false);
+	}
+}
+
+void ContactEvents::AddEnd(const SensorOverlap* overlap, bool destroyed)
+{
+	if (m_flags & endContactEvents)
+	{
+		AddTouch(&m_endEvents, &m_endCount, &m_endCapacity,
+			overlap->sensor, overlap->sensorIndex, overlap->visitor, overlap->visitorIndex, destroyed);
+	}
+}
+
+void ContactEvents::AddImpulse(Contact* contact, const ContactVelocityConstraint* vc)
+{
+	if ((m_flags & impulseContactEvents) == 0)
+	{
+		return;
+	}
+
+	real32 normalImpulse = 0.0f;
+	real32 maxNormalImpulse = 0.0f;
+	real32 tangentImpulse = 0.0f;
+	for (s32 j = 0; j < vc->pointCount; ++j)
+	{
+		normalImpulse += vc->points[j].normalImpulse;
+		maxNormalImpulse = glm::max(maxNormalImpulse, vc->points[j].normalImpulse);
+		tangentImpulse += vc->points[j].tangentImpulse;
+	}
+
+	if (maxNormalImpulse < m_impulseThreshold)
+	{
+		return;
+	}
+
+	if (m_impulseCount == m_impulseCapacity)
+	{
+		Grow(&m_impulseEvents, m_impulseCount, &m_impulseCapacity);
+	}
+
+	ContactImpulseEvent* event = m_impulseEvents + m_impulseCount;
+	event->fixtureA = contact->GetFixtureA();
+	event->fixtureB = contact->GetFixtureB();
+	event->childIndexA = contact->GetChildIndexA();
+	event->childIndexB = contact->GetChildIndexB();
+	event->normal = vc->normal;
+	event->normalImpulse = normalImpulse;
+	event->maxNormalImpulse = maxNormalImpulse;
+	event->tangentImpulse = tangentImpulse;
+	event->pointCount = vc->pointCount;
+	++m_impulseCount;
+}
@@ -3,6 +3,10 @@
 #include "Fixture.hpp"
 #include "WorldCallBacks.hpp"
 #include "Contact2D.hpp"
+#include "ContactEvents.hpp"
+#include "StaticTree.hpp"
+#include "Collision.hpp"
+#include <stdint.h>
 
 using namespace Break;
 using namespace Break::Infrastructure;
@@ -10,27 +14,57 @@ using namespace Break::Physics;
 
 
 ContactFilter _defaultFilter;
-ContactListener _defaultListener;
 
 ContactManager::ContactManager()
 {
+	m_broadPhase = NULL;
 	m_contactList = NULL;
 	m_contactCount = 0;
+	m_contactCapacity = 256;
+	m_contacts = (Contact**)malloc(m_contactCapacity * sizeof(Contact*));
+	m_filterCount = 0;
+	m_filterCapacity = 16;
+	m_filterContacts = (Contact**)malloc(m_filterCapacity * sizeof(Contact*));
+	m_pairCount = 0;
 	m_contactFilter = &_defaultFilter;
-	m_contactListener = &_defaultListener;
+	m_contactListener = NULL;
+	m_overlapCount = 0;
+	m_overlapCapacity = 64;
+	m_overlaps = (SensorOverlap*)malloc(m_overlapCapacity * sizeof(SensorOverlap));
+	m_overlapBucketCount = 64;
+	m_overlapBuckets = (s32*)malloc(m_overlapBucketCount * sizeof(s32));
+	memset(m_overlapBuckets, 0xFF, m_overlapBucketCount * sizeof(s32));
+	m_contactEvents = NULL;
 	m_allocator = NULL;
 }
 
-void ContactManager::Destroy(Contact* c)
+ContactManager::~ContactManager()
+{
+	delete m_broadPhase;
+	free(m_contacts);
+	free(m_filterContacts);
+	free(m_overlaps);
+	free(m_overlapBuckets);
+}
+
+void ContactManager::Destroy(Contact* c, bool destroyed)
 {
 	Fixture* fixtureA = c->GetFixtureA();
 	Fixture* fixtureB = c->GetFixtureB();
 	Body* bodyA = fixtureA->GetBody();
 	Body* bodyB = fixtureB->GetBody();
 
-	if (m_contactListener && c->IsTouching())
+	if (c->IsTouching())
 	{
-		m_contactListener->EndContact(c);
+		if (m_contactListener)
+		{
+			m_contactListener->EndContact(c);
+		}
+
+		if (m_contactEvents)
+		{
+			m_contactEvents->AddEnd(c, destroyed);
+		}
 	}
 
 	// Remove from the world.
@@ -49,6 +83,15 @@ void ContactManager::Destroy(Contact* c)
 		m_contactList = c->m_next;
 	}
 
+	Contact* last = m_contacts[m_contactCount - 1];
+	m_contacts[c->m_managerIndex] = last;
+	last->m_managerIndex = c->m_managerIndex;
+
+	if (c->m_filterIndex != -1)
+	{
+		UnqueueFilter(c);
+	}
+
 	// Remove from body 1
 	if (c->m_nodeA.prev)
 	{
@@ -89,80 +132,140 @@ void ContactManager::Destroy(Contact* c)
 // This is the top level collision call for the time step. Here
 // all the narrow phase collision is processed for the world
 // contact list.
-void ContactManager::Collide()
+void ContactManager::Collide(Contact* c)
 {
-	// Update awake contacts.
-	Contact* c = m_contactList;
-	while (c)
-	{
-		Fixture* fixtureA = c->GetFixtureA();
-		Fixture* fixtureB = c->GetFixtureB();
-		s32 indexA = c->GetChildIndexA();
-		s32 indexB = c->GetChildIndexB();
-		Body* bodyA = fixtureA->GetBody();
-		Body* bodyB = fixtureB->GetBody();
-
-		// Is this contact flagged for filtering?
-		if (c->m_flags & Contact::filterFlag)
-		{
-			// Should these bodies collide?
-			if (bodyB->ShouldCollide(bodyA) == false)
-			{
-				Contact* cNuke = c;
-				c = cNuke->GetNext();
-				Destroy(cNuke);
-				continue;
-			}
+	Fixture* fixtureA = c->GetFixtureA();
+	Fixture* fixtureB = c->GetFixtureB();
+	s32 indexA = c->GetChildIndexA();
+	s32 indexB = c->GetChildIndexB();
+	Body* bodyA = fixtureA->GetBody();
+	Body* bodyB = fixtureB->GetBody();
 
-			// Check user filtering.
-			if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
-			{
-				Contact* cNuke = c;
-				c = cNuke->GetNext();
-				Destroy(cNuke);
-				continue;
-			}
+	// Is this contact flagged for filtering?
+	if (c->m_flags & Contact::filterFlag)
+	{
+		UnqueueFilter(c);
 
-			// Clear the filtering flag.
-			c->m_flags &= ~Contact::filterFlag;
+		// Should these bodies collide?
+		if (bodyB->ShouldCollide(bodyA) == false)
+		{
+			Destroy(c, false);
+			return;
 		}
 
-		bool activeA = bodyA->IsAwake() && bodyA->m_type != staticBody;
-		bool activeB = bodyB->IsAwake() && bodyB->m_type != staticBody;
+		// Check user filtering.
+		if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+		{
+			Destroy(c, false);
+			return;
+		}
 
-		// At least one body must be awake and it must be dynamic or kinematic.
-		if (activeA == false && activeB == false)
+		// A fixture that became a sensor keeps an overlap instead, created when
+		// the broad-phase reports the pair again.
+		if (fixtureA->IsSensor() || fixtureB->IsSensor())
 		{
-			c = c->GetNext();
-			continue;
+			Destroy(c, false);
+			return;
 		}
 
-		s32 proxyIdA = fixtureA->m_proxies[indexA].proxyId;
-		s32 proxyIdB = fixtureB->m_proxies[indexB].proxyId;
-		bool overlap = m_broadPhase.TestOverlap(proxyIdA, proxyIdB);
+		// Clear the filtering flag.
+		c->m_flags &= ~Contact::filterFlag;
+	}
+
+	bool activeA = bodyA->IsAwake() && bodyA->m_type != staticBody;
+	bool activeB = bodyB->IsAwake() && bodyB->m_type != staticBody;
+
+	// At least one body must be awake and it must be dynamic or kinematic.
+	if (activeA == false && activeB == false)
+	{
+		return;
+	}
+
+	// Here we destroy contacts that cease to overlap in the broad-phase.
+	if (TestChildOverlap(fixtureA, indexA, fixtureB, indexB) == false)
+	{
+		Destroy(c, false);
+		return;
+	}
 
-		// Here we destroy contacts that cease to overlap in the broad-phase.
-		if (overlap == false)
+	// The contact persists.
+	c->Update(m_contactListener, m_contactEvents);
+}
+
+void ContactManager::FlagForFiltering(Contact* c)
+{
+	c->m_flags |= Contact::filterFlag;
+	if (c->m_filterIndex != -1)
+	{
+		return;
+	}
+
+	if (m_filterCount == m_filterCapacity)
+	{
+		Contact** old = m_filterContacts;
+		m_filterCapacity *= 2;
+		m_filterContacts = (Contact**)malloc(m_filterCapacity * sizeof(Contact*));
+		memcpy(m_filterContacts, old, m_filterCount * sizeof(Contact*));
+		free(old);
+	}
+	c->m_filterIndex = m_filterCount;
+	m_filterContacts[m_filterCount] = c;
+	++m_filterCount;
+}
+
+void ContactManager::UnqueueFilter(Contact* c)
+{
+	assert(0 <= c->m_filterIndex && c->m_filterIndex < m_filterCount);
+	Contact* last = m_filterContacts[m_filterCount - 1];
+	m_filterContacts[c->m_filterIndex] = last;
+	last->m_filterIndex = c->m_filterIndex;
+	c->m_filterIndex = -1;
+	--m_filterCount;
+}
+
+void ContactManager::RequeueFiltering()
+{
+	m_filterCount = 0;
+	for (s32 i = 0; i < m_contactCount; ++i)
+	{
+		Contact* c = m_contacts[i];
+		c->m_filterIndex = -1;
+		if (c->m_flags & Contact::filterFlag)
 		{
-			Contact* cNuke = c;
-			c = cNuke->GetNext();
-			Destroy(cNuke);
-			continue;
+			FlagForFiltering(c);
 		}
+	}
+}
 
-		// The contact persists.
-		c->Update(m_contactListener);
-		c = c->GetNext();
+bool ContactManager::TestChildOverlap(const Fixture* fixtureA, s32 indexA, const Fixture* fixtureB, s32 indexB) const
+{
+	// A mesh or chain pair lasts while its element overlaps the other proxy.
+	if (fixtureA->GetShape()->GetElementTree())
+	{
+		AABB aabb;
+		fixtureA->GetShape()->ComputeElementAABB(&aabb, fixtureA->GetBody()->GetTransform2D(), indexA);
+		return TestOverlap(aabb, m_broadPhase->GetFatAABB(fixtureB->m_proxies[indexB].proxyId));
 	}
+
+	if (fixtureB->GetShape()->GetElementTree())
+	{
+		AABB aabb;
+		fixtureB->GetShape()->ComputeElementAABB(&aabb, fixtureB->GetBody()->GetTransform2D(), indexB);
+		return TestOverlap(aabb, m_broadPhase->GetFatAABB(fixtureA->m_proxies[indexA].proxyId));
+	}
+
+	return m_broadPhase->TestOverlap(fixtureA->m_proxies[indexA].proxyId, fixtureB->m_proxies[indexB].proxyId);
 }
 
 void ContactManager::FindNewContacts()
 {
-	m_broadPhase.UpdatePairs(this);
+	m_broadPhase->UpdatePairs(this);
 }
 
 void ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 {
+	++m_pairCount;
+
 	FixtureProxy* proxyA = (FixtureProxy*)proxyUserDataA;
 	FixtureProxy* proxyB = (FixtureProxy*)proxyUserDataB;
 
@@ -181,9 +284,127 @@ void ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 		return;
 	}
 
+	// A mesh or chain proxy covers many elements, each with its own contact.
+	if (fixtureA->GetShape()->GetElementTree())
+	{
+		AddElementPairs(proxyA, proxyB);
+		return;
+	}
+
+	if (fixtureB->GetShape()->GetElementTree())
+	{
+		AddElementPairs(proxyB, proxyA);
+		return;
+	}
+
+	// Sensors keep an overlap instead of a contact. Does either exist already?
+	bool sensor = fixtureA->IsSensor() || fixtureB->IsSensor();
+	if (sensor)
+	{
+		if (FindOverlap(fixtureA, indexA, fixtureB, indexB) != -1)
+		{
+			return;
+		}
+	}
+	else if (FindContact(fixtureA, indexA, fixtureB, indexB))
+	{
+		return;
+	}
+
+	// Does a joint override collision? Is at least one body dynamic?
+	if (bodyB->ShouldCollide(bodyA) == false)
+	{
+		return;
+	}
+
+	// Check user filtering.
+	if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
+	{
+		return;
+	}
+
+	if (sensor)
+	{
+		CreateOverlap(fixtureA, indexA, fixtureB, indexB);
+		return;
+	}
+
+	CreateContact(fixtureA, indexA, fixtureB, indexB);
+}
+
+namespace
+{
+	// Creates the missing contacts between the elements under a proxy and that proxy.
+	struct ElementPairQuery
+	{
+		bool QueryCallback(s32 element)
+		{
+			if (sensor)
+			{
+				if (manager->FindOverlap(treeFixture, element, fixture, childIndex) == -1)
+				{
+					manager->CreateOverlap(treeFixture, element, fixture, childIndex);
+				}
+			}
+			else if (manager->FindContact(treeFixture, element, fixture, childIndex) == false)
+			{
+				manager->CreateContact(treeFixture, element, fixture, childIndex);
+			}
+			return true;
+		}
+
+		ContactManager* manager;
+		Fixture* treeFixture;
+		Fixture* fixture;
+		s32 childIndex;
+		bool sensor;
+	};
+}
+
+void ContactManager::AddElementPairs(FixtureProxy* treeProxy, FixtureProxy* proxy)
+{
+	Fixture* treeFixture = treeProxy->fixture;
+	Fixture* fixture = proxy->fixture;
+
+	// Only circles, polygons and capsules collide with mesh elements and chain edges.
+	Shape::Type type = fixture->GetType();
+	if (type != Shape::circle && type != Shape::polygon && type != Shape::capsule)
+	{
+		return;
+	}
+
+	Body* treeBody = treeFixture->GetBody();
+	Body* body = fixture->GetBody();
+
+	// The filters are the same for every element, so they are checked once.
+	if (body->ShouldCollide(treeBody) == false)
+	{
+		return;
+	}
+
+	if (m_contactFilter && m_contactFilter->ShouldCollide(treeFixture, fixture) == false)
+	{
+		return;
+	}
+
+	ElementPairQuery query;
+	query.manager = this;
+	query.treeFixture = treeFixture;
+	query.fixture = fixture;
+	query.childIndex = proxy->childIndex;
+	query.sensor = treeFixture->IsSensor() || fixture->IsSensor();
+
+	const StaticTree* tree = treeFixture->GetShape()->GetElementTree();
+	tree->Query(&query, m_broadPhase->GetFatAABB(proxy->proxyId), treeBody->GetTransform2D());
+}
+
+bool ContactManager::FindContact(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB) const
+{
+	Body* bodyA = fixtureA->GetBody();
+	Body* bodyB = fixtureB->GetBody();
+
 	// TODO_ERIN use a hash table to remove a potential bottleneck when both
 	// bodies have a lot of contacts.
-	// Does a contact already exist?
 	ContactEdge* edge = bodyB->GetContactList();
 	while (edge)
 	{
@@ -196,32 +417,23 @@ void ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 
 			if (fA == fixtureA && fB == fixtureB && iA == indexA && iB == indexB)
 			{
-				// A contact already exists.
-				return;
+				return true;
 			}
 
 			if (fA == fixtureB && fB == fixtureA && iA == indexB && iB == indexA)
 			{
-				// A contact already exists.
-				return;
+				return true;
 			}
 		}
 
 		edge = edge->next;
 	}
 
-	// Does a joint override collision? Is at least one body dynamic?
-	if (bodyB->ShouldCollide(bodyA) == false)
-	{
-		return;
-	}
-
-	// Check user filtering.
-	if (m_contactFilter && m_contactFilter->ShouldCollide(fixtureA, fixtureB) == false)
-	{
-		return;
-	}
+	return false;
+}
 
+void ContactManager::CreateContact(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB)
+{
 	// Call the factory.
 	Contact* c = Contact::Create(fixtureA, indexA, fixtureB, indexB, m_allocator);
 	if (c == NULL)
@@ -229,13 +441,23 @@ void ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 		return;
 	}
 
+	Insert(c);
+
 	// Contact creation may swap fixtures.
 	fixtureA = c->GetFixtureA();
 	fixtureB = c->GetFixtureB();
-	indexA = c->GetChildIndexA();
-	indexB = c->GetChildIndexB();
-	bodyA = fixtureA->GetBody();
-	bodyB = fixtureB->GetBody();
+	Body* bodyA = fixtureA->GetBody();
+	Body* bodyB = fixtureB->GetBody();
+
+	// Wake up the bodies
+	bodyA->SetAwake(true);
+	bodyB->SetAwake(true);
+}
+
+void ContactManager::Insert(Contact* c)
+{
+	Body* bodyA = c->GetFixtureA()->GetBody();
+	Body* bodyB = c->GetFixtureB()->GetBody();
 
 	// Insert into the world.
 	c->m_prev = NULL;
@@ -246,6 +468,18 @@ void ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 	}
 	m_contactList = c;
 
+	if (m_contactCount == m_contactCapacity)
+	{
+		Contact** old = m_contacts;
+		m_contactCapacity *= 2;
+		m_contacts = (Contact**)malloc(m_contactCapacity * sizeof(Contact*));
+		memcpy(m_contacts, old, m_contactCount * sizeof(Contact*));
+		free(old);
+	}
+	c->m_managerIndex = m_contactCount;
+	m_contacts[m_contactCount] = c;
+	++m_contactCount;
+
 	// Connect to island graph.
 
 	// Connect to body A
@@ -271,14 +505,354 @@ void ContactManager::AddPair(void* proxyUserDataA, void* proxyUserDataB)
 		bodyB->m_contactList->prev = &c->m_nodeB;
 	}
 	bodyB->m_contactList = &c->m_nodeB;
+}
 
-	// Wake up the bodies
-	if (fixtureA->IsSensor() == false && fixtureB->IsSensor() == false)
+void ContactManager::Clear()
+{
+	for (s32 i = 0; i < m_contactCount; ++i)
 	{
-		bodyA->SetAwake(true);
-		bodyB->SetAwake(true);
+		Contact* c = m_contacts[i];
+		c->GetFixtureA()->GetBody()->m_contactList = NULL;
+		c->GetFixtureB()->GetBody()->m_contactList = NULL;
+
+		// An empty manifold keeps the factory from waking the bodies.
+		c->m_manifold.pointCount = 0;
+		Contact::Destroy(c, m_allocator);
 	}
 
-	++m_contactCount;
+	m_contactList = NULL;
+	m_contactCount = 0;
+	m_filterCount = 0;
+}
+
+
+namespace
+{
+	inline u32 HashChild(const Fixture* fixture, s32 index)
+	{
+		u32 key = (u32)((uintptr_t)fixture >> 4) * 2654435761u + (u32)index * 40503u;
+		key ^= key >> 16;
+		key *= 0x85EBCA6Bu;
+		key ^= key >> 13;
+		return key;
+	}
+
+	// The hash does not depend on the order of the children.
+	inline u32 HashPair(const Fixture* fixtureA, s32 indexA, const Fixture* fixtureB, s32 indexB)
+	{
+		return HashChild(fixtureA, indexA) ^ HashChild(fixtureB, indexB);
+	}
+
+	// Overlap list links name a side of an overlap: twice its index, plus one
+	// for the visitor side.
+	inline SensorOverlapEdge* GetOverlapEdge(SensorOverlap* overlaps, s32 edge)
+	{
+		return overlaps[edge >> 1].edges + (edge & 1);
+	}
+
+	inline Fixture* GetEdgeFixture(const SensorOverlap* o, s32 side)
+	{
+		return side == 0 ? o->sensor : o->visitor;
+	}
+}
+
+// Push both sides of an overlap onto the lists of their fixtures.
+void ContactManager::LinkOverlap(s32 index)
+{
+	SensorOverlap* o = m_overlaps + index;
+	for (s32 side = 0; side < 2; ++side)
+	{
+		Fixture* fixture = GetEdgeFixture(o, side);
+		SensorOverlapEdge* edge = o->edges + side;
+		edge->prev = -1;
+		edge->next = fixture->m_overlapList;
+		if (edge->next != -1)
+		{
+			GetOverlapEdge(m_overlaps, edge->next)->prev = 2 * index + side;
+		}
+		fixture->m_overlapList = 2 * index + side;
+	}
+}
+
+// Point the neighbours of both sides of an overlap at the given index. With
+// remove set the sides are unlinked instead.
+void ContactManager::RelinkOverlap(s32 index, bool remove)
+{
+	SensorOverlap* o = m_overlaps + index;
+	for (s32 side = 0; side < 2; ++side)
+	{
+		const SensorOverlapEdge* edge = o->edges + side;
+		s32 fromPrev = remove ? edge->next : 2 * index + side;
+		s32 fromNext = remove ? edge->prev : 2 * index + side;
+
+		if (edge->prev != -1)
+		{
+			GetOverlapEdge(m_overlaps, edge->prev)->next = fromPrev;
+		}
+		else
+		{
+			GetEdgeFixture(o, side)->m_overlapList = fromPrev;
+		}
+
+		if (edge->next != -1)
+		{
+			GetOverlapEdge(m_overlaps, edge->next)->prev = fromNext;
+		}
+	}
+}
+
+s32 ContactManager::FindOverlap(const Fixture* fixtureA, s32 indexA, const Fixture* fixtureB, s32 indexB) const
+{
+	u32 bucket = HashPair(fixtureA, indexA, fixtureB, indexB) & (m_overlapBucketCount - 1);
+	for (s32 i = m_overlapBuckets[bucket]; i != -1; i = m_overlaps[i].next)
+	{
+		const SensorOverlap* o = m_overlaps + i;
+		if (o->sensor == fixtureA && o->visitor == fixtureB && o->sensorIndex == indexA && o->visitorIndex == indexB)
+		{
+			return i;
+		}
+
+		if (o->sensor == fixtureB && o->visitor == fixtureA && o->sensorIndex == indexB && o->visitorIndex == indexA)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+void ContactManager::CreateOverlap(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB)
+{
+	assert(fixtureA->IsSensor() || fixtureB->IsSensor());
+
+	if (m_overlapCount == m_overlapCapacity)
+	{
+		SensorOverlap* old = m_overlaps;
+		m_overlapCapacity *= 2;
+		m_overlaps = (SensorOverlap*)malloc(m_overlapCapacity * sizeof(SensorOverlap));
+		memcpy(m_overlaps, old, m_overlapCount * sizeof(SensorOverlap));
+		free(old);
+	}
+
+	// Keep at most one overlap per bucket on average.
+	if (m_overlapCount == m_overlapBucketCount)
+	{
+		m_overlapBucketCount *= 2;
+		free(m_overlapBuckets);
+		m_overlapBuckets = (s32*)malloc(m_overlapBucketCount * sizeof(s32));
+		memset(m_overlapBuckets, 0xFF, m_overlapBucketCount * sizeof(s32));
+		for (s32 i = 0; i < m_overlapCount; ++i)
+		{
+			SensorOverlap* o = m_overlaps + i;
+			u32 bucket = HashPair(o->sensor, o->sensorIndex, o->visitor, o->visitorIndex) & (m_overlapBucketCount - 1);
+			o->next = m_overlapBuckets[bucket];
+			m_overlapBuckets[bucket] = i;
+		}
+	}
+
+	bool sensorA = fixtureA->IsSensor();
+	SensorOverlap* o = m_overlaps + m_overlapCount;
+	o->sensor = sensorA ? fixtureA : fixtureB;
+	o->visitor = sensorA ? fixtureB : fixtureA;
+	o->sensorIndex = sensorA ? indexA : indexB;
+	o->visitorIndex = sensorA ? indexB : indexA;
+	o->simplexCache.count = 0;
+	o->flags = 0;
+
+	u32 bucket = HashPair(fixtureA, indexA, fixtureB, indexB) & (m_overlapBucketCount - 1);
+	o->next = m_overlapBuckets[bucket];
+	m_overlapBuckets[bucket] = m_overlapCount;
+
+	LinkOverlap(m_overlapCount);
+	++m_overlapCount;
+}
+
+void ContactManager::DestroyOverlap(s32 index, bool destroyed)
+{
+	assert(0 <= index && index < m_overlapCount);
+	SensorOverlap* o = m_overlaps + index;
+
+	if (o->IsTouching())
+	{
+		if (m_contactListener)
+		{
+			m_contactListener->EndSensor(o);
+		}
+
+		if (m_contactEvents)
+		{
+			m_contactEvents->AddEnd(o, destroyed);
+		}
+	}
+
+	// Unlink from the hash chain.
+	u32 bucket = HashPair(o->sensor, o->sensorIndex, o->visitor, o->visitorIndex) & (m_overlapBucketCount - 1);
+	s32* link = m_overlapBuckets + bucket;
+	while (*link != index)
+	{
+		link = &m_overlaps[*link].next;
+	}
+	*link = o->next;
+	RelinkOverlap(index, true);
+
+	// Move the last overlap into the hole and point its chain and its fixture
+	// lists at the new index.
+	--m_overlapCount;
+	if (index == m_overlapCount)
+	{
+		return;
+	}
+
+	SensorOverlap* last = m_overlaps + m_overlapCount;
+	bucket = HashPair(last->sensor, last->sensorIndex, last->visitor, last->visitorIndex) & (m_overlapBucketCount - 1);
+	link = m_overlapBuckets + bucket;
+	while (*link != m_overlapCount)
+	{
+		link = &m_overlaps[*link].next;
+	}
+	*link = index;
+	*o = *last;
+	RelinkOverlap(index, false);
+}
+
+void ContactManager::DestroyOverlaps(const Body* body, bool destroyed)
+{
+	for (const Fixture* f = body->m_fixtureList; f; f = f->m_next)
+	{
+		DestroyOverlaps(f, destroyed);
+	}
+}
+
+void ContactManager::DestroyOverlaps(const Fixture* fixture, bool destroyed)
+{
+	// Destroying an overlap unlinks it, so the list head moves on each time.
+	while (fixture->m_overlapList != -1)
+	{
+		DestroyOverlap(fixture->m_overlapList >> 1, destroyed);
+	}
+}
+
+void ContactManager::ClearOverlaps()
+{
+	for (s32 i = 0; i < m_overlapCount; ++i)
+	{
+		m_overlaps[i].sensor->m_overlapList = -1;
+		m_overlaps[i].visitor->m_overlapList = -1;
+	}
+
+	m_overlapCount = 0;
+	memset(m_overlapBuckets, 0xFF, m_overlapBucketCount * sizeof(s32));
+}
+
+void ContactManager::FlagOverlapsForFiltering(const Fixture* fixture)
+{
+	for (s32 edge = fixture->m_overlapList; edge != -1; edge = GetOverlapEdge(m_overlaps, edge)->next)
+	{
+		m_overlaps[edge >> 1].flags |= SensorOverlap::filterFlag;
+	}
+}
+
+void ContactManager::FlagOverlapsForFiltering(const Body* bodyA, const Body* bodyB)
+{
+	// Walk the body with fewer fixtures.
+	if (bodyB->m_fixtureCount < bodyA->m_fixtureCount)
+	{
+		const Body* body = bodyA;
+		bodyA = bodyB;
+		bodyB = body;
+	}
+
+	for (const Fixture* f = bodyA->m_fixtureList; f; f = f->m_next)
+	{
+		for (s32 edge = f->m_overlapList; edge != -1; edge = GetOverlapEdge(m_overlaps, edge)->next)
+		{
+			SensorOverlap* o = m_overlaps + (edge >> 1);
+			const Fixture* other = (edge & 1) ? o->sensor : o->visitor;
+			if (other->GetBody() == bodyB)
+			{
+				o->flags |= SensorOverlap::filterFlag;
+			}
+		}
+	}
 }
 
+// Sensor overlaps are tested in one pass over the packed array. Unlike
+// contacts they never wake a body and never reach the solver.
+void ContactManager::UpdateOverlaps()
+{
+	s32 i = 0;
+	while (i < m_overlapCount)
+	{
+		SensorOverlap* o = m_overlaps + i;
+		Fixture* sensor = o->sensor;
+		Fixture* visitor = o->visitor;
+		Body* sensorBody = sensor->GetBody();
+		Body* visitorBody = visitor->GetBody();
+
+		if (o->flags & SensorOverlap::filterFlag)
+		{
+			// A fixture that is no longer a sensor gets a contact instead, created
+			// when the broad-phase reports the pair again.
+			if ((sensor->IsSensor() == false && visitor->IsSensor() == false) ||
+				visitorBody->ShouldCollide(sensorBody) == false ||
+				(m_contactFilter && m_contactFilter->ShouldCollide(sensor, visitor) == false))
+			{
+				DestroyOverlap(i, false);
+				continue;
+			}
+
+			o->flags &= ~SensorOverlap::filterFlag;
+		}
+
+		bool activeSensor = sensorBody->IsAwake() && sensorBody->m_type != staticBody;
+		bool activeVisitor = visitorBody->IsAwake() && visitorBody->m_type != staticBody;
+
+		// Nothing moved, so the overlap cannot have changed.
+		if (activeSensor == false && activeVisitor == false)
+		{
+			++i;
+			continue;
+		}
+
+		if (TestChildOverlap(sensor, o->sensorIndex, visitor, o->visitorIndex) == false)
+		{
+			DestroyOverlap(i, false);
+			continue;
+		}
+
+		bool wasTouching = o->IsTouching();
+		bool touching = TestOverlap(&o->simplexCache, sensor->GetShape(), o->sensorIndex, visitor->GetShape(), o->visitorIndex,
+			sensorBody->GetTransform2D(), visitorBody->GetTransform2D());
+
+		if (touching && wasTouching == false)
+		{
+			o->flags |= SensorOverlap::touchingFlag;
+
+			if (m_contactListener)
+			{
+				m_contactListener->BeginSensor(o);
+			}
+
+			if (m_contactEvents)
+			{
+				m_contactEvents->AddBegin(o);
+			}
+		}
+		else if (touching == false && wasTouching)
+		{
+			o->flags &= ~SensorOverlap::touchingFlag;
+
+			if (m_contactListener)
+			{
+				m_contactListener->EndSensor(o);
+			}
+
+			if (m_contactEvents)
+			{
+				m_contactEvents->AddEnd(o, false);
+			}
+		}
+
+		++i;
+	}
+}
@@ -3,6 +3,8 @@
 #include "PolygonShape.hpp"
 #include "EdgeShape.hpp"
 #include "ChainShape.hpp"
+#include "MeshShape.hpp"
+#include "CapsuleShape.hpp"
 
 using namespace Break;
 using namespace Break::Infrastructure;
@@ -62,6 +64,30 @@ void DistanceProxy::Set(const Shape* shape, s32 index)
 		}
 		break;
 
+	case Shape::capsule:
+		{
+			const CapsuleShape* capsule = static_cast<const CapsuleShape*>(shape);
+			m_vertices = &capsule->m_vertex1;
+			m_count = 2;
+			m_radius = capsule->m_radius;
+		}
+		break;
+
+	case Shape::mesh:
+		{
+			const MeshShape* mesh = static_cast<const MeshShape*>(shape);
+			const MeshElement& element = mesh->GetElement(index);
+			m_vertices = mesh->m_vertices + element.vertexIndex;
+			if (element.flags & MeshElement::edgeFlag)
+			{
+				// Skip the ghost vertex.
+				++m_vertices;
+			}
+			m_count = element.count;
+			m_radius = mesh->m_radius;
+		}
+		break;
+
 	default:
 		assert(false);
 	}
@@ -427,11 +453,19 @@ void Simplex::Solve3()
 
 
 // GJK using Voronoi regions (Christer Ericson) and Barycentric coordinates.
-s32 _gjkCalls, _gjkIters, _gjkMaxIters;
+std::atomic<s32> Physics::_gjkCalls(0), Physics::_gjkIters(0), Physics::_gjkMaxIters(0);
+
+// The iterations run on this thread, so each world can count its own.
+static thread_local s32 s_threadGJKIters = 0;
+
+s32 Physics::GetThreadGJKIterations()
+{
+	return s_threadGJKIters;
+}
 
 void Physics::Distance(DistanceOutput* output,SimplexCache* cache,const DistanceInput* input)
 {
-	++_gjkCalls; 
+	_gjkCalls.fetch_add(1, std::memory_order_relaxed);
 
 	const DistanceProxy* proxyA = &input->proxyA;
 	const DistanceProxy* proxyB = &input->proxyB;
@@ -527,7 +561,6 @@ void Physics::Distance(DistanceOutput* output,SimplexCache* cache,const Distance
 
 		// Iteration count is equated to the number of support point calls.
 		++iter;
-		++_gjkIters;
 
 		// Check for duplicate support points. This is the main termination criteria.
 		bool duplicate = false;
@@ -550,7 +583,9 @@ void Physics::Distance(DistanceOutput* output,SimplexCache* cache,const Distance
 		++simplex.m_count;
 	}
 
-	_gjkMaxIters = glm::max(_gjkMaxIters, iter);
+	_gjkIters.fetch_add(iter, std::memory_order_relaxed);
+	s_threadGJKIters += iter;
+	AtomicMax(_gjkMaxIters, iter);
 
 	// Prepare output.
 	simplex.GetWitnessPoints(&output->pointA, &output->pointB);
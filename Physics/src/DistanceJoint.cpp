@@ -30,7 +30,7 @@ void DistanceJointDef::Initialize(Body* b1, Body* b2 ,const glm::vec2& anchor1,
 	localAnchorA = bodyA->GetLocalPoint(anchor1);
 	localAnchorB = bodyB->GetLocalPoint(anchor2);
 	glm::vec2 d = anchor2 - anchor1;
-	length = d.length();
+	length = glm::length(d);
 }
 
 DistanceJoint::DistanceJoint(const DistanceJointDef* def) : Joint(def)
@@ -73,7 +73,7 @@ void DistanceJoint::InitVelocityConstraints(const SolverData& data)
 	m_u = cB + m_rB - cA - m_rA;
 
 	// Handle singularity.
-	real32 length = m_u.length();
+	real32 length = glm::length(m_u);
 	if (length > linearSlop)
 	{
 		m_u *= 1.0f / length;
@@ -186,7 +186,16 @@ bool DistanceJoint::SolvePositionConstraints(const SolverData& data)
 	glm::vec2 rB = Rotation2D::Mul(qB, m_localAnchorB - m_localCenterB);
 	glm::vec2 u = cB + rB - cA - rA;
 
-	real32 length = u.length();
+	real32 length = glm::length(u);
+	if (length < FLT_EPSILON)
+	{
+		length = 0.0f;
+	}
+	else
+	{
+		u *= 1.0f / length;
+	}
+
 	real32 C = length - m_length;
 	C = glm::clamp(C, - maxLinearCorrection, maxLinearCorrection);
 
@@ -244,3 +253,13 @@ void DistanceJoint::Dump()
 	printf("  jd.dampingRatio = %.15lef;\n", m_dampingRatio);
 	printf("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+void DistanceJoint::SaveState(JointState* state) const
+{
+	state->values[0] = m_impulse;
+}
+
+void DistanceJoint::LoadState(const JointState* state)
+{
+	m_impulse = state->values[0];
+}
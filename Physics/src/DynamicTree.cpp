@@ -1,4 +1,5 @@
 #include "DynamicTree.hpp"
+#include <algorithm>
 
 using namespace Break;
 using namespace Break::Infrastructure;
@@ -27,6 +28,8 @@ DynamicTree::DynamicTree()
 	m_path = 0;
 
 	m_insertionCount = 0;
+
+	m_revision = 0;
 }
 
 DynamicTree::~DynamicTree()
@@ -42,24 +45,7 @@ s32 DynamicTree::AllocateNode()
 	if (m_freeList == _nullNode)
 	{
 		assert(m_nodeCount == m_nodeCapacity);
-
-		// The free list is empty. Rebuild a bigger pool.
-		TreeNode* oldNodes = m_nodes;
-		m_nodeCapacity *= 2;
-		m_nodes = (TreeNode*)malloc(m_nodeCapacity * sizeof(TreeNode));
-		memcpy(m_nodes, oldNodes, m_nodeCount * sizeof(TreeNode));
-		free(oldNodes);
-
-		// Build a linked list for the free list. The parent
-		// pointer becomes the "next" pointer.
-		for (s32 i = m_nodeCount; i < m_nodeCapacity - 1; ++i)
-		{
-			m_nodes[i].next = i + 1;
-			m_nodes[i].height = -1;
-		}
-		m_nodes[m_nodeCapacity-1].next = _nullNode;
-		m_nodes[m_nodeCapacity-1].height = -1;
-		m_freeList = m_nodeCount;
+		Reserve(2 * m_nodeCapacity);
 	}
 
 	// Peel a node off the free list.
@@ -74,6 +60,34 @@ s32 DynamicTree::AllocateNode()
 	return nodeId;
 }
 
+// Grow the node pool and put the new nodes in front of the free list.
+void DynamicTree::Reserve(s32 capacity)
+{
+	if (capacity <= m_nodeCapacity)
+	{
+		return;
+	}
+
+	// Rebuild a bigger pool.
+	TreeNode* oldNodes = m_nodes;
+	s32 oldCapacity = m_nodeCapacity;
+	m_nodeCapacity = capacity;
+	m_nodes = (TreeNode*)malloc(m_nodeCapacity * sizeof(TreeNode));
+	memcpy(m_nodes, oldNodes, oldCapacity * sizeof(TreeNode));
+	free(oldNodes);
+
+	// Build a linked list for the free list. The parent
+	// pointer becomes the "next" pointer.
+	for (s32 i = oldCapacity; i < m_nodeCapacity - 1; ++i)
+	{
+		m_nodes[i].next = i + 1;
+		m_nodes[i].height = -1;
+	}
+	m_nodes[m_nodeCapacity-1].next = m_freeList;
+	m_nodes[m_nodeCapacity-1].height = -1;
+	m_freeList = oldCapacity;
+}
+
 // Return a node to the pool.
 void DynamicTree::FreeNode(s32 nodeId)
 {
@@ -105,6 +119,26 @@ s32 DynamicTree::CreateProxy(const AABB& aabb, void* userData)
 	return proxyId;
 }
 
+void DynamicTree::CreateProxies(const AABB* aabbs, void* const* userData, s32 count, s32* proxyIds)
+{
+	// The rebuilt tree has one internal node per leaf, less one.
+	Reserve(m_nodeCount + 2 * count);
+
+	glm::vec2 r(aabbExtension, aabbExtension);
+	for (s32 i = 0; i < count; ++i)
+	{
+		s32 proxyId = AllocateNode();
+		m_nodes[proxyId].aabb.lowerBound = aabbs[i].lowerBound - r;
+		m_nodes[proxyId].aabb.upperBound = aabbs[i].upperBound + r;
+		m_nodes[proxyId].userData = userData[i];
+		m_nodes[proxyId].height = 0;
+		proxyIds[i] = proxyId;
+	}
+
+	// The new leaves are not in the tree yet. The rebuild picks them up with the others.
+	RebuildTopDown();
+}
+
 void DynamicTree::DestroyProxy(s32 proxyId)
 {
 	assert(0 <= proxyId && proxyId < m_nodeCapacity);
@@ -160,9 +194,27 @@ bool DynamicTree::MoveProxy(s32 proxyId, const AABB& aabb, const glm::vec2& disp
 	return true;
 }
 
+void DynamicTree::SetFatAABB(s32 proxyId, const AABB& fatAABB)
+{
+	assert(0 <= proxyId && proxyId < m_nodeCapacity);
+
+	assert(m_nodes[proxyId].IsLeaf());
+
+	const AABB& aabb = m_nodes[proxyId].aabb;
+	if (aabb.lowerBound == fatAABB.lowerBound && aabb.upperBound == fatAABB.upperBound)
+	{
+		return;
+	}
+
+	RemoveLeaf(proxyId);
+	m_nodes[proxyId].aabb = fatAABB;
+	InsertLeaf(proxyId);
+}
+
 void DynamicTree::InsertLeaf(s32 leaf)
 {
 	++m_insertionCount;
+	++m_revision;
 
 	if (m_root == _nullNode)
 	{
@@ -302,6 +354,8 @@ void DynamicTree::InsertLeaf(s32 leaf)
 
 void DynamicTree::RemoveLeaf(s32 leaf)
 {
+	++m_revision;
+
 	if (leaf == m_root)
 	{
 		m_root = _nullNode;
@@ -751,9 +805,225 @@ void DynamicTree::RebuildBottomUp()
 	m_root = nodes[0];
 	free(nodes);
 
+	++m_revision;
+
 	Validate();
 }
 
+namespace
+{
+	const s32 buildBinCount = 16;
+
+	// Below this depth the tree is split at the median so that it stays
+	// balanced when the heuristic keeps peeling off a few leaves.
+	const s32 maxBuildDepth = 48;
+}
+
+struct DynamicTree::BuildLeaf
+{
+	glm::vec2 center;
+	s32 proxyId;
+};
+
+void DynamicTree::RebuildTopDown()
+{
+	if (m_nodeCount == 0)
+	{
+		return;
+	}
+
+	BuildLeaf* leaves = (BuildLeaf*)malloc(m_nodeCount * sizeof(BuildLeaf));
+	s32 count = 0;
+
+	// Build array of leaves. Free the rest.
+	for (s32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		if (m_nodes[i].height < 0)
+		{
+			// free node in pool
+			continue;
+		}
+
+		if (m_nodes[i].IsLeaf())
+		{
+			leaves[count].center = m_nodes[i].aabb.GetCenter();
+			leaves[count].proxyId = i;
+			++count;
+		}
+		else
+		{
+			FreeNode(i);
+		}
+	}
+
+	m_root = BuildTopDown(leaves, count, 0);
+	m_nodes[m_root].parent = _nullNode;
+	free(leaves);
+
+	++m_revision;
+}
+
+s32 DynamicTree::BuildTopDown(BuildLeaf* leaves, s32 count, s32 depth)
+{
+	if (count == 1)
+	{
+		return leaves[0].proxyId;
+	}
+
+	// Split along the longest axis of the leaf centers.
+	glm::vec2 lower = leaves[0].center;
+	glm::vec2 upper = leaves[0].center;
+	for (s32 i = 1; i < count; ++i)
+	{
+		lower = glm::min(lower, leaves[i].center);
+		upper = glm::max(upper, leaves[i].center);
+	}
+
+	glm::vec2 extent = upper - lower;
+	s32 axis = extent.x >= extent.y ? 0 : 1;
+
+	s32 splitCount = 0;
+	if (extent[axis] > 0.0f && depth < maxBuildDepth)
+	{
+		// Bin the leaves by center and take the bin boundary with the lowest
+		// perimeter times leaf count on both sides.
+		AABB binAABBs[buildBinCount];
+		s32 binCounts[buildBinCount];
+		for (s32 i = 0; i < buildBinCount; ++i)
+		{
+			binCounts[i] = 0;
+		}
+
+		real32 scale = buildBinCount / extent[axis];
+		for (s32 i = 0; i < count; ++i)
+		{
+			s32 bin = glm::min((s32)((leaves[i].center[axis] - lower[axis]) * scale), buildBinCount - 1);
+			const AABB& aabb = m_nodes[leaves[i].proxyId].aabb;
+			if (binCounts[bin] == 0)
+			{
+				binAABBs[bin] = aabb;
+			}
+			else
+			{
+				binAABBs[bin].Combine(aabb);
+			}
+			++binCounts[bin];
+		}
+
+		// Perimeter of everything right of each boundary.
+		real32 rightPerimeters[buildBinCount];
+		AABB rightAABB;
+		s32 rightCount = 0;
+		for (s32 i = buildBinCount - 1; i > 0; --i)
+		{
+			if (binCounts[i] > 0)
+			{
+				if (rightCount == 0)
+				{
+					rightAABB = binAABBs[i];
+				}
+				else
+				{
+					rightAABB.Combine(binAABBs[i]);
+				}
+				rightCount += binCounts[i];
+			}
+			rightPerimeters[i] = rightCount > 0 ? rightAABB.GetPerimeter() : 0.0f;
+		}
+
+		real32 bestCost = FLT_MAX;
+		s32 bestBin = -1;
+		AABB leftAABB;
+		s32 leftCount = 0;
+		for (s32 i = 0; i < buildBinCount - 1; ++i)
+		{
+			if (binCounts[i] > 0)
+			{
+				if (leftCount == 0)
+				{
+					leftAABB = binAABBs[i];
+				}
+				else
+				{
+					leftAABB.Combine(binAABBs[i]);
+				}
+				leftCount += binCounts[i];
+			}
+
+			if (leftCount == 0 || leftCount == count)
+			{
+				continue;
+			}
+
+			real32 cost = leftCount * leftAABB.GetPerimeter() + (count - leftCount) * rightPerimeters[i + 1];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestBin = i;
+			}
+		}
+
+		if (bestBin >= 0)
+		{
+			// Partition in place around the chosen boundary.
+			s32 i = 0;
+			s32 j = count - 1;
+			while (i <= j)
+			{
+				s32 bin = glm::min((s32)((leaves[i].center[axis] - lower[axis]) * scale), buildBinCount - 1);
+				if (bin <= bestBin)
+				{
+					++i;
+				}
+				else
+				{
+					BuildLeaf tmp = leaves[i];
+					leaves[i] = leaves[j];
+					leaves[j] = tmp;
+					--j;
+				}
+			}
+			splitCount = i;
+		}
+	}
+
+	if (splitCount == 0 || splitCount == count)
+	{
+		// Fall back to the median.
+		splitCount = count / 2;
+		if (extent[axis] > 0.0f)
+		{
+			struct CenterLess
+			{
+				s32 axis;
+				bool operator()(const BuildLeaf& a, const BuildLeaf& b) const
+				{
+					return a.center[axis] < b.center[axis];
+				}
+			};
+			CenterLess less;
+			less.axis = axis;
+			std::nth_element(leaves, leaves + splitCount, leaves + count, less);
+		}
+	}
+
+	s32 child1 = BuildTopDown(leaves, splitCount, depth + 1);
+	s32 child2 = BuildTopDown(leaves + splitCount, count - splitCount, depth + 1);
+
+	s32 parentIndex = AllocateNode();
+	TreeNode* parent = m_nodes + parentIndex;
+	parent->child1 = child1;
+	parent->child2 = child2;
+	parent->height = 1 + glm::max(m_nodes[child1].height, m_nodes[child2].height);
+	parent->aabb.Combine(m_nodes[child1].aabb, m_nodes[child2].aabb);
+	parent->parent = _nullNode;
+
+	m_nodes[child1].parent = parentIndex;
+	m_nodes[child2].parent = parentIndex;
+
+	return parentIndex;
+}
+
 void DynamicTree::ShiftOrigin(const glm::vec2& newOrigin)
 {
 	// Build array of leaves. Free the rest.
@@ -762,4 +1032,6 @@ void DynamicTree::ShiftOrigin(const glm::vec2& newOrigin)
 		m_nodes[i].aabb.lowerBound -= newOrigin;
 		m_nodes[i].aabb.upperBound -= newOrigin;
 	}
+
+	++m_revision;
 }
@@ -0,0 +1,37 @@
+#include "EdgeCapsuleContact.hpp"
+#include "BlockAllocator.hpp"
+#include "Fixture.hpp"
+#include "CapsuleShape.hpp"
+#include "EdgeShape.hpp"
+#include <new>
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+
+Contact* EdgeAndCapsuleContact::Create(Fixture* fixtureA, s32, Fixture* fixtureB, s32, BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(EdgeAndCapsuleContact));
+	return new (mem) EdgeAndCapsuleContact(fixtureA, fixtureB);
+}
+
+void EdgeAndCapsuleContact::Destroy(Contact* contact, BlockAllocator* allocator)
+{
+	((EdgeAndCapsuleContact*)contact)->~EdgeAndCapsuleContact();
+	allocator->Free(contact, sizeof(EdgeAndCapsuleContact));
+}
+
+EdgeAndCapsuleContact::EdgeAndCapsuleContact(Fixture* fixtureA, Fixture* fixtureB)
+	: Contact(fixtureA, 0, fixtureB, 0)
+{
+	assert(m_fixtureA->GetType() == Shape::edge);
+	assert(m_fixtureB->GetType() == Shape::capsule);
+}
+
+void EdgeAndCapsuleContact::Evaluate(Manifold* manifold, const Transform2D& xfA, const Transform2D& xfB)
+{
+	CollideEdgeAndCapsule(manifold,
+		(EdgeShape*)m_fixtureA->GetShape(), xfA,
+		(CapsuleShape*)m_fixtureB->GetShape(), xfB);
+}
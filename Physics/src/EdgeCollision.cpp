@@ -416,7 +416,7 @@ void EPCollider::Collide(Manifold* manifold, const EdgeShape* edgeA, const Trans
 		m_polygonB.normals[i] = Rotation2D::Mul(m_xf.q, polygonB->m_normals[i]);
 	}
 
-	m_radius = 2.0f * polygonRadius;
+	m_radius = edgeA->m_radius + polygonB->m_radius;
 
 	manifold->pointCount = 0;
 
@@ -99,6 +99,42 @@ bool EdgeShape::RayCast(RayCastOutput* output, const RayCastInput& input,const T
 	return true;
 }
 
+void EdgeShape::ComputeDistance(const Transform2D& xf, const glm::vec2& p, real32* distance, glm::vec2* normal, s32 childIndex) const
+{
+	NOT_USED(childIndex);
+
+	glm::vec2 v1 = Transform2D::Mul(xf, m_vertex1);
+	glm::vec2 v2 = Transform2D::Mul(xf, m_vertex2);
+
+	glm::vec2 d = p - v1;
+	glm::vec2 s = v2 - v1;
+	real32 ds = glm::dot(d, s);
+	if (ds > 0.0f)
+	{
+		real32 s2 = glm::dot(s, s);
+		if (ds > s2)
+		{
+			d = p - v2;
+		}
+		else
+		{
+			d -= (ds / s2) * s;
+		}
+	}
+
+	real32 length = glm::length(d);
+	*distance = length - m_radius;
+	if (length > FLT_EPSILON)
+	{
+		*normal = (1.0f / length) * d;
+	}
+	else
+	{
+		// On the edge, either side will do.
+		*normal = glm::normalize(glm::vec2(s.y, -s.x));
+	}
+}
+
 void EdgeShape::ComputeAABB(AABB* aabb, const Transform2D& xf, s32 childIndex) const
 {
 	NOT_USED(childIndex);
@@ -0,0 +1,125 @@
+#include "FixedStepDriver.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+
+
+FixedStepDriver::FixedStepDriver(World* world, const FixedStepDef* def)
+{
+	assert(def->timeStep > 0.0f);
+	assert(def->maxStepsPerUpdate > 0);
+
+	m_world = world;
+	m_def = *def;
+	m_accumulator = 0.0;
+	m_stepCount = 0;
+
+	m_previousCapacity = 0;
+	m_previous = NULL;
+	m_hasPrevious = false;
+}
+
+FixedStepDriver::~FixedStepDriver()
+{
+	free(m_previous);
+}
+
+s32 FixedStepDriver::Update(real64 frameTime)
+{
+	assert(frameTime >= 0.0);
+
+	m_accumulator += frameTime;
+
+	s32 stepCount = (s32)(m_accumulator / m_def.timeStep);
+	if (stepCount > m_def.maxStepsPerUpdate)
+	{
+		// Drop the time that cannot be caught up.
+		stepCount = m_def.maxStepsPerUpdate;
+		m_accumulator = stepCount * (real64)m_def.timeStep;
+	}
+
+	for (s32 i = 0; i < stepCount; ++i)
+	{
+		// Only the last step of an update is interpolated.
+		if (i == stepCount - 1)
+		{
+			RecordPrevious();
+		}
+
+		m_world->Step(m_def.timeStep, m_def.velocityIterations, m_def.positionIterations);
+		++m_stepCount;
+		m_accumulator -= m_def.timeStep;
+	}
+
+	if (m_accumulator < 0.0)
+	{
+		m_accumulator = 0.0;
+	}
+
+	return stepCount;
+}
+
+void FixedStepDriver::RecordPrevious()
+{
+	s32 count = m_world->GetAwakeBodyCount();
+	Body* const* bodies = m_world->GetAwakeBodies();
+	for (s32 i = 0; i < count; ++i)
+	{
+		const Body* b = bodies[i];
+		BodyHandle handle = b->GetHandle();
+
+		if (handle.index >= m_previousCapacity)
+		{
+			PreviousTransform* old = m_previous;
+			s32 oldCapacity = m_previousCapacity;
+			m_previousCapacity = glm::max(2 * m_previousCapacity, handle.index + 1);
+			m_previous = (PreviousTransform*)malloc(m_previousCapacity * sizeof(PreviousTransform));
+			memcpy(m_previous, old, oldCapacity * sizeof(PreviousTransform));
+			memset(m_previous + oldCapacity, 0, (m_previousCapacity - oldCapacity) * sizeof(PreviousTransform));
+			free(old);
+		}
+
+		PreviousTransform* previous = m_previous + handle.index;
+		previous->position = b->GetPosition();
+		previous->angle = b->GetAngle();
+		previous->generation = handle.generation;
+		previous->step = m_stepCount + 1;
+	}
+
+	m_hasPrevious = true;
+}
+
+Transform2D FixedStepDriver::GetInterpolatedTransform(const Body* body) const
+{
+	const Transform2D& xf = body->GetTransform2D();
+	if (m_hasPrevious == false)
+	{
+		return xf;
+	}
+
+	BodyHandle handle = body->GetHandle();
+	if (handle.index >= m_previousCapacity)
+	{
+		return xf;
+	}
+
+	const PreviousTransform* previous = m_previous + handle.index;
+	if (previous->step != m_stepCount || previous->generation != handle.generation)
+	{
+		return xf;
+	}
+
+	real32 alpha = GetAlpha();
+	Transform2D result;
+	result.Set((1.0f - alpha) * previous->position + alpha * xf.p,
+		(1.0f - alpha) * previous->angle + alpha * body->GetAngle());
+	return result;
+}
+
+void FixedStepDriver::Reset()
+{
+	m_accumulator = 0.0;
+	m_hasPrevious = false;
+}
@@ -5,9 +5,12 @@
 #include "EdgeShape.hpp"
 #include "PolygonShape.hpp"
 #include "ChainShape.hpp"
-#include "BroadPhase.hpp"
+#include "MeshShape.hpp"
+#include "CapsuleShape.hpp"
+#include "IBroadPhase.hpp"
 #include "Collision.hpp"
 #include "BlockAllocator.hpp"
+#include <cstdio>
 
 
 using namespace Break;
@@ -22,6 +25,7 @@ Fixture::Fixture()
 	m_next = NULL;
 	m_proxies = NULL;
 	m_proxyCount = 0;
+	m_overlapList = -1;
 	m_shape = NULL;
 	m_density = 0.0f;
 }
@@ -47,17 +51,19 @@ void Fixture::Create(BlockAllocator* allocator, Body* body, const FixtureDef* de
 	for (s32 i = 0; i < childCount; ++i)
 	{
 		m_proxies[i].fixture = NULL;
-		m_proxies[i].proxyId = BroadPhase::nullProxy;
+		m_proxies[i].proxyId = IBroadPhase::nullProxy;
 	}
 	m_proxyCount = 0;
+	m_overlapList = -1;
 
 	m_density = def->density;
 }
 
 void Fixture::Destroy(BlockAllocator* allocator)
 {
-	// The proxies must be destroyed before calling this.
+	// The proxies and the sensor overlaps must be destroyed before calling this.
 	assert(m_proxyCount == 0);
+	assert(m_overlapList == -1);
 
 	// Free the proxy array.
 	s32 childCount = m_shape->GetChildCount();
@@ -99,6 +105,22 @@ void Fixture::Destroy(BlockAllocator* allocator)
 		}
 		break;
 
+	case Shape::mesh:
+		{
+			MeshShape* s = (MeshShape*)m_shape;
+			s->~MeshShape();
+			allocator->Free(s, sizeof(MeshShape));
+		}
+		break;
+
+	case Shape::capsule:
+		{
+			CapsuleShape* s = (CapsuleShape*)m_shape;
+			s->~CapsuleShape();
+			allocator->Free(s, sizeof(CapsuleShape));
+		}
+		break;
+
 	default:
 		assert(false);
 		break;
@@ -107,7 +129,7 @@ void Fixture::Destroy(BlockAllocator* allocator)
 	m_shape = NULL;
 }
 
-void Fixture::CreateProxies(BroadPhase* broadPhase, const Transform2D& xf)
+void Fixture::CreateProxies(IBroadPhase* broadPhase, const Transform2D& xf)
 {
 	assert(m_proxyCount == 0);
 
@@ -124,20 +146,20 @@ void Fixture::CreateProxies(BroadPhase* broadPhase, const Transform2D& xf)
 	}
 }
 
-void Fixture::DestroyProxies(BroadPhase* broadPhase)
+void Fixture::DestroyProxies(IBroadPhase* broadPhase)
 {
 	// Destroy proxies in the broad-phase.
 	for (s32 i = 0; i < m_proxyCount; ++i)
 	{
 		FixtureProxy* proxy = m_proxies + i;
 		broadPhase->DestroyProxy(proxy->proxyId);
-		proxy->proxyId = BroadPhase::nullProxy;
+		proxy->proxyId = IBroadPhase::nullProxy;
 	}
 
 	m_proxyCount = 0;
 }
 
-void Fixture::Synchronize(BroadPhase* broadPhase, const Transform2D& Transform2D1, const Transform2D& Transform2D2)
+void Fixture::Synchronize(IBroadPhase* broadPhase, const Transform2D& Transform2D1, const Transform2D& Transform2D2)
 {
 	if (m_proxyCount == 0)
 	{	
@@ -159,6 +181,14 @@ void Fixture::Synchronize(BroadPhase* broadPhase, const Transform2D& Transform2D
 
 		broadPhase->MoveProxy(proxy->proxyId, proxy->aabb, displacement);
 	}
+
+	// The elements of a mesh or chain move with the body even while the proxy
+	// stays inside its fat AABB. Report the proxy's pairs again so the contact
+	// manager queries the element tree at the new Transform2D.
+	if (m_shape->GetElementTree())
+	{
+		broadPhase->TouchProxy(m_proxies[0].proxyId);
+	}
 }
 
 void Fixture::SetFilterData(const Filter& filter)
@@ -197,8 +227,11 @@ void Fixture::Refilter()
 		return;
 	}
 
+	// Sensor overlaps are filtered whether or not their bodies are awake.
+	world->m_contactManager.FlagOverlapsForFiltering(this);
+
 	// Touch each proxy so that new pairs may be created
-	BroadPhase* broadPhase = &world->m_contactManager.m_broadPhase;
+	IBroadPhase* broadPhase = world->m_contactManager.m_broadPhase;
 	for (s32 i = 0; i < m_proxyCount; ++i)
 	{
 		broadPhase->TouchProxy(m_proxies[i].proxyId);
@@ -211,6 +244,10 @@ void Fixture::SetSensor(bool sensor)
 	{
 		m_body->SetAwake(true);
 		m_isSensor = sensor;
+
+		// Filtering drops the contacts that now have a sensor and the overlaps
+		// that no longer do, and the touched proxies create the replacements.
+		Refilter();
 	}
 }
 
@@ -280,6 +317,15 @@ void Fixture::Dump(s32 bodyIndex)
 		}
 		break;
 
+	case Shape::capsule:
+		{
+			CapsuleShape* s = (CapsuleShape*)m_shape;
+			printf("    CapsuleShape shape;\n");
+			printf("    shape.Set(glm::vec2(%.15lef, %.15lef), glm::vec2(%.15lef, %.15lef), %.15lef);\n",
+				s->m_vertex1.x, s->m_vertex1.y, s->m_vertex2.x, s->m_vertex2.y, s->m_radius);
+		}
+		break;
+
 	default:
 		return;
 	}
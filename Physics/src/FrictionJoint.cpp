@@ -240,3 +240,17 @@ void FrictionJoint::Dump()
 	printf("  jd.maxTorque = %.15lef;\n", m_maxTorque);
 	printf("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+void FrictionJoint::SaveState(JointState* state) const
+{
+	state->values[0] = m_linearImpulse.x;
+	state->values[1] = m_linearImpulse.y;
+	state->values[2] = m_angularImpulse;
+}
+
+void FrictionJoint::LoadState(const JointState* state)
+{
+	m_linearImpulse.x = state->values[0];
+	m_linearImpulse.y = state->values[1];
+	m_angularImpulse = state->values[2];
+}
@@ -405,3 +405,13 @@ void GearJoint::Dump()
 	printf("  jd.ratio = %.15lef;\n", m_ratio);
 	printf("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+void GearJoint::SaveState(JointState* state) const
+{
+	state->values[0] = m_impulse;
+}
+
+void GearJoint::LoadState(const JointState* state)
+{
+	m_impulse = state->values[0];
+}
@@ -0,0 +1,557 @@
+#include "JointSolver.hpp"
+#include "Joint2D.hpp"
+#include "RevoluteJoint.hpp"
+#include "DistanceJoint.hpp"
+#include "StackAllocator.hpp"
+#include "Simd.hpp"
+#include <memory.h>
+
+using namespace Break;
+using namespace Break::Physics;
+
+
+// Four revolute point-to-point constraints in lanes. Unused lanes have zero
+// mass and are never written back.
+struct Physics::RevoluteBundle
+{
+	RevoluteJoint* joints[jointBundleWidth];
+	s32 count;
+	s32 indexA[jointBundleWidth];
+	s32 indexB[jointBundleWidth];
+	real32 rAx[jointBundleWidth], rAy[jointBundleWidth];
+	real32 rBx[jointBundleWidth], rBy[jointBundleWidth];
+	real32 mA[jointBundleWidth], mB[jointBundleWidth];
+	real32 iA[jointBundleWidth], iB[jointBundleWidth];
+
+	// The 2x2 block of the effective mass and the inverse of its determinant.
+	real32 a11[jointBundleWidth], a12[jointBundleWidth];
+	real32 a21[jointBundleWidth], a22[jointBundleWidth];
+	real32 invDet[jointBundleWidth];
+
+	real32 impulseX[jointBundleWidth], impulseY[jointBundleWidth];
+};
+
+// Four distance constraints in lanes.
+struct Physics::DistanceBundle
+{
+	DistanceJoint* joints[jointBundleWidth];
+	s32 count;
+	s32 indexA[jointBundleWidth];
+	s32 indexB[jointBundleWidth];
+	real32 rAx[jointBundleWidth], rAy[jointBundleWidth];
+	real32 rBx[jointBundleWidth], rBy[jointBundleWidth];
+	real32 ux[jointBundleWidth], uy[jointBundleWidth];
+	real32 mA[jointBundleWidth], mB[jointBundleWidth];
+	real32 iA[jointBundleWidth], iB[jointBundleWidth];
+
+	// Negated effective mass, so the lanes multiply like the scalar solver.
+	real32 negMass[jointBundleWidth];
+	real32 bias[jointBundleWidth];
+	real32 gamma[jointBundleWidth];
+	real32 impulse[jointBundleWidth];
+};
+
+namespace
+{
+	// The upper bound of bundles for count joints: each color leaves at most one
+	// partial bundle.
+	s32 GetBundleCapacity(s32 count)
+	{
+		return count > 0 ? count / jointBundleWidth + jointColorCount : 0;
+	}
+
+	// Greedy coloring. bodiesA and bodiesB hold island indices, or -1 for bodies
+	// the solver does not move, which may be shared freely. Joints that find no
+	// free color get -1.
+	void ColorJoints(const s32* bodiesA, const s32* bodiesB, s32 count, s32 bodyCount,
+		s32* colors, StackAllocator* allocator)
+	{
+		s32 wordCount = (bodyCount + 31) >> 5;
+		u32* used = (u32*)allocator->Allocate(jointColorCount * wordCount * sizeof(u32));
+		memset(used, 0, jointColorCount * wordCount * sizeof(u32));
+
+		for (s32 i = 0; i < count; ++i)
+		{
+			s32 a = bodiesA[i];
+			s32 b = bodiesB[i];
+			colors[i] = -1;
+
+			for (s32 c = 0; c < jointColorCount; ++c)
+			{
+				u32* bits = used + c * wordCount;
+				if (a >= 0 && (bits[a >> 5] & (1u << (a & 31))))
+				{
+					continue;
+				}
+
+				if (b >= 0 && (bits[b >> 5] & (1u << (b & 31))))
+				{
+					continue;
+				}
+
+				if (a >= 0)
+				{
+					bits[a >> 5] |= 1u << (a & 31);
+				}
+
+				if (b >= 0)
+				{
+					bits[b >> 5] |= 1u << (b & 31);
+				}
+
+				colors[i] = c;
+				break;
+			}
+		}
+
+		allocator->Free(used);
+	}
+
+	// Gather the velocities of the bodies of a bundle into lanes.
+	void GatherVelocities(const Velocity* velocities, const s32* indices, s32 count,
+		Float4* vx, Float4* vy, Float4* w)
+	{
+		real32 x[jointBundleWidth], y[jointBundleWidth], a[jointBundleWidth];
+		for (s32 lane = 0; lane < jointBundleWidth; ++lane)
+		{
+			// Unused lanes read the first body and are never stored.
+			const Velocity& v = velocities[indices[lane < count ? lane : 0]];
+			x[lane] = v.v.x;
+			y[lane] = v.v.y;
+			a[lane] = v.w;
+		}
+
+		*vx = Float4::Load(x);
+		*vy = Float4::Load(y);
+		*w = Float4::Load(a);
+	}
+
+	void ScatterVelocities(Velocity* velocities, const s32* indices, s32 count,
+		const Float4& vx, const Float4& vy, const Float4& w)
+	{
+		real32 x[jointBundleWidth], y[jointBundleWidth], a[jointBundleWidth];
+		vx.Store(x);
+		vy.Store(y);
+		w.Store(a);
+
+		for (s32 lane = 0; lane < count; ++lane)
+		{
+			Velocity& v = velocities[indices[lane]];
+			v.v.x = x[lane];
+			v.v.y = y[lane];
+			v.w = a[lane];
+		}
+	}
+
+	// The island index of a body the solver moves, -1 for static and kinematic bodies.
+	s32 GetColorIndex(s32 index, real32 invMass, real32 invI)
+	{
+		return invMass == 0.0f && invI == 0.0f ? -1 : index;
+	}
+}
+
+JointSolver::JointSolver(JointSolverDef* def)
+{
+	m_step = def->step;
+	m_positions = def->positions;
+	m_velocities = def->velocities;
+	m_allocator = def->allocator;
+	m_joints = def->joints;
+	m_count = def->count;
+	m_bodyCount = def->bodyCount;
+
+	m_scalarJoints = (Joint**)m_allocator->Allocate(m_count * sizeof(Joint*));
+	m_revoluteJoints = (RevoluteJoint**)m_allocator->Allocate(m_count * sizeof(RevoluteJoint*));
+	m_distanceJoints = (DistanceJoint**)m_allocator->Allocate(m_count * sizeof(DistanceJoint*));
+	m_revoluteBundles = (RevoluteBundle*)m_allocator->Allocate(GetBundleCapacity(m_count) * sizeof(RevoluteBundle));
+	m_distanceBundles = (DistanceBundle*)m_allocator->Allocate(GetBundleCapacity(m_count) * sizeof(DistanceBundle));
+
+	m_scalarCount = 0;
+	m_revoluteCount = 0;
+	m_distanceCount = 0;
+	m_revoluteBundleCount = 0;
+	m_distanceBundleCount = 0;
+}
+
+JointSolver::~JointSolver()
+{
+	m_allocator->Free(m_distanceBundles);
+	m_allocator->Free(m_revoluteBundles);
+	m_allocator->Free(m_distanceJoints);
+	m_allocator->Free(m_revoluteJoints);
+	m_allocator->Free(m_scalarJoints);
+}
+
+void JointSolver::InitializeVelocityConstraints()
+{
+	SolverData data;
+	data.step = m_step;
+	data.positions = m_positions;
+	data.velocities = m_velocities;
+
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		Joint* joint = m_joints[i];
+		joint->InitVelocityConstraints(data);
+
+		if (m_step.batchJoints == false)
+		{
+			m_scalarJoints[m_scalarCount++] = joint;
+			continue;
+		}
+
+		switch (joint->m_type)
+		{
+		case revoluteJoint:
+			{
+				// Only the point-to-point constraint is batched.
+				RevoluteJoint* revolute = (RevoluteJoint*)joint;
+				if (revolute->m_enableLimit == false && revolute->m_enableMotor == false)
+				{
+					m_revoluteJoints[m_revoluteCount++] = revolute;
+				}
+				else
+				{
+					m_scalarJoints[m_scalarCount++] = joint;
+				}
+			}
+			break;
+
+		case distanceJoint:
+			m_distanceJoints[m_distanceCount++] = (DistanceJoint*)joint;
+			break;
+
+		default:
+			m_scalarJoints[m_scalarCount++] = joint;
+			break;
+		}
+	}
+
+	BuildRevoluteBundles();
+	BuildDistanceBundles();
+}
+
+void JointSolver::BuildRevoluteBundles()
+{
+	s32 count = m_revoluteCount;
+	if (count == 0)
+	{
+		return;
+	}
+
+	s32* bodiesA = (s32*)m_allocator->Allocate(3 * count * sizeof(s32));
+	s32* bodiesB = bodiesA + count;
+	s32* colors = bodiesB + count;
+	for (s32 i = 0; i < count; ++i)
+	{
+		RevoluteJoint* joint = m_revoluteJoints[i];
+		bodiesA[i] = GetColorIndex(joint->m_indexA, joint->m_invMassA, joint->m_invIA);
+		bodiesB[i] = GetColorIndex(joint->m_indexB, joint->m_invMassB, joint->m_invIB);
+	}
+
+	ColorJoints(bodiesA, bodiesB, count, m_bodyCount, colors, m_allocator);
+
+	// Joints without a color go to the scalar solver.
+	for (s32 i = 0; i < count; ++i)
+	{
+		if (colors[i] == -1)
+		{
+			m_scalarJoints[m_scalarCount++] = m_revoluteJoints[i];
+		}
+	}
+
+	for (s32 c = 0; c < jointColorCount; ++c)
+	{
+		RevoluteBundle* bundle = NULL;
+		for (s32 i = 0; i < count; ++i)
+		{
+			if (colors[i] != c)
+			{
+				continue;
+			}
+
+			if (bundle == NULL || bundle->count == jointBundleWidth)
+			{
+				bundle = m_revoluteBundles + m_revoluteBundleCount;
+				++m_revoluteBundleCount;
+				memset(bundle, 0, sizeof(RevoluteBundle));
+			}
+
+			RevoluteJoint* joint = m_revoluteJoints[i];
+			s32 lane = bundle->count;
+			bundle->joints[lane] = joint;
+			bundle->indexA[lane] = joint->m_indexA;
+			bundle->indexB[lane] = joint->m_indexB;
+			bundle->rAx[lane] = joint->m_rA.x;
+			bundle->rAy[lane] = joint->m_rA.y;
+			bundle->rBx[lane] = joint->m_rB.x;
+			bundle->rBy[lane] = joint->m_rB.y;
+			bundle->mA[lane] = joint->m_invMassA;
+			bundle->mB[lane] = joint->m_invMassB;
+			bundle->iA[lane] = joint->m_invIA;
+			bundle->iB[lane] = joint->m_invIB;
+
+			// Same layout as MathUtils::SolveEq2.
+			real32 a11 = joint->m_mass[0][0], a12 = joint->m_mass[1][0];
+			real32 a21 = joint->m_mass[0][1], a22 = joint->m_mass[1][1];
+			real32 det = a11 * a22 - a12 * a21;
+			if (det != 0.0f)
+			{
+				det = 1.0f / det;
+			}
+			bundle->a11[lane] = a11;
+			bundle->a12[lane] = a12;
+			bundle->a21[lane] = a21;
+			bundle->a22[lane] = a22;
+			bundle->invDet[lane] = det;
+
+			bundle->impulseX[lane] = joint->m_impulse.x;
+			bundle->impulseY[lane] = joint->m_impulse.y;
+			++bundle->count;
+		}
+	}
+
+	// Keep the bundled joints in bundle order for the position solver.
+	m_revoluteCount = 0;
+	for (s32 i = 0; i < m_revoluteBundleCount; ++i)
+	{
+		const RevoluteBundle* bundle = m_revoluteBundles + i;
+		for (s32 lane = 0; lane < bundle->count; ++lane)
+		{
+			m_revoluteJoints[m_revoluteCount++] = bundle->joints[lane];
+		}
+	}
+
+	m_allocator->Free(bodiesA);
+}
+
+void JointSolver::BuildDistanceBundles()
+{
+	s32 count = m_distanceCount;
+	if (count == 0)
+	{
+		return;
+	}
+
+	s32* bodiesA = (s32*)m_allocator->Allocate(3 * count * sizeof(s32));
+	s32* bodiesB = bodiesA + count;
+	s32* colors = bodiesB + count;
+	for (s32 i = 0; i < count; ++i)
+	{
+		DistanceJoint* joint = m_distanceJoints[i];
+		bodiesA[i] = GetColorIndex(joint->m_indexA, joint->m_invMassA, joint->m_invIA);
+		bodiesB[i] = GetColorIndex(joint->m_indexB, joint->m_invMassB, joint->m_invIB);
+	}
+
+	ColorJoints(bodiesA, bodiesB, count, m_bodyCount, colors, m_allocator);
+
+	for (s32 i = 0; i < count; ++i)
+	{
+		if (colors[i] == -1)
+		{
+			m_scalarJoints[m_scalarCount++] = m_distanceJoints[i];
+		}
+	}
+
+	for (s32 c = 0; c < jointColorCount; ++c)
+	{
+		DistanceBundle* bundle = NULL;
+		for (s32 i = 0; i < count; ++i)
+		{
+			if (colors[i] != c)
+			{
+				continue;
+			}
+
+			if (bundle == NULL || bundle->count == jointBundleWidth)
+			{
+				bundle = m_distanceBundles + m_distanceBundleCount;
+				++m_distanceBundleCount;
+				memset(bundle, 0, sizeof(DistanceBundle));
+			}
+
+			DistanceJoint* joint = m_distanceJoints[i];
+			s32 lane = bundle->count;
+			bundle->joints[lane] = joint;
+			bundle->indexA[lane] = joint->m_indexA;
+			bundle->indexB[lane] = joint->m_indexB;
+			bundle->rAx[lane] = joint->m_rA.x;
+			bundle->rAy[lane] = joint->m_rA.y;
+			bundle->rBx[lane] = joint->m_rB.x;
+			bundle->rBy[lane] = joint->m_rB.y;
+			bundle->ux[lane] = joint->m_u.x;
+			bundle->uy[lane] = joint->m_u.y;
+			bundle->mA[lane] = joint->m_invMassA;
+			bundle->mB[lane] = joint->m_invMassB;
+			bundle->iA[lane] = joint->m_invIA;
+			bundle->iB[lane] = joint->m_invIB;
+			bundle->negMass[lane] = -joint->m_mass;
+			bundle->bias[lane] = joint->m_bias;
+			bundle->gamma[lane] = joint->m_gamma;
+			bundle->impulse[lane] = joint->m_impulse;
+			++bundle->count;
+		}
+	}
+
+	// Keep the bundled joints in bundle order for the position solver.
+	m_distanceCount = 0;
+	for (s32 i = 0; i < m_distanceBundleCount; ++i)
+	{
+		const DistanceBundle* bundle = m_distanceBundles + i;
+		for (s32 lane = 0; lane < bundle->count; ++lane)
+		{
+			m_distanceJoints[m_distanceCount++] = bundle->joints[lane];
+		}
+	}
+
+	m_allocator->Free(bodiesA);
+}
+
+void JointSolver::SolveVelocityConstraints()
+{
+	if (m_scalarCount > 0)
+	{
+		SolverData data;
+		data.step = m_step;
+		data.positions = m_positions;
+		data.velocities = m_velocities;
+
+		for (s32 i = 0; i < m_scalarCount; ++i)
+		{
+			m_scalarJoints[i]->SolveVelocityConstraints(data);
+		}
+	}
+
+	// The lanes follow RevoluteJoint::SolveVelocityConstraints operation by operation.
+	for (s32 i = 0; i < m_revoluteBundleCount; ++i)
+	{
+		RevoluteBundle* b = m_revoluteBundles + i;
+
+		Float4 vAx, vAy, wA, vBx, vBy, wB;
+		GatherVelocities(m_velocities, b->indexA, b->count, &vAx, &vAy, &wA);
+		GatherVelocities(m_velocities, b->indexB, b->count, &vBx, &vBy, &wB);
+
+		Float4 rAx = Float4::Load(b->rAx), rAy = Float4::Load(b->rAy);
+		Float4 rBx = Float4::Load(b->rBx), rBy = Float4::Load(b->rBy);
+
+		// Cdot = vB + cross(wB, rB) - vA - cross(wA, rA)
+		Float4 cdotX = ((vBx - wB * rBy) - vAx) + wA * rAy;
+		Float4 cdotY = ((vBy + wB * rBx) - vAy) - wA * rAx;
+
+		// impulse = solve(K, -Cdot)
+		Float4 invDet = Float4::Load(b->invDet);
+		Float4 a11 = Float4::Load(b->a11), a12 = Float4::Load(b->a12);
+		Float4 a21 = Float4::Load(b->a21), a22 = Float4::Load(b->a22);
+		Float4 impulseX = invDet * (a12 * cdotY - a22 * cdotX);
+		Float4 impulseY = invDet * (a21 * cdotX - a11 * cdotY);
+
+		(Float4::Load(b->impulseX) + impulseX).Store(b->impulseX);
+		(Float4::Load(b->impulseY) + impulseY).Store(b->impulseY);
+
+		Float4 mA = Float4::Load(b->mA), mB = Float4::Load(b->mB);
+		Float4 iA = Float4::Load(b->iA), iB = Float4::Load(b->iB);
+
+		vAx = vAx - mA * impulseX;
+		vAy = vAy - mA * impulseY;
+		wA = wA - iA * (rAx * impulseY - rAy * impulseX);
+
+		vBx = vBx + mB * impulseX;
+		vBy = vBy + mB * impulseY;
+		wB = wB + iB * (rBx * impulseY - rBy * impulseX);
+
+		ScatterVelocities(m_velocities, b->indexA, b->count, vAx, vAy, wA);
+		ScatterVelocities(m_velocities, b->indexB, b->count, vBx, vBy, wB);
+	}
+
+	// The lanes follow DistanceJoint::SolveVelocityConstraints operation by operation.
+	for (s32 i = 0; i < m_distanceBundleCount; ++i)
+	{
+		DistanceBundle* b = m_distanceBundles + i;
+
+		Float4 vAx, vAy, wA, vBx, vBy, wB;
+		GatherVelocities(m_velocities, b->indexA, b->count, &vAx, &vAy, &wA);
+		GatherVelocities(m_velocities, b->indexB, b->count, &vBx, &vBy, &wB);
+
+		Float4 rAx = Float4::Load(b->rAx), rAy = Float4::Load(b->rAy);
+		Float4 rBx = Float4::Load(b->rBx), rBy = Float4::Load(b->rBy);
+		Float4 ux = Float4::Load(b->ux), uy = Float4::Load(b->uy);
+
+		// Cdot = dot(u, vB + cross(wB, rB) - vA - cross(wA, rA))
+		Float4 vpAx = vAx - wA * rAy, vpAy = vAy + wA * rAx;
+		Float4 vpBx = vBx - wB * rBy, vpBy = vBy + wB * rBx;
+		Float4 cdot = ux * (vpBx - vpAx) + uy * (vpBy - vpAy);
+
+		Float4 accumulated = Float4::Load(b->impulse);
+		Float4 impulse = Float4::Load(b->negMass) * ((cdot + Float4::Load(b->bias)) + Float4::Load(b->gamma) * accumulated);
+		(accumulated + impulse).Store(b->impulse);
+
+		Float4 Px = impulse * ux;
+		Float4 Py = impulse * uy;
+
+		Float4 mA = Float4::Load(b->mA), mB = Float4::Load(b->mB);
+		Float4 iA = Float4::Load(b->iA), iB = Float4::Load(b->iB);
+
+		vAx = vAx - mA * Px;
+		vAy = vAy - mA * Py;
+		wA = wA - iA * (rAx * Py - rAy * Px);
+
+		vBx = vBx + mB * Px;
+		vBy = vBy + mB * Py;
+		wB = wB + iB * (rBx * Py - rBy * Px);
+
+		ScatterVelocities(m_velocities, b->indexA, b->count, vAx, vAy, wA);
+		ScatterVelocities(m_velocities, b->indexB, b->count, vBx, vBy, wB);
+	}
+}
+
+void JointSolver::StoreImpulses()
+{
+	for (s32 i = 0; i < m_revoluteBundleCount; ++i)
+	{
+		const RevoluteBundle* b = m_revoluteBundles + i;
+		for (s32 lane = 0; lane < b->count; ++lane)
+		{
+			b->joints[lane]->m_impulse.x = b->impulseX[lane];
+			b->joints[lane]->m_impulse.y = b->impulseY[lane];
+		}
+	}
+
+	for (s32 i = 0; i < m_distanceBundleCount; ++i)
+	{
+		const DistanceBundle* b = m_distanceBundles + i;
+		for (s32 lane = 0; lane < b->count; ++lane)
+		{
+			b->joints[lane]->m_impulse = b->impulse[lane];
+		}
+	}
+}
+
+bool JointSolver::SolvePositionConstraints()
+{
+	SolverData data;
+	data.step = m_step;
+	data.positions = m_positions;
+	data.velocities = m_velocities;
+
+	bool jointsOkay = true;
+	for (s32 i = 0; i < m_scalarCount; ++i)
+	{
+		bool jointOkay = m_scalarJoints[i]->SolvePositionConstraints(data);
+		jointsOkay = jointsOkay && jointOkay;
+	}
+
+	// The batched types are called directly, without the virtual dispatch.
+	for (s32 i = 0; i < m_revoluteCount; ++i)
+	{
+		bool jointOkay = m_revoluteJoints[i]->RevoluteJoint::SolvePositionConstraints(data);
+		jointsOkay = jointsOkay && jointOkay;
+	}
+
+	for (s32 i = 0; i < m_distanceCount; ++i)
+	{
+		bool jointOkay = m_distanceJoints[i]->DistanceJoint::SolvePositionConstraints(data);
+		jointsOkay = jointsOkay && jointOkay;
+	}
+
+	return jointsOkay;
+}
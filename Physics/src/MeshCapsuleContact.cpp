@@ -0,0 +1,51 @@
+#include "MeshCapsuleContact.hpp"
+#include "BlockAllocator.hpp"
+#include "Fixture.hpp"
+#include "CapsuleShape.hpp"
+#include "MeshShape.hpp"
+#include "EdgeShape.hpp"
+#include "PolygonShape.hpp"
+#include <new>
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+
+Contact* MeshAndCapsuleContact::Create(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB, BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(MeshAndCapsuleContact));
+	return new (mem) MeshAndCapsuleContact(fixtureA, indexA, fixtureB, indexB);
+}
+
+void MeshAndCapsuleContact::Destroy(Contact* contact, BlockAllocator* allocator)
+{
+	((MeshAndCapsuleContact*)contact)->~MeshAndCapsuleContact();
+	allocator->Free(contact, sizeof(MeshAndCapsuleContact));
+}
+
+MeshAndCapsuleContact::MeshAndCapsuleContact(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB)
+	: Contact(fixtureA, indexA, fixtureB, indexB)
+{
+	assert(m_fixtureA->GetType() == Shape::mesh);
+	assert(m_fixtureB->GetType() == Shape::capsule);
+}
+
+void MeshAndCapsuleContact::Evaluate(Manifold* manifold, const Transform2D& xfA, const Transform2D& xfB)
+{
+	MeshShape* mesh = (MeshShape*)m_fixtureA->GetShape();
+	if (mesh->GetElement(m_indexA).flags & MeshElement::edgeFlag)
+	{
+		EdgeShape edge;
+		mesh->GetChildEdge(&edge, m_indexA);
+		CollideEdgeAndCapsule(manifold, &edge, xfA,
+			(CapsuleShape*)m_fixtureB->GetShape(), xfB);
+	}
+	else
+	{
+		PolygonShape polygon;
+		mesh->GetChildPolygon(&polygon, m_indexA);
+		CollidePolygonAndCapsule(manifold, &m_separationCache, &polygon, xfA,
+			(CapsuleShape*)m_fixtureB->GetShape(), xfB);
+	}
+}
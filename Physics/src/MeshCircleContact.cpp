@@ -0,0 +1,50 @@
+#include "MeshCircleContact.hpp"
+#include "BlockAllocator.hpp"
+#include "Fixture.hpp"
+#include "MeshShape.hpp"
+#include "EdgeShape.hpp"
+#include "PolygonShape.hpp"
+#include <new>
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+
+Contact* MeshAndCircleContact::Create(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB, BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(MeshAndCircleContact));
+	return new (mem) MeshAndCircleContact(fixtureA, indexA, fixtureB, indexB);
+}
+
+void MeshAndCircleContact::Destroy(Contact* contact, BlockAllocator* allocator)
+{
+	((MeshAndCircleContact*)contact)->~MeshAndCircleContact();
+	allocator->Free(contact, sizeof(MeshAndCircleContact));
+}
+
+MeshAndCircleContact::MeshAndCircleContact(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB)
+	: Contact(fixtureA, indexA, fixtureB, indexB)
+{
+	assert(m_fixtureA->GetType() == Shape::mesh);
+	assert(m_fixtureB->GetType() == Shape::circle);
+}
+
+void MeshAndCircleContact::Evaluate(Manifold* manifold, const Transform2D& xfA, const Transform2D& xfB)
+{
+	MeshShape* mesh = (MeshShape*)m_fixtureA->GetShape();
+	if (mesh->GetElement(m_indexA).flags & MeshElement::edgeFlag)
+	{
+		EdgeShape edge;
+		mesh->GetChildEdge(&edge, m_indexA);
+		CollideEdgeAndCircle(manifold, &edge, xfA,
+			(CircleShape*)m_fixtureB->GetShape(), xfB);
+	}
+	else
+	{
+		PolygonShape polygon;
+		mesh->GetChildPolygon(&polygon, m_indexA);
+		CollidePolygonAndCircle(manifold, &polygon, xfA,
+			(CircleShape*)m_fixtureB->GetShape(), xfB);
+	}
+}
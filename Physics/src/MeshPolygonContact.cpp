@@ -0,0 +1,50 @@
+#include "MeshPolygonContact.hpp"
+#include "BlockAllocator.hpp"
+#include "Fixture.hpp"
+#include "MeshShape.hpp"
+#include "EdgeShape.hpp"
+#include "PolygonShape.hpp"
+#include <new>
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+
+Contact* MeshAndPolygonContact::Create(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB, BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(MeshAndPolygonContact));
+	return new (mem) MeshAndPolygonContact(fixtureA, indexA, fixtureB, indexB);
+}
+
+void MeshAndPolygonContact::Destroy(Contact* contact, BlockAllocator* allocator)
+{
+	((MeshAndPolygonContact*)contact)->~MeshAndPolygonContact();
+	allocator->Free(contact, sizeof(MeshAndPolygonContact));
+}
+
+MeshAndPolygonContact::MeshAndPolygonContact(Fixture* fixtureA, s32 indexA, Fixture* fixtureB, s32 indexB)
+	: Contact(fixtureA, indexA, fixtureB, indexB)
+{
+	assert(m_fixtureA->GetType() == Shape::mesh);
+	assert(m_fixtureB->GetType() == Shape::polygon);
+}
+
+void MeshAndPolygonContact::Evaluate(Manifold* manifold, const Transform2D& xfA, const Transform2D& xfB)
+{
+	MeshShape* mesh = (MeshShape*)m_fixtureA->GetShape();
+	if (mesh->GetElement(m_indexA).flags & MeshElement::edgeFlag)
+	{
+		EdgeShape edge;
+		mesh->GetChildEdge(&edge, m_indexA);
+		CollideEdgeAndPolygon(manifold, &edge, xfA,
+			(PolygonShape*)m_fixtureB->GetShape(), xfB);
+	}
+	else
+	{
+		PolygonShape polygon;
+		mesh->GetChildPolygon(&polygon, m_indexA);
+		CollidePolygons(manifold, &m_separationCache, &polygon, xfA,
+			(PolygonShape*)m_fixtureB->GetShape(), xfB);
+	}
+}
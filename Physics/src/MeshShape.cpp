@@ -0,0 +1,407 @@
+#include "MeshShape.hpp"
+#include "EdgeShape.hpp"
+#include "PolygonShape.hpp"
+#include "ChainShape.hpp"
+#include <new>
+#include <memory.h>
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+
+MeshShape::MeshShape()
+{
+	m_type = mesh;
+	m_radius = polygonRadius;
+	m_vertices = NULL;
+	m_normals = NULL;
+	m_vertexCount = 0;
+	m_vertexCapacity = 0;
+	m_elements = NULL;
+	m_elementCount = 0;
+	m_elementCapacity = 0;
+}
+
+MeshShape::~MeshShape()
+{
+	free(m_vertices);
+	free(m_normals);
+	free(m_elements);
+}
+
+void MeshShape::Reserve(s32 vertexCount, s32 elementCount)
+{
+	if (vertexCount > m_vertexCapacity)
+	{
+		m_vertexCapacity = glm::max(2 * m_vertexCapacity, vertexCount);
+		glm::vec2* vertices = (glm::vec2*)malloc(m_vertexCapacity * sizeof(glm::vec2));
+		glm::vec2* normals = (glm::vec2*)malloc(m_vertexCapacity * sizeof(glm::vec2));
+		if (m_vertexCount > 0)
+		{
+			memcpy(vertices, m_vertices, m_vertexCount * sizeof(glm::vec2));
+			memcpy(normals, m_normals, m_vertexCount * sizeof(glm::vec2));
+		}
+		free(m_vertices);
+		free(m_normals);
+		m_vertices = vertices;
+		m_normals = normals;
+	}
+
+	if (elementCount > m_elementCapacity)
+	{
+		m_elementCapacity = glm::max(2 * m_elementCapacity, glm::max(elementCount, 16));
+		MeshElement* elements = (MeshElement*)malloc(m_elementCapacity * sizeof(MeshElement));
+		if (m_elementCount > 0)
+		{
+			memcpy(elements, m_elements, m_elementCount * sizeof(MeshElement));
+		}
+		free(m_elements);
+		m_elements = elements;
+	}
+}
+
+MeshElement* MeshShape::AddElement(s32 vertexCount)
+{
+	Reserve(m_vertexCount + vertexCount, m_elementCount + 1);
+
+	MeshElement* element = m_elements + m_elementCount;
+	element->vertexIndex = m_vertexCount;
+	element->flags = 0;
+	++m_elementCount;
+	m_vertexCount += vertexCount;
+	return element;
+}
+
+void MeshShape::AddPolygon(const PolygonShape* polygon, const Transform2D& xf)
+{
+	assert(polygon->m_count >= 3);
+	MeshElement* element = AddElement(polygon->m_count);
+	element->count = (s16)polygon->m_count;
+
+	glm::vec2* vertices = m_vertices + element->vertexIndex;
+	glm::vec2* normals = m_normals + element->vertexIndex;
+	for (s32 i = 0; i < polygon->m_count; ++i)
+	{
+		vertices[i] = Transform2D::Mul(xf, polygon->m_vertices[i]);
+		normals[i] = Rotation2D::Mul(xf.q, polygon->m_normals[i]);
+	}
+}
+
+void MeshShape::AddEdge(const EdgeShape* edge, const Transform2D& xf)
+{
+	MeshElement* element = AddElement(4);
+	element->count = 2;
+	element->flags = MeshElement::edgeFlag;
+	if (edge->m_hasVertex0)
+	{
+		element->flags |= MeshElement::vertex0Flag;
+	}
+	if (edge->m_hasVertex3)
+	{
+		element->flags |= MeshElement::vertex3Flag;
+	}
+
+	glm::vec2* vertices = m_vertices + element->vertexIndex;
+	vertices[0] = Transform2D::Mul(xf, edge->m_vertex0);
+	vertices[1] = Transform2D::Mul(xf, edge->m_vertex1);
+	vertices[2] = Transform2D::Mul(xf, edge->m_vertex2);
+	vertices[3] = Transform2D::Mul(xf, edge->m_vertex3);
+
+	glm::vec2* normals = m_normals + element->vertexIndex;
+	for (s32 i = 0; i < 4; ++i)
+	{
+		normals[i] = glm::vec2(0.0f, 0.0f);
+	}
+}
+
+void MeshShape::AddChain(const ChainShape* chain, const Transform2D& xf)
+{
+	EdgeShape edge;
+	for (s32 i = 0; i < chain->m_count - 1; ++i)
+	{
+		chain->GetChildEdge(&edge, i);
+		AddEdge(&edge, xf);
+	}
+}
+
+void MeshShape::Build()
+{
+	if (m_elementCount == 0)
+	{
+		m_tree.Clear();
+		return;
+	}
+
+	Transform2D identity;
+	identity.SetIdentity();
+
+	AABB* aabbs = (AABB*)malloc(m_elementCount * sizeof(AABB));
+	for (s32 i = 0; i < m_elementCount; ++i)
+	{
+		ComputeElementAABB(aabbs + i, identity, i);
+	}
+
+	m_tree.Build(aabbs, m_elementCount);
+	free(aabbs);
+}
+
+void MeshShape::Clear()
+{
+	m_vertexCount = 0;
+	m_elementCount = 0;
+	m_tree.Clear();
+}
+
+void MeshShape::Set(const MeshElement* elements, s32 elementCount, const glm::vec2* vertices, const glm::vec2* normals, s32 vertexCount)
+{
+	Clear();
+	Reserve(vertexCount, elementCount);
+
+	if (elementCount > 0)
+	{
+		memcpy(m_elements, elements, elementCount * sizeof(MeshElement));
+		memcpy(m_vertices, vertices, vertexCount * sizeof(glm::vec2));
+		memcpy(m_normals, normals, vertexCount * sizeof(glm::vec2));
+	}
+	m_elementCount = elementCount;
+	m_vertexCount = vertexCount;
+	Build();
+}
+
+void MeshShape::GetChildEdge(EdgeShape* edge, s32 index) const
+{
+	const MeshElement& element = GetElement(index);
+	assert(element.flags & MeshElement::edgeFlag);
+
+	const glm::vec2* vertices = m_vertices + element.vertexIndex;
+	edge->m_type = Shape::edge;
+	edge->m_radius = m_radius;
+	edge->m_vertex0 = vertices[0];
+	edge->m_vertex1 = vertices[1];
+	edge->m_vertex2 = vertices[2];
+	edge->m_vertex3 = vertices[3];
+	edge->m_hasVertex0 = (element.flags & MeshElement::vertex0Flag) != 0;
+	edge->m_hasVertex3 = (element.flags & MeshElement::vertex3Flag) != 0;
+}
+
+void MeshShape::GetChildPolygon(PolygonShape* polygon, s32 index) const
+{
+	const MeshElement& element = GetElement(index);
+	assert((element.flags & MeshElement::edgeFlag) == 0);
+
+	polygon->m_type = Shape::polygon;
+	polygon->m_radius = m_radius;
+	polygon->m_count = element.count;
+	memcpy(polygon->m_vertices, m_vertices + element.vertexIndex, element.count * sizeof(glm::vec2));
+	memcpy(polygon->m_normals, m_normals + element.vertexIndex, element.count * sizeof(glm::vec2));
+
+	// The centroid is not used by the collision routines, the vertex average is enough.
+	glm::vec2 c(0.0f, 0.0f);
+	for (s32 i = 0; i < element.count; ++i)
+	{
+		c += polygon->m_vertices[i];
+	}
+	polygon->m_centroid = c * (1.0f / element.count);
+}
+
+void MeshShape::ComputeElementAABB(AABB* aabb, const Transform2D& xf, s32 index) const
+{
+	const MeshElement& element = GetElement(index);
+
+	const glm::vec2* vertices = m_vertices + element.vertexIndex;
+	s32 count = element.count;
+	if (element.flags & MeshElement::edgeFlag)
+	{
+		// Skip the ghost vertex.
+		++vertices;
+	}
+
+	glm::vec2 lower = Transform2D::Mul(xf, vertices[0]);
+	glm::vec2 upper = lower;
+	for (s32 i = 1; i < count; ++i)
+	{
+		glm::vec2 v = Transform2D::Mul(xf, vertices[i]);
+		lower = glm::min(lower, v);
+		upper = glm::max(upper, v);
+	}
+
+	glm::vec2 r(m_radius, m_radius);
+	aabb->lowerBound = lower - r;
+	aabb->upperBound = upper + r;
+}
+
+Shape* MeshShape::Clone(BlockAllocator* allocator) const
+{
+	void* mem = allocator->Allocate(sizeof(MeshShape));
+	MeshShape* clone = new (mem) MeshShape;
+	clone->m_radius = m_radius;
+
+	if (m_elementCount > 0)
+	{
+		clone->m_vertexCount = m_vertexCount;
+		clone->m_vertexCapacity = m_vertexCount;
+		clone->m_vertices = (glm::vec2*)malloc(m_vertexCount * sizeof(glm::vec2));
+		clone->m_normals = (glm::vec2*)malloc(m_vertexCount * sizeof(glm::vec2));
+		memcpy(clone->m_vertices, m_vertices, m_vertexCount * sizeof(glm::vec2));
+		memcpy(clone->m_normals, m_normals, m_vertexCount * sizeof(glm::vec2));
+
+		clone->m_elementCount = m_elementCount;
+		clone->m_elementCapacity = m_elementCount;
+		clone->m_elements = (MeshElement*)malloc(m_elementCount * sizeof(MeshElement));
+		memcpy(clone->m_elements, m_elements, m_elementCount * sizeof(MeshElement));
+	}
+
+	clone->m_tree.Copy(&m_tree);
+	return clone;
+}
+
+s32 MeshShape::GetChildCount() const
+{
+	return 1;
+}
+
+bool MeshShape::TestPoint(const Transform2D& xf, const glm::vec2& p) const
+{
+	glm::vec2 pLocal = Transform2D::MulT(xf, p);
+
+	for (s32 index = 0; index < m_elementCount; ++index)
+	{
+		const MeshElement& element = m_elements[index];
+		if (element.flags & MeshElement::edgeFlag)
+		{
+			continue;
+		}
+
+		const glm::vec2* vertices = m_vertices + element.vertexIndex;
+		const glm::vec2* normals = m_normals + element.vertexIndex;
+		bool inside = true;
+		for (s32 i = 0; i < element.count; ++i)
+		{
+			if (glm::dot(normals[i], pLocal - vertices[i]) > 0.0f)
+			{
+				inside = false;
+				break;
+			}
+		}
+
+		if (inside)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+namespace
+{
+	// Casts the ray against each element the tree reports and keeps the closest hit.
+	// The ray is in mesh coordinates.
+	struct MeshRayCastCallback
+	{
+		real32 RayCastCallback(const RayCastInput& input, s32 index)
+		{
+			RayCastOutput output;
+			bool hit;
+			if (mesh->GetElement(index).flags & MeshElement::edgeFlag)
+			{
+				EdgeShape edge;
+				mesh->GetChildEdge(&edge, index);
+				hit = edge.RayCast(&output, input, identity, 0);
+			}
+			else
+			{
+				PolygonShape polygon;
+				mesh->GetChildPolygon(&polygon, index);
+				hit = polygon.RayCast(&output, input, identity, 0);
+			}
+
+			if (hit == false)
+			{
+				return input.maxFraction;
+			}
+
+			this->hit = true;
+			this->output = output;
+			return output.fraction;
+		}
+
+		const MeshShape* mesh;
+		Transform2D identity;
+		RayCastOutput output;
+		bool hit;
+	};
+}
+
+bool MeshShape::RayCast(RayCastOutput* output, const RayCastInput& input, const Transform2D& xf, s32 childIndex) const
+{
+	NOT_USED(childIndex);
+
+	if (m_elementCount == 0)
+	{
+		return false;
+	}
+
+	// Put the ray into the mesh's frame of reference.
+	RayCastInput localInput;
+	localInput.p1 = Transform2D::MulT(xf, input.p1);
+	localInput.p2 = Transform2D::MulT(xf, input.p2);
+	localInput.maxFraction = input.maxFraction;
+
+	MeshRayCastCallback callback;
+	callback.mesh = this;
+	callback.identity.SetIdentity();
+	callback.hit = false;
+	m_tree.RayCast(&callback, localInput);
+
+	if (callback.hit == false)
+	{
+		return false;
+	}
+
+	output->fraction = callback.output.fraction;
+	output->normal = Rotation2D::Mul(xf.q, callback.output.normal);
+	return true;
+}
+
+void MeshShape::ComputeDistance(const Transform2D& xf, const glm::vec2& p, real32* distance, glm::vec2* normal, s32 childIndex) const
+{
+	assert(0 <= childIndex && childIndex < m_elementCount);
+
+	if (m_elements[childIndex].flags & MeshElement::edgeFlag)
+	{
+		EdgeShape edge;
+		GetChildEdge(&edge, childIndex);
+		edge.ComputeDistance(xf, p, distance, normal, 0);
+	}
+	else
+	{
+		PolygonShape polygon;
+		GetChildPolygon(&polygon, childIndex);
+		polygon.ComputeDistance(xf, p, distance, normal, 0);
+	}
+}
+
+void MeshShape::ComputeAABB(AABB* aabb, const Transform2D& xf, s32 childIndex) const
+{
+	NOT_USED(childIndex);
+
+	if (m_elementCount == 0)
+	{
+		aabb->lowerBound = xf.p;
+		aabb->upperBound = xf.p;
+		return;
+	}
+
+	TransformAABB(aabb, m_tree.GetBounds(), xf);
+}
+
+void MeshShape::ComputeMass(MassData* massData, real32 density) const
+{
+	NOT_USED(density);
+
+	massData->mass = 0.0f;
+	massData->center = glm::vec2(0.0f, 0.0f);
+	massData->I = 0.0f;
+}
@@ -296,3 +296,16 @@ void MotorJoint::Dump()
 	printf("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
 
+void MotorJoint::SaveState(JointState* state) const
+{
+	state->values[0] = m_linearImpulse.x;
+	state->values[1] = m_linearImpulse.y;
+	state->values[2] = m_angularImpulse;
+}
+
+void MotorJoint::LoadState(const JointState* state)
+{
+	m_linearImpulse.x = state->values[0];
+	m_linearImpulse.y = state->values[1];
+	m_angularImpulse = state->values[2];
+}
@@ -174,7 +174,7 @@ void MouseJoint::SolveVelocityConstraints(const SolverData& data)
 
 	if (MathUtils::LengthSquared( m_impulse ) > maxImpulse * maxImpulse)
 	{
-		m_impulse *= maxImpulse / m_impulse.length();
+		m_impulse *= maxImpulse / glm::length(m_impulse);
 	}
 	impulse = m_impulse - oldImpulse;
 
@@ -216,3 +216,18 @@ void MouseJoint::ShiftOrigin(const glm::vec2& newOrigin)
 	m_targetA -= newOrigin;
 }
 
+void MouseJoint::SaveState(JointState* state) const
+{
+	state->values[0] = m_impulse.x;
+	state->values[1] = m_impulse.y;
+	state->values[2] = m_targetA.x;
+	state->values[3] = m_targetA.y;
+}
+
+void MouseJoint::LoadState(const JointState* state)
+{
+	m_impulse.x = state->values[0];
+	m_impulse.y = state->values[1];
+	m_targetA.x = state->values[2];
+	m_targetA.y = state->values[3];
+}
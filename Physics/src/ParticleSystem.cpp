@@ -0,0 +1,1013 @@
+#include "ParticleSystem.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "Shape.hpp"
+#include "StaticTree.hpp"
+#include "BroadPhaseDispatch.hpp"
+#include "ThreadPool.hpp"
+#include <float.h>
+#include <memory.h>
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+// Neighbors kept per particle. A fluid at rest has 6 within the kernel.
+#define maxParticleNeighbors	32
+
+// Over-relaxation of the averaged contact corrections, in [1,2].
+#define particleRelaxation		2.0f
+
+// Particles per chunk when running a pass on the thread pool.
+#define particleGrainSize		256
+
+namespace
+{
+	// Reallocate a malloc'ed buffer, keeping the first count elements.
+	template <typename T>
+	void Resize(T*& buffer, s32 count, s32 capacity)
+	{
+		T* oldBuffer = buffer;
+		buffer = (T*)malloc(capacity * sizeof(T));
+		if (count > 0)
+		{
+			memcpy(buffer, oldBuffer, count * sizeof(T));
+		}
+		free(oldBuffer);
+	}
+
+	// The same rules as ContactFilter::ShouldCollide.
+	bool ShouldCollide(const Filter& filterA, const Filter& filterB)
+	{
+		if (filterA.groupIndex == filterB.groupIndex && filterA.groupIndex != 0)
+		{
+			return filterA.groupIndex > 0;
+		}
+
+		return (filterA.maskBits & filterB.categoryBits) != 0 && (filterA.categoryBits & filterB.maskBits) != 0;
+	}
+
+	// The direction from particle j to particle i. Particles pushed into a corner
+	// can end up on top of each other, so coincident particles are split along
+	// x by index.
+	glm::vec2 GetSeparation(const glm::vec2& d, real32 r, s32 i, s32 j)
+	{
+		if (r > FLT_EPSILON)
+		{
+			return (1.0f / r) * d;
+		}
+
+		return glm::vec2(i < j ? -1.0f : 1.0f, 0.0f);
+	}
+
+	// The bounds a particle covers during the step.
+	AABB GetSweptAABB(const glm::vec2& p1, const glm::vec2& p2, real32 radius)
+	{
+		AABB aabb;
+		aabb.lowerBound = glm::min(p1, p2) - glm::vec2(radius, radius);
+		aabb.upperBound = glm::max(p1, p2) + glm::vec2(radius, radius);
+		return aabb;
+	}
+}
+
+ParticleSystem::ParticleSystem(const ParticleSystemDef* def, World* world)
+{
+	assert(def->radius > 0.0f);
+	assert(def->iterations > 0);
+
+	m_world = world;
+	m_prev = NULL;
+	m_next = NULL;
+
+	real32 pi = glm::pi<float>();
+	m_radius = def->radius;
+	m_diameter = 2.0f * def->radius;
+	m_particleMass = def->density * pi * m_radius * m_radius;
+	m_gravityScale = def->gravityScale;
+	m_damping = def->damping;
+	m_viscosity = def->viscosity;
+	m_friction = def->friction;
+	m_iterations = def->iterations;
+	m_filter = def->filter;
+
+	// Each iteration moves a particle at most a radius from where it was
+	// predicted, see ConstraintTask.
+	m_reach = m_radius + m_iterations * m_radius;
+
+	// 2D poly6 kernel for the density and the gradient of the spiky kernel
+	// for the pressure, see "Position Based Fluids" by Macklin and Muller.
+	real32 h = 1.5f * m_diameter;
+	m_kernelRadius = h;
+	m_poly6 = 4.0f / (pi * powf(h, 8.0f));
+	m_spikyGradient = -30.0f / (pi * powf(h, 5.0f));
+
+	// The rest density is the density of a hexagonal packing a diameter apart,
+	// so a fluid at rest keeps its particles that far apart.
+	real32 restDensity = 0.0f;
+	real32 rowHeight = 0.5f * sqrtf(3.0f) * m_diameter;
+	for (s32 row = -4; row <= 4; ++row)
+	{
+		for (s32 column = -4; column <= 4; ++column)
+		{
+			glm::vec2 p((column + 0.5f * (row & 1)) * m_diameter, row * rowHeight);
+			real32 q = h * h - glm::dot(p, p);
+			if (q > 0.0f)
+			{
+				restDensity += m_poly6 * q * q * q;
+			}
+		}
+	}
+	m_inverseRestDensity = 1.0f / restDensity;
+
+	// Softens the density constraint. Small next to the constraint gradients,
+	// which are of the order of 1 / h.
+	m_relaxation = 1.0f / (h * h);
+
+	m_positions = NULL;
+	m_velocities = NULL;
+	m_userData = NULL;
+	m_flags = NULL;
+	m_count = 0;
+	m_capacity = 0;
+	m_destroyCount = 0;
+
+	m_predicted = NULL;
+	m_deltas = NULL;
+	m_lambdas = NULL;
+	m_neighbors = NULL;
+	m_neighborCounts = NULL;
+	m_contactStart = NULL;
+	m_stamps = NULL;
+	m_buckets = NULL;
+
+	m_bucketStart = NULL;
+	m_bucketCapacity = 0;
+	m_cellParticles = NULL;
+	m_bucketMask = 0;
+	m_inverseCellSize = 1.0f / h;
+
+	m_maxTravel = 0.0f;
+
+	m_shapeProxyCapacity = 16;
+	m_shapeProxyCount = 0;
+	m_shapeProxies = (ShapeProxy*)malloc(m_shapeProxyCapacity * sizeof(ShapeProxy));
+
+	m_shapeContactCapacity = 64;
+	m_shapeContactCount = 0;
+	m_shapeContacts = (ShapeContact*)malloc(m_shapeContactCapacity * sizeof(ShapeContact));
+	m_sortedCapacity = 0;
+	m_sortedContacts = NULL;
+
+	Reserve(256);
+}
+
+ParticleSystem::~ParticleSystem()
+{
+	free(m_positions);
+	free(m_velocities);
+	free(m_userData);
+	free(m_flags);
+
+	free(m_predicted);
+	free(m_deltas);
+	free(m_lambdas);
+	free(m_neighbors);
+	free(m_neighborCounts);
+	free(m_contactStart);
+	free(m_stamps);
+	free(m_buckets);
+
+	free(m_bucketStart);
+	free(m_cellParticles);
+
+	free(m_shapeProxies);
+	free(m_shapeContacts);
+	free(m_sortedContacts);
+}
+
+void ParticleSystem::Reserve(s32 capacity)
+{
+	if (capacity <= m_capacity)
+	{
+		return;
+	}
+
+	Resize(m_positions, m_count, capacity);
+	Resize(m_velocities, m_count, capacity);
+	Resize(m_userData, m_count, capacity);
+	Resize(m_flags, m_count, capacity);
+
+	// Step data is rebuilt every step.
+	Resize(m_predicted, 0, capacity);
+	Resize(m_deltas, 0, capacity);
+	Resize(m_lambdas, 0, capacity);
+	Resize(m_neighbors, 0, capacity * maxParticleNeighbors);
+	Resize(m_neighborCounts, 0, capacity);
+	Resize(m_contactStart, 0, capacity + 1);
+	Resize(m_stamps, 0, capacity);
+	Resize(m_buckets, 0, capacity);
+	Resize(m_cellParticles, 0, capacity);
+
+	m_capacity = capacity;
+}
+
+s32 ParticleSystem::CreateParticle(const ParticleDef* def)
+{
+	assert(m_world->IsLocked() == false);
+	if (m_world->IsLocked())
+	{
+		return -1;
+	}
+
+	if (m_count == m_capacity)
+	{
+		Reserve(2 * m_capacity);
+	}
+
+	s32 index = m_count;
+	m_positions[index] = def->position;
+	m_velocities[index] = def->velocity;
+	m_userData[index] = def->userData;
+	m_flags[index] = (u32)def->type;
+	++m_count;
+	return index;
+}
+
+s32 ParticleSystem::CreateParticlesInShape(const Shape* shape, const Transform2D& xf, const ParticleDef* def)
+{
+	AABB aabb;
+	shape->ComputeAABB(&aabb, xf, 0);
+
+	ParticleDef particleDef = *def;
+	real32 rowHeight = 0.5f * sqrtf(3.0f) * m_diameter;
+	s32 count = 0;
+	s32 row = 0;
+	for (real32 y = aabb.lowerBound.y + m_radius; y <= aabb.upperBound.y - m_radius; y += rowHeight, ++row)
+	{
+		real32 offset = (row & 1) ? m_radius : 0.0f;
+		for (real32 x = aabb.lowerBound.x + m_radius + offset; x <= aabb.upperBound.x - m_radius; x += m_diameter)
+		{
+			glm::vec2 p(x, y);
+			if (shape->TestPoint(xf, p))
+			{
+				particleDef.position = p;
+				if (CreateParticle(&particleDef) < 0)
+				{
+					return count;
+				}
+				++count;
+			}
+		}
+	}
+
+	return count;
+}
+
+void ParticleSystem::DestroyParticle(s32 index)
+{
+	assert(0 <= index && index < m_count);
+	if ((m_flags[index] & destroyFlag) == 0)
+	{
+		m_flags[index] |= destroyFlag;
+		++m_destroyCount;
+	}
+}
+
+void ParticleSystem::RemoveDestroyed()
+{
+	if (m_destroyCount == 0)
+	{
+		return;
+	}
+
+	s32 i = 0;
+	while (i < m_count)
+	{
+		if (m_flags[i] & destroyFlag)
+		{
+			--m_count;
+			m_positions[i] = m_positions[m_count];
+			m_velocities[i] = m_velocities[m_count];
+			m_userData[i] = m_userData[m_count];
+			m_flags[i] = m_flags[m_count];
+		}
+		else
+		{
+			++i;
+		}
+	}
+
+	m_destroyCount = 0;
+}
+
+void ParticleSystem::ShiftOrigin(const glm::vec2& newOrigin)
+{
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		m_positions[i] -= newOrigin;
+	}
+}
+
+void ParticleSystem::WritePositions(void* data, s32 stride) const
+{
+	u8* p = (u8*)data;
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		memcpy(p, m_positions + i, sizeof(glm::vec2));
+		p += stride;
+	}
+}
+
+void ParticleSystem::WriteSprites(Vertex2DPosColorTex* vertices, real32 size, const glm::vec4& color) const
+{
+	real32 half = 0.5f * size;
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		glm::vec2 p = m_positions[i];
+		Vertex2DPosColorTex* v = vertices + 4 * i;
+		v[0] = Vertex2DPosColorTex(p + glm::vec2(-half, -half), color, glm::vec2(0.0f, 0.0f));
+		v[1] = Vertex2DPosColorTex(p + glm::vec2(-half, half), color, glm::vec2(0.0f, 1.0f));
+		v[2] = Vertex2DPosColorTex(p + glm::vec2(half, -half), color, glm::vec2(1.0f, 0.0f));
+		v[3] = Vertex2DPosColorTex(p + glm::vec2(half, half), color, glm::vec2(1.0f, 1.0f));
+	}
+}
+
+inline s32 ParticleSystem::GetCell(real32 value) const
+{
+	return (s32)floorf(value * m_inverseCellSize);
+}
+
+inline u32 ParticleSystem::GetBucket(s32 x, s32 y) const
+{
+	return ((u32)x * 73856093u ^ (u32)y * 19349663u) & m_bucketMask;
+}
+
+void ParticleSystem::ParallelFor(s32 count, void (*task)(void*, s32, s32, s32))
+{
+	ThreadPool* pool = m_world->GetThreadPool();
+	if (pool && count > particleGrainSize)
+	{
+		pool->ParallelFor(count, particleGrainSize, task, this);
+	}
+	else
+	{
+		task(this, 0, count, 0);
+	}
+}
+
+void ParticleSystem::Solve(const PTimeStep& step)
+{
+	RemoveDestroyed();
+	if (m_count == 0)
+	{
+		return;
+	}
+
+	m_step = step;
+
+	ParallelFor(m_count, PredictTask);
+	BuildGrid();
+	ParallelFor(m_count, NeighborTask);
+	FindShapeContacts();
+
+	// Jacobi iterations: each pass reads the positions of the last one.
+	for (s32 iteration = 0; iteration < m_iterations; ++iteration)
+	{
+		ParallelFor(m_count, DensityTask);
+		ParallelFor(m_count, ConstraintTask);
+		ParallelFor(m_count, CollideTask);
+	}
+
+	ParallelFor(m_count, VelocityTask);
+	if (m_viscosity > 0.0f)
+	{
+		// The smoothed velocities are written to m_deltas, which then becomes
+		// the velocity buffer.
+		ParallelFor(m_count, ViscosityTask);
+		glm::vec2* velocities = m_velocities;
+		m_velocities = m_deltas;
+		m_deltas = velocities;
+	}
+
+	ApplyImpulses();
+}
+
+void ParticleSystem::PredictTask(void* context, s32 begin, s32 end, s32 threadIndex)
+{
+	NOT_USED(threadIndex);
+
+	ParticleSystem* system = (ParticleSystem*)context;
+	real32 dt = system->m_step.delta;
+	glm::vec2 gravity = dt * system->m_gravityScale * system->m_world->GetGravity();
+	real32 damping = 1.0f / (1.0f + dt * system->m_damping);
+	for (s32 i = begin; i < end; ++i)
+	{
+		glm::vec2 v = damping * (system->m_velocities[i] + gravity);
+
+		// Keep the particles from running away, like the bodies.
+		glm::vec2 translation = dt * v;
+		if (glm::dot(translation, translation) > maxTranslationSquared)
+		{
+			translation *= maxTranslation / glm::length(translation);
+		}
+
+		system->m_velocities[i] = v;
+		system->m_predicted[i] = system->m_positions[i] + translation;
+	}
+}
+
+void ParticleSystem::BuildGrid()
+{
+	s32 bucketCount = 16;
+	while (bucketCount < 2 * m_count)
+	{
+		bucketCount *= 2;
+	}
+
+	if (bucketCount + 1 > m_bucketCapacity)
+	{
+		m_bucketCapacity = bucketCount + 1;
+		Resize(m_bucketStart, 0, m_bucketCapacity);
+	}
+	m_bucketMask = (u32)(bucketCount - 1);
+
+	memset(m_bucketStart, 0, (bucketCount + 1) * sizeof(s32));
+
+	m_bounds.lowerBound = glm::vec2(FLT_MAX, FLT_MAX);
+	m_bounds.upperBound = glm::vec2(-FLT_MAX, -FLT_MAX);
+	real32 maxTravelSquared = 0.0f;
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		glm::vec2 p = m_predicted[i];
+		u32 bucket = GetBucket(GetCell(p.x), GetCell(p.y));
+		m_buckets[i] = bucket;
+		++m_bucketStart[bucket];
+
+		glm::vec2 d = p - m_positions[i];
+		maxTravelSquared = glm::max(maxTravelSquared, glm::dot(d, d));
+		m_bounds.lowerBound = glm::min(m_bounds.lowerBound, glm::min(p, m_positions[i]));
+		m_bounds.upperBound = glm::max(m_bounds.upperBound, glm::max(p, m_positions[i]));
+	}
+
+	m_maxTravel = sqrtf(maxTravelSquared);
+	m_bounds.lowerBound -= glm::vec2(m_reach, m_reach);
+	m_bounds.upperBound += glm::vec2(m_reach, m_reach);
+
+	// A counting sort: turn the counts into bucket ends, then walk the
+	// particles backwards so each bucket lists them in order.
+	s32 sum = 0;
+	for (s32 b = 0; b < bucketCount; ++b)
+	{
+		sum += m_bucketStart[b];
+		m_bucketStart[b] = sum;
+	}
+	m_bucketStart[bucketCount] = m_count;
+
+	for (s32 i = m_count - 1; i >= 0; --i)
+	{
+		m_cellParticles[--m_bucketStart[m_buckets[i]]] = i;
+	}
+}
+
+void ParticleSystem::NeighborTask(void* context, s32 begin, s32 end, s32 threadIndex)
+{
+	NOT_USED(threadIndex);
+
+	ParticleSystem* system = (ParticleSystem*)context;
+	const glm::vec2* predicted = system->m_predicted;
+	const s32* bucketStart = system->m_bucketStart;
+	const s32* cellParticles = system->m_cellParticles;
+	real32 h2 = system->m_kernelRadius * system->m_kernelRadius;
+
+	for (s32 i = begin; i < end; ++i)
+	{
+		glm::vec2 p = predicted[i];
+		s32 x = system->GetCell(p.x);
+		s32 y = system->GetCell(p.y);
+
+		s32* neighbors = system->m_neighbors + i * maxParticleNeighbors;
+		s32 count = 0;
+
+		// Two of the nine cells may share a bucket, which must be read once.
+		u32 visited[9];
+		s32 visitedCount = 0;
+		for (s32 dy = -1; dy <= 1; ++dy)
+		{
+			for (s32 dx = -1; dx <= 1; ++dx)
+			{
+				u32 bucket = system->GetBucket(x + dx, y + dy);
+				bool seen = false;
+				for (s32 k = 0; k < visitedCount; ++k)
+				{
+					seen = seen || visited[k] == bucket;
+				}
+				if (seen)
+				{
+					continue;
+				}
+				visited[visitedCount++] = bucket;
+
+				for (s32 k = bucketStart[bucket]; k < bucketStart[bucket + 1]; ++k)
+				{
+					s32 j = cellParticles[k];
+					glm::vec2 d = predicted[j] - p;
+					if (j != i && glm::dot(d, d) < h2 && count < maxParticleNeighbors)
+					{
+						neighbors[count++] = j;
+					}
+				}
+			}
+		}
+
+		system->m_neighborCounts[i] = count;
+	}
+}
+
+namespace Break
+{
+	namespace Physics
+	{
+		// Adds the mesh elements or chain edges that overlap the particles.
+		struct ParticleElementQuery
+		{
+			bool QueryCallback(s32 elementIndex)
+			{
+				AABB aabb;
+				fixture->GetShape()->ComputeElementAABB(&aabb, fixture->GetBody()->GetTransform2D(), elementIndex);
+				system->AddShapeProxy(fixture, elementIndex, aabb);
+				return true;
+			}
+
+			ParticleSystem* system;
+			Fixture* fixture;
+		};
+
+		// Collects the fixtures overlapping the particles.
+		template <typename B>
+		struct ParticleShapeQuery
+		{
+			bool QueryCallback(s32 proxyId)
+			{
+				FixtureProxy* proxy = (FixtureProxy*)broadPhase->GetUserData(proxyId);
+				Fixture* fixture = proxy->fixture;
+				if (fixture->IsSensor() || ShouldCollide(*filter, fixture->GetFilterData()) == false)
+				{
+					return true;
+				}
+
+				const StaticTree* tree = fixture->GetShape()->GetElementTree();
+				if (tree)
+				{
+					ParticleElementQuery elementQuery;
+					elementQuery.system = system;
+					elementQuery.fixture = fixture;
+					tree->Query(&elementQuery, bounds, fixture->GetBody()->GetTransform2D());
+					return true;
+				}
+
+				system->AddShapeProxy(fixture, proxy->childIndex, proxy->aabb);
+				return true;
+			}
+
+			const B* broadPhase;
+			ParticleSystem* system;
+			const Filter* filter;
+			AABB bounds;
+		};
+
+		// Runs the shape query on the concrete broad-phase type.
+		struct ParticleShapeQueryOp
+		{
+			template <typename B>
+			void operator()(const B* broadPhase) const
+			{
+				ParticleShapeQuery<B> query;
+				query.broadPhase = broadPhase;
+				query.system = system;
+				query.filter = filter;
+				query.bounds = bounds;
+				broadPhase->Query(&query, bounds);
+			}
+
+			ParticleSystem* system;
+			const Filter* filter;
+			AABB bounds;
+		};
+	}
+}
+
+void ParticleSystem::AddShapeProxy(Fixture* fixture, s32 childIndex, const AABB& aabb)
+{
+	if (m_shapeProxyCount == m_shapeProxyCapacity)
+	{
+		m_shapeProxyCapacity *= 2;
+		Resize(m_shapeProxies, m_shapeProxyCount, m_shapeProxyCapacity);
+	}
+
+	s32 proxyIndex = m_shapeProxyCount++;
+	ShapeProxy* proxy = m_shapeProxies + proxyIndex;
+	proxy->shape = fixture->GetShape();
+	proxy->body = fixture->GetBody();
+	proxy->xf = proxy->body->GetTransform2D();
+	proxy->childIndex = childIndex;
+
+	// Find the particles whose sweep overlaps the child. Grid cells are keyed
+	// by the predicted positions, so the cell range covers the travel too.
+	AABB range;
+	range.lowerBound = glm::max(aabb.lowerBound, m_bounds.lowerBound);
+	range.upperBound = glm::min(aabb.upperBound, m_bounds.upperBound);
+	if (range.lowerBound.x > range.upperBound.x || range.lowerBound.y > range.upperBound.y)
+	{
+		return;
+	}
+
+	glm::vec2 margin(m_reach + m_maxTravel, m_reach + m_maxTravel);
+	s32 lowerX = GetCell(range.lowerBound.x - margin.x);
+	s32 lowerY = GetCell(range.lowerBound.y - margin.y);
+	s32 upperX = GetCell(range.upperBound.x + margin.x);
+	s32 upperY = GetCell(range.upperBound.y + margin.y);
+
+	// Large children are cheaper to test against every particle.
+	bool scan = (s64)(upperX - lowerX + 1) * (upperY - lowerY + 1) > m_count;
+	s32 cellCount = scan ? 1 : (upperX - lowerX + 1) * (upperY - lowerY + 1);
+	for (s32 cell = 0; cell < cellCount; ++cell)
+	{
+		s32 first = 0;
+		s32 last = m_count;
+		if (scan == false)
+		{
+			s32 width = upperX - lowerX + 1;
+			u32 bucket = GetBucket(lowerX + cell % width, lowerY + cell / width);
+			first = m_bucketStart[bucket];
+			last = m_bucketStart[bucket + 1];
+		}
+
+		for (s32 k = first; k < last; ++k)
+		{
+			s32 i = scan ? k : m_cellParticles[k];
+			if (m_stamps[i] == proxyIndex)
+			{
+				continue;
+			}
+
+			if (TestOverlap(aabb, GetSweptAABB(m_positions[i], m_predicted[i], m_reach)) == false)
+			{
+				continue;
+			}
+			m_stamps[i] = proxyIndex;
+
+			if (m_shapeContactCount == m_shapeContactCapacity)
+			{
+				m_shapeContactCapacity *= 2;
+				Resize(m_shapeContacts, m_shapeContactCount, m_shapeContactCapacity);
+			}
+
+			ShapeContact* contact = m_shapeContacts + m_shapeContactCount++;
+			contact->particle = i;
+			contact->proxy = proxyIndex;
+			contact->impulse = glm::vec2(0.0f, 0.0f);
+			contact->point = glm::vec2(0.0f, 0.0f);
+		}
+	}
+}
+
+void ParticleSystem::FindShapeContacts()
+{
+	m_shapeProxyCount = 0;
+	m_shapeContactCount = 0;
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		m_stamps[i] = -1;
+	}
+
+	ParticleShapeQueryOp op;
+	op.system = this;
+	op.filter = &m_filter;
+	op.bounds = m_bounds;
+	DispatchBroadPhase(m_world->m_contactManager.m_broadPhase, op);
+
+	// Sort the contacts by particle so the collide pass only touches the
+	// contacts of its own particles.
+	if (m_shapeContactCount > m_sortedCapacity)
+	{
+		m_sortedCapacity = m_shapeContactCapacity;
+		Resize(m_sortedContacts, 0, m_sortedCapacity);
+	}
+
+	memset(m_contactStart, 0, (m_count + 1) * sizeof(s32));
+	for (s32 k = 0; k < m_shapeContactCount; ++k)
+	{
+		++m_contactStart[m_shapeContacts[k].particle];
+	}
+
+	s32 sum = 0;
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		sum += m_contactStart[i];
+		m_contactStart[i] = sum;
+	}
+	m_contactStart[m_count] = m_shapeContactCount;
+
+	for (s32 k = m_shapeContactCount - 1; k >= 0; --k)
+	{
+		m_sortedContacts[--m_contactStart[m_shapeContacts[k].particle]] = m_shapeContacts[k];
+	}
+}
+
+void ParticleSystem::DensityTask(void* context, s32 begin, s32 end, s32 threadIndex)
+{
+	NOT_USED(threadIndex);
+
+	ParticleSystem* system = (ParticleSystem*)context;
+	const glm::vec2* predicted = system->m_predicted;
+	real32 h = system->m_kernelRadius;
+	real32 h2 = h * h;
+	real32 poly6 = system->m_poly6;
+	real32 spiky = system->m_spikyGradient;
+	real32 inverseRestDensity = system->m_inverseRestDensity;
+
+	for (s32 i = begin; i < end; ++i)
+	{
+		system->m_lambdas[i] = 0.0f;
+		if (system->m_flags[i] & granularParticle)
+		{
+			continue;
+		}
+
+		glm::vec2 p = predicted[i];
+		const s32* neighbors = system->m_neighbors + i * maxParticleNeighbors;
+		s32 count = system->m_neighborCounts[i];
+
+		real32 density = poly6 * h2 * h2 * h2;
+		glm::vec2 gradient(0.0f, 0.0f);
+		real32 sumGradient2 = 0.0f;
+		for (s32 k = 0; k < count; ++k)
+		{
+			s32 j = neighbors[k];
+			glm::vec2 d = p - predicted[j];
+			real32 r2 = glm::dot(d, d);
+			if (r2 >= h2)
+			{
+				continue;
+			}
+
+			real32 q = h2 - r2;
+			density += poly6 * q * q * q;
+
+			real32 r = sqrtf(r2);
+			real32 s = h - r;
+			glm::vec2 g = (inverseRestDensity * spiky * s * s) * GetSeparation(d, r, i, j);
+			gradient += g;
+			sumGradient2 += glm::dot(g, g);
+		}
+
+		// The constraint only pushes: a sparse fluid is left alone rather than
+		// pulled together.
+		real32 C = density * inverseRestDensity - 1.0f;
+		if (C > 0.0f)
+		{
+			sumGradient2 += glm::dot(gradient, gradient);
+			system->m_lambdas[i] = -C / (sumGradient2 + system->m_relaxation);
+		}
+	}
+}
+
+void ParticleSystem::ConstraintTask(void* context, s32 begin, s32 end, s32 threadIndex)
+{
+	NOT_USED(threadIndex);
+
+	ParticleSystem* system = (ParticleSystem*)context;
+	const glm::vec2* predicted = system->m_predicted;
+	const glm::vec2* positions = system->m_positions;
+	const real32* lambdas = system->m_lambdas;
+	const u32* flags = system->m_flags;
+	real32 h = system->m_kernelRadius;
+	real32 h2 = h * h;
+	real32 spiky = system->m_spikyGradient;
+	real32 inverseRestDensity = system->m_inverseRestDensity;
+	real32 radius = system->m_radius;
+	real32 diameter = system->m_diameter;
+	real32 friction = system->m_friction;
+	real32 maxCorrection = radius;
+
+	for (s32 i = begin; i < end; ++i)
+	{
+		glm::vec2 p = predicted[i];
+		glm::vec2 travel = p - positions[i];
+		bool fluid = (flags[i] & granularParticle) == 0;
+		const s32* neighbors = system->m_neighbors + i * maxParticleNeighbors;
+		s32 count = system->m_neighborCounts[i];
+
+		glm::vec2 pressure(0.0f, 0.0f);
+		glm::vec2 contact(0.0f, 0.0f);
+		s32 contactCount = 0;
+		for (s32 k = 0; k < count; ++k)
+		{
+			s32 j = neighbors[k];
+			glm::vec2 d = p - predicted[j];
+			real32 r2 = glm::dot(d, d);
+			if (r2 >= h2)
+			{
+				continue;
+			}
+			real32 r = sqrtf(r2);
+			glm::vec2 n = GetSeparation(d, r, i, j);
+
+			if (fluid)
+			{
+				real32 s = h - r;
+				pressure += ((lambdas[i] + lambdas[j]) * spiky * s * s) * n;
+			}
+
+			// Granular particles keep a diameter from everything and slide with
+			// friction. Fluid particles keep a radius from each other, which stops
+			// them from clumping in pairs where the density alone is satisfied.
+			bool granular = fluid == false || (flags[j] & granularParticle);
+			real32 minDistance = granular ? diameter : radius;
+			if (r < minDistance)
+			{
+				real32 penetration = minDistance - r;
+				glm::vec2 correction = (0.5f * penetration) * n;
+
+				glm::vec2 relative = travel - (predicted[j] - positions[j]);
+				glm::vec2 tangent = relative - glm::dot(relative, n) * n;
+				real32 length = glm::length(tangent);
+				if (granular && length > FLT_EPSILON)
+				{
+					real32 scale = glm::min(friction * penetration / length, 1.0f);
+					correction -= (0.5f * scale) * tangent;
+				}
+
+				contact += correction;
+				++contactCount;
+			}
+		}
+
+		// The contact corrections are averaged so a particle squeezed from all
+		// sides does not overshoot, then over-relaxed so the weight of a pile
+		// reaches the ground in a few iterations.
+		glm::vec2 delta = inverseRestDensity * pressure;
+		if (contactCount > 0)
+		{
+			delta += glm::min(particleRelaxation / contactCount, 1.0f) * contact;
+		}
+
+		real32 length = glm::length(delta);
+		if (length > maxCorrection)
+		{
+			delta *= maxCorrection / length;
+		}
+		system->m_deltas[i] = delta;
+	}
+}
+
+void ParticleSystem::CollideTask(void* context, s32 begin, s32 end, s32 threadIndex)
+{
+	NOT_USED(threadIndex);
+
+	ParticleSystem* system = (ParticleSystem*)context;
+	real32 radius = system->m_radius;
+	real32 friction = system->m_friction;
+	real32 dt = system->m_step.delta;
+	real32 impulseScale = system->m_particleMass * system->m_step.inv_dt;
+	for (s32 i = begin; i < end; ++i)
+	{
+		glm::vec2 p = system->m_predicted[i] + system->m_deltas[i];
+		glm::vec2 p0 = system->m_positions[i];
+
+		for (s32 k = system->m_contactStart[i]; k < system->m_contactStart[i + 1]; ++k)
+		{
+			ShapeContact* contact = system->m_sortedContacts + k;
+			const ShapeProxy* proxy = system->m_shapeProxies + contact->proxy;
+
+			// The particle could have passed through a thin shape, pushed by its
+			// speed or by its neighbors, so its path is ray cast first.
+			glm::vec2 travel = p - p0;
+			if (travel.x != 0.0f || travel.y != 0.0f)
+			{
+				RayCastInput input;
+				input.p1 = p0;
+				input.p2 = p;
+				input.maxFraction = 1.0f;
+				RayCastOutput output;
+				if (proxy->shape->RayCast(&output, input, proxy->xf, proxy->childIndex))
+				{
+					glm::vec2 hit = p0 + output.fraction * travel + radius * output.normal;
+					contact->impulse -= (impulseScale * glm::dot(hit - p, output.normal)) * output.normal;
+					contact->point = hit;
+					p = hit;
+				}
+			}
+
+			real32 distance;
+			glm::vec2 normal;
+			proxy->shape->ComputeDistance(proxy->xf, p, &distance, &normal, proxy->childIndex);
+			if (distance >= radius)
+			{
+				continue;
+			}
+
+			// The body takes the momentum of every push it gives the particle,
+			// so the weight of a fluid rests on what it stands on.
+			real32 penetration = radius - distance;
+			p += penetration * normal;
+			contact->impulse -= (impulseScale * penetration) * normal;
+			contact->point = p;
+
+			// Friction against the surface, relative to the body.
+			glm::vec2 vb = proxy->body->GetLinearVelocityFromWorldPoint(p);
+			glm::vec2 relative = p - p0 - dt * vb;
+			glm::vec2 tangent = relative - glm::dot(relative, normal) * normal;
+			real32 length = glm::length(tangent);
+			if (length > FLT_EPSILON)
+			{
+				p -= glm::min(friction * penetration / length, 1.0f) * tangent;
+			}
+		}
+
+		system->m_predicted[i] = p;
+	}
+}
+
+void ParticleSystem::VelocityTask(void* context, s32 begin, s32 end, s32 threadIndex)
+{
+	NOT_USED(threadIndex);
+
+	ParticleSystem* system = (ParticleSystem*)context;
+	real32 inv_dt = system->m_step.inv_dt;
+	for (s32 i = begin; i < end; ++i)
+	{
+		glm::vec2 p = system->m_predicted[i];
+		system->m_velocities[i] = inv_dt * (p - system->m_positions[i]);
+		system->m_positions[i] = p;
+	}
+}
+
+// XSPH viscosity: blend the velocity of a fluid particle with the kernel
+// weighted velocity of its fluid neighbors.
+void ParticleSystem::ViscosityTask(void* context, s32 begin, s32 end, s32 threadIndex)
+{
+	NOT_USED(threadIndex);
+
+	ParticleSystem* system = (ParticleSystem*)context;
+	const glm::vec2* positions = system->m_positions;
+	const glm::vec2* velocities = system->m_velocities;
+	const u32* flags = system->m_flags;
+	real32 h2 = system->m_kernelRadius * system->m_kernelRadius;
+	real32 viscosity = system->m_viscosity;
+
+	for (s32 i = begin; i < end; ++i)
+	{
+		glm::vec2 v = velocities[i];
+		if (flags[i] & granularParticle)
+		{
+			system->m_deltas[i] = v;
+			continue;
+		}
+
+		const s32* neighbors = system->m_neighbors + i * maxParticleNeighbors;
+		s32 count = system->m_neighborCounts[i];
+		glm::vec2 sum(0.0f, 0.0f);
+		real32 weight = 0.0f;
+		for (s32 k = 0; k < count; ++k)
+		{
+			s32 j = neighbors[k];
+			if (flags[j] & granularParticle)
+			{
+				continue;
+			}
+
+			glm::vec2 d = positions[i] - positions[j];
+			real32 q = h2 - glm::dot(d, d);
+			if (q > 0.0f)
+			{
+				real32 w = q * q * q;
+				sum += w * (velocities[j] - v);
+				weight += w;
+			}
+		}
+
+		if (weight > 0.0f)
+		{
+			v += (viscosity / weight) * sum;
+		}
+		system->m_deltas[i] = v;
+	}
+}
+
+void ParticleSystem::ApplyImpulses()
+{
+	for (s32 k = 0; k < m_shapeContactCount; ++k)
+	{
+		const ShapeContact* contact = m_sortedContacts + k;
+		if (contact->impulse.x == 0.0f && contact->impulse.y == 0.0f)
+		{
+			continue;
+		}
+
+		// Particles do not wake bodies: a resting fluid would keep them awake.
+		Body* body = m_shapeProxies[contact->proxy].body;
+		body->ApplyLinearImpulse(contact->impulse, contact->point, false);
+	}
+}
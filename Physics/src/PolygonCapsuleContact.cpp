@@ -0,0 +1,37 @@
+#include "PolygonCapsuleContact.hpp"
+#include "BlockAllocator.hpp"
+#include "Fixture.hpp"
+#include "CapsuleShape.hpp"
+#include "PolygonShape.hpp"
+#include <new>
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+
+Contact* PolygonAndCapsuleContact::Create(Fixture* fixtureA, s32, Fixture* fixtureB, s32, BlockAllocator* allocator)
+{
+	void* mem = allocator->Allocate(sizeof(PolygonAndCapsuleContact));
+	return new (mem) PolygonAndCapsuleContact(fixtureA, fixtureB);
+}
+
+void PolygonAndCapsuleContact::Destroy(Contact* contact, BlockAllocator* allocator)
+{
+	((PolygonAndCapsuleContact*)contact)->~PolygonAndCapsuleContact();
+	allocator->Free(contact, sizeof(PolygonAndCapsuleContact));
+}
+
+PolygonAndCapsuleContact::PolygonAndCapsuleContact(Fixture* fixtureA, Fixture* fixtureB)
+	: Contact(fixtureA, 0, fixtureB, 0)
+{
+	assert(m_fixtureA->GetType() == Shape::polygon);
+	assert(m_fixtureB->GetType() == Shape::capsule);
+}
+
+void PolygonAndCapsuleContact::Evaluate(Manifold* manifold, const Transform2D& xfA, const Transform2D& xfB)
+{
+	CollidePolygonAndCapsule(manifold, &m_separationCache,
+		(PolygonShape*)m_fixtureA->GetShape(), xfA,
+		(CapsuleShape*)m_fixtureB->GetShape(), xfB);
+}
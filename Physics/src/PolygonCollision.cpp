@@ -5,35 +5,42 @@ using namespace Break;
 using namespace Break::Infrastructure;
 using namespace Break::Physics;
 
+// Find the separation between poly1 and poly2 along the normal of edge i of poly1.
+// xf takes poly1 coordinates to poly2 coordinates.
+static real32 EdgeSeparation(const PolygonShape* poly1, const Transform2D& xf, s32 i, const PolygonShape* poly2)
+{
+	s32 count2 = poly2->m_count;
+	const glm::vec2* v2s = poly2->m_vertices;
+
+	// Get poly1 normal in frame2.
+	glm::vec2 n = Rotation2D::Mul(xf.q, poly1->m_normals[i]);
+	glm::vec2 v1 = Transform2D::Mul(xf, poly1->m_vertices[i]);
+
+	// Find deepest point for normal i.
+	real32 si = FLT_MAX;
+	for (s32 j = 0; j < count2; ++j)
+	{
+		real32 sij = glm::dot(n, v2s[j] - v1);
+		if (sij < si)
+		{
+			si = sij;
+		}
+	}
+
+	return si;
+}
+
 // Find the max separation between poly1 and poly2 using edge normals from poly1.
 static real32 FindMaxSeparation(s32* edgeIndex,const PolygonShape* poly1, const Transform2D& xf1,const PolygonShape* poly2, const Transform2D& xf2)
 {
 	s32 count1 = poly1->m_count;
-	s32 count2 = poly2->m_count;
-	const glm::vec2* n1s = poly1->m_normals;
-	const glm::vec2* v1s = poly1->m_vertices;
-	const glm::vec2* v2s = poly2->m_vertices;
 	Transform2D xf = Transform2D::MulT(xf2, xf1);
 
 	s32 bestIndex = 0;
 	real32 maxSeparation = -FLT_MAX;  //<<<---- using of maxfloat
 	for (s32 i = 0; i < count1; ++i)
 	{
-		// Get poly1 normal in frame2.
-		glm::vec2 n = Rotation2D::Mul(xf.q, n1s[i]);
-		glm::vec2 v1 = Transform2D::Mul(xf, v1s[i]);
-
-		// Find deepest point for normal i.
-		real32 si = FLT_MAX;
-		for (s32 j = 0; j < count2; ++j)
-		{
-			real32 sij = glm::dot(n, v2s[j] - v1);
-			if (sij < si)
-			{
-				si = sij;
-			}
-		}
-
+		real32 si = EdgeSeparation(poly1, xf, i, poly2);
 		if (si > maxSeparation)
 		{
 			maxSeparation = si;
@@ -45,6 +52,17 @@ static real32 FindMaxSeparation(s32* edgeIndex,const PolygonShape* poly1, const
 	return maxSeparation;
 }
 
+// Get the distance of the farthest vertex from the polygon origin.
+static real32 GetBoundingRadius(const PolygonShape* poly)
+{
+	real32 radiusSquared = 0.0f;
+	for (s32 i = 0; i < poly->m_count; ++i)
+	{
+		radiusSquared = glm::max(radiusSquared, MathUtils::LengthSquared(poly->m_vertices[i]));
+	}
+	return sqrtf(radiusSquared);
+}
+
 static void FindIncidentEdge(ClipVertex c[2],const PolygonShape* poly1, const Transform2D& xf1, s32 edge1,const PolygonShape* poly2, const Transform2D& xf2)
 {
 	const glm::vec2* normals1 = poly1->m_normals;
@@ -97,46 +115,14 @@ static void FindIncidentEdge(ClipVertex c[2],const PolygonShape* poly1, const Tr
 // The normal points from 1 to 2
 void Physics::CollidePolygons(Manifold* manifold,const PolygonShape* polyA, const Transform2D& xfA,const PolygonShape* polyB, const Transform2D& xfB)
 {
-	manifold->pointCount = 0;
-	real32 totalRadius = polyA->m_radius + polyB->m_radius;
-
-	s32 edgeA = 0;
-	real32 separationA = FindMaxSeparation(&edgeA, polyA, xfA, polyB, xfB);
-	if (separationA > totalRadius)
-		return;
-
-	s32 edgeB = 0;
-	real32 separationB = FindMaxSeparation(&edgeB, polyB, xfB, polyA, xfA);
-	if (separationB > totalRadius)
-		return;
-
-	const PolygonShape* poly1;	// reference polygon
-	const PolygonShape* poly2;	// incident polygon
-	Transform2D xf1, xf2;
-	s32 edge1;					// reference edge
-	u8 flip;
-	const real32 k_tol = 0.1f * linearSlop;
+	CollidePolygons(manifold, NULL, polyA, xfA, polyB, xfB);
+}
 
-	if (separationB > separationA + k_tol)
-	{
-		poly1 = polyB;
-		poly2 = polyA;
-		xf1 = xfB;
-		xf2 = xfA;
-		edge1 = edgeB;
-		manifold->type = Manifold::faceB;
-		flip = 1;
-	}
-	else
-	{
-		poly1 = polyA;
-		poly2 = polyB;
-		xf1 = xfA;
-		xf2 = xfB;
-		edge1 = edgeA;
-		manifold->type = Manifold::faceA;
-		flip = 0;
-	}
+// Clip the incident edge of poly2 against reference edge edge1 of poly1.
+static void ClipPolygons(Manifold* manifold, const PolygonShape* poly1, const Transform2D& xf1, s32 edge1,
+						 const PolygonShape* poly2, const Transform2D& xf2, u8 flip, real32 totalRadius)
+{
+	manifold->type = flip ? Manifold::faceB : Manifold::faceA;
 
 	ClipVertex incidentEdge[2];
 	FindIncidentEdge(incidentEdge, poly1, xf1, edge1, poly2, xf2);
@@ -217,3 +203,108 @@ void Physics::CollidePolygons(Manifold* manifold,const PolygonShape* polyA, cons
 
 	manifold->pointCount = pointCount;
 }
+
+void Physics::CollidePolygons(Manifold* manifold, SeparationCache* cache, const PolygonShape* polyA, const Transform2D& xfA, const PolygonShape* polyB, const Transform2D& xfB)
+{
+	manifold->pointCount = 0;
+	real32 totalRadius = polyA->m_radius + polyB->m_radius;
+	const real32 k_tol = 0.1f * linearSlop;
+
+	Transform2D xf;
+	if (cache != NULL)
+	{
+		xf = Transform2D::MulT(xfA, xfB);
+
+		switch (cache->type)
+		{
+		case SeparationCache::separatedA:
+			// Any separating axis proves that there is no contact.
+			if (EdgeSeparation(polyA, Transform2D::MulT(xfB, xfA), cache->index, polyB) > totalRadius)
+			{
+				return;
+			}
+			break;
+
+		case SeparationCache::separatedB:
+			if (EdgeSeparation(polyB, xf, cache->index, polyA) > totalRadius)
+			{
+				return;
+			}
+			break;
+
+		case SeparationCache::faceA:
+		case SeparationCache::faceB:
+			{
+				// The separation along any axis changes by at most delta since the cache
+				// was filled, so the cached face is still within k_tol + 2 * delta of
+				// the deepest one. Keep it while that stays within 2 * k_tol.
+				real32 dp = MathUtils::Distance(xf.p, cache->xf.p);
+				real32 dq = glm::length(glm::vec2(xf.q.c - cache->xf.q.c, xf.q.s - cache->xf.q.s));
+				real32 delta = dp;
+				if (dq > 0.0f)
+				{
+					delta += dq * (GetBoundingRadius(polyA) + GetBoundingRadius(polyB) + glm::length(xf.p));
+				}
+
+				if (2.0f * delta < k_tol)
+				{
+					if (cache->type == SeparationCache::faceB)
+					{
+						ClipPolygons(manifold, polyB, xfB, cache->index, polyA, xfA, 1, totalRadius);
+					}
+					else
+					{
+						ClipPolygons(manifold, polyA, xfA, cache->index, polyB, xfB, 0, totalRadius);
+					}
+					return;
+				}
+			}
+			break;
+		}
+	}
+
+	s32 edgeA = 0;
+	real32 separationA = FindMaxSeparation(&edgeA, polyA, xfA, polyB, xfB);
+	if (separationA > totalRadius)
+	{
+		if (cache != NULL)
+		{
+			cache->type = SeparationCache::separatedA;
+			cache->index = (u8)edgeA;
+		}
+		return;
+	}
+
+	s32 edgeB = 0;
+	real32 separationB = FindMaxSeparation(&edgeB, polyB, xfB, polyA, xfA);
+	if (separationB > totalRadius)
+	{
+		if (cache != NULL)
+		{
+			cache->type = SeparationCache::separatedB;
+			cache->index = (u8)edgeB;
+		}
+		return;
+	}
+
+	if (separationB > separationA + k_tol)
+	{
+		if (cache != NULL)
+		{
+			cache->xf = xf;
+			cache->type = SeparationCache::faceB;
+			cache->index = (u8)edgeB;
+		}
+		ClipPolygons(manifold, polyB, xfB, edgeB, polyA, xfA, 1, totalRadius);
+	}
+	else
+	{
+		if (cache != NULL)
+		{
+			cache->xf = xf;
+			cache->type = SeparationCache::faceA;
+			cache->index = (u8)edgeA;
+		}
+		ClipPolygons(manifold, polyA, xfA, edgeA, polyB, xfB, 0, totalRadius);
+	}
+}
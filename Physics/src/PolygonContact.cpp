@@ -33,7 +33,7 @@ PolygonContact::PolygonContact(Fixture* fixtureA, Fixture* fixtureB)
 
 void PolygonContact::Evaluate(Manifold* manifold, const Transform2D& xfA, const Transform2D& xfB)
 {
-	CollidePolygons(	manifold,
+	CollidePolygons(	manifold, &m_separationCache,
 		(PolygonShape*)m_fixtureA->GetShape(), xfA,
 		(PolygonShape*)m_fixtureB->GetShape(), xfB);
 }
@@ -328,6 +328,56 @@ bool PolygonShape::RayCast(RayCastOutput* output, const RayCastInput& input,cons
 	return false;
 }
 
+void PolygonShape::ComputeDistance(const Transform2D& xf, const glm::vec2& p, real32* distance, glm::vec2* normal, s32 childIndex) const
+{
+	NOT_USED(childIndex);
+
+	glm::vec2 pLocal = Rotation2D::MulT(xf.q, p - xf.p);
+
+	// Inside, the distance is the largest face separation.
+	s32 bestIndex = 0;
+	real32 maxSeparation = -FLT_MAX;
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		real32 separation = glm::dot(m_normals[i], pLocal - m_vertices[i]);
+		if (separation > maxSeparation)
+		{
+			maxSeparation = separation;
+			bestIndex = i;
+		}
+	}
+
+	if (maxSeparation <= 0.0f)
+	{
+		*distance = maxSeparation - m_radius;
+		*normal = Rotation2D::Mul(xf.q, m_normals[bestIndex]);
+		return;
+	}
+
+	// Outside, the point may be closest to a vertex, so find the closest
+	// point on the boundary.
+	glm::vec2 closest(0.0f, 0.0f);
+	real32 minDistanceSquared = FLT_MAX;
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		glm::vec2 v1 = m_vertices[i];
+		glm::vec2 v2 = m_vertices[i + 1 < m_count ? i + 1 : 0];
+		glm::vec2 e = v2 - v1;
+		real32 t = glm::clamp(glm::dot(pLocal - v1, e) / glm::dot(e, e), 0.0f, 1.0f);
+		glm::vec2 d = pLocal - (v1 + t * e);
+		real32 distanceSquared = glm::dot(d, d);
+		if (distanceSquared < minDistanceSquared)
+		{
+			minDistanceSquared = distanceSquared;
+			closest = d;
+		}
+	}
+
+	real32 length = sqrtf(minDistanceSquared);
+	*distance = length - m_radius;
+	*normal = Rotation2D::Mul(xf.q, (1.0f / length) * closest);
+}
+
 void PolygonShape::ComputeAABB(AABB* aabb, const Transform2D& xf, s32 childIndex) const
 {
 	NOT_USED(childIndex);
@@ -660,3 +660,21 @@ void PrismaticJoint::Dump()
 	printf("  jd.maxMotorForce = %.15lef;\n", m_maxMotorForce);
 	printf("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+void PrismaticJoint::SaveState(JointState* state) const
+{
+	state->values[0] = m_impulse.x;
+	state->values[1] = m_impulse.y;
+	state->values[2] = m_impulse.z;
+	state->values[3] = m_motorImpulse;
+	state->limitState = m_limitState;
+}
+
+void PrismaticJoint::LoadState(const JointState* state)
+{
+	m_impulse.x = state->values[0];
+	m_impulse.y = state->values[1];
+	m_impulse.z = state->values[2];
+	m_motorImpulse = state->values[3];
+	m_limitState = (LimitState)state->limitState;
+}
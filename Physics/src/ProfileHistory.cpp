@@ -0,0 +1,178 @@
+#include "ProfileHistory.hpp"
+#include <algorithm>
+#include <cstdio>
+
+using namespace Break;
+using namespace Break::Physics;
+
+
+ProfileHistory::ProfileHistory()
+{
+	m_profiles = NULL;
+	m_capacity = 0;
+	m_count = 0;
+	m_next = 0;
+}
+
+ProfileHistory::~ProfileHistory()
+{
+	free(m_profiles);
+}
+
+void ProfileHistory::SetCapacity(s32 capacity)
+{
+	assert(capacity >= 0);
+
+	free(m_profiles);
+	m_profiles = NULL;
+
+	m_capacity = capacity;
+	if (capacity > 0)
+	{
+		m_profiles = (Profile*)malloc(capacity * sizeof(Profile));
+	}
+
+	Clear();
+}
+
+void ProfileHistory::Clear()
+{
+	m_count = 0;
+	m_next = 0;
+}
+
+void ProfileHistory::Push(const Profile& profile)
+{
+	if (m_capacity == 0)
+	{
+		return;
+	}
+
+	m_profiles[m_next] = profile;
+	++m_next;
+	if (m_next == m_capacity)
+	{
+		m_next = 0;
+	}
+
+	if (m_count < m_capacity)
+	{
+		++m_count;
+	}
+}
+
+ProfileStats ProfileHistory::GetStats(ProfileField field) const
+{
+	ProfileStats stats;
+	stats.min = 0.0;
+	stats.avg = 0.0;
+	stats.max = 0.0;
+	stats.p99 = 0.0;
+
+	if (m_count == 0)
+	{
+		return stats;
+	}
+
+	// Sort a copy so concurrent readers do not share scratch space.
+	real64* values = (real64*)malloc(m_count * sizeof(real64));
+	real64 sum = 0.0;
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		values[i] = GetValue(m_profiles[i], field);
+		sum += values[i];
+	}
+
+	// The order of the ring does not matter for the statistics.
+	std::sort(values, values + m_count);
+	stats.min = values[0];
+	stats.max = values[m_count - 1];
+	stats.avg = sum / m_count;
+
+	s32 rank = (99 * m_count + 99) / 100;
+	stats.p99 = values[rank - 1];
+
+	free(values);
+	return stats;
+}
+
+bool ProfileHistory::DumpCSV(const char* path) const
+{
+	FILE* file = fopen(path, "w");
+	if (file == NULL)
+	{
+		return false;
+	}
+
+	for (s32 field = 0; field < profileFieldCount; ++field)
+	{
+		fprintf(file, field == 0 ? "%s" : ",%s", GetFieldName((ProfileField)field));
+	}
+	fprintf(file, "\n");
+
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		const Profile& profile = GetProfile(i);
+		for (s32 field = 0; field < profileFieldCount; ++field)
+		{
+			fprintf(file, field == 0 ? "%.0f" : ",%.0f", GetValue(profile, (ProfileField)field));
+		}
+		fprintf(file, "\n");
+	}
+
+	bool ok = ferror(file) == 0;
+	ok = fclose(file) == 0 && ok;
+	return ok;
+}
+
+const char* ProfileHistory::GetFieldName(ProfileField field)
+{
+	switch (field)
+	{
+	case profileStep:				return "step";
+	case profileBroadphase:			return "broadphase";
+	case profileNarrowphase:		return "narrowphase";
+	case profileSolve:				return "solve";
+	case profileIslands:			return "islands";
+	case profileSolveInit:			return "solveInit";
+	case profileSolveVelocity:		return "solveVelocity";
+	case profileSolvePosition:		return "solvePosition";
+	case profileSolveTOI:			return "solveTOI";
+	case profileSync:				return "sync";
+	case profileParticles:			return "particles";
+	case profileBroadphasePairs:	return "broadphasePairs";
+	case profileContactCount:		return "contactCount";
+	case profileIslandCount:		return "islandCount";
+	case profileTOIEventCount:		return "toiEventCount";
+	case profileGJKIterations:		return "gjkIterations";
+	default:
+		assert(false);
+		return "";
+	}
+}
+
+real64 ProfileHistory::GetValue(const Profile& profile, ProfileField field)
+{
+	switch (field)
+	{
+	case profileStep:				return (real64)profile.step;
+	case profileBroadphase:			return (real64)profile.broadphase;
+	case profileNarrowphase:		return (real64)profile.narrowphase;
+	case profileSolve:				return (real64)profile.solve;
+	case profileIslands:			return (real64)profile.islands;
+	case profileSolveInit:			return (real64)profile.solveInit;
+	case profileSolveVelocity:		return (real64)profile.solveVelocity;
+	case profileSolvePosition:		return (real64)profile.solvePosition;
+	case profileSolveTOI:			return (real64)profile.solveTOI;
+	case profileSync:				return (real64)profile.sync;
+	case profileParticles:			return (real64)profile.particles;
+	case profileBroadphasePairs:	return (real64)profile.broadphasePairs;
+	case profileContactCount:		return (real64)profile.contactCount;
+	case profileIslandCount:		return (real64)profile.islandCount;
+	case profileTOIEventCount:		return (real64)profile.toiEventCount;
+	case profileGJKIterations:		return (real64)profile.gjkIterations;
+	default:
+		assert(false);
+		return 0.0;
+	}
+}
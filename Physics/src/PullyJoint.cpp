@@ -32,9 +32,9 @@ void PulleyJointDef::Initialize(Body* bA, Body* bB,
 	localAnchorA = bodyA->GetLocalPoint(anchorA);
 	localAnchorB = bodyB->GetLocalPoint(anchorB);
 	glm::vec2 dA = anchorA - groundA;
-	lengthA = dA.length();
+	lengthA = glm::length(dA);
 	glm::vec2 dB = anchorB - groundB;
-	lengthB = dB.length();
+	lengthB = glm::length(dB);
 	ratio = r;
 	assert(ratio > FLT_EPSILON);
 }
@@ -88,8 +88,8 @@ void PulleyJoint::InitVelocityConstraints(const SolverData& data)
 	m_uA = cA + m_rA - m_groundAnchorA;
 	m_uB = cB + m_rB - m_groundAnchorB;
 
-	real32 lengthA = m_uA.length();
-	real32 lengthB = m_uB.length();
+	real32 lengthA = glm::length(m_uA);
+	real32 lengthB = glm::length(m_uB);
 
 	if (lengthA > 10.0f * linearSlop)
 	{
@@ -191,8 +191,8 @@ bool PulleyJoint::SolvePositionConstraints(const SolverData& data)
 	glm::vec2 uA = cA + rA - m_groundAnchorA;
 	glm::vec2 uB = cB + rB - m_groundAnchorB;
 
-	real32 lengthA = uA.length();
-	real32 lengthB = uB.length();
+	real32 lengthA = glm::length(uA);
+	real32 lengthB = glm::length(uB);
 
 	if (lengthA > 10.0f * linearSlop)
 	{
@@ -299,7 +299,7 @@ real32 PulleyJoint::GetCurrentLengthA() const
 	glm::vec2 p = m_bodyA->GetWorldPoint(m_localAnchorA);
 	glm::vec2 s = m_groundAnchorA;
 	glm::vec2 d = p - s;
-	return d.length();
+	return glm::length(d);
 }
 
 real32 PulleyJoint::GetCurrentLengthB() const
@@ -307,7 +307,7 @@ real32 PulleyJoint::GetCurrentLengthB() const
 	glm::vec2 p = m_bodyB->GetWorldPoint(m_localAnchorB);
 	glm::vec2 s = m_groundAnchorB;
 	glm::vec2 d = p - s;
-	return d.length();
+	return glm::length(d);
 }
 
 void PulleyJoint::Dump()
@@ -333,4 +333,14 @@ void PulleyJoint::ShiftOrigin(const glm::vec2& newOrigin)
 {
 	m_groundAnchorA -= newOrigin;
 	m_groundAnchorB -= newOrigin;
-}
\ No newline at end of file
+}
+
+void PulleyJoint::SaveState(JointState* state) const
+{
+	state->values[0] = m_impulse;
+}
+
+void PulleyJoint::LoadState(const JointState* state)
+{
+	m_impulse = state->values[0];
+}
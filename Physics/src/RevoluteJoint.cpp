@@ -355,7 +355,7 @@ bool RevoluteJoint::SolvePositionConstraints(const SolverData& data)
 		glm::vec2 rB = Rotation2D::Mul(qB, m_localAnchorB - m_localCenterB);
 
 		glm::vec2 C = cB + rB - cA - rA;
-		positionError = C.length();
+		positionError = glm::length(C);
 
 		real32 mA = m_invMassA, mB = m_invMassB;
 		real32 iA = m_invIA, iB = m_invIB;
@@ -517,3 +517,21 @@ void RevoluteJoint::Dump()
 	printf("  jd.maxMotorTorque = %.15lef;\n", m_maxMotorTorque);
 	printf("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+void RevoluteJoint::SaveState(JointState* state) const
+{
+	state->values[0] = m_impulse.x;
+	state->values[1] = m_impulse.y;
+	state->values[2] = m_impulse.z;
+	state->values[3] = m_motorImpulse;
+	state->limitState = m_limitState;
+}
+
+void RevoluteJoint::LoadState(const JointState* state)
+{
+	m_impulse.x = state->values[0];
+	m_impulse.y = state->values[1];
+	m_impulse.z = state->values[2];
+	m_motorImpulse = state->values[3];
+	m_limitState = (LimitState)state->limitState;
+}
@@ -55,7 +55,7 @@ void RopeJoint::InitVelocityConstraints(const SolverData& data)
 	m_rB = Rotation2D::Mul(qB, m_localAnchorB - m_localCenterB);
 	m_u = cB + m_rB - cA - m_rA;
 
-	m_length = m_u.length();
+	m_length = glm::length(m_u);
 
 	real32 C = m_length - m_maxLength;
 	if (C > 0.0f)
@@ -157,7 +157,7 @@ bool RopeJoint::SolvePositionConstraints(const SolverData& data)
 	glm::vec2 rB = Rotation2D::Mul(qB, m_localAnchorB - m_localCenterB);
 	glm::vec2 u = cB + rB - cA - rA;
 
-	real32 length = u.length();
+	real32 length = glm::length(u);
 	real32 C = length - m_maxLength;
 
 	C = glm::clamp(C, 0.0f, maxLinearCorrection);
@@ -224,3 +224,15 @@ void RopeJoint::Dump()
 	printf("  jd.maxLength = %.15lef;\n", m_maxLength);
 	printf("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+void RopeJoint::SaveState(JointState* state) const
+{
+	state->values[0] = m_impulse;
+	state->limitState = m_state;
+}
+
+void RopeJoint::LoadState(const JointState* state)
+{
+	m_impulse = state->values[0];
+	m_state = (LimitState)state->limitState;
+}
@@ -0,0 +1,454 @@
+#include "SpatialHash.hpp"
+#include <float.h>
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+
+// Double the capacity of a malloc'ed buffer, keeping the first count elements.
+template <typename T>
+static void GrowBuffer(T*& buffer, s32 count, s32& capacity)
+{
+	T* oldBuffer = buffer;
+	capacity *= 2;
+	buffer = (T*)malloc(capacity * sizeof(T));
+	memcpy(buffer, oldBuffer, count * sizeof(T));
+	free(oldBuffer);
+}
+
+SpatialHash::SpatialHash(real32 cellSize)
+{
+	assert(cellSize > 0.0f);
+	m_type = spatialHashBroadPhase;
+	m_cellSize = cellSize;
+	m_inverseCellSize = 1.0f / cellSize;
+
+	m_proxyCapacity = 16;
+	m_proxyCount = 0;
+	m_proxies = (Proxy*)malloc(m_proxyCapacity * sizeof(Proxy));
+	for (s32 i = 0; i < m_proxyCapacity - 1; ++i)
+	{
+		m_proxies[i].next = i + 1;
+		m_proxies[i].flags = 0;
+	}
+	m_proxies[m_proxyCapacity - 1].next = nullProxy;
+	m_proxies[m_proxyCapacity - 1].flags = 0;
+	m_freeList = 0;
+
+	m_bucketCount = 0;
+	m_bucketStart = NULL;
+
+	m_cellProxyCapacity = 16;
+	m_cellProxies = (s32*)malloc(m_cellProxyCapacity * sizeof(s32));
+
+	m_oversizedCapacity = 16;
+	m_oversizedCount = 0;
+	m_oversized = (s32*)malloc(m_oversizedCapacity * sizeof(s32));
+
+	m_gridDirty = true;
+
+	m_touchCapacity = 16;
+	m_touchCount = 0;
+	m_touchBuffer = (s32*)malloc(m_touchCapacity * sizeof(s32));
+
+	m_pairCapacity = 16;
+	m_pairCount = 0;
+	m_pairBuffer = (Pair*)malloc(m_pairCapacity * sizeof(Pair));
+}
+
+SpatialHash::~SpatialHash()
+{
+	free(m_proxies);
+	free(m_bucketStart);
+	free(m_cellProxies);
+	free(m_oversized);
+	free(m_touchBuffer);
+	free(m_pairBuffer);
+}
+
+s32 SpatialHash::CreateProxy(const AABB& aabb, void* userData)
+{
+	s32 proxyId = AddProxy(aabb, userData);
+	TouchProxy(proxyId);
+	return proxyId;
+}
+
+void SpatialHash::CreateProxies(const AABB* aabbs, void* const* userData, s32 count, s32* proxyIds)
+{
+	for (s32 i = 0; i < count; ++i)
+	{
+		proxyIds[i] = AddProxy(aabbs[i], userData[i]);
+	}
+}
+
+s32 SpatialHash::AddProxy(const AABB& aabb, void* userData)
+{
+	if (m_freeList == nullProxy)
+	{
+		s32 oldCapacity = m_proxyCapacity;
+		GrowBuffer(m_proxies, oldCapacity, m_proxyCapacity);
+		for (s32 i = oldCapacity; i < m_proxyCapacity - 1; ++i)
+		{
+			m_proxies[i].next = i + 1;
+			m_proxies[i].flags = 0;
+		}
+		m_proxies[m_proxyCapacity - 1].next = nullProxy;
+		m_proxies[m_proxyCapacity - 1].flags = 0;
+		m_freeList = oldCapacity;
+	}
+
+	s32 proxyId = m_freeList;
+	Proxy* proxy = m_proxies + proxyId;
+	m_freeList = proxy->next;
+
+	// Fatten the aabb.
+	glm::vec2 r(aabbExtension, aabbExtension);
+	proxy->aabb.lowerBound = aabb.lowerBound - r;
+	proxy->aabb.upperBound = aabb.upperBound + r;
+	proxy->userData = userData;
+	proxy->next = nullProxy;
+	proxy->flags = liveFlag;
+
+	++m_proxyCount;
+	m_gridDirty = true;
+	return proxyId;
+}
+
+void SpatialHash::DestroyProxy(s32 proxyId)
+{
+	assert(0 <= proxyId && proxyId < m_proxyCapacity);
+	Proxy* proxy = m_proxies + proxyId;
+	assert(proxy->flags & liveFlag);
+
+	proxy->flags = 0;
+	proxy->userData = NULL;
+	proxy->next = m_freeList;
+	m_freeList = proxyId;
+
+	--m_proxyCount;
+	m_gridDirty = true;
+}
+
+void SpatialHash::MoveProxy(s32 proxyId, const AABB& aabb, const glm::vec2& displacement)
+{
+	assert(0 <= proxyId && proxyId < m_proxyCapacity);
+	Proxy* proxy = m_proxies + proxyId;
+	assert(aabb.IsValid());
+
+	if (proxy->aabb.Contains(aabb))
+	{
+		return;
+	}
+
+	// Extend AABB, the same way the dynamic tree does.
+	AABB b = aabb;
+	glm::vec2 r(aabbExtension, aabbExtension);
+	b.lowerBound = b.lowerBound - r;
+	b.upperBound = b.upperBound + r;
+
+	// Predict AABB displacement.
+	glm::vec2 d = aabbMultiplier * displacement;
+
+	if (d.x < 0.0f)
+	{
+		b.lowerBound.x += d.x;
+	}
+	else
+	{
+		b.upperBound.x += d.x;
+	}
+
+	if (d.y < 0.0f)
+	{
+		b.lowerBound.y += d.y;
+	}
+	else
+	{
+		b.upperBound.y += d.y;
+	}
+
+	SetFatAABB(proxyId, b);
+	TouchProxy(proxyId);
+}
+
+void SpatialHash::SetFatAABB(s32 proxyId, const AABB& fatAABB)
+{
+	assert(0 <= proxyId && proxyId < m_proxyCapacity);
+	Proxy* proxy = m_proxies + proxyId;
+	if (proxy->aabb.lowerBound == fatAABB.lowerBound && proxy->aabb.upperBound == fatAABB.upperBound)
+	{
+		return;
+	}
+
+	proxy->aabb = fatAABB;
+	m_gridDirty = true;
+}
+
+void SpatialHash::TouchProxy(s32 proxyId)
+{
+	assert(0 <= proxyId && proxyId < m_proxyCapacity);
+	Proxy* proxy = m_proxies + proxyId;
+	if (proxy->flags & touchedFlag)
+	{
+		return;
+	}
+
+	proxy->flags |= touchedFlag;
+	if (m_touchCount == m_touchCapacity)
+	{
+		GrowBuffer(m_touchBuffer, m_touchCount, m_touchCapacity);
+	}
+	m_touchBuffer[m_touchCount] = proxyId;
+	++m_touchCount;
+}
+
+// Rebuild the bucket table from scratch with a counting sort over all cells
+// covered by all proxies.
+void SpatialHash::UpdateGrid()
+{
+	if (m_gridDirty == false)
+	{
+		return;
+	}
+
+	m_oversizedCount = 0;
+	s32 entryCount = 0;
+	for (s32 i = 0; i < m_proxyCapacity; ++i)
+	{
+		Proxy* proxy = m_proxies + i;
+		if ((proxy->flags & liveFlag) == 0)
+		{
+			continue;
+		}
+
+		proxy->lowerX = GetCell(proxy->aabb.lowerBound.x);
+		proxy->lowerY = GetCell(proxy->aabb.lowerBound.y);
+		proxy->upperX = GetCell(proxy->aabb.upperBound.x);
+		proxy->upperY = GetCell(proxy->aabb.upperBound.y);
+
+		s64 cellCount = (s64)(proxy->upperX - proxy->lowerX + 1) * (s64)(proxy->upperY - proxy->lowerY + 1);
+		if (cellCount > maxProxyCells)
+		{
+			proxy->flags |= oversizedFlag;
+			if (m_oversizedCount == m_oversizedCapacity)
+			{
+				GrowBuffer(m_oversized, m_oversizedCount, m_oversizedCapacity);
+			}
+			m_oversized[m_oversizedCount] = i;
+			++m_oversizedCount;
+		}
+		else
+		{
+			proxy->flags &= ~oversizedFlag;
+			entryCount += (s32)cellCount;
+		}
+	}
+
+	// Keep the load factor at or below one.
+	s32 bucketCount = 16;
+	while (bucketCount < entryCount)
+	{
+		bucketCount <<= 1;
+	}
+
+	if (bucketCount != m_bucketCount)
+	{
+		free(m_bucketStart);
+		m_bucketStart = (s32*)malloc((bucketCount + 1) * sizeof(s32));
+		m_bucketCount = bucketCount;
+	}
+	memset(m_bucketStart, 0, (m_bucketCount + 1) * sizeof(s32));
+
+	if (entryCount > m_cellProxyCapacity)
+	{
+		free(m_cellProxies);
+		while (m_cellProxyCapacity < entryCount)
+		{
+			m_cellProxyCapacity *= 2;
+		}
+		m_cellProxies = (s32*)malloc(m_cellProxyCapacity * sizeof(s32));
+	}
+
+	// Count the entries per bucket.
+	for (s32 i = 0; i < m_proxyCapacity; ++i)
+	{
+		const Proxy* proxy = m_proxies + i;
+		if ((proxy->flags & (liveFlag | oversizedFlag)) != liveFlag)
+		{
+			continue;
+		}
+
+		for (s32 y = proxy->lowerY; y <= proxy->upperY; ++y)
+		{
+			for (s32 x = proxy->lowerX; x <= proxy->upperX; ++x)
+			{
+				++m_bucketStart[GetBucket(x, y)];
+			}
+		}
+	}
+
+	// Turn the counts into bucket ends.
+	for (s32 i = 1; i < m_bucketCount; ++i)
+	{
+		m_bucketStart[i] += m_bucketStart[i - 1];
+	}
+	m_bucketStart[m_bucketCount] = entryCount;
+
+	// Fill backwards so every bucket ends up sorted by proxy id and its ends
+	// become starts. All entries of one proxy in a bucket are adjacent.
+	for (s32 i = m_proxyCapacity - 1; i >= 0; --i)
+	{
+		const Proxy* proxy = m_proxies + i;
+		if ((proxy->flags & (liveFlag | oversizedFlag)) != liveFlag)
+		{
+			continue;
+		}
+
+		for (s32 y = proxy->lowerY; y <= proxy->upperY; ++y)
+		{
+			for (s32 x = proxy->lowerX; x <= proxy->upperX; ++x)
+			{
+				s32 index = --m_bucketStart[GetBucket(x, y)];
+				m_cellProxies[index] = i;
+			}
+		}
+	}
+
+	m_gridDirty = false;
+}
+
+void SpatialHash::AddPair(s32 proxyIdA, s32 proxyIdB)
+{
+	if (m_pairCount == m_pairCapacity)
+	{
+		GrowBuffer(m_pairBuffer, m_pairCount, m_pairCapacity);
+	}
+
+	m_pairBuffer[m_pairCount].proxyIdA = glm::min(proxyIdA, proxyIdB);
+	m_pairBuffer[m_pairCount].proxyIdB = glm::max(proxyIdA, proxyIdB);
+	++m_pairCount;
+}
+
+// Buffer a pair for every proxy overlapping a new or moved proxy.
+void SpatialHash::QueryProxy(s32 proxyId)
+{
+	const Proxy* proxy = m_proxies + proxyId;
+
+	if (proxy->flags & oversizedFlag)
+	{
+		for (s32 i = 0; i < m_proxyCapacity; ++i)
+		{
+			if (i != proxyId && (m_proxies[i].flags & liveFlag) && TestOverlap(proxyId, i))
+			{
+				AddPair(proxyId, i);
+			}
+		}
+		return;
+	}
+
+	for (s32 y = proxy->lowerY; y <= proxy->upperY; ++y)
+	{
+		for (s32 x = proxy->lowerX; x <= proxy->upperX; ++x)
+		{
+			u32 bucket = GetBucket(x, y);
+			s32 previousId = nullProxy;
+			for (s32 i = m_bucketStart[bucket]; i < m_bucketStart[bucket + 1]; ++i)
+			{
+				s32 otherId = m_cellProxies[i];
+				if (otherId == previousId || otherId == proxyId)
+				{
+					continue;
+				}
+				previousId = otherId;
+
+				// Only pair up in the first cell both proxies cover.
+				const Proxy* other = m_proxies + otherId;
+				if (glm::max(other->lowerX, proxy->lowerX) != x || glm::max(other->lowerY, proxy->lowerY) != y)
+				{
+					continue;
+				}
+
+				if (TestOverlap(proxyId, otherId))
+				{
+					AddPair(proxyId, otherId);
+				}
+			}
+		}
+	}
+
+	for (s32 i = 0; i < m_oversizedCount; ++i)
+	{
+		s32 otherId = m_oversized[i];
+		if (TestOverlap(proxyId, otherId))
+		{
+			AddPair(proxyId, otherId);
+		}
+	}
+}
+
+void SpatialHash::UpdatePairs(BroadPhasePairCallback* callback)
+{
+	UpdateGrid();
+
+	// Perform the queries now that the grid is final.
+	for (s32 i = 0; i < m_touchCount; ++i)
+	{
+		s32 proxyId = m_touchBuffer[i];
+		Proxy* proxy = m_proxies + proxyId;
+		if ((proxy->flags & touchedFlag) == 0)
+		{
+			continue;
+		}
+
+		proxy->flags &= ~touchedFlag;
+		QueryProxy(proxyId);
+	}
+	m_touchCount = 0;
+
+	// Sort the pair buffer to expose duplicates.
+	std::sort(m_pairBuffer, m_pairBuffer + m_pairCount, PairLessThan);
+
+	// Send the pairs back to the client.
+	s32 i = 0;
+	while (i < m_pairCount)
+	{
+		Pair* primaryPair = m_pairBuffer + i;
+		callback->AddPair(m_proxies[primaryPair->proxyIdA].userData, m_proxies[primaryPair->proxyIdB].userData);
+		++i;
+
+		// Skip any duplicate pairs.
+		while (i < m_pairCount)
+		{
+			Pair* pair = m_pairBuffer + i;
+			if (pair->proxyIdA != primaryPair->proxyIdA || pair->proxyIdB != primaryPair->proxyIdB)
+			{
+				break;
+			}
+			++i;
+		}
+	}
+
+	m_pairCount = 0;
+}
+
+void SpatialHash::Query(BroadPhaseQueryCallback* callback, const AABB& aabb) const
+{
+	Query<BroadPhaseQueryCallback>(callback, aabb);
+}
+
+void SpatialHash::RayCast(BroadPhaseRayCastCallback* callback, const RayCastInput& input) const
+{
+	RayCast<BroadPhaseRayCastCallback>(callback, input);
+}
+
+void SpatialHash::ShiftOrigin(const glm::vec2& newOrigin)
+{
+	for (s32 i = 0; i < m_proxyCapacity; ++i)
+	{
+		m_proxies[i].aabb.lowerBound -= newOrigin;
+		m_proxies[i].aabb.upperBound -= newOrigin;
+	}
+
+	m_gridDirty = true;
+}
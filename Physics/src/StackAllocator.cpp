@@ -1,5 +1,6 @@
 #include "StackAllocator.hpp"
 #include <assert.h>
+#include <string.h>
 #include <glm/glm.hpp>
 using namespace Break;
 using namespace Break::Physics;
@@ -8,38 +9,98 @@ using namespace Break::Physics;
 
 StackAllocator::StackAllocator()
 {
-	m_index = 0;
 	m_allocation = 0;
-	m_maxAllocation = 0;
 	m_entryCount = 0;
+	m_entryCapacity = maxStackEntries;
+	m_entries = (StackEntry*)malloc(m_entryCapacity * sizeof(StackEntry));
+
+	memset(&m_stats, 0, sizeof(StackAllocatorStats));
+	m_stats.capacity = stackSize;
+
+	m_first = CreateBlock(stackSize);
+	m_block = m_first;
 }
 
 StackAllocator::~StackAllocator()
 {
-	assert(m_index == 0);
 	assert(m_entryCount == 0);
+	DestroyBlocks(m_first);
+	free(m_entries);
 }
 
-void* StackAllocator::Allocate(s32 size)
+StackBlock* StackAllocator::CreateBlock(s32 size)
 {
-	assert(m_entryCount < maxStackEntries);
+	// The data follows the header in the same heap block.
+	s32 headerSize = (sizeof(StackBlock) + stackAlignment - 1) & ~(stackAlignment - 1);
+	StackBlock* block = (StackBlock*)malloc(headerSize + size);
+	block->prev = NULL;
+	block->next = NULL;
+	block->data = (char*)block + headerSize;
+	block->size = size;
+	block->index = 0;
+	return block;
+}
 
-	StackEntry* entry = m_entries + m_entryCount;
-	entry->size = size;
-	if (m_index + size > stackSize)
+void StackAllocator::DestroyBlocks(StackBlock* block)
+{
+	while (block)
 	{
-		entry->data = (char*)malloc(size);
-		entry->usedMalloc = true;
+		StackBlock* next = block->next;
+		free(block);
+		block = next;
 	}
-	else
+}
+
+void StackAllocator::SetCapacity(s32 capacity)
+{
+	assert(m_entryCount == 0);
+	assert(capacity > 0);
+
+	DestroyBlocks(m_first);
+	m_first = CreateBlock(capacity);
+	m_block = m_first;
+	m_stats.capacity = capacity;
+}
+
+void* StackAllocator::Allocate(s32 size)
+{
+	if (m_entryCount == m_entryCapacity)
 	{
-		entry->data = m_data + m_index;
-		entry->usedMalloc = false;
-		m_index += size;
+		StackEntry* old = m_entries;
+		m_entryCapacity *= 2;
+		m_entries = (StackEntry*)malloc(m_entryCapacity * sizeof(StackEntry));
+		memcpy(m_entries, old, m_entryCount * sizeof(StackEntry));
+		free(old);
 	}
-	
-	m_allocation += size;
-	m_maxAllocation = glm::max(m_maxAllocation, m_allocation);
+
+	// Round up so the next entry stays aligned.
+	s32 alignedSize = (size + stackAlignment - 1) & ~(stackAlignment - 1);
+
+	if (m_block->index + alignedSize > m_block->size)
+	{
+		// The blocks after the current one are empty. Reuse the next one if it
+		// is large enough, otherwise replace them.
+		StackBlock* next = m_block->next;
+		if (next == NULL || next->size < alignedSize)
+		{
+			DestroyBlocks(next);
+			next = CreateBlock(glm::max(alignedSize, m_stats.capacity));
+			next->prev = m_block;
+			m_block->next = next;
+		}
+
+		m_block = next;
+		++m_stats.overflowCount;
+		m_stats.overflowBytes += size;
+	}
+
+	StackEntry* entry = m_entries + m_entryCount;
+	entry->size = alignedSize;
+	entry->data = m_block->data + m_block->index;
+	m_block->index += alignedSize;
+
+	m_allocation += alignedSize;
+	m_stats.maxAllocation = glm::max(m_stats.maxAllocation, m_allocation);
 	++m_entryCount;
 
 	return entry->data;
@@ -50,21 +111,36 @@ void StackAllocator::Free(void* p)
 	assert(m_entryCount > 0);
 	StackEntry* entry = m_entries + m_entryCount - 1;
 	assert(p == entry->data);
-	if (entry->usedMalloc)
-	{
-		free(p);
-	}
-	else
+
+	// Entries are freed in reverse order, so this one is at the top of the current block.
+	assert(entry->data + entry->size == m_block->data + m_block->index);
+	m_block->index -= entry->size;
+	if (m_block->index == 0 && m_block->prev != NULL)
 	{
-		m_index -= entry->size;
+		m_block = m_block->prev;
 	}
+
 	m_allocation -= entry->size;
 	--m_entryCount;
 
 	p = NULL;
 }
 
-s32 StackAllocator::GetMaxAllocation() const
+void StackAllocator::Reset()
 {
-	return m_maxAllocation;
-}
\ No newline at end of file
+	assert(m_entryCount == 0);
+
+	if (m_first->next == NULL)
+	{
+		return;
+	}
+
+	// The peak did not fit. Make room for it in a single block with some
+	// headroom, since a growing scene would overflow again on the next step.
+	s32 capacity = glm::max(2 * m_stats.capacity, m_stats.maxAllocation + m_stats.maxAllocation / 2);
+	DestroyBlocks(m_first);
+	m_first = CreateBlock(capacity);
+	m_block = m_first;
+	m_stats.capacity = capacity;
+	++m_stats.growCount;
+}
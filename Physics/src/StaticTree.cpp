@@ -0,0 +1,124 @@
+#include "StaticTree.hpp"
+#include <algorithm>
+#include <cstring>
+
+using namespace Break;
+using namespace Break::Physics;
+
+
+struct StaticTree::BuildItem
+{
+	glm::vec2 center;
+	s32 index;
+};
+
+namespace
+{
+	struct CenterLess
+	{
+		s32 axis;
+
+		template <typename T>
+		bool operator()(const T& a, const T& b) const
+		{
+			return a.center[axis] < b.center[axis];
+		}
+	};
+}
+
+StaticTree::StaticTree()
+{
+	m_nodes = NULL;
+	m_nodeCount = 0;
+	m_height = 0;
+}
+
+StaticTree::~StaticTree()
+{
+	free(m_nodes);
+}
+
+void StaticTree::Build(const AABB* aabbs, s32 count)
+{
+	Clear();
+	if (count == 0)
+	{
+		return;
+	}
+
+	BuildItem* items = (BuildItem*)malloc(count * sizeof(BuildItem));
+	for (s32 i = 0; i < count; ++i)
+	{
+		items[i].center = aabbs[i].GetCenter();
+		items[i].index = i;
+	}
+
+	// A binary tree over count leaves has 2 * count - 1 nodes.
+	m_nodes = (StaticNode*)malloc((2 * count - 1) * sizeof(StaticNode));
+	BuildNode(items, count, aabbs, 0);
+	assert(m_nodeCount == 2 * count - 1);
+
+	free(items);
+}
+
+// Split at the median of the longest axis of the item centers. Static
+// geometry is built once, so a balanced tree is preferred over a faster build.
+s32 StaticTree::BuildNode(BuildItem* items, s32 count, const AABB* aabbs, s32 depth)
+{
+	s32 index = m_nodeCount;
+	++m_nodeCount;
+	m_height = glm::max(m_height, depth);
+
+	StaticNode* node = m_nodes + index;
+	if (count == 1)
+	{
+		node->aabb = aabbs[items[0].index];
+		node->item = items[0].index;
+		node->skip = m_nodeCount;
+		return index;
+	}
+
+	glm::vec2 lower = items[0].center;
+	glm::vec2 upper = items[0].center;
+	for (s32 i = 1; i < count; ++i)
+	{
+		lower = glm::min(lower, items[i].center);
+		upper = glm::max(upper, items[i].center);
+	}
+
+	CenterLess less;
+	less.axis = upper.x - lower.x >= upper.y - lower.y ? 0 : 1;
+
+	s32 half = count / 2;
+	std::nth_element(items, items + half, items + count, less);
+
+	s32 child1 = BuildNode(items, half, aabbs, depth + 1);
+	s32 child2 = BuildNode(items + half, count - half, aabbs, depth + 1);
+
+	node->aabb.Combine(m_nodes[child1].aabb, m_nodes[child2].aabb);
+	node->item = -1;
+	node->skip = m_nodeCount;
+	return index;
+}
+
+void StaticTree::Copy(const StaticTree* tree)
+{
+	Clear();
+	if (tree->m_nodeCount == 0)
+	{
+		return;
+	}
+
+	m_nodeCount = tree->m_nodeCount;
+	m_height = tree->m_height;
+	m_nodes = (StaticNode*)malloc(m_nodeCount * sizeof(StaticNode));
+	memcpy(m_nodes, tree->m_nodes, m_nodeCount * sizeof(StaticNode));
+}
+
+void StaticTree::Clear()
+{
+	free(m_nodes);
+	m_nodes = NULL;
+	m_nodeCount = 0;
+	m_height = 0;
+}
@@ -0,0 +1,536 @@
+#include "SweepAndPrune.hpp"
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+
+// Double the capacity of a malloc'ed buffer, keeping the first count elements.
+template <typename T>
+static void GrowBuffer(T*& buffer, s32 count, s32& capacity)
+{
+	T* oldBuffer = buffer;
+	capacity *= 2;
+	buffer = (T*)malloc(capacity * sizeof(T));
+	memcpy(buffer, oldBuffer, count * sizeof(T));
+	free(oldBuffer);
+}
+
+SweepAndPrune::SweepAndPrune()
+{
+	m_type = sweepAndPruneBroadPhase;
+	m_proxyCapacity = 16;
+	m_proxyCount = 0;
+	m_proxies = (Proxy*)malloc(m_proxyCapacity * sizeof(Proxy));
+	for (s32 i = 0; i < m_proxyCapacity - 1; ++i)
+	{
+		m_proxies[i].next = i + 1;
+		m_proxies[i].flags = 0;
+	}
+	m_proxies[m_proxyCapacity - 1].next = nullProxy;
+	m_proxies[m_proxyCapacity - 1].flags = 0;
+	m_freeList = 0;
+
+	m_endpointCapacity = 32;
+	m_endpointCount = 0;
+	m_endpoints = (Endpoint*)malloc(m_endpointCapacity * sizeof(Endpoint));
+
+	m_maxExtent = 0.0f;
+
+	m_pendingCapacity = 16;
+	m_pendingCount = 0;
+	m_pendingBuffer = (s32*)malloc(m_pendingCapacity * sizeof(s32));
+
+	m_touchCapacity = 16;
+	m_touchCount = 0;
+	m_touchBuffer = (s32*)malloc(m_touchCapacity * sizeof(s32));
+
+	m_deadCount = 0;
+
+	m_pairCapacity = 16;
+	m_pairCount = 0;
+	m_pairBuffer = (Pair*)malloc(m_pairCapacity * sizeof(Pair));
+}
+
+SweepAndPrune::~SweepAndPrune()
+{
+	free(m_proxies);
+	free(m_endpoints);
+	free(m_pendingBuffer);
+	free(m_touchBuffer);
+	free(m_pairBuffer);
+}
+
+bool SweepAndPrune::EndpointLessThan(const Endpoint& a, const Endpoint& b)
+{
+	if (a.value < b.value)
+	{
+		return true;
+	}
+
+	// Lower bounds go first on ties so touching boxes count as overlapping,
+	// matching TestOverlap.
+	return a.value == b.value && (a.data & 1) < (b.data & 1);
+}
+
+s32 SweepAndPrune::AllocateProxy()
+{
+	if (m_freeList == nullProxy)
+	{
+		s32 oldCapacity = m_proxyCapacity;
+		GrowBuffer(m_proxies, oldCapacity, m_proxyCapacity);
+		for (s32 i = oldCapacity; i < m_proxyCapacity - 1; ++i)
+		{
+			m_proxies[i].next = i + 1;
+			m_proxies[i].flags = 0;
+		}
+		m_proxies[m_proxyCapacity - 1].next = nullProxy;
+		m_proxies[m_proxyCapacity - 1].flags = 0;
+		m_freeList = oldCapacity;
+	}
+
+	s32 proxyId = m_freeList;
+	m_freeList = m_proxies[proxyId].next;
+	return proxyId;
+}
+
+s32 SweepAndPrune::CreateProxy(const AABB& aabb, void* userData)
+{
+	s32 proxyId = AddProxy(aabb, userData);
+	TouchProxy(proxyId);
+	return proxyId;
+}
+
+void SweepAndPrune::CreateProxies(const AABB* aabbs, void* const* userData, s32 count, s32* proxyIds)
+{
+	for (s32 i = 0; i < count; ++i)
+	{
+		proxyIds[i] = AddProxy(aabbs[i], userData[i]);
+	}
+}
+
+s32 SweepAndPrune::AddProxy(const AABB& aabb, void* userData)
+{
+	s32 proxyId = AllocateProxy();
+	Proxy* proxy = m_proxies + proxyId;
+
+	// Fatten the aabb.
+	glm::vec2 r(aabbExtension, aabbExtension);
+	proxy->aabb.lowerBound = aabb.lowerBound - r;
+	proxy->aabb.upperBound = aabb.upperBound + r;
+	proxy->userData = userData;
+	proxy->lower = -1;
+	proxy->upper = -1;
+	proxy->next = nullProxy;
+	proxy->flags = liveFlag | pendingFlag;
+
+	// The endpoints are merged in on the next UpdatePairs.
+	if (m_pendingCount == m_pendingCapacity)
+	{
+		GrowBuffer(m_pendingBuffer, m_pendingCount, m_pendingCapacity);
+	}
+	m_pendingBuffer[m_pendingCount] = proxyId;
+	++m_pendingCount;
+
+	m_maxExtent = glm::max(m_maxExtent, proxy->aabb.upperBound.x - proxy->aabb.lowerBound.x);
+
+	++m_proxyCount;
+	return proxyId;
+}
+
+void SweepAndPrune::DestroyProxy(s32 proxyId)
+{
+	assert(0 <= proxyId && proxyId < m_proxyCapacity);
+	Proxy* proxy = m_proxies + proxyId;
+	assert(proxy->flags & liveFlag);
+
+	// The endpoints stay in the array until the next compaction and the slot
+	// is not reused before then.
+	proxy->flags = deadFlag;
+	proxy->userData = NULL;
+	++m_deadCount;
+	--m_proxyCount;
+}
+
+void SweepAndPrune::MoveProxy(s32 proxyId, const AABB& aabb, const glm::vec2& displacement)
+{
+	assert(0 <= proxyId && proxyId < m_proxyCapacity);
+	Proxy* proxy = m_proxies + proxyId;
+	assert(aabb.IsValid());
+
+	if (proxy->aabb.Contains(aabb))
+	{
+		return;
+	}
+
+	// Extend AABB, the same way the dynamic tree does.
+	AABB b = aabb;
+	glm::vec2 r(aabbExtension, aabbExtension);
+	b.lowerBound = b.lowerBound - r;
+	b.upperBound = b.upperBound + r;
+
+	// Predict AABB displacement.
+	glm::vec2 d = aabbMultiplier * displacement;
+
+	if (d.x < 0.0f)
+	{
+		b.lowerBound.x += d.x;
+	}
+	else
+	{
+		b.upperBound.x += d.x;
+	}
+
+	if (d.y < 0.0f)
+	{
+		b.lowerBound.y += d.y;
+	}
+	else
+	{
+		b.upperBound.y += d.y;
+	}
+
+	SetFatAABB(proxyId, b);
+	TouchProxy(proxyId);
+}
+
+void SweepAndPrune::SetFatAABB(s32 proxyId, const AABB& fatAABB)
+{
+	assert(0 <= proxyId && proxyId < m_proxyCapacity);
+	Proxy* proxy = m_proxies + proxyId;
+
+	real32 oldUpper = proxy->aabb.upperBound.x;
+	proxy->aabb = fatAABB;
+	m_maxExtent = glm::max(m_maxExtent, fatAABB.upperBound.x - fatAABB.lowerBound.x);
+
+	if (proxy->flags & pendingFlag)
+	{
+		return;
+	}
+
+	m_endpoints[proxy->lower].value = fatAABB.lowerBound.x;
+	m_endpoints[proxy->upper].value = fatAABB.upperBound.x;
+
+	// Sort the leading bound first so the trailing one never has to pass it.
+	if (fatAABB.upperBound.x > oldUpper)
+	{
+		SortEndpoint(proxy->upper);
+		SortEndpoint(proxy->lower);
+	}
+	else
+	{
+		SortEndpoint(proxy->lower);
+		SortEndpoint(proxy->upper);
+	}
+}
+
+void SweepAndPrune::TouchProxy(s32 proxyId)
+{
+	assert(0 <= proxyId && proxyId < m_proxyCapacity);
+	Proxy* proxy = m_proxies + proxyId;
+	if (proxy->flags & touchedFlag)
+	{
+		return;
+	}
+
+	proxy->flags |= touchedFlag;
+	if (m_touchCount == m_touchCapacity)
+	{
+		GrowBuffer(m_touchBuffer, m_touchCount, m_touchCapacity);
+	}
+	m_touchBuffer[m_touchCount] = proxyId;
+	++m_touchCount;
+}
+
+void SweepAndPrune::SetEndpointIndex(const Endpoint& endpoint, s32 index)
+{
+	Proxy* proxy = m_proxies + (endpoint.data >> 1);
+	if (endpoint.data & 1)
+	{
+		proxy->upper = index;
+	}
+	else
+	{
+		proxy->lower = index;
+	}
+}
+
+// Insertion sort one endpoint into place.
+void SweepAndPrune::SortEndpoint(s32 index)
+{
+	Endpoint moving = m_endpoints[index];
+
+	while (index > 0 && EndpointLessThan(moving, m_endpoints[index - 1]))
+	{
+		m_endpoints[index] = m_endpoints[index - 1];
+		SetEndpointIndex(m_endpoints[index], index);
+		--index;
+	}
+
+	while (index < m_endpointCount - 1 && EndpointLessThan(m_endpoints[index + 1], moving))
+	{
+		m_endpoints[index] = m_endpoints[index + 1];
+		SetEndpointIndex(m_endpoints[index], index);
+		++index;
+	}
+
+	m_endpoints[index] = moving;
+	SetEndpointIndex(moving, index);
+}
+
+// Merge the endpoints of all pending proxies into the sorted array.
+void SweepAndPrune::InsertPending()
+{
+	s32 added = 0;
+	for (s32 i = 0; i < m_pendingCount; ++i)
+	{
+		if (m_proxies[m_pendingBuffer[i]].flags & liveFlag)
+		{
+			m_pendingBuffer[added] = m_pendingBuffer[i];
+			++added;
+		}
+	}
+	m_pendingCount = 0;
+
+	if (added == 0)
+	{
+		return;
+	}
+
+	s32 newCount = m_endpointCount + 2 * added;
+	if (newCount > m_endpointCapacity)
+	{
+		while (m_endpointCapacity < newCount)
+		{
+			m_endpointCapacity *= 2;
+		}
+
+		Endpoint* oldEndpoints = m_endpoints;
+		m_endpoints = (Endpoint*)malloc(m_endpointCapacity * sizeof(Endpoint));
+		memcpy(m_endpoints, oldEndpoints, m_endpointCount * sizeof(Endpoint));
+		free(oldEndpoints);
+	}
+
+	Endpoint* incoming = (Endpoint*)malloc(2 * added * sizeof(Endpoint));
+	for (s32 i = 0; i < added; ++i)
+	{
+		s32 proxyId = m_pendingBuffer[i];
+		Proxy* proxy = m_proxies + proxyId;
+		incoming[2 * i].value = proxy->aabb.lowerBound.x;
+		incoming[2 * i].data = 2 * proxyId;
+		incoming[2 * i + 1].value = proxy->aabb.upperBound.x;
+		incoming[2 * i + 1].data = 2 * proxyId + 1;
+		proxy->flags &= ~pendingFlag;
+	}
+	std::sort(incoming, incoming + 2 * added, EndpointLessThan);
+
+	// Merge from the back so the existing endpoints can stay in place.
+	s32 i = m_endpointCount - 1;
+	s32 j = 2 * added - 1;
+	for (s32 k = newCount - 1; j >= 0; --k)
+	{
+		if (i >= 0 && EndpointLessThan(incoming[j], m_endpoints[i]))
+		{
+			m_endpoints[k] = m_endpoints[i];
+			--i;
+		}
+		else
+		{
+			m_endpoints[k] = incoming[j];
+			--j;
+		}
+	}
+	free(incoming);
+
+	m_endpointCount = newCount;
+	for (s32 k = 0; k < m_endpointCount; ++k)
+	{
+		SetEndpointIndex(m_endpoints[k], k);
+	}
+}
+
+// Drop the endpoints of destroyed proxies and release their slots.
+void SweepAndPrune::Compact()
+{
+	s32 count = 0;
+	for (s32 i = 0; i < m_endpointCount; ++i)
+	{
+		if ((m_proxies[m_endpoints[i].data >> 1].flags & liveFlag) == 0)
+		{
+			continue;
+		}
+
+		m_endpoints[count] = m_endpoints[i];
+		SetEndpointIndex(m_endpoints[count], count);
+		++count;
+	}
+	m_endpointCount = count;
+
+	for (s32 i = 0; i < m_proxyCapacity; ++i)
+	{
+		Proxy* proxy = m_proxies + i;
+		if (proxy->flags == deadFlag)
+		{
+			proxy->flags = 0;
+			proxy->next = m_freeList;
+			m_freeList = i;
+		}
+	}
+
+	m_deadCount = 0;
+}
+
+void SweepAndPrune::ComputeMaxExtent()
+{
+	m_maxExtent = 0.0f;
+	for (s32 i = 0; i < m_endpointCount; ++i)
+	{
+		if (m_endpoints[i].data & 1)
+		{
+			continue;
+		}
+
+		const AABB& aabb = m_proxies[m_endpoints[i].data >> 1].aabb;
+		m_maxExtent = glm::max(m_maxExtent, aabb.upperBound.x - aabb.lowerBound.x);
+	}
+}
+
+// Index of the first endpoint not less than value.
+s32 SweepAndPrune::FindFirstEndpoint(real32 value) const
+{
+	s32 low = 0;
+	s32 high = m_endpointCount;
+	while (low < high)
+	{
+		s32 mid = (low + high) >> 1;
+		if (m_endpoints[mid].value < value)
+		{
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid;
+		}
+	}
+	return low;
+}
+
+// Buffer a pair for every proxy overlapping a new or moved proxy.
+void SweepAndPrune::QueryTouched(s32 proxyId)
+{
+	const AABB& aabb = m_proxies[proxyId].aabb;
+	for (s32 i = FindFirstEndpoint(aabb.lowerBound.x - m_maxExtent); i < m_endpointCount; ++i)
+	{
+		const Endpoint& endpoint = m_endpoints[i];
+		if (endpoint.value > aabb.upperBound.x)
+		{
+			break;
+		}
+
+		s32 otherId = endpoint.data >> 1;
+		if ((endpoint.data & 1) || otherId == proxyId)
+		{
+			continue;
+		}
+
+		const Proxy* other = m_proxies + otherId;
+		if ((other->flags & liveFlag) == 0 || Physics::TestOverlap(other->aabb, aabb) == false)
+		{
+			continue;
+		}
+
+		if (m_pairCount == m_pairCapacity)
+		{
+			GrowBuffer(m_pairBuffer, m_pairCount, m_pairCapacity);
+		}
+
+		m_pairBuffer[m_pairCount].proxyIdA = glm::min(proxyId, otherId);
+		m_pairBuffer[m_pairCount].proxyIdB = glm::max(proxyId, otherId);
+		++m_pairCount;
+	}
+}
+
+void SweepAndPrune::UpdatePairs(BroadPhasePairCallback* callback)
+{
+	bool rebuilt = false;
+	if (m_deadCount > 0)
+	{
+		Compact();
+		rebuilt = true;
+	}
+
+	if (m_pendingCount > 0)
+	{
+		InsertPending();
+		rebuilt = true;
+	}
+
+	if (rebuilt)
+	{
+		ComputeMaxExtent();
+	}
+
+	// Perform the queries now that the array is final.
+	for (s32 i = 0; i < m_touchCount; ++i)
+	{
+		s32 proxyId = m_touchBuffer[i];
+		Proxy* proxy = m_proxies + proxyId;
+		if ((proxy->flags & liveFlag) == 0)
+		{
+			continue;
+		}
+
+		proxy->flags &= ~touchedFlag;
+		QueryTouched(proxyId);
+	}
+	m_touchCount = 0;
+
+	// Sort the pair buffer to expose duplicates.
+	std::sort(m_pairBuffer, m_pairBuffer + m_pairCount, PairLessThan);
+
+	// Send the pairs back to the client.
+	s32 i = 0;
+	while (i < m_pairCount)
+	{
+		Pair* primaryPair = m_pairBuffer + i;
+		callback->AddPair(m_proxies[primaryPair->proxyIdA].userData, m_proxies[primaryPair->proxyIdB].userData);
+		++i;
+
+		// Skip any duplicate pairs.
+		while (i < m_pairCount)
+		{
+			Pair* pair = m_pairBuffer + i;
+			if (pair->proxyIdA != primaryPair->proxyIdA || pair->proxyIdB != primaryPair->proxyIdB)
+			{
+				break;
+			}
+			++i;
+		}
+	}
+
+	m_pairCount = 0;
+}
+
+void SweepAndPrune::Query(BroadPhaseQueryCallback* callback, const AABB& aabb) const
+{
+	Query<BroadPhaseQueryCallback>(callback, aabb);
+}
+
+void SweepAndPrune::RayCast(BroadPhaseRayCastCallback* callback, const RayCastInput& input) const
+{
+	RayCast<BroadPhaseRayCastCallback>(callback, input);
+}
+
+void SweepAndPrune::ShiftOrigin(const glm::vec2& newOrigin)
+{
+	for (s32 i = 0; i < m_proxyCapacity; ++i)
+	{
+		m_proxies[i].aabb.lowerBound -= newOrigin;
+		m_proxies[i].aabb.upperBound -= newOrigin;
+	}
+
+	for (s32 i = 0; i < m_endpointCount; ++i)
+	{
+		m_endpoints[i].value -= newOrigin.x;
+	}
+}
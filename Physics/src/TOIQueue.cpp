@@ -0,0 +1,132 @@
+#include "TOIQueue.hpp"
+#include "Contact2D.hpp"
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+
+TOIQueue::TOIQueue()
+{
+	m_capacity = 64;
+	m_count = 0;
+	m_heap = (Contact**)malloc(m_capacity * sizeof(Contact*));
+}
+
+TOIQueue::~TOIQueue()
+{
+	free(m_heap);
+}
+
+void TOIQueue::Set(s32 index, Contact* contact)
+{
+	m_heap[index] = contact;
+	contact->m_toiIndex = index;
+}
+
+void TOIQueue::SiftUp(s32 index)
+{
+	Contact* contact = m_heap[index];
+	while (index > 0)
+	{
+		s32 parent = (index - 1) >> 1;
+		if (m_heap[parent]->m_toi <= contact->m_toi)
+		{
+			break;
+		}
+
+		Set(index, m_heap[parent]);
+		index = parent;
+	}
+
+	Set(index, contact);
+}
+
+void TOIQueue::SiftDown(s32 index)
+{
+	Contact* contact = m_heap[index];
+	for (;;)
+	{
+		s32 child = 2 * index + 1;
+		if (child >= m_count)
+		{
+			break;
+		}
+
+		if (child + 1 < m_count && m_heap[child + 1]->m_toi < m_heap[child]->m_toi)
+		{
+			++child;
+		}
+
+		if (contact->m_toi <= m_heap[child]->m_toi)
+		{
+			break;
+		}
+
+		Set(index, m_heap[child]);
+		index = child;
+	}
+
+	Set(index, contact);
+}
+
+void TOIQueue::Update(Contact* contact)
+{
+	s32 index = contact->m_toiIndex;
+	if (index == -1)
+	{
+		if (m_count == m_capacity)
+		{
+			Contact** old = m_heap;
+			m_capacity *= 2;
+			m_heap = (Contact**)malloc(m_capacity * sizeof(Contact*));
+			memcpy(m_heap, old, m_count * sizeof(Contact*));
+			free(old);
+		}
+
+		index = m_count;
+		++m_count;
+		Set(index, contact);
+		SiftUp(index);
+		return;
+	}
+
+	assert(0 <= index && index < m_count && m_heap[index] == contact);
+
+	// The key may have moved either way.
+	SiftUp(index);
+	SiftDown(contact->m_toiIndex);
+}
+
+void TOIQueue::Remove(Contact* contact)
+{
+	s32 index = contact->m_toiIndex;
+	if (index == -1)
+	{
+		return;
+	}
+
+	assert(0 <= index && index < m_count && m_heap[index] == contact);
+	contact->m_toiIndex = -1;
+
+	--m_count;
+	if (index == m_count)
+	{
+		return;
+	}
+
+	// Move the last contact into the hole and restore the heap order.
+	Contact* moved = m_heap[m_count];
+	Set(index, moved);
+	SiftUp(index);
+	SiftDown(moved->m_toiIndex);
+}
+
+void TOIQueue::Clear()
+{
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		m_heap[i]->m_toiIndex = -1;
+	}
+	m_count = 0;
+}
@@ -0,0 +1,137 @@
+#include "ThreadPool.hpp"
+#include <new>
+
+using namespace Break;
+using namespace Break::Physics;
+
+
+ThreadPool::ThreadPool(s32 workerCount)
+{
+	m_workerCount = workerCount > 0 ? workerCount : 0;
+	m_generation = 0;
+	m_busyCount = 0;
+	m_quit = false;
+	m_task = NULL;
+	m_context = NULL;
+	m_count = 0;
+	m_grainSize = 1;
+	m_next = 0;
+
+	m_workers = NULL;
+	if (m_workerCount > 0)
+	{
+		m_workers = (std::thread*)malloc(m_workerCount * sizeof(std::thread));
+		for (s32 i = 0; i < m_workerCount; ++i)
+		{
+			new (m_workers + i) std::thread(&ThreadPool::WorkerMain, this, i + 1);
+		}
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_wake.notify_all();
+
+	for (s32 i = 0; i < m_workerCount; ++i)
+	{
+		m_workers[i].join();
+		m_workers[i].~thread();
+	}
+	free(m_workers);
+}
+
+void ThreadPool::ParallelFor(s32 count, s32 grainSize, TaskFunction task, void* context)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	if (grainSize < 1)
+	{
+		grainSize = 1;
+	}
+
+	// Small loops, pools without workers and nested loops run inline.
+	if (m_workerCount == 0 || count <= grainSize || m_loopMutex.try_lock() == false)
+	{
+		task(context, 0, count, 0);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_task = task;
+		m_context = context;
+		m_count = count;
+		m_grainSize = grainSize;
+		m_next = 0;
+		m_busyCount = m_workerCount;
+		++m_generation;
+	}
+	m_wake.notify_all();
+
+	RunChunks(0);
+
+	// Workers still hold the loop state until they check out.
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while (m_busyCount > 0)
+		{
+			m_done.wait(lock);
+		}
+		m_task = NULL;
+		m_context = NULL;
+	}
+
+	m_loopMutex.unlock();
+}
+
+void ThreadPool::RunChunks(s32 threadIndex)
+{
+	for (;;)
+	{
+		s32 begin = m_next.fetch_add(m_grainSize);
+		if (begin >= m_count)
+		{
+			break;
+		}
+
+		s32 end = begin + m_grainSize < m_count ? begin + m_grainSize : m_count;
+		m_task(m_context, begin, end, threadIndex);
+	}
+}
+
+void ThreadPool::WorkerMain(s32 threadIndex)
+{
+	u32 seen = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			while (m_quit == false && m_generation == seen)
+			{
+				m_wake.wait(lock);
+			}
+
+			if (m_quit)
+			{
+				return;
+			}
+
+			seen = m_generation;
+		}
+
+		RunChunks(threadIndex);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			--m_busyCount;
+		}
+		m_done.notify_one();
+	}
+}
@@ -3,17 +3,18 @@
 #include "TimeOfImpact.hpp"
 #include "CircleShape.hpp"
 #include "PolygonShape.hpp"
-#include "TimeManager.hpp"
 #include "Sweep.hpp"
-#include <Services.hpp>
+#include "Timer.hpp"
+#include <cstdio>
 using namespace Break;
 using namespace Break::Infrastructure;
 using namespace Break::Physics;
 
 
-real32 toiTime, toiMaxTime;
-s32 toiCalls, toiIters, toiMaxIters;
-s32 toiRootIters, toiMaxRootIters;
+// Statistics, updated atomically since contacts may be solved on several threads.
+std::atomic<real32> toiTime(0.0f), toiMaxTime(0.0f);
+std::atomic<s32> toiCalls(0), toiIters(0), toiMaxIters(0);
+std::atomic<s32> toiRootIters(0), toiMaxRootIters(0);
 
 //
 struct BREAK_API SeparationFunction
@@ -51,7 +52,11 @@ struct BREAK_API SeparationFunction
 			glm::vec2 pointA = Transform2D::Mul(xfA, localPointA);
 			glm::vec2 pointB = Transform2D::Mul(xfB, localPointB);
 			m_axis = pointB - pointA;
-			real32 s = m_axis.length();
+			real32 s = glm::length(m_axis);
+			if (s >= FLT_EPSILON)
+			{
+				m_axis *= 1.0f / s;
+			}
 			return s;
 		}
 		else if (cache->indexA[0] == cache->indexA[1])
@@ -238,9 +243,17 @@ struct BREAK_API SeparationFunction
 // by computing the largest time at which separation is maintained.
 void Physics::TimeOfImpact(TOIOutput* output, const TOIInput* input)
 {
-	Time timer;
+	SimplexCache cache;
+	cache.count = 0;
+
+	TimeOfImpact(output, &cache, input);
+}
+
+void Physics::TimeOfImpact(TOIOutput* output, SimplexCache* cache, const TOIInput* input)
+{
+	Timer timer;
 
-	++toiCalls;
+	toiCalls.fetch_add(1, std::memory_order_relaxed);
 
 	output->state = TOIOutput::unknown;
 	output->t = input->tMax;
@@ -268,8 +281,6 @@ void Physics::TimeOfImpact(TOIOutput* output, const TOIInput* input)
 	s32 iter = 0;
 
 	// Prepare input for distance query.
-	SimplexCache cache;
-	cache.count = 0;
 	DistanceInput distanceInput;
 	distanceInput.proxyA = input->proxyA;
 	distanceInput.proxyB = input->proxyB;
@@ -288,7 +299,7 @@ void Physics::TimeOfImpact(TOIOutput* output, const TOIInput* input)
 		distanceInput.Transform2DA = xfA;
 		distanceInput.Transform2DB = xfB;
 		DistanceOutput distanceOutput;
-		Distance(&distanceOutput, &cache, &distanceInput);
+		Distance(&distanceOutput, cache, &distanceInput);
 
 		// If the shapes are overlapped, we give up on continuous collision.
 		if (distanceOutput.distance <= 0.0f)
@@ -309,7 +320,7 @@ void Physics::TimeOfImpact(TOIOutput* output, const TOIInput* input)
 
 		// Initialize the separating axis.
 		SeparationFunction fcn;
-		fcn.Initialize(&cache, proxyA, sweepA, proxyB, sweepB, t1);
+		fcn.Initialize(cache, proxyA, sweepA, proxyB, sweepB, t1);
 #if 0
 		// Dump the curve seen by the root finder
 		{
@@ -407,7 +418,7 @@ void Physics::TimeOfImpact(TOIOutput* output, const TOIInput* input)
 				}
 
 				++rootIterCount;
-				++toiRootIters;
+				toiRootIters.fetch_add(1, std::memory_order_relaxed);
 
 				real32 s = fcn.Evaluate(indexA, indexB, t);
 
@@ -436,7 +447,7 @@ void Physics::TimeOfImpact(TOIOutput* output, const TOIInput* input)
 				}
 			}
 
-			toiMaxRootIters = glm::max(toiMaxRootIters, rootIterCount);
+			AtomicMax(toiMaxRootIters, rootIterCount);
 
 			++pushBackIter;
 
@@ -447,7 +458,6 @@ void Physics::TimeOfImpact(TOIOutput* output, const TOIInput* input)
 		}
 
 		++iter;
-		++toiIters;
 
 		if (done)
 		{
@@ -463,15 +473,82 @@ void Physics::TimeOfImpact(TOIOutput* output, const TOIInput* input)
 		}
 	}
 
-	toiMaxIters = glm::max(toiMaxIters, iter);
+	toiIters.fetch_add(iter, std::memory_order_relaxed);
+	AtomicMax(toiMaxIters, iter);
 
-	real32 time = Services::getPlatform()->getTime();
-	toiMaxTime = glm::max(toiMaxTime, time);
-	toiTime += time;
+	real32 time = timer.GetMilliseconds();
+	AtomicMax(toiMaxTime, time);
+	real32 total = toiTime.load(std::memory_order_relaxed);
+	while (toiTime.compare_exchange_weak(total, total + time, std::memory_order_relaxed) == false)
+	{
+	}
 }
 
+bool Physics::ShapeCast(ShapeCastOutput* output, const ShapeCastInput* input)
+{
+	output->point = glm::vec2(0.0f, 0.0f);
+	output->normal = glm::vec2(0.0f, 0.0f);
+	output->fraction = input->maxFraction;
+
+	// Shape A translates without rotating, shape B does not move.
+	TOIInput toiInput;
+	toiInput.proxyA = input->proxyA;
+	toiInput.proxyB = input->proxyB;
+	toiInput.sweepA.localCenter = glm::vec2(0.0f, 0.0f);
+	toiInput.sweepA.c0 = input->transformA.p;
+	toiInput.sweepA.c = input->transformA.p + input->translationA;
+	toiInput.sweepA.a0 = input->transformA.q.GetAngle();
+	toiInput.sweepA.a = toiInput.sweepA.a0;
+	toiInput.sweepA.alpha0 = 0.0f;
+	toiInput.sweepB.localCenter = glm::vec2(0.0f, 0.0f);
+	toiInput.sweepB.c0 = input->transformB.p;
+	toiInput.sweepB.c = input->transformB.p;
+	toiInput.sweepB.a0 = input->transformB.q.GetAngle();
+	toiInput.sweepB.a = toiInput.sweepB.a0;
+	toiInput.sweepB.alpha0 = 0.0f;
+	toiInput.tMax = input->maxFraction;
+
+	SimplexCache cache;
+	cache.count = 0;
+
+	TOIOutput toiOutput;
+	TimeOfImpact(&toiOutput, &cache, &toiInput);
+	if (toiOutput.state == TOIOutput::separated)
+	{
+		return false;
+	}
 
+	// A failed root finder still leaves the shapes separated at t, so it is
+	// reported as a conservative hit.
+	real32 t = toiOutput.t;
 
+	DistanceInput distanceInput;
+	distanceInput.proxyA = input->proxyA;
+	distanceInput.proxyB = input->proxyB;
+	distanceInput.Transform2DA.p = input->transformA.p + t * input->translationA;
+	distanceInput.Transform2DA.q = input->transformA.q;
+	distanceInput.Transform2DB = input->transformB;
+	distanceInput.useRadii = false;
 
+	DistanceOutput distanceOutput;
+	Distance(&distanceOutput, &cache, &distanceInput);
 
+	glm::vec2 normal;
+	if (distanceOutput.distance > FLT_EPSILON)
+	{
+		normal = (distanceOutput.pointA - distanceOutput.pointB) / distanceOutput.distance;
+	}
+	else if (glm::dot(input->translationA, input->translationA) > FLT_EPSILON * FLT_EPSILON)
+	{
+		normal = -glm::normalize(input->translationA);
+	}
+	else
+	{
+		normal = glm::vec2(0.0f, 1.0f);
+	}
 
+	output->point = distanceOutput.pointB + input->proxyB.m_radius * normal;
+	output->normal = normal;
+	output->fraction = t;
+	return true;
+}
@@ -0,0 +1,26 @@
+#include "Timer.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+
+
+Timer::Timer()
+{
+	Reset();
+}
+
+void Timer::Reset()
+{
+	m_start = std::chrono::steady_clock::now();
+}
+
+u64 Timer::GetNanoseconds() const
+{
+	std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - m_start;
+	return (u64)elapsed.count();
+}
+
+real32 Timer::GetMilliseconds() const
+{
+	return (real32)(GetNanoseconds() * 1.0e-6);
+}
@@ -264,7 +264,7 @@ bool WeldJoint::SolvePositionConstraints(const SolverData& data)
 	{
 		glm::vec2 C1 =  cB + rB - cA - rA;
 
-		positionError = C1.length();
+		positionError = glm::length(C1);
 		angularError = 0.0f;
 
 		//glm::vec2 P = -K.Solve22(C1);
@@ -281,7 +281,7 @@ bool WeldJoint::SolvePositionConstraints(const SolverData& data)
 		glm::vec2 C1 =  cB + rB - cA - rA;
 		real32 C2 = aB - aA - m_referenceAngle;
 
-		positionError = C1.length();
+		positionError = glm::length(C1);
 		angularError = glm::abs(C2);
 
 		glm::vec3 C(C1.x, C1.y, C2);
@@ -344,3 +344,17 @@ void WeldJoint::Dump()
 	printf("  jd.dampingRatio = %.15lef;\n", m_dampingRatio);
 	printf("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+void WeldJoint::SaveState(JointState* state) const
+{
+	state->values[0] = m_impulse.x;
+	state->values[1] = m_impulse.y;
+	state->values[2] = m_impulse.z;
+}
+
+void WeldJoint::LoadState(const JointState* state)
+{
+	m_impulse.x = state->values[0];
+	m_impulse.y = state->values[1];
+	m_impulse.z = state->values[2];
+}
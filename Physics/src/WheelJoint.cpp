@@ -404,3 +404,17 @@ void WheelJoint::Dump()
 	printf("  jd.dampingRatio = %.15lef;\n", m_dampingRatio);
 	printf("  joints[%d] = m_world->CreateJoint(&jd);\n", m_index);
 }
+
+void WheelJoint::SaveState(JointState* state) const
+{
+	state->values[0] = m_impulse;
+	state->values[1] = m_motorImpulse;
+	state->values[2] = m_springImpulse;
+}
+
+void WheelJoint::LoadState(const JointState* state)
+{
+	m_impulse = state->values[0];
+	m_motorImpulse = state->values[1];
+	m_springImpulse = state->values[2];
+}
@@ -0,0 +1,131 @@
+#include "WideTree.hpp"
+#include <float.h>
+
+using namespace Break;
+using namespace Break::Infrastructure;
+using namespace Break::Physics;
+
+
+WideTree::WideTree()
+{
+	m_nodes = NULL;
+	m_nodeCount = 0;
+	m_nodeCapacity = 0;
+}
+
+WideTree::~WideTree()
+{
+	free(m_nodes);
+}
+
+void WideTree::Clear()
+{
+	m_nodeCount = 0;
+}
+
+void WideTree::Build(const DynamicTree* tree)
+{
+	m_nodeCount = 0;
+
+	if (tree->m_root == _nullNode)
+	{
+		return;
+	}
+
+	// Every wide node consumes at least one binary node, so this never overflows.
+	if (m_nodeCapacity < tree->m_nodeCount)
+	{
+		free(m_nodes);
+		m_nodeCapacity = tree->m_nodeCount;
+		m_nodes = (WideNode*)malloc(m_nodeCapacity * sizeof(WideNode));
+	}
+
+	BuildNode(tree->m_nodes, tree->m_root);
+}
+
+// Emit the wide node for the binary subtree at index in depth-first order.
+s32 WideTree::BuildNode(const TreeNode* nodes, s32 index)
+{
+	s32 wideIndex = m_nodeCount;
+	++m_nodeCount;
+
+	s32 children[4];
+	s32 count = 0;
+
+	if (nodes[index].IsLeaf())
+	{
+		// Only happens for a tree holding a single proxy.
+		children[count++] = index;
+	}
+	else
+	{
+		children[count++] = nodes[index].child1;
+		children[count++] = nodes[index].child2;
+
+		// Pull grandchildren up until the node is full. Opening the largest
+		// child first keeps the wide bounds as tight as possible.
+		while (count < 4)
+		{
+			s32 best = -1;
+			real32 bestPerimeter = -1.0f;
+			for (s32 i = 0; i < count; ++i)
+			{
+				const TreeNode* child = nodes + children[i];
+				if (child->IsLeaf())
+				{
+					continue;
+				}
+
+				real32 perimeter = child->aabb.GetPerimeter();
+				if (perimeter > bestPerimeter)
+				{
+					best = i;
+					bestPerimeter = perimeter;
+				}
+			}
+
+			if (best == -1)
+			{
+				break;
+			}
+
+			s32 opened = children[best];
+			children[best] = nodes[opened].child1;
+			children[count++] = nodes[opened].child2;
+		}
+	}
+
+	WideNode* node = m_nodes + wideIndex;
+	for (s32 i = 0; i < 4; ++i)
+	{
+		if (i < count)
+		{
+			const AABB& aabb = nodes[children[i]].aabb;
+			node->minX[i] = aabb.lowerBound.x;
+			node->minY[i] = aabb.lowerBound.y;
+			node->maxX[i] = aabb.upperBound.x;
+			node->maxY[i] = aabb.upperBound.y;
+			node->children[i] = EncodeLeaf(children[i]);
+		}
+		else
+		{
+			node->minX[i] = FLT_MAX;
+			node->minY[i] = FLT_MAX;
+			node->maxX[i] = -FLT_MAX;
+			node->maxY[i] = -FLT_MAX;
+			node->children[i] = _nullNode;
+		}
+	}
+
+	// Children are emitted after the parent is filled in so the array stays in pre-order.
+	for (s32 i = 0; i < count; ++i)
+	{
+		if (nodes[children[i]].IsLeaf() == false)
+		{
+			s32 child = BuildNode(nodes, children[i]);
+			m_nodes[wideIndex].children[i] = child;
+		}
+	}
+
+	return wideIndex;
+}
@@ -7,40 +7,73 @@
 #include "ContactSolver.hpp"
 #include "Collision.hpp"
 #include "BroadPhase.hpp"
+#include "SweepAndPrune.hpp"
+#include "SpatialHash.hpp"
+#include "BroadPhaseDispatch.hpp"
 #include "CircleShape.hpp"
 #include "EdgeShape.hpp"
 #include "ChainShape.hpp"
 #include "PolygonShape.hpp"
+#include "MeshShape.hpp"
 #include "TimeOfImpact.hpp"
-#include "TimeManager.hpp"
+#include "ThreadPool.hpp"
+#include "Distance.hpp"
+#include "Timer.hpp"
+#include "ParticleSystem.hpp"
 
 #include <new>
-#include <Services.hpp>
+#include <algorithm>
 
 
 using namespace Break;
 using namespace Break::Infrastructure;
 using namespace Break::Physics;
 
+// Contacts per chunk when computing TOIs on the thread pool.
+#define toiGrainSize 32
 
 World::World(const glm::vec2& gravity)
 {
+	WorldDef def;
+	def.gravity = gravity;
+	Initialize(&def);
+}
+
+World::World(const WorldDef* def)
+{
+	Initialize(def);
+}
+
+void World::Initialize(const WorldDef* def)
+{
+	m_blockAllocator.SetThreadCaching(def->threadCachingAllocator);
+	m_stackAllocator.SetCapacity(def->stackAllocatorSize);
+
 	m_destructionListener = NULL;
+	m_threadPool = NULL;
 
 	m_bodyList = NULL;
 	m_jointList = NULL;
+	m_particleSystemList = NULL;
 
 	m_bodyCount = 0;
 	m_jointCount = 0;
 
+	m_awakeCapacity = 256;
+	m_awakeBodies = (Body**)malloc(m_awakeCapacity * sizeof(Body*));
+	m_awakeCount = 0;
+	m_collideStamp = 0;
+	m_toiStamp = 0;
+
 	m_warmStarting = true;
+	m_jointBatching = true;
 	m_continuousPhysics = true;
 	m_subStepping = false;
 
 	m_stepComplete = true;
 
 	m_allowSleep = true;
-	m_gravity = gravity;
+	m_gravity = def->gravity;
 
 	m_flags = clearForces;
 
@@ -48,28 +81,56 @@ World::World(const glm::vec2& gravity)
 
 	m_contactManager.m_allocator = &m_blockAllocator;
 
+	switch (def->broadPhase)
+	{
+	case sweepAndPruneBroadPhase:
+		m_contactManager.m_broadPhase = new SweepAndPrune();
+		break;
+
+	case spatialHashBroadPhase:
+		m_contactManager.m_broadPhase = new SpatialHash(def->cellSize);
+		break;
+
+	default:
+		m_contactManager.m_broadPhase = new BroadPhase();
+		break;
+	}
+
 	memset(&m_profile, 0, sizeof(Profile));
+	m_profileHistory.SetCapacity(def->profileHistorySize);
+
+	m_contactEvents.SetFlags(def->contactEventFlags);
+	m_contactEvents.SetImpulseThreshold(def->impulseEventThreshold);
+	m_contactManager.m_contactEvents = def->contactEventFlags != 0 ? &m_contactEvents : NULL;
 }
 
 World::~World()
 {
 	// Some shapes allocate using Alloc.
-	Body* b = m_bodyList;
-	while (b)
+	for (s32 slot = 0; slot < m_bodies.GetSlotEnd(); ++slot)
 	{
-		Body* bNext = b->m_next;
+		if (m_bodies.IsAlive(slot) == false)
+		{
+			continue;
+		}
 
-		Fixture* f = b->m_fixtureList;
+		Fixture* f = m_bodies.GetObject(slot)->m_fixtureList;
 		while (f)
 		{
 			Fixture* fNext = f->m_next;
 			f->m_proxyCount = 0;
+			f->m_overlapList = -1;
 			f->Destroy(&m_blockAllocator);
 			f = fNext;
 		}
+	}
 
-		b = bNext;
+	while (m_particleSystemList)
+	{
+		DestroyParticleSystem(m_particleSystemList);
 	}
+
+	free(m_awakeBodies);
 }
 
 void World::SetDestructionListener(DestructionListener* listener)
@@ -87,6 +148,35 @@ void World::SetContactListener(ContactListener* listener)
 	m_contactManager.m_contactListener = listener;
 }
 
+void World::SetContactEventFlags(u32 flags)
+{
+	m_contactEvents.SetFlags(flags);
+
+	// Contacts destroyed between steps are recorded too, so the manager keeps
+	// the stream whenever something is recorded.
+	m_contactManager.m_contactEvents = flags != 0 ? &m_contactEvents : NULL;
+}
+
+void World::SetImpulseEventThreshold(real32 threshold)
+{
+	m_contactEvents.SetImpulseThreshold(threshold);
+}
+
+void World::SetThreadPool(ThreadPool* pool)
+{
+	m_threadPool = pool;
+}
+
+Body* World::GetBody(BodyHandle handle)
+{
+	return m_bodies.Get(handle);
+}
+
+void World::GetAllocatorStats(BlockAllocatorStats* stats) const
+{
+	m_blockAllocator.GetStats(stats);
+}
+
 Body* World::CreateBody(const BodyDef* def)
 {
 	assert(IsLocked() == false);
@@ -95,8 +185,10 @@ Body* World::CreateBody(const BodyDef* def)
 		return NULL;
 	}
 
-	void* mem = m_blockAllocator.Allocate(sizeof(Body));
+	s32 slot;
+	void* mem = m_bodies.Allocate(&slot);
 	Body* b = new (mem) Body(def, this);
+	b->m_slotIndex = slot;
 
 	// Add to world doubly linked list.
 	b->m_prev = NULL;
@@ -108,6 +200,8 @@ Body* World::CreateBody(const BodyDef* def)
 	m_bodyList = b;
 	++m_bodyCount;
 
+	UpdateAwakeSet(b);
+
 	return b;
 }
 
@@ -144,9 +238,10 @@ void World::DestroyBody(Body* b)
 	{
 		ContactEdge* ce0 = ce;
 		ce = ce->next;
-		m_contactManager.Destroy(ce0->contact);
+		m_contactManager.Destroy(ce0->contact, true);
 	}
 	b->m_contactList = NULL;
+	m_contactManager.DestroyOverlaps(b, true);
 
 	// Delete the attached fixtures. This destroys broad-phase proxies.
 	Fixture* f = b->m_fixtureList;
@@ -160,7 +255,7 @@ void World::DestroyBody(Body* b)
 			m_destructionListener->SayGoodbye(f0);
 		}
 
-		f0->DestroyProxies(&m_contactManager.m_broadPhase);
+		f0->DestroyProxies(m_contactManager.m_broadPhase);
 		f0->Destroy(&m_blockAllocator);
 		f0->~Fixture();
 		m_blockAllocator.Free(f0, sizeof(Fixture));
@@ -188,8 +283,301 @@ void World::DestroyBody(Body* b)
 	}
 
 	--m_bodyCount;
+	b->m_flags &= ~Body::awakeFlag;
+	UpdateAwakeSet(b);
+	s32 slot = b->m_slotIndex;
 	b->~Body();
-	m_blockAllocator.Free(b, sizeof(Body));
+	m_bodies.Free(slot);
+}
+
+void World::BeginBulkLoad()
+{
+	assert(IsLocked() == false);
+	assert(IsBulkLoading() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	m_flags |= bulkLoad;
+}
+
+void World::EndBulkLoad()
+{
+	assert(IsBulkLoading());
+	m_flags &= ~bulkLoad;
+
+	// Count the proxies of the new fixtures. Fixtures that already have proxies
+	// were created before the load or got them from Body::SetActive.
+	s32 proxyCount = 0;
+	bool newStaticProxies = false;
+	for (Body* b = m_bodyList; b; b = b->m_next)
+	{
+		if ((b->m_flags & Body::bulkLoadFlag) == 0 || (b->m_flags & Body::activeFlag) == 0)
+		{
+			continue;
+		}
+
+		for (Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			if (f->m_proxyCount == 0)
+			{
+				proxyCount += f->m_shape->GetChildCount();
+				newStaticProxies = newStaticProxies || b->m_type == staticBody;
+			}
+		}
+	}
+
+	IBroadPhase* broadPhase = m_contactManager.m_broadPhase;
+
+	// New static proxies are not touched since they never collide with each other,
+	// which saves most of the pair search of a level. Touch the existing proxies
+	// that could collide with them instead.
+	if (newStaticProxies)
+	{
+		for (Body* b = m_bodyList; b; b = b->m_next)
+		{
+			if (b->m_type == staticBody)
+			{
+				continue;
+			}
+
+			for (Fixture* f = b->m_fixtureList; f; f = f->m_next)
+			{
+				for (s32 i = 0; i < f->m_proxyCount; ++i)
+				{
+					broadPhase->TouchProxy(f->m_proxies[i].proxyId);
+				}
+			}
+		}
+	}
+
+	AABB* aabbs = (AABB*)m_stackAllocator.Allocate(proxyCount * sizeof(AABB));
+	void** userData = (void**)m_stackAllocator.Allocate(proxyCount * sizeof(void*));
+	s32* proxyIds = (s32*)m_stackAllocator.Allocate(proxyCount * sizeof(s32));
+
+	s32 count = 0;
+	for (Body* b = m_bodyList; b; b = b->m_next)
+	{
+		if ((b->m_flags & Body::bulkLoadFlag) == 0)
+		{
+			continue;
+		}
+
+		b->m_flags &= ~Body::bulkLoadFlag;
+		b->ResetMassData();
+
+		if ((b->m_flags & Body::activeFlag) == 0)
+		{
+			continue;
+		}
+
+		for (Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			if (f->m_proxyCount > 0)
+			{
+				continue;
+			}
+
+			f->m_proxyCount = f->m_shape->GetChildCount();
+			for (s32 i = 0; i < f->m_proxyCount; ++i)
+			{
+				FixtureProxy* proxy = f->m_proxies + i;
+				f->m_shape->ComputeAABB(&proxy->aabb, b->m_xf, i);
+				proxy->fixture = f;
+				proxy->childIndex = i;
+
+				aabbs[count] = proxy->aabb;
+				userData[count] = proxy;
+				++count;
+			}
+		}
+	}
+
+	assert(count == proxyCount);
+	broadPhase->CreateProxies(aabbs, userData, count, proxyIds);
+
+	for (s32 i = 0; i < count; ++i)
+	{
+		FixtureProxy* proxy = (FixtureProxy*)userData[i];
+		proxy->proxyId = proxyIds[i];
+		if (proxy->fixture->m_body->m_type != staticBody)
+		{
+			broadPhase->TouchProxy(proxy->proxyId);
+		}
+	}
+
+	m_stackAllocator.Free(proxyIds);
+	m_stackAllocator.Free(userData);
+	m_stackAllocator.Free(aabbs);
+}
+
+namespace
+{
+	// Can this fixture of a static body be merged into a mesh?
+	bool IsBakeable(const Fixture* f, const AABB& region)
+	{
+		Shape::Type type = f->GetType();
+		if (type != Shape::polygon && type != Shape::edge && type != Shape::chain)
+		{
+			return false;
+		}
+
+		// Sensors and fixtures that the game refers to keep their own identity.
+		if (f->IsSensor() || f->GetUserData() != NULL)
+		{
+			return false;
+		}
+
+		for (s32 i = 0; i < f->GetShape()->GetChildCount(); ++i)
+		{
+			if (region.Contains(f->GetAABB(i)) == false)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Orders fixtures by material so that each run can share one mesh.
+	struct MaterialLess
+	{
+		bool operator()(const Fixture* a, const Fixture* b) const
+		{
+			if (a->GetFriction() != b->GetFriction())
+			{
+				return a->GetFriction() < b->GetFriction();
+			}
+
+			if (a->GetRestitution() != b->GetRestitution())
+			{
+				return a->GetRestitution() < b->GetRestitution();
+			}
+
+			const Filter& fa = a->GetFilterData();
+			const Filter& fb = b->GetFilterData();
+			if (fa.categoryBits != fb.categoryBits)
+			{
+				return fa.categoryBits < fb.categoryBits;
+			}
+
+			if (fa.maskBits != fb.maskBits)
+			{
+				return fa.maskBits < fb.maskBits;
+			}
+
+			return fa.groupIndex < fb.groupIndex;
+		}
+	};
+}
+
+Body* World::BakeStaticGeometry(const AABB& region)
+{
+	assert(IsLocked() == false);
+	assert(IsBulkLoading() == false);
+	if (IsLocked())
+	{
+		return NULL;
+	}
+
+	s32 count = 0;
+	for (Body* b = m_bodyList; b; b = b->m_next)
+	{
+		if (b->m_type != staticBody || b->IsActive() == false)
+		{
+			continue;
+		}
+
+		for (Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			count += IsBakeable(f, region) ? 1 : 0;
+		}
+	}
+
+	if (count == 0)
+	{
+		return NULL;
+	}
+
+	Fixture** fixtures = (Fixture**)m_stackAllocator.Allocate(count * sizeof(Fixture*));
+	count = 0;
+	for (Body* b = m_bodyList; b; b = b->m_next)
+	{
+		if (b->m_type != staticBody || b->IsActive() == false)
+		{
+			continue;
+		}
+
+		for (Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			if (IsBakeable(f, region))
+			{
+				fixtures[count++] = f;
+			}
+		}
+	}
+
+	MaterialLess less;
+	std::sort(fixtures, fixtures + count, less);
+
+	BodyDef bd;
+	Body* body = CreateBody(&bd);
+
+	// One mesh per material.
+	MeshShape mesh;
+	for (s32 i = 0; i < count;)
+	{
+		s32 j = i + 1;
+		while (j < count && less(fixtures[i], fixtures[j]) == false)
+		{
+			++j;
+		}
+
+		mesh.Clear();
+		for (s32 k = i; k < j; ++k)
+		{
+			const Shape* shape = fixtures[k]->GetShape();
+			const Transform2D& xf = fixtures[k]->GetBody()->GetTransform2D();
+			switch (shape->GetType())
+			{
+			case Shape::polygon:
+				mesh.AddPolygon((const PolygonShape*)shape, xf);
+				break;
+
+			case Shape::edge:
+				mesh.AddEdge((const EdgeShape*)shape, xf);
+				break;
+
+			case Shape::chain:
+				mesh.AddChain((const ChainShape*)shape, xf);
+				break;
+
+			default:
+				assert(false);
+				break;
+			}
+		}
+		mesh.Build();
+
+		FixtureDef fd;
+		fd.shape = &mesh;
+		fd.friction = fixtures[i]->GetFriction();
+		fd.restitution = fixtures[i]->GetRestitution();
+		fd.filter = fixtures[i]->GetFilterData();
+		body->CreateFixture(&fd);
+
+		i = j;
+	}
+
+	// The old bodies stay, so references to them remain valid.
+	for (s32 i = 0; i < count; ++i)
+	{
+		fixtures[i]->GetBody()->DestroyFixture(fixtures[i]);
+	}
+
+	m_stackAllocator.Free(fixtures);
+	return body;
 }
 
 Joint* World::CreateJoint(const JointDef* def)
@@ -238,13 +626,14 @@ Joint* World::CreateJoint(const JointDef* def)
 		{
 			if (edge->other == bodyA)
 			{
-				// Flag the contact for filtering at the next time step (where either
-				// body is awake).
+				// Flag the contact for filtering at the next time step.
 				edge->contact->FlagForFiltering();
 			}
 
 			edge = edge->next;
 		}
+
+		m_contactManager.FlagOverlapsForFiltering(bodyA, bodyB);
 	}
 
 	// Note: creating a joint doesn't wake the bodies.
@@ -337,14 +726,66 @@ void World::DestroyJoint(Joint* j)
 		{
 			if (edge->other == bodyA)
 			{
-				// Flag the contact for filtering at the next time step (where either
-				// body is awake).
+				// Flag the contact for filtering at the next time step.
 				edge->contact->FlagForFiltering();
 			}
 
 			edge = edge->next;
 		}
+
+		m_contactManager.FlagOverlapsForFiltering(bodyA, bodyB);
+	}
+}
+
+ParticleSystem* World::CreateParticleSystem(const ParticleSystemDef* def)
+{
+	assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return NULL;
+	}
+
+	void* mem = m_blockAllocator.Allocate(sizeof(ParticleSystem));
+	ParticleSystem* p = new (mem) ParticleSystem(def, this);
+
+	// Add to world doubly linked list.
+	p->m_prev = NULL;
+	p->m_next = m_particleSystemList;
+	if (m_particleSystemList)
+	{
+		m_particleSystemList->m_prev = p;
+	}
+	m_particleSystemList = p;
+
+	return p;
+}
+
+void World::DestroyParticleSystem(ParticleSystem* p)
+{
+	assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return;
+	}
+
+	// Remove from the doubly linked list.
+	if (p->m_prev)
+	{
+		p->m_prev->m_next = p->m_next;
+	}
+
+	if (p->m_next)
+	{
+		p->m_next->m_prev = p->m_prev;
+	}
+
+	if (p == m_particleSystemList)
+	{
+		m_particleSystemList = p->m_next;
 	}
+
+	p->~ParticleSystem();
+	m_blockAllocator.Free(p, sizeof(ParticleSystem));
 }
 
 //
@@ -358,53 +799,127 @@ void World::SetAllowSleeping(bool flag)
 	m_allowSleep = flag;
 	if (m_allowSleep == false)
 	{
-		for (Body* b = m_bodyList; b; b = b->m_next)
+		for (s32 slot = 0; slot < m_bodies.GetSlotEnd(); ++slot)
 		{
+			if (m_bodies.IsAlive(slot) == false)
+			{
+				continue;
+			}
+
+			Body* b = m_bodies.GetObject(slot);
 			b->SetAwake(true);
 		}
 	}
 }
 
 // Find islands, integrate and solve constraints, solve position constraints
-void World::Solve(const PTimeStep& step)
+void World::UpdateAwakeSet(Body* b)
 {
-	m_profile.solveInit = 0.0f;
-	m_profile.solveVelocity = 0.0f;
-	m_profile.solvePosition = 0.0f;
-
-	// Size the island for the worst case.
-	Island island(m_bodyCount,
-		m_contactManager.m_contactCount,
-		m_jointCount,
-		&m_stackAllocator,
-		m_contactManager.m_contactListener);
-
-	// Clear all the island flags.
-	for (Body* b = m_bodyList; b; b = b->m_next)
+	bool awake = (b->m_flags & Body::awakeFlag) != 0 && b->m_type != staticBody;
+	if (awake && b->m_awakeIndex == -1)
 	{
-		b->m_flags &= ~Body::islandFlag;
+		if (m_awakeCount == m_awakeCapacity)
+		{
+			Body** old = m_awakeBodies;
+			m_awakeCapacity *= 2;
+			m_awakeBodies = (Body**)malloc(m_awakeCapacity * sizeof(Body*));
+			memcpy(m_awakeBodies, old, m_awakeCount * sizeof(Body*));
+			free(old);
+		}
+		b->m_awakeIndex = m_awakeCount;
+		m_awakeBodies[m_awakeCount] = b;
+		++m_awakeCount;
 	}
-	for (Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	else if (awake == false && b->m_awakeIndex != -1)
 	{
-		c->m_flags &= ~Contact::islandFlag;
+		--m_awakeCount;
+		Body* last = m_awakeBodies[m_awakeCount];
+		m_awakeBodies[b->m_awakeIndex] = last;
+		last->m_awakeIndex = b->m_awakeIndex;
+		b->m_awakeIndex = -1;
 	}
-	for (Joint* j = m_jointList; j; j = j->m_next)
+}
+
+void World::Collide()
+{
+	++m_collideStamp;
+
+	// Contacts flagged for filtering are filtered whether or not their bodies
+	// are awake, so a new joint or filter between sleeping bodies ends their
+	// contact now. Collide takes each one off the queue.
+	while (m_contactManager.m_filterCount > 0)
 	{
-		j->m_islandFlag = false;
+		Contact* c = m_contactManager.m_filterContacts[m_contactManager.m_filterCount - 1];
+		c->m_collideStamp = m_collideStamp;
+		m_contactManager.Collide(c);
 	}
 
-	// Build and simulate all awake islands.
-	s32 stackSize = m_bodyCount;
-	Body** stack = (Body**)m_stackAllocator.Allocate(stackSize * sizeof(Body*));
-	for (Body* seed = m_bodyList; seed; seed = seed->m_next)
+	// Otherwise a contact between two sleeping or static bodies cannot change, so
+	// only the contacts of awake bodies are updated. Updates may wake bodies, which appends
+	// them to the set, so the count is read on every iteration.
+	for (s32 i = 0; i < m_awakeCount; ++i)
 	{
-		if (seed->m_flags & Body::islandFlag)
+		ContactEdge* ce = m_awakeBodies[i]->m_contactList;
+		while (ce)
 		{
-			continue;
-		}
+			Contact* c = ce->contact;
+			ce = ce->next;
 
-		if (seed->IsAwake() == false || seed->IsActive() == false)
-		{
+			if (c->m_collideStamp == m_collideStamp)
+			{
+				continue;
+			}
+
+			c->m_collideStamp = m_collideStamp;
+			m_contactManager.Collide(c);
+		}
+	}
+
+	m_contactManager.UpdateOverlaps();
+}
+
+void World::Solve(const PTimeStep& step)
+{
+	m_profile.islands = 0;
+	m_profile.solveInit = 0;
+	m_profile.solveVelocity = 0;
+	m_profile.solvePosition = 0;
+	m_profile.islandCount = 0;
+
+	// Size the island for the worst case.
+	Island island(m_bodyCount,
+		m_contactManager.m_contactCount,
+		m_jointCount,
+		&m_stackAllocator,
+		m_contactManager.m_contactListener,
+		m_contactManager.m_contactEvents);
+
+	// No island flag is set between steps: each island clears the flags of its
+	// contacts and joints after it is solved and the synchronize pass below
+	// clears the body flags. Islands only start from awake bodies, so the cost
+	// does not depend on the number of sleeping bodies.
+	// Island::Solve may put bodies to sleep, which reorders the awake set.
+	s32 seedCount = m_awakeCount;
+	Body** seeds = (Body**)m_stackAllocator.Allocate(seedCount * sizeof(Body*));
+	memcpy(seeds, m_awakeBodies, seedCount * sizeof(Body*));
+
+	// The bodies that moved, for the synchronize pass.
+	Body** solved = (Body**)m_stackAllocator.Allocate(m_bodyCount * sizeof(Body*));
+	s32 solvedCount = 0;
+
+	// Build and simulate all awake islands.
+	s32 stackSize = m_bodyCount;
+	Body** stack = (Body**)m_stackAllocator.Allocate(stackSize * sizeof(Body*));
+	for (s32 i = 0; i < seedCount; ++i)
+	{
+		Body* seed = seeds[i];
+		if (seed->m_flags & Body::islandFlag)
+		{
+			continue;
+		}
+
+		if (seed->IsAwake() == false || seed->IsActive() == false)
+		{
 			continue;
 		}
 
@@ -414,6 +929,8 @@ void World::Solve(const PTimeStep& step)
 			continue;
 		}
 
+		Timer islandTimer;
+
 		// Reset island and stack.
 		island.Clear();
 		s32 stackCount = 0;
@@ -449,21 +966,13 @@ void World::Solve(const PTimeStep& step)
 					continue;
 				}
 
-				// Is this contact solid and touching?
+				// Is this contact enabled and touching? Sensors have no contacts.
 				if (contact->IsEnabled() == false ||
 					contact->IsTouching() == false)
 				{
 					continue;
 				}
 
-				// Skip sensors.
-				bool sensorA = contact->m_fixtureA->m_isSensor;
-				bool sensorB = contact->m_fixtureB->m_isSensor;
-				if (sensorA || sensorB)
-				{
-					continue;
-				}
-
 				island.Add(contact);
 				contact->m_flags |= Contact::islandFlag;
 
@@ -510,6 +1019,9 @@ void World::Solve(const PTimeStep& step)
 			}
 		}
 
+		m_profile.islands += islandTimer.GetNanoseconds();
+		++m_profile.islandCount;
+
 		Profile profile;
 		island.Solve(&profile, step, m_gravity, m_allowSleep);
 		m_profile.solveInit += profile.solveInit;
@@ -525,176 +1037,294 @@ void World::Solve(const PTimeStep& step)
 			{
 				b->m_flags &= ~Body::islandFlag;
 			}
+			else
+			{
+				solved[solvedCount++] = b;
+			}
+		}
+
+		for (s32 i = 0; i < island.m_contactCount; ++i)
+		{
+			island.m_contacts[i]->m_flags &= ~Contact::islandFlag;
+		}
+
+		for (s32 i = 0; i < island.m_jointCount; ++i)
+		{
+			island.m_joints[i]->m_islandFlag = false;
 		}
 	}
 
 	m_stackAllocator.Free(stack);
 
 	{
-		Time timer;
+		Timer timer;
 		// Synchronize fixtures, check for out of range bodies.
-		for (Body* b = m_bodyList; b; b = b->GetNext())
+		// If a body was not in an island then it did not move.
+		for (s32 i = 0; i < solvedCount; ++i)
 		{
-			// If a body was not in an island then it did not move.
-			if ((b->m_flags & Body::islandFlag) == 0)
-			{
-				continue;
-			}
-
-			if (b->GetType() == staticBody)
-			{
-				continue;
-			}
+			Body* b = solved[i];
+			b->m_flags &= ~Body::islandFlag;
 
 			// Update fixtures (for broad-phase).
 			b->SynchronizeFixtures();
 		}
+		m_profile.sync = timer.GetNanoseconds();
+
+		m_stackAllocator.Free(solved);
+		m_stackAllocator.Free(seeds);
 
 		// Look for new contacts.
+		timer.Reset();
 		m_contactManager.FindNewContacts();
-		m_profile.broadphase = Services::getPlatform()->getTime();
+		m_profile.broadphase += timer.GetNanoseconds();
 	}
 }
 
-// Find TOI contacts and solve them.
-void World::SolveTOI(const PTimeStep& step)
+// Can this contact have a TOI event? Contacts that fail this are skipped
+// without caching so they are checked again once their bodies change.
+bool World::IsTOICandidate(Contact* c)
 {
-	Island island(2 * maxTOIContacts, maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener);
+	Fixture* fA = c->GetFixtureA();
+	Fixture* fB = c->GetFixtureB();
 
-	if (m_stepComplete)
+	Body* bA = fA->GetBody();
+	Body* bB = fB->GetBody();
+
+	BodyType typeA = bA->m_type;
+	BodyType typeB = bB->m_type;
+	assert(typeA == dynamicBody || typeB == dynamicBody);
+
+	bool activeA = bA->IsAwake() && typeA != staticBody;
+	bool activeB = bB->IsAwake() && typeB != staticBody;
+
+	// Is at least one body active (awake and dynamic or kinematic)?
+	if (activeA == false && activeB == false)
 	{
-		for (Body* b = m_bodyList; b; b = b->m_next)
-		{
-			b->m_flags &= ~Body::islandFlag;
-			b->m_sweep.alpha0 = 0.0f;
-		}
+		return false;
+	}
 
-		for (Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
-		{
-			// Invalidate TOI
-			c->m_flags &= ~(Contact::toiFlag | Contact::islandFlag);
-			c->m_toiCount = 0;
-			c->m_toi = 1.0f;
-		}
+	bool collideA = bA->IsBullet() || typeA != dynamicBody;
+	bool collideB = bB->IsBullet() || typeB != dynamicBody;
+
+	// Are these two non-bullet dynamic bodies?
+	if (collideA == false && collideB == false)
+	{
+		return false;
 	}
 
-	// Find TOI events and solve them.
-	for (;;)
+	return true;
+}
+
+// Compute and cache the TOI of a candidate contact.
+void World::UpdateContactTOI(Contact* c)
+{
+	Fixture* fA = c->GetFixtureA();
+	Fixture* fB = c->GetFixtureB();
+	Body* bA = fA->GetBody();
+	Body* bB = fB->GetBody();
+
+	// Compute the TOI for this contact.
+	// Put the sweeps onto the same time interval.
+	real32 alpha0 = bA->m_sweep.alpha0;
+
+	if (bA->m_sweep.alpha0 < bB->m_sweep.alpha0)
 	{
-		// Find the first TOI.
-		Contact* minContact = NULL;
-		real32 minAlpha = 1.0f;
+		alpha0 = bB->m_sweep.alpha0;
+		bA->m_sweep.Advance(alpha0);
+	}
+	else if (bB->m_sweep.alpha0 < bA->m_sweep.alpha0)
+	{
+		alpha0 = bA->m_sweep.alpha0;
+		bB->m_sweep.Advance(alpha0);
+	}
 
-		for (Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
-		{
-			// Is this contact disabled?
-			if (c->IsEnabled() == false)
-			{
-				continue;
-			}
+	assert(alpha0 < 1.0f);
 
-			// Prevent excessive sub-stepping.
-			if (c->m_toiCount > maxSubSteps)
-			{
-				continue;
-			}
+	s32 indexA = c->GetChildIndexA();
+	s32 indexB = c->GetChildIndexB();
 
-			real32 alpha = 1.0f;
-			if (c->m_flags & Contact::toiFlag)
-			{
-				// This contact has a valid cached TOI.
-				alpha = c->m_toi;
-			}
-			else
-			{
-				Fixture* fA = c->GetFixtureA();
-				Fixture* fB = c->GetFixtureB();
+	// Compute the time of impact in interval [0, minTOI]
+	TOIInput input;
+	input.proxyA.Set(fA->GetShape(), indexA);
+	input.proxyB.Set(fB->GetShape(), indexB);
+	input.sweepA = bA->m_sweep;
+	input.sweepB = bB->m_sweep;
+	input.tMax = 1.0f;
 
-				// Is there a sensor?
-				if (fA->IsSensor() || fB->IsSensor())
-				{
-					continue;
-				}
+	TOIOutput output;
+	TimeOfImpact(&output, &c->m_simplexCache, &input);
 
-				Body* bA = fA->GetBody();
-				Body* bB = fB->GetBody();
+	// Beta is the fraction of the remaining portion of the .
+	real32 beta = output.t;
+	real32 alpha = 1.0f;
+	if (output.state == TOIOutput::touching)
+	{
+		alpha = glm::min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
+	}
 
-				BodyType typeA = bA->m_type;
-				BodyType typeB = bB->m_type;
-				assert(typeA == dynamicBody || typeB == dynamicBody);
+	c->m_toi = alpha;
+	c->m_flags |= Contact::toiFlag;
+}
 
-				bool activeA = bA->IsAwake() && typeA != staticBody;
-				bool activeB = bB->IsAwake() && typeB != staticBody;
+struct WorldTOIContext
+{
+	Contact** contacts;
 
-				// Is at least one body active (awake and dynamic or kinematic)?
-				if (activeA == false && activeB == false)
-				{
-					continue;
-				}
+	/// GJK iterations run by the worker threads. The calling thread's own are
+	/// already counted by Step.
+	std::atomic<s32> gjkIterations;
+};
 
-				bool collideA = bA->IsBullet() || typeA != dynamicBody;
-				bool collideB = bB->IsBullet() || typeB != dynamicBody;
+// Computes the TOI of the contacts in [begin, end). The bodies of all contacts
+// share the same alpha0, so no sweep is advanced and contacts sharing a body
+// can run on different threads.
+void World::UpdateContactTOITask(void* context, s32 begin, s32 end, s32 threadIndex)
+{
+	WorldTOIContext* toiContext = (WorldTOIContext*)context;
+	s32 gjkIters = GetThreadGJKIterations();
+	for (s32 i = begin; i < end; ++i)
+	{
+		UpdateContactTOI(toiContext->contacts[i]);
+	}
 
-				// Are these two non-bullet dynamic bodies?
-				if (collideA == false && collideB == false)
-				{
-					continue;
-				}
+	if (threadIndex != 0)
+	{
+		toiContext->gjkIterations.fetch_add(GetThreadGJKIterations() - gjkIters, std::memory_order_relaxed);
+	}
+}
 
-				// Compute the TOI for this contact.
-				// Put the sweeps onto the same time interval.
-				real32 alpha0 = bA->m_sweep.alpha0;
+// Compute the TOI of a contact and queue it if it has an event before the end of the step.
+void World::ComputeTOI(Contact* c)
+{
+	PrepareTOI(c);
 
-				if (bA->m_sweep.alpha0 < bB->m_sweep.alpha0)
-				{
-					alpha0 = bB->m_sweep.alpha0;
-					bA->m_sweep.Advance(alpha0);
-				}
-				else if (bB->m_sweep.alpha0 < bA->m_sweep.alpha0)
-				{
-					alpha0 = bA->m_sweep.alpha0;
-					bB->m_sweep.Advance(alpha0);
-				}
+	// Is this contact disabled? Prevent excessive sub-stepping.
+	if (c->IsEnabled() == false || c->m_toiCount > maxSubSteps)
+	{
+		m_toiQueue.Remove(c);
+		return;
+	}
 
-				assert(alpha0 < 1.0f);
+	if ((c->m_flags & Contact::toiFlag) == 0)
+	{
+		if (IsTOICandidate(c) == false)
+		{
+			m_toiQueue.Remove(c);
+			return;
+		}
 
-				s32 indexA = c->GetChildIndexA();
-				s32 indexB = c->GetChildIndexB();
+		PrepareTOI(c->m_fixtureA->m_body);
+		PrepareTOI(c->m_fixtureB->m_body);
+		UpdateContactTOI(c);
+	}
 
-				// Compute the time of impact in interval [0, minTOI]
-				TOIInput input;
-				input.proxyA.Set(fA->GetShape(), indexA);
-				input.proxyB.Set(fB->GetShape(), indexB);
-				input.sweepA = bA->m_sweep;
-				input.sweepB = bB->m_sweep;
-				input.tMax = 1.0f;
+	// Use the cached TOI.
+	if (c->m_toi < 1.0f)
+	{
+		m_toiQueue.Update(c);
+	}
+	else
+	{
+		m_toiQueue.Remove(c);
+	}
+}
 
-				TOIOutput output;
-				TimeOfImpact(&output, &input);
+// Find TOI contacts and solve them.
+void World::PrepareTOI(Body* b)
+{
+	if (b->m_toiStamp != m_toiStamp)
+	{
+		b->m_toiStamp = m_toiStamp;
+		b->m_sweep.alpha0 = 0.0f;
+	}
+}
 
-				// Beta is the fraction of the remaining portion of the .
-				real32 beta = output.t;
-				if (output.state == TOIOutput::touching)
-				{
-					alpha = glm::min(alpha0 + (1.0f - alpha0) * beta, 1.0f);
-				}
-				else
-				{
-					alpha = 1.0f;
-				}
+void World::PrepareTOI(Contact* c)
+{
+	if (c->m_toiStamp != m_toiStamp)
+	{
+		// Invalidate TOI
+		c->m_toiStamp = m_toiStamp;
+		c->m_flags &= ~Contact::toiFlag;
+		c->m_toiCount = 0;
+		c->m_toi = 1.0f;
+	}
+}
+
+void World::SolveTOI(const PTimeStep& step)
+{
+	Island island(2 * maxTOIContacts, maxTOIContacts, 0, &m_stackAllocator, m_contactManager.m_contactListener, m_contactManager.m_contactEvents);
 
-				c->m_toi = alpha;
-				c->m_flags |= Contact::toiFlag;
+	// Instead of resetting every body and contact, a new stamp marks the TOI
+	// state of the previous step as stale. PrepareTOI resets it on first touch.
+	if (m_stepComplete)
+	{
+		++m_toiStamp;
+	}
+
+	// A TOI candidate has an awake body, so the contacts are gathered from the
+	// awake set. A contact between two awake bodies is taken at body A.
+	Contact** candidates = (Contact**)m_stackAllocator.Allocate(m_contactManager.m_contactCount * sizeof(Contact*));
+	s32 candidateCount = 0;
+	for (s32 i = 0; i < m_awakeCount; ++i)
+	{
+		Body* b = m_awakeBodies[i];
+		for (ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+		{
+			Contact* c = ce->contact;
+			if (c->m_fixtureA->m_body != b && ce->other->m_awakeIndex != -1)
+			{
+				continue;
 			}
 
-			if (alpha < minAlpha)
+			PrepareTOI(c);
+			candidates[candidateCount++] = c;
+		}
+	}
+
+	// At the start of a step every sweep begins at alpha0 = 0, so computing a TOI
+	// advances no sweep and the candidates are independent of each other.
+	if (m_stepComplete && m_threadPool != NULL && candidateCount > toiGrainSize)
+	{
+		s32 count = 0;
+		for (s32 i = 0; i < candidateCount; ++i)
+		{
+			Contact* c = candidates[i];
+			if (c->IsEnabled() && IsTOICandidate(c))
 			{
-				// This is the minimum TOI found so far.
-				minContact = c;
-				minAlpha = alpha;
+				PrepareTOI(c->m_fixtureA->m_body);
+				PrepareTOI(c->m_fixtureB->m_body);
+				candidates[count++] = c;
 			}
 		}
 
+		WorldTOIContext context;
+		context.contacts = candidates;
+		context.gjkIterations = 0;
+		m_threadPool->ParallelFor(count, toiGrainSize, UpdateContactTOITask, &context);
+		m_profile.gjkIterations += context.gjkIterations;
+
+		// The filtered candidates are the only ones with a TOI. The others
+		// are left out of the queue.
+		candidateCount = count;
+	}
+
+	// Queue the contacts that may have a TOI event. The queue is only valid
+	// during this call because contacts can be destroyed between steps.
+	for (s32 i = 0; i < candidateCount; ++i)
+	{
+		ComputeTOI(candidates[i]);
+	}
+
+	m_stackAllocator.Free(candidates);
+
+	// Find TOI events and solve them.
+	for (;;)
+	{
+		// Find the first TOI.
+		Contact* minContact = m_toiQueue.GetMin();
+		real32 minAlpha = minContact != NULL ? minContact->m_toi : 1.0f;
+
 		if (minContact == NULL || 1.0f - 10.0f * FLT_EPSILON < minAlpha)
 		{
 			// No more TOI events. Done!
@@ -702,6 +1332,8 @@ void World::SolveTOI(const PTimeStep& step)
 			break;
 		}
 
+		m_toiQueue.Remove(minContact);
+
 		// Advance the bodies to the TOI.
 		Fixture* fA = minContact->GetFixtureA();
 		Fixture* fB = minContact->GetFixtureB();
@@ -715,7 +1347,7 @@ void World::SolveTOI(const PTimeStep& step)
 		bB->Advance(minAlpha);
 
 		// The TOI contact likely has some new contact points.
-		minContact->Update(m_contactManager.m_contactListener);
+		minContact->Update(m_contactManager.m_contactListener, m_contactManager.m_contactEvents);
 		minContact->m_flags &= ~Contact::toiFlag;
 		++minContact->m_toiCount;
 
@@ -733,6 +1365,7 @@ void World::SolveTOI(const PTimeStep& step)
 
 		bA->SetAwake(true);
 		bB->SetAwake(true);
+		++m_profile.toiEventCount;
 
 		// Build the island
 		island.Clear();
@@ -779,15 +1412,8 @@ void World::SolveTOI(const PTimeStep& step)
 						continue;
 					}
 
-					// Skip sensors.
-					bool sensorA = contact->m_fixtureA->m_isSensor;
-					bool sensorB = contact->m_fixtureB->m_isSensor;
-					if (sensorA || sensorB)
-					{
-						continue;
-					}
-
 					// Tentatively advance the body to the TOI.
+					PrepareTOI(other);
 					Sweep backup = other->m_sweep;
 					if ((other->m_flags & Body::islandFlag) == 0)
 					{
@@ -795,7 +1421,7 @@ void World::SolveTOI(const PTimeStep& step)
 					}
 
 					// Update the contact points
-					contact->Update(m_contactManager.m_contactListener);
+					contact->Update(m_contactManager.m_contactListener, m_contactManager.m_contactEvents);
 
 					// Was the contact disabled by the user?
 					if (contact->IsEnabled() == false)
@@ -843,6 +1469,7 @@ void World::SolveTOI(const PTimeStep& step)
 		subStep.positionIterations = 20;
 		subStep.velocityIterations = step.velocityIterations;
 		subStep.warmStarting = false;
+		subStep.batchJoints = false;
 		island.SolveTOI(subStep, bA->m_islandIndex, bB->m_islandIndex);
 
 		// Reset island flags and synchronize broad-phase proxies.
@@ -867,29 +1494,63 @@ void World::SolveTOI(const PTimeStep& step)
 
 		// Commit fixture proxy movements to the broad-phase so that new contacts are created.
 		// Also, some contacts can be destroyed.
+		s32 oldContactCount = m_contactManager.m_contactCount;
 		m_contactManager.FindNewContacts();
 
+		// Only the contacts of the island bodies changed: the displaced bodies invalidated
+		// theirs and woken bodies may activate others. New contacts are appended.
+		for (s32 i = 0; i < island.m_bodyCount; ++i)
+		{
+			for (ContactEdge* ce = island.m_bodies[i]->m_contactList; ce; ce = ce->next)
+			{
+				PrepareTOI(ce->contact);
+				if ((ce->contact->m_flags & Contact::toiFlag) == 0)
+				{
+					ComputeTOI(ce->contact);
+				}
+			}
+		}
+
+		for (s32 i = oldContactCount; i < m_contactManager.m_contactCount; ++i)
+		{
+			ComputeTOI(m_contactManager.m_contacts[i]);
+		}
+
 		if (m_subStepping)
 		{
 			m_stepComplete = false;
 			break;
 		}
 	}
+
+	m_toiQueue.Clear();
 }
 
 void World::Step(real32 dt, s32 velocityIterations, s32 positionIterations)
 {
-	Time stepTimer;
+	assert(IsBulkLoading() == false);
+
+	Timer stepTimer;
+
+	memset(&m_profile, 0, sizeof(Profile));
+	m_contactManager.m_pairCount = 0;
+	s32 gjkIters = GetThreadGJKIterations();
 
 	// If new fixtures were added, we need to find the new contacts.
 	if (m_flags & newFixture)
 	{
+		Timer timer;
 		m_contactManager.FindNewContacts();
 		m_flags &= ~newFixture;
+		m_profile.broadphase = timer.GetNanoseconds();
 	}
 
 	m_flags |= locked;
 
+	// Contacts that change inside the step are recorded, after the end events
+	// of the contacts destroyed since the last step.
+	m_contactEvents.BeginStep();
+
 	PTimeStep step;
 	step.delta = dt;
 	step.velocityIterations	= velocityIterations;
@@ -906,28 +1567,40 @@ void World::Step(real32 dt, s32 velocityIterations, s32 positionIterations)
 	step.dtRatio = m_inv_dt0 * dt;
 
 	step.warmStarting = m_warmStarting;
+	step.batchJoints = m_jointBatching;
 
 	// Update contacts. This is where some contacts are destroyed.
 	{
-		Time timer;
-		m_contactManager.Collide();
-		m_profile.collide = Services::getPlatform()->getTime();
+		Timer timer;
+		Collide();
+		m_profile.narrowphase = timer.GetNanoseconds();
 	}
 
 	// Integrate velocities, solve velocity constraints, and integrate positions.
 	if (m_stepComplete && step.delta > 0.0f)
 	{
-		Time timer;
+		Timer timer;
 		Solve(step);
-		m_profile.solve = Services::getPlatform()->getTime();
+		m_profile.solve = timer.GetNanoseconds();
 	}
 
 	// Handle TOI events.
 	if (m_continuousPhysics && step.delta > 0.0f)
 	{
-		Time timer;
+		Timer timer;
 		SolveTOI(step);
-		m_profile.solveTOI = Services::getPlatform()->getTime();
+		m_profile.solveTOI = timer.GetNanoseconds();
+	}
+
+	// Particles collide with the bodies where this step left them.
+	if (m_particleSystemList && step.delta > 0.0f)
+	{
+		Timer timer;
+		for (ParticleSystem* p = m_particleSystemList; p; p = p->m_next)
+		{
+			p->Solve(step);
+		}
+		m_profile.particles = timer.GetNanoseconds();
 	}
 
 	if (step.delta > 0.0f)
@@ -940,20 +1613,31 @@ void World::Step(real32 dt, s32 velocityIterations, s32 positionIterations)
 		ClearForces();
 	}
 
+	// Make the next step fit in one stack block if this one did not.
+	m_stackAllocator.Reset();
+
 	m_flags &= ~locked;
+	m_contactEvents.EndStep();
 
-	m_profile.step = Services::getPlatform()->getTime();
+	m_profile.broadphasePairs = m_contactManager.m_pairCount;
+	m_profile.contactCount = m_contactManager.m_contactCount;
+	m_profile.gjkIterations += GetThreadGJKIterations() - gjkIters;
+	m_profile.step = stepTimer.GetNanoseconds();
+	m_profileHistory.Push(m_profile);
 }
 
 void World::ClearForces()
 {
-	for (Body* body = m_bodyList; body; body = body->GetNext())
+	// Sleeping bodies have no force, Body::SetAwake cleared it.
+	for (s32 i = 0; i < m_awakeCount; ++i)
 	{
+		Body* body = m_awakeBodies[i];
 		body->m_force = glm::vec2(0.0f,0.0f);
 		body->m_torque = 0.0f;
 	}
 }
 
+template <typename B>
 struct WorldQueryWrapper
 {
 	bool QueryCallback(s32 proxyId)
@@ -962,18 +1646,34 @@ struct WorldQueryWrapper
 		return callback->ReportFixture(proxy->fixture);
 	}
 
-	const BroadPhase* broadPhase;
+	const B* broadPhase;
+	Physics::QueryCallback* callback;
+};
+
+struct WorldQueryOp
+{
+	template <typename B>
+	void operator()(const B* broadPhase) const
+	{
+		WorldQueryWrapper<B> wrapper;
+		wrapper.broadPhase = broadPhase;
+		wrapper.callback = callback;
+		broadPhase->Query(&wrapper, *aabb);
+	}
+
 	Physics::QueryCallback* callback;
+	const AABB* aabb;
 };
 
 void World::QueryAABB(QueryCallback* callback, const AABB& aabb) const
 {
-	WorldQueryWrapper wrapper;
-	wrapper.broadPhase = &m_contactManager.m_broadPhase;
-	wrapper.callback = callback;
-	m_contactManager.m_broadPhase.Query(&wrapper, aabb);
+	WorldQueryOp op;
+	op.callback = callback;
+	op.aabb = &aabb;
+	DispatchBroadPhase(m_contactManager.m_broadPhase, op);
 }
 
+template <typename B>
 struct WorldRayCastWrapper
 {
 	real32 RayCastCallback(const RayCastInput& input, s32 proxyId)
@@ -995,41 +1695,580 @@ struct WorldRayCastWrapper
 		return input.maxFraction;
 	}
 
-	const BroadPhase* broadPhase;
+	const B* broadPhase;
 	Physics::RayCastCallback* callback;
 };
 
-void World::RayCast(RayCastCallback* callback, const glm::vec2& point1, const glm::vec2& point2) const
+struct WorldRayCastOp
 {
-	WorldRayCastWrapper wrapper;
-	wrapper.broadPhase = &m_contactManager.m_broadPhase;
-	wrapper.callback = callback;
+	template <typename B>
+	void operator()(const B* broadPhase) const
+	{
+		WorldRayCastWrapper<B> wrapper;
+		wrapper.broadPhase = broadPhase;
+		wrapper.callback = callback;
+		broadPhase->RayCast(&wrapper, input);
+	}
+
+	Physics::RayCastCallback* callback;
 	RayCastInput input;
-	input.maxFraction = 1.0f;
-	input.p1 = point1;
-	input.p2 = point2;
-	m_contactManager.m_broadPhase.RayCast(&wrapper, input);
+};
+
+void World::RayCast(RayCastCallback* callback, const glm::vec2& point1, const glm::vec2& point2) const
+{
+	WorldRayCastOp op;
+	op.callback = callback;
+	op.input.maxFraction = 1.0f;
+	op.input.p1 = point1;
+	op.input.p2 = point2;
+	DispatchBroadPhase(m_contactManager.m_broadPhase, op);
+}
+
+// Casts a shape against the fixtures under its swept box. With a callback the
+// hits are reported as in RayCast. Without one the closest hit on a solid
+// fixture that passes maskBits is written to result.
+template <typename B>
+struct WorldShapeCastWrapper
+{
+	bool QueryCallback(s32 proxyId)
+	{
+		FixtureProxy* proxy = (FixtureProxy*)broadPhase->GetUserData(proxyId);
+		Fixture* fixture = proxy->fixture;
+		if (callback == NULL && (fixture->IsSensor() || (fixture->GetFilterData().categoryBits & maskBits) == 0))
+		{
+			return true;
+		}
+
+		if (Physics::TestOverlap(proxy->aabb, sweptAABB) == false)
+		{
+			return true;
+		}
+
+		const StaticTree* tree = fixture->GetShape()->GetElementTree();
+		if (tree == NULL)
+		{
+			return Cast(fixture, proxy->childIndex, proxy->aabb);
+		}
+
+		// Cast against the mesh elements or chain edges under the swept box.
+		ElementQuery query;
+		query.wrapper = this;
+		query.fixture = fixture;
+		query.proceed = true;
+		tree->Query(&query, sweptAABB, fixture->GetBody()->GetTransform2D());
+		return query.proceed;
+	}
+
+	struct ElementQuery
+	{
+		bool QueryCallback(s32 elementIndex)
+		{
+			AABB aabb;
+			fixture->GetShape()->ComputeElementAABB(&aabb, fixture->GetBody()->GetTransform2D(), elementIndex);
+			proceed = wrapper->Cast(fixture, elementIndex, aabb);
+			return proceed;
+		}
+
+		WorldShapeCastWrapper* wrapper;
+		Fixture* fixture;
+		bool proceed;
+	};
+
+	bool Cast(Fixture* fixture, s32 childIndex, const AABB& aabb)
+	{
+		if (Physics::TestSweptOverlap(startAABB, input.translationA, input.maxFraction, aabb) == false)
+		{
+			return true;
+		}
+
+		input.proxyB.Set(fixture->GetShape(), childIndex);
+		input.transformB = fixture->GetBody()->GetTransform2D();
+
+		ShapeCastOutput output;
+		if (Physics::ShapeCast(&output, &input) == false)
+		{
+			return true;
+		}
+
+		if (callback == NULL)
+		{
+			// Later candidates only have to beat this hit.
+			result->fixture = fixture;
+			result->point = output.point;
+			result->normal = output.normal;
+			result->fraction = output.fraction;
+			input.maxFraction = output.fraction;
+			return true;
+		}
+
+		real32 value = callback->ReportFixture(fixture, output.point, output.normal, output.fraction);
+		if (value == 0.0f)
+		{
+			return false;
+		}
+
+		if (value > 0.0f && value < input.maxFraction)
+		{
+			input.maxFraction = value;
+		}
+
+		return true;
+	}
+
+	// Set up the cast of one shape.
+	void Begin(const Shape* shape, const Transform2D& xf, const glm::vec2& translation)
+	{
+		assert(shape->GetChildCount() == 1 && shape->GetElementTree() == NULL);
+
+		input.proxyA.Set(shape, 0);
+		input.transformA = xf;
+		input.translationA = translation;
+		input.maxFraction = 1.0f;
+
+		// The shape does not rotate, so the swept box is the start box stretched
+		// along the translation.
+		shape->ComputeAABB(&startAABB, xf, 0);
+		sweptAABB.lowerBound = startAABB.lowerBound + glm::min(translation, glm::vec2(0.0f, 0.0f));
+		sweptAABB.upperBound = startAABB.upperBound + glm::max(translation, glm::vec2(0.0f, 0.0f));
+	}
+
+	const B* broadPhase;
+	Physics::RayCastCallback* callback;
+	ShapeCastInput input;
+	AABB startAABB;
+	AABB sweptAABB;
+	RayCastHit* result;
+	u16 maskBits;
+};
+
+struct WorldShapeCastOp
+{
+	template <typename B>
+	void operator()(const B* broadPhase) const
+	{
+		WorldShapeCastWrapper<B> wrapper;
+		wrapper.broadPhase = broadPhase;
+		wrapper.callback = callback;
+		wrapper.result = NULL;
+		wrapper.maskBits = 0xFFFF;
+		wrapper.Begin(shape, *xf, *translation);
+		broadPhase->Query(&wrapper, wrapper.sweptAABB);
+	}
+
+	Physics::RayCastCallback* callback;
+	const Shape* shape;
+	const Transform2D* xf;
+	const glm::vec2* translation;
+};
+
+void World::ShapeCast(RayCastCallback* callback, const Shape* shape, const Transform2D& xf, const glm::vec2& translation) const
+{
+	WorldShapeCastOp op;
+	op.callback = callback;
+	op.shape = shape;
+	op.xf = &xf;
+	op.translation = &translation;
+	DispatchBroadPhase(m_contactManager.m_broadPhase, op);
+}
+
+// Batches smaller than this are not worth sorting or splitting.
+#define batchGrainSize 64
+
+// Interleave the bits of two 16 bit coordinates.
+static u32 MortonKey(u32 x, u32 y)
+{
+	x = (x | (x << 8)) & 0x00FF00FF;
+	x = (x | (x << 4)) & 0x0F0F0F0F;
+	x = (x | (x << 2)) & 0x33333333;
+	x = (x | (x << 1)) & 0x55555555;
+	y = (y | (y << 8)) & 0x00FF00FF;
+	y = (y | (y << 4)) & 0x0F0F0F0F;
+	y = (y | (y << 2)) & 0x33333333;
+	y = (y | (y << 1)) & 0x55555555;
+	return x | (y << 1);
+}
+
+// Sort the batch along a Z-order curve through the item centers. On return the
+// low 32 bits of keys[i] hold the index of the i-th item to process.
+static void SortBatch(u64* keys, const glm::vec2* centers, s32 count)
+{
+	glm::vec2 lower = centers[0];
+	glm::vec2 upper = centers[0];
+	for (s32 i = 1; i < count; ++i)
+	{
+		lower = glm::min(lower, centers[i]);
+		upper = glm::max(upper, centers[i]);
+	}
+
+	glm::vec2 extent = glm::max(upper - lower, glm::vec2(FLT_EPSILON, FLT_EPSILON));
+	glm::vec2 scale = 65535.0f / extent;
+	for (s32 i = 0; i < count; ++i)
+	{
+		glm::vec2 q = (centers[i] - lower) * scale;
+		u64 key = MortonKey((u32)q.x, (u32)q.y);
+		keys[i] = (key << 32) | (u32)i;
+	}
+
+	std::sort(keys, keys + count);
+}
+
+template <typename B>
+struct WorldBatchRayCastWrapper
+{
+	real32 RayCastCallback(const RayCastInput& input, s32 proxyId)
+	{
+		FixtureProxy* proxy = (FixtureProxy*)broadPhase->GetUserData(proxyId);
+		Fixture* fixture = proxy->fixture;
+		if (fixture->IsSensor() || (fixture->GetFilterData().categoryBits & maskBits) == 0)
+		{
+			return -1.0f;
+		}
+
+		RayCastOutput output;
+		bool hit = fixture->RayCast(&output, input, proxy->childIndex);
+		if (hit == false)
+		{
+			return -1.0f;
+		}
+
+		// The tree clips the ray to the returned fraction, so the last hit is the closest.
+		result->fixture = fixture;
+		result->fraction = output.fraction;
+		result->normal = output.normal;
+		result->point = (1.0f - output.fraction) * input.p1 + output.fraction * input.p2;
+		return output.fraction;
+	}
+
+	const B* broadPhase;
+	RayCastHit* result;
+	u16 maskBits;
+};
+
+template <typename B>
+struct WorldBatchQueryWrapper
+{
+	bool QueryCallback(s32 proxyId)
+	{
+		FixtureProxy* proxy = (FixtureProxy*)broadPhase->GetUserData(proxyId);
+		if ((proxy->fixture->GetFilterData().categoryBits & maskBits) == 0)
+		{
+			return true;
+		}
+
+		if (Physics::TestOverlap(proxy->aabb, *aabb) == false)
+		{
+			return true;
+		}
+
+		if (count == maxResults)
+		{
+			truncated = true;
+			return false;
+		}
+
+		results[count] = proxy->fixture;
+		++count;
+		return true;
+	}
+
+	const B* broadPhase;
+	const AABB* aabb;
+	Fixture** results;
+	s32 count;
+	s32 maxResults;
+	bool truncated;
+	u16 maskBits;
+};
+
+struct WorldBatchContext
+{
+	const IBroadPhase* broadPhase;
+	const u64* order;
+	const RayCastInput* inputs;
+	const ShapeCastQuery* queries;
+	RayCastHit* hits;
+	const AABB* aabbs;
+	Fixture** fixtures;
+	s32 maxResults;
+	s32* counts;
+	std::atomic<bool> truncated;
+	u16 maskBits;
+};
+
+// Runs one range of a batch on the concrete broad-phase type.
+struct WorldBatchRange
+{
+	WorldBatchContext* context;
+	s32 begin;
+	s32 end;
+};
+
+struct RayCastBatchOp : public WorldBatchRange
+{
+	template <typename B>
+	void operator()(const B* broadPhase) const
+	{
+		WorldBatchRayCastWrapper<B> wrapper;
+		wrapper.broadPhase = broadPhase;
+		wrapper.maskBits = context->maskBits;
+
+		for (s32 i = begin; i < end; ++i)
+		{
+			s32 index = context->order ? (s32)(u32)context->order[i] : i;
+			const RayCastInput& input = context->inputs[index];
+
+			RayCastHit* hit = context->hits + index;
+			hit->fixture = NULL;
+			hit->fraction = input.maxFraction;
+			hit->point = input.p1 + input.maxFraction * (input.p2 - input.p1);
+			hit->normal = glm::vec2(0.0f, 0.0f);
+
+			if (glm::dot(input.p2 - input.p1, input.p2 - input.p1) == 0.0f)
+			{
+				continue;
+			}
+
+			wrapper.result = hit;
+			broadPhase->RayCast(&wrapper, input);
+		}
+	}
+};
+
+static void RayCastBatchTask(void* userContext, s32 begin, s32 end, s32 threadIndex)
+{
+	NOT_USED(threadIndex);
+	RayCastBatchOp op;
+	op.context = (WorldBatchContext*)userContext;
+	op.begin = begin;
+	op.end = end;
+	DispatchBroadPhase(op.context->broadPhase, op);
+}
+
+struct ShapeCastBatchOp : public WorldBatchRange
+{
+	template <typename B>
+	void operator()(const B* broadPhase) const
+	{
+		WorldShapeCastWrapper<B> wrapper;
+		wrapper.broadPhase = broadPhase;
+		wrapper.callback = NULL;
+		wrapper.maskBits = context->maskBits;
+
+		for (s32 i = begin; i < end; ++i)
+		{
+			s32 index = context->order ? (s32)(u32)context->order[i] : i;
+			const ShapeCastQuery& query = context->queries[index];
+
+			RayCastHit* hit = context->hits + index;
+			hit->fixture = NULL;
+			hit->fraction = 1.0f;
+			hit->point = query.transform.p + query.translation;
+			hit->normal = glm::vec2(0.0f, 0.0f);
+
+			wrapper.result = hit;
+			wrapper.Begin(query.shape, query.transform, query.translation);
+			broadPhase->Query(&wrapper, wrapper.sweptAABB);
+		}
+	}
+};
+
+static void ShapeCastBatchTask(void* userContext, s32 begin, s32 end, s32 threadIndex)
+{
+	NOT_USED(threadIndex);
+	ShapeCastBatchOp op;
+	op.context = (WorldBatchContext*)userContext;
+	op.begin = begin;
+	op.end = end;
+	DispatchBroadPhase(op.context->broadPhase, op);
+}
+
+struct QueryAABBBatchOp : public WorldBatchRange
+{
+	template <typename B>
+	void operator()(const B* broadPhase) const
+	{
+		WorldBatchQueryWrapper<B> wrapper;
+		wrapper.broadPhase = broadPhase;
+		wrapper.maxResults = context->maxResults;
+		wrapper.maskBits = context->maskBits;
+		wrapper.truncated = false;
+
+		for (s32 i = begin; i < end; ++i)
+		{
+			s32 index = context->order ? (s32)(u32)context->order[i] : i;
+			wrapper.aabb = context->aabbs + index;
+			wrapper.results = context->fixtures + index * context->maxResults;
+			wrapper.count = 0;
+			broadPhase->Query(&wrapper, *wrapper.aabb);
+			context->counts[index] = wrapper.count;
+		}
+
+		if (wrapper.truncated)
+		{
+			context->truncated = true;
+		}
+	}
+};
+
+static void QueryAABBBatchTask(void* userContext, s32 begin, s32 end, s32 threadIndex)
+{
+	NOT_USED(threadIndex);
+	QueryAABBBatchOp op;
+	op.context = (WorldBatchContext*)userContext;
+	op.begin = begin;
+	op.end = end;
+	DispatchBroadPhase(op.context->broadPhase, op);
+}
+
+void World::RayCastBatch(const RayCastInput* inputs, s32 count, RayCastHit* hits, u16 maskBits) const
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	WorldBatchContext context;
+	context.broadPhase = m_contactManager.m_broadPhase;
+	context.order = NULL;
+	context.inputs = inputs;
+	context.hits = hits;
+	context.maskBits = maskBits;
+
+	u64* order = NULL;
+	if (count > batchGrainSize)
+	{
+		glm::vec2* centers = (glm::vec2*)malloc(count * sizeof(glm::vec2));
+		for (s32 i = 0; i < count; ++i)
+		{
+			const RayCastInput& input = inputs[i];
+			centers[i] = input.p1 + (0.5f * input.maxFraction) * (input.p2 - input.p1);
+		}
+
+		order = (u64*)malloc(count * sizeof(u64));
+		SortBatch(order, centers, count);
+		free(centers);
+		context.order = order;
+	}
+
+	if (m_threadPool)
+	{
+		m_threadPool->ParallelFor(count, batchGrainSize, RayCastBatchTask, &context);
+	}
+	else
+	{
+		RayCastBatchTask(&context, 0, count, 0);
+	}
+
+	free(order);
+}
+
+void World::ShapeCastBatch(const ShapeCastQuery* queries, s32 count, RayCastHit* hits, u16 maskBits) const
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	WorldBatchContext context;
+	context.broadPhase = m_contactManager.m_broadPhase;
+	context.order = NULL;
+	context.queries = queries;
+	context.hits = hits;
+	context.maskBits = maskBits;
+
+	u64* order = NULL;
+	if (count > batchGrainSize)
+	{
+		glm::vec2* centers = (glm::vec2*)malloc(count * sizeof(glm::vec2));
+		for (s32 i = 0; i < count; ++i)
+		{
+			const ShapeCastQuery& query = queries[i];
+			centers[i] = query.transform.p + 0.5f * query.translation;
+		}
+
+		order = (u64*)malloc(count * sizeof(u64));
+		SortBatch(order, centers, count);
+		free(centers);
+		context.order = order;
+	}
+
+	if (m_threadPool)
+	{
+		m_threadPool->ParallelFor(count, batchGrainSize, ShapeCastBatchTask, &context);
+	}
+	else
+	{
+		ShapeCastBatchTask(&context, 0, count, 0);
+	}
+
+	free(order);
+}
+
+bool World::QueryAABBBatch(const AABB* aabbs, s32 count, Fixture** fixtures, s32 maxResults, s32* counts, u16 maskBits) const
+{
+	if (count <= 0)
+	{
+		return true;
+	}
+
+	WorldBatchContext context;
+	context.broadPhase = m_contactManager.m_broadPhase;
+	context.order = NULL;
+	context.aabbs = aabbs;
+	context.fixtures = fixtures;
+	context.maxResults = maxResults;
+	context.counts = counts;
+	context.truncated = false;
+	context.maskBits = maskBits;
+
+	u64* order = NULL;
+	if (count > batchGrainSize)
+	{
+		glm::vec2* centers = (glm::vec2*)malloc(count * sizeof(glm::vec2));
+		for (s32 i = 0; i < count; ++i)
+		{
+			centers[i] = aabbs[i].GetCenter();
+		}
+
+		order = (u64*)malloc(count * sizeof(u64));
+		SortBatch(order, centers, count);
+		free(centers);
+		context.order = order;
+	}
+
+	if (m_threadPool)
+	{
+		m_threadPool->ParallelFor(count, batchGrainSize, QueryAABBBatchTask, &context);
+	}
+	else
+	{
+		QueryAABBBatchTask(&context, 0, count, 0);
+	}
+
+	free(order);
+
+	return context.truncated == false;
 }
 
 
 s32 World::GetProxyCount() const
 {
-	return m_contactManager.m_broadPhase.GetProxyCount();
+	return m_contactManager.m_broadPhase->GetProxyCount();
 }
 
 s32 World::GetTreeHeight() const
 {
-	return m_contactManager.m_broadPhase.GetTreeHeight();
+	return m_contactManager.m_broadPhase->GetTreeHeight();
 }
 
 s32 World::GetTreeBalance() const
 {
-	return m_contactManager.m_broadPhase.GetTreeBalance();
+	return m_contactManager.m_broadPhase->GetTreeBalance();
 }
 
 real32 World::GetTreeQuality() const
 {
-	return m_contactManager.m_broadPhase.GetTreeQuality();
+	return m_contactManager.m_broadPhase->GetTreeQuality();
 }
 
 void World::ShiftOrigin(const glm::vec2& newOrigin)
@@ -1040,8 +2279,14 @@ void World::ShiftOrigin(const glm::vec2& newOrigin)
 		return;
 	}
 
-	for (Body* b = m_bodyList; b; b = b->m_next)
+	for (s32 slot = 0; slot < m_bodies.GetSlotEnd(); ++slot)
 	{
+		if (m_bodies.IsAlive(slot) == false)
+		{
+			continue;
+		}
+
+		Body* b = m_bodies.GetObject(slot);
 		b->m_xf.p -= newOrigin;
 		b->m_sweep.c0 -= newOrigin;
 		b->m_sweep.c -= newOrigin;
@@ -1052,7 +2297,12 @@ void World::ShiftOrigin(const glm::vec2& newOrigin)
 		j->ShiftOrigin(newOrigin);
 	}
 
-	m_contactManager.m_broadPhase.ShiftOrigin(newOrigin);
+	for (ParticleSystem* p = m_particleSystemList; p; p = p->m_next)
+	{
+		p->ShiftOrigin(newOrigin);
+	}
+
+	m_contactManager.m_broadPhase->ShiftOrigin(newOrigin);
 }
 
 void World::Dump()
@@ -1068,8 +2318,14 @@ void World::Dump()
 	printf("Body** bodies = (Body**)Alloc(%d * sizeof(Body*));\n", m_bodyCount);
 	printf("Joint** joints = (Joint**)Alloc(%d * sizeof(Joint*));\n", m_jointCount);
 	s32 i = 0;
-	for (Body* b = m_bodyList; b; b = b->m_next)
+	for (s32 slot = 0; slot < m_bodies.GetSlotEnd(); ++slot)
 	{
+		if (m_bodies.IsAlive(slot) == false)
+		{
+			continue;
+		}
+
+		Body* b = m_bodies.GetObject(slot);
 		b->m_islandIndex = i;
 		b->Dump();
 		++i;
@@ -0,0 +1,587 @@
+#include "WorldFile.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "CircleShape.hpp"
+#include "EdgeShape.hpp"
+#include "PolygonShape.hpp"
+#include "ChainShape.hpp"
+#include "MeshShape.hpp"
+#include "CapsuleShape.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+
+
+namespace
+{
+	// Layout: the header, then one body record per body, oldest first, each
+	// followed by its fixture records, oldest first. A fixture record is
+	// followed by its shape:
+	// circle: the center.
+	// edge: an edge record.
+	// polygon: the centroid, then vertexCount vertices and vertexCount normals.
+	// chain: a chain record, then vertexCount vertices.
+	// mesh: the element count, the elements, then vertexCount vertices and
+	// vertexCount normals.
+	const u32 worldFileMagic = 0x574b5242; // "BRKW"
+	const s32 worldFileVersion = 1;
+
+	struct FileHeader
+	{
+		u32 magic;
+		s32 version;
+		s32 bodyCount;
+		s32 fixtureCount;
+	};
+
+	// BodyRecord::flags
+	enum
+	{
+		allowSleepBit		= 0x0001,
+		awakeBit			= 0x0002,
+		fixedRotationBit	= 0x0004,
+		bulletBit			= 0x0008,
+		activeBit			= 0x0010
+	};
+
+	struct BodyRecord
+	{
+		s32 type;
+		glm::vec2 position;
+		real32 angle;
+		glm::vec2 linearVelocity;
+		real32 angularVelocity;
+		real32 linearDamping;
+		real32 angularDamping;
+		real32 gravityScale;
+		u32 flags;
+		s32 fixtureCount;
+	};
+
+	struct FixtureRecord
+	{
+		real32 friction;
+		real32 restitution;
+		real32 density;
+		u16 categoryBits;
+		u16 maskBits;
+		s16 groupIndex;
+		u16 isSensor;
+		s32 shapeType;
+		real32 radius;
+		s32 vertexCount;
+	};
+
+	// EdgeRecord::flags and ChainRecord::flags
+	enum
+	{
+		hasFirstVertexBit	= 0x0001,
+		hasLastVertexBit	= 0x0002
+	};
+
+	struct EdgeRecord
+	{
+		glm::vec2 vertex0, vertex1, vertex2, vertex3;
+		s32 flags;
+	};
+
+	struct ChainRecord
+	{
+		glm::vec2 prevVertex, nextVertex;
+		s32 flags;
+	};
+
+	// Check the elements of a mesh against its vertex count.
+	bool IsValidMesh(const MeshElement* elements, s32 elementCount, s32 vertexCount)
+	{
+		for (s32 i = 0; i < elementCount; ++i)
+		{
+			const MeshElement& element = elements[i];
+			s32 size = element.count;
+			if (element.flags & MeshElement::edgeFlag)
+			{
+				if (element.count != 2)
+				{
+					return false;
+				}
+				size = 4;
+			}
+			else if (element.count < 3 || element.count > maxPolygonVertices)
+			{
+				return false;
+			}
+
+			if (element.vertexIndex < 0 || element.vertexIndex > vertexCount - size)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// Get the size of the shape that follows a fixture record, or -1 if the record is
+	// invalid or the shape does not fit in the available bytes.
+	s32 GetShapeSize(const FixtureRecord* record, ptrdiff_t available)
+	{
+		s32 count = record->vertexCount;
+		s32 size = -1;
+		switch (record->shapeType)
+		{
+		case Shape::circle:
+			size = count == 0 ? (s32)sizeof(glm::vec2) : -1;
+			break;
+
+		case Shape::edge:
+			size = count == 0 ? (s32)sizeof(EdgeRecord) : -1;
+			break;
+
+		case Shape::polygon:
+			if (count >= 3 && count <= maxPolygonVertices)
+			{
+				size = (1 + 2 * count) * sizeof(glm::vec2);
+			}
+			break;
+
+		case Shape::chain:
+			if (count >= 2 && count <= (1 << 24))
+			{
+				size = sizeof(ChainRecord) + count * sizeof(glm::vec2);
+			}
+			break;
+
+		case Shape::mesh:
+			if (count >= 0 && count <= (1 << 24) && available >= (ptrdiff_t)sizeof(s32))
+			{
+				const s32* elementCount = (const s32*)(record + 1);
+				if (*elementCount >= 0 && *elementCount <= (1 << 24))
+				{
+					size = sizeof(s32) + *elementCount * sizeof(MeshElement) + 2 * count * sizeof(glm::vec2);
+					if (size <= available && IsValidMesh((const MeshElement*)(elementCount + 1), *elementCount, count) == false)
+					{
+						size = -1;
+					}
+				}
+			}
+			break;
+
+		case Shape::capsule:
+			size = count == 0 ? (s32)(2 * sizeof(glm::vec2)) : -1;
+			break;
+		}
+
+		return size <= available ? size : -1;
+	}
+}
+
+WorldFile::WorldFile()
+{
+	m_data = NULL;
+	m_size = 0;
+	m_capacity = 0;
+}
+
+WorldFile::~WorldFile()
+{
+	free(m_data);
+}
+
+void WorldFile::SetData(const void* data, s32 size)
+{
+	assert(size >= 0);
+	m_size = 0;
+	memcpy(Append(size), data, size);
+}
+
+s32 WorldFile::GetBodyCount() const
+{
+	if (m_size < (s32)sizeof(FileHeader))
+	{
+		return -1;
+	}
+
+	const FileHeader* header = (const FileHeader*)m_data;
+	if (header->magic != worldFileMagic || header->version != worldFileVersion || header->bodyCount < 0)
+	{
+		return -1;
+	}
+
+	return header->bodyCount;
+}
+
+void* WorldFile::Append(s32 size)
+{
+	if (m_size + size > m_capacity)
+	{
+		u8* old = m_data;
+		m_capacity = glm::max(2 * m_capacity, m_size + size);
+		m_data = (u8*)malloc(m_capacity);
+		if (m_size > 0)
+		{
+			memcpy(m_data, old, m_size);
+		}
+		free(old);
+	}
+
+	void* p = m_data + m_size;
+	m_size += size;
+	return p;
+}
+
+void World::Save(WorldFile* file) const
+{
+	assert(IsLocked() == false);
+
+	file->Clear();
+	file->Append(sizeof(FileHeader));
+
+	// The lists are newest first. Walk them backwards so a load recreates them in the same order.
+	const Body* tail = m_bodyList;
+	s32 maxFixtureCount = 0;
+	for (const Body* b = m_bodyList; b; b = b->m_next)
+	{
+		maxFixtureCount = glm::max(maxFixtureCount, b->m_fixtureCount);
+		tail = b;
+	}
+
+	const Fixture** fixtures = (const Fixture**)malloc(maxFixtureCount * sizeof(Fixture*));
+	s32 fixtureCount = 0;
+
+	for (const Body* b = m_bodyList ? tail : NULL; b; b = b->m_prev)
+	{
+		BodyRecord* br = (BodyRecord*)file->Append(sizeof(BodyRecord));
+		br->type = b->GetType();
+		br->position = b->GetPosition();
+		br->angle = b->GetAngle();
+		br->linearVelocity = b->GetLinearVelocity();
+		br->angularVelocity = b->GetAngularVelocity();
+		br->linearDamping = b->GetLinearDamping();
+		br->angularDamping = b->GetAngularDamping();
+		br->gravityScale = b->GetGravityScale();
+		br->flags = 0;
+		br->flags |= b->IsSleepingAllowed() ? allowSleepBit : 0;
+		br->flags |= b->IsAwake() ? awakeBit : 0;
+		br->flags |= b->IsFixedRotation() ? fixedRotationBit : 0;
+		br->flags |= b->IsBullet() ? bulletBit : 0;
+		br->flags |= b->IsActive() ? activeBit : 0;
+		br->fixtureCount = b->m_fixtureCount;
+
+		s32 count = 0;
+		for (const Fixture* f = b->m_fixtureList; f; f = f->m_next)
+		{
+			fixtures[count++] = f;
+		}
+
+		for (s32 i = count - 1; i >= 0; --i)
+		{
+			const Fixture* f = fixtures[i];
+			const Shape* shape = f->GetShape();
+
+			FixtureRecord* fr = (FixtureRecord*)file->Append(sizeof(FixtureRecord));
+			fr->friction = f->GetFriction();
+			fr->restitution = f->GetRestitution();
+			fr->density = f->GetDensity();
+			fr->categoryBits = f->GetFilterData().categoryBits;
+			fr->maskBits = f->GetFilterData().maskBits;
+			fr->groupIndex = f->GetFilterData().groupIndex;
+			fr->isSensor = f->IsSensor() ? 1 : 0;
+			fr->shapeType = shape->GetType();
+			fr->radius = shape->m_radius;
+			fr->vertexCount = 0;
+
+			switch (shape->GetType())
+			{
+			case Shape::circle:
+				{
+					const CircleShape* circle = (const CircleShape*)shape;
+					*(glm::vec2*)file->Append(sizeof(glm::vec2)) = circle->m_p;
+				}
+				break;
+
+			case Shape::edge:
+				{
+					const EdgeShape* edge = (const EdgeShape*)shape;
+					EdgeRecord* er = (EdgeRecord*)file->Append(sizeof(EdgeRecord));
+					er->vertex0 = edge->m_vertex0;
+					er->vertex1 = edge->m_vertex1;
+					er->vertex2 = edge->m_vertex2;
+					er->vertex3 = edge->m_vertex3;
+					er->flags = (edge->m_hasVertex0 ? hasFirstVertexBit : 0) | (edge->m_hasVertex3 ? hasLastVertexBit : 0);
+				}
+				break;
+
+			case Shape::polygon:
+				{
+					const PolygonShape* polygon = (const PolygonShape*)shape;
+					s32 n = polygon->m_count;
+					fr->vertexCount = n;
+					glm::vec2* v = (glm::vec2*)file->Append((1 + 2 * n) * sizeof(glm::vec2));
+					v[0] = polygon->m_centroid;
+					memcpy(v + 1, polygon->m_vertices, n * sizeof(glm::vec2));
+					memcpy(v + 1 + n, polygon->m_normals, n * sizeof(glm::vec2));
+				}
+				break;
+
+			case Shape::chain:
+				{
+					const ChainShape* chain = (const ChainShape*)shape;
+					s32 n = chain->m_count;
+					fr->vertexCount = n;
+					ChainRecord* cr = (ChainRecord*)file->Append(sizeof(ChainRecord) + n * sizeof(glm::vec2));
+					cr->prevVertex = chain->m_prevVertex;
+					cr->nextVertex = chain->m_nextVertex;
+					cr->flags = (chain->m_hasPrevVertex ? hasFirstVertexBit : 0) | (chain->m_hasNextVertex ? hasLastVertexBit : 0);
+					memcpy(cr + 1, chain->m_vertices, n * sizeof(glm::vec2));
+				}
+				break;
+
+			case Shape::mesh:
+				{
+					const MeshShape* mesh = (const MeshShape*)shape;
+					s32 n = mesh->m_vertexCount;
+					s32 elementCount = mesh->m_elementCount;
+					fr->vertexCount = n;
+					s32* header = (s32*)file->Append(sizeof(s32) + elementCount * sizeof(MeshElement) + 2 * n * sizeof(glm::vec2));
+					*header = elementCount;
+					MeshElement* elements = (MeshElement*)(header + 1);
+					memcpy(elements, mesh->m_elements, elementCount * sizeof(MeshElement));
+					glm::vec2* v = (glm::vec2*)(elements + elementCount);
+					memcpy(v, mesh->m_vertices, n * sizeof(glm::vec2));
+					memcpy(v + n, mesh->m_normals, n * sizeof(glm::vec2));
+				}
+				break;
+
+			case Shape::capsule:
+				{
+					const CapsuleShape* capsule = (const CapsuleShape*)shape;
+					glm::vec2* v = (glm::vec2*)file->Append(2 * sizeof(glm::vec2));
+					v[0] = capsule->m_vertex1;
+					v[1] = capsule->m_vertex2;
+				}
+				break;
+
+			default:
+				assert(false);
+				break;
+			}
+		}
+
+		fixtureCount += count;
+	}
+
+	free(fixtures);
+
+	// Appending may have moved the buffer, so fill in the header last.
+	FileHeader* header = (FileHeader*)file->m_data;
+	header->magic = worldFileMagic;
+	header->version = worldFileVersion;
+	header->bodyCount = m_bodyCount;
+	header->fixtureCount = fixtureCount;
+}
+
+bool World::Load(const WorldFile* file, Body** bodies)
+{
+	assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return false;
+	}
+
+	s32 bodyCount = file->GetBodyCount();
+	if (bodyCount < 0)
+	{
+		return false;
+	}
+
+	const FileHeader* header = (const FileHeader*)file->m_data;
+	const u8* begin = file->m_data + sizeof(FileHeader);
+	const u8* end = file->m_data + file->m_size;
+
+	// Check the whole file before creating anything.
+	const u8* p = begin;
+	s32 fixtureCount = 0;
+	for (s32 i = 0; i < bodyCount; ++i)
+	{
+		if (end - p < (s32)sizeof(BodyRecord))
+		{
+			return false;
+		}
+
+		const BodyRecord* br = (const BodyRecord*)p;
+		p += sizeof(BodyRecord);
+		if (br->type < staticBody || br->type > dynamicBody || br->fixtureCount < 0)
+		{
+			return false;
+		}
+
+		for (s32 j = 0; j < br->fixtureCount; ++j)
+		{
+			if (end - p < (s32)sizeof(FixtureRecord))
+			{
+				return false;
+			}
+
+			const FixtureRecord* fr = (const FixtureRecord*)p;
+			p += sizeof(FixtureRecord);
+			s32 shapeSize = GetShapeSize(fr, end - p);
+			if (shapeSize < 0)
+			{
+				return false;
+			}
+			p += shapeSize;
+		}
+
+		fixtureCount += br->fixtureCount;
+	}
+
+	if (p != end || fixtureCount != header->fixtureCount)
+	{
+		return false;
+	}
+
+	// Join a bulk load the caller already started.
+	bool ownBulkLoad = IsBulkLoading() == false;
+	if (ownBulkLoad)
+	{
+		BeginBulkLoad();
+	}
+
+	CircleShape circle;
+	EdgeShape edge;
+	PolygonShape polygon;
+
+	p = begin;
+	for (s32 i = 0; i < bodyCount; ++i)
+	{
+		const BodyRecord* br = (const BodyRecord*)p;
+		p += sizeof(BodyRecord);
+
+		BodyDef bd;
+		bd.type = (BodyType)br->type;
+		bd.position = br->position;
+		bd.angle = br->angle;
+		bd.linearVelocity = br->linearVelocity;
+		bd.angularVelocity = br->angularVelocity;
+		bd.linearDamping = br->linearDamping;
+		bd.angularDamping = br->angularDamping;
+		bd.gravityScale = br->gravityScale;
+		bd.allowSleep = (br->flags & allowSleepBit) != 0;
+		bd.awake = (br->flags & awakeBit) != 0;
+		bd.fixedRotation = (br->flags & fixedRotationBit) != 0;
+		bd.bullet = (br->flags & bulletBit) != 0;
+		bd.active = (br->flags & activeBit) != 0;
+
+		Body* b = CreateBody(&bd);
+		if (bodies)
+		{
+			bodies[i] = b;
+		}
+
+		for (s32 j = 0; j < br->fixtureCount; ++j)
+		{
+			const FixtureRecord* fr = (const FixtureRecord*)p;
+			p += sizeof(FixtureRecord);
+
+			FixtureDef fd;
+			fd.friction = fr->friction;
+			fd.restitution = fr->restitution;
+			fd.density = fr->density;
+			fd.filter.categoryBits = fr->categoryBits;
+			fd.filter.maskBits = fr->maskBits;
+			fd.filter.groupIndex = fr->groupIndex;
+			fd.isSensor = fr->isSensor != 0;
+
+			s32 n = fr->vertexCount;
+			switch (fr->shapeType)
+			{
+			case Shape::circle:
+				{
+					circle.m_radius = fr->radius;
+					circle.m_p = *(const glm::vec2*)p;
+					fd.shape = &circle;
+					b->CreateFixture(&fd);
+				}
+				break;
+
+			case Shape::edge:
+				{
+					const EdgeRecord* er = (const EdgeRecord*)p;
+					edge.m_radius = fr->radius;
+					edge.m_vertex0 = er->vertex0;
+					edge.m_vertex1 = er->vertex1;
+					edge.m_vertex2 = er->vertex2;
+					edge.m_vertex3 = er->vertex3;
+					edge.m_hasVertex0 = (er->flags & hasFirstVertexBit) != 0;
+					edge.m_hasVertex3 = (er->flags & hasLastVertexBit) != 0;
+					fd.shape = &edge;
+					b->CreateFixture(&fd);
+				}
+				break;
+
+			case Shape::polygon:
+				{
+					// The hull is stored as computed, so it is not rebuilt here.
+					const glm::vec2* v = (const glm::vec2*)p;
+					polygon.m_radius = fr->radius;
+					polygon.m_centroid = v[0];
+					memcpy(polygon.m_vertices, v + 1, n * sizeof(glm::vec2));
+					memcpy(polygon.m_normals, v + 1 + n, n * sizeof(glm::vec2));
+					polygon.m_count = n;
+					fd.shape = &polygon;
+					b->CreateFixture(&fd);
+				}
+				break;
+
+			case Shape::chain:
+				{
+					const ChainRecord* cr = (const ChainRecord*)p;
+					ChainShape chain;
+					chain.m_radius = fr->radius;
+					chain.CreateChain((const glm::vec2*)(cr + 1), n);
+					chain.m_prevVertex = cr->prevVertex;
+					chain.m_nextVertex = cr->nextVertex;
+					chain.m_hasPrevVertex = (cr->flags & hasFirstVertexBit) != 0;
+					chain.m_hasNextVertex = (cr->flags & hasLastVertexBit) != 0;
+					fd.shape = &chain;
+					b->CreateFixture(&fd);
+				}
+				break;
+
+			case Shape::mesh:
+				{
+					const s32* elementCount = (const s32*)p;
+					const MeshElement* elements = (const MeshElement*)(elementCount + 1);
+					const glm::vec2* v = (const glm::vec2*)(elements + *elementCount);
+					MeshShape mesh;
+					mesh.m_radius = fr->radius;
+					mesh.Set(elements, *elementCount, v, v + n, n);
+					fd.shape = &mesh;
+					b->CreateFixture(&fd);
+				}
+				break;
+
+			case Shape::capsule:
+				{
+					const glm::vec2* v = (const glm::vec2*)p;
+					CapsuleShape capsule;
+					capsule.m_radius = fr->radius;
+					capsule.m_vertex1 = v[0];
+					capsule.m_vertex2 = v[1];
+					fd.shape = &capsule;
+					b->CreateFixture(&fd);
+				}
+				break;
+			}
+
+			p += GetShapeSize(fr, end - p);
+		}
+	}
+
+	if (ownBulkLoad)
+	{
+		EndBulkLoad();
+	}
+
+	return true;
+}
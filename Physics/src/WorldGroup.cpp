@@ -0,0 +1,209 @@
+#include "WorldGroup.hpp"
+#include "World2D.hpp"
+#include "ThreadPool.hpp"
+#include "Timer.hpp"
+#include <algorithm>
+#include <memory.h>
+
+using namespace Break;
+using namespace Break::Physics;
+
+
+struct WorldGroup::Entry
+{
+	World* world;
+	u64 stepTime;
+	u64 latency;
+};
+
+namespace
+{
+	struct StepContext
+	{
+		WorldGroup* group;
+		Timer timer;
+	};
+
+	// Orders entry indices by decreasing step time, so the slowest worlds start first.
+	struct SlowerFirst
+	{
+		const u64* times;
+
+		bool operator()(s32 a, s32 b) const
+		{
+			return times[a] > times[b];
+		}
+	};
+}
+
+WorldGroup::WorldGroup()
+{
+	m_entries = NULL;
+	m_count = 0;
+	m_capacity = 0;
+	m_order = NULL;
+	m_threadPool = NULL;
+	m_timeStep = 0.0f;
+	m_velocityIterations = 0;
+	m_positionIterations = 0;
+	m_groupStepTime = 0;
+}
+
+WorldGroup::~WorldGroup()
+{
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		delete m_entries[i].world;
+	}
+
+	free(m_entries);
+	free(m_order);
+}
+
+World* WorldGroup::CreateWorld(const WorldDef* def)
+{
+	if (m_count == m_capacity)
+	{
+		m_capacity = glm::max(2 * m_capacity, 8);
+		Entry* entries = (Entry*)malloc(m_capacity * sizeof(Entry));
+		if (m_count > 0)
+		{
+			memcpy(entries, m_entries, m_count * sizeof(Entry));
+		}
+		free(m_entries);
+		free(m_order);
+		m_entries = entries;
+		m_order = (s32*)malloc(m_capacity * sizeof(s32));
+	}
+
+	Entry* entry = m_entries + m_count;
+	entry->world = new World(def);
+	entry->stepTime = 0;
+	entry->latency = 0;
+	++m_count;
+	return entry->world;
+}
+
+void WorldGroup::DestroyWorld(World* world)
+{
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		if (m_entries[i].world == world)
+		{
+			delete world;
+			m_entries[i] = m_entries[m_count - 1];
+			--m_count;
+			return;
+		}
+	}
+
+	// The world is not in this group.
+	assert(false);
+}
+
+World* WorldGroup::GetWorld(s32 index)
+{
+	assert(0 <= index && index < m_count);
+	return m_entries[index].world;
+}
+
+const World* WorldGroup::GetWorld(s32 index) const
+{
+	assert(0 <= index && index < m_count);
+	return m_entries[index].world;
+}
+
+u64 WorldGroup::GetStepTime(s32 index) const
+{
+	assert(0 <= index && index < m_count);
+	return m_entries[index].stepTime;
+}
+
+u64 WorldGroup::GetLatency(s32 index) const
+{
+	assert(0 <= index && index < m_count);
+	return m_entries[index].latency;
+}
+
+ProfileStats WorldGroup::GetLatencyStats() const
+{
+	ProfileStats stats;
+	memset(&stats, 0, sizeof(ProfileStats));
+	if (m_count == 0)
+	{
+		return stats;
+	}
+
+	real64* values = (real64*)malloc(m_count * sizeof(real64));
+	real64 sum = 0.0;
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		values[i] = (real64)m_entries[i].latency;
+		sum += values[i];
+	}
+	std::sort(values, values + m_count);
+
+	stats.min = values[0];
+	stats.max = values[m_count - 1];
+	stats.avg = sum / m_count;
+
+	// Nearest rank, as in ProfileHistory::GetStats.
+	s32 rank = (99 * m_count + 99) / 100;
+	stats.p99 = values[rank - 1];
+
+	free(values);
+	return stats;
+}
+
+void WorldGroup::StepTask(void* context, s32 begin, s32 end, s32 threadIndex)
+{
+	NOT_USED(threadIndex);
+
+	StepContext* stepContext = (StepContext*)context;
+	WorldGroup* group = stepContext->group;
+	for (s32 i = begin; i < end; ++i)
+	{
+		Entry* entry = group->m_entries + group->m_order[i];
+
+		Timer timer;
+		entry->world->Step(group->m_timeStep, group->m_velocityIterations, group->m_positionIterations);
+		entry->stepTime = timer.GetNanoseconds();
+		entry->latency = stepContext->timer.GetNanoseconds();
+	}
+}
+
+void WorldGroup::Step(real32 timeStep, s32 velocityIterations, s32 positionIterations)
+{
+	m_timeStep = timeStep;
+	m_velocityIterations = velocityIterations;
+	m_positionIterations = positionIterations;
+
+	u64* times = (u64*)malloc(m_count * sizeof(u64));
+	for (s32 i = 0; i < m_count; ++i)
+	{
+		m_order[i] = i;
+		times[i] = m_entries[i].stepTime;
+	}
+
+	// Start the slowest worlds first so a long step does not end up last on
+	// an otherwise idle pool.
+	SlowerFirst slowerFirst;
+	slowerFirst.times = times;
+	std::stable_sort(m_order, m_order + m_count, slowerFirst);
+	free(times);
+
+	StepContext context;
+	context.group = this;
+	context.timer.Reset();
+
+	if (m_threadPool)
+	{
+		m_threadPool->ParallelFor(m_count, 1, StepTask, &context);
+	}
+	else
+	{
+		StepTask(&context, 0, m_count, 0);
+	}
+
+	m_groupStepTime = context.timer.GetNanoseconds();
+}
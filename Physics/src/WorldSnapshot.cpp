@@ -0,0 +1,528 @@
+#include "WorldSnapshot.hpp"
+#include "World2D.hpp"
+#include "Body2D.hpp"
+#include "Fixture.hpp"
+#include "Contact2D.hpp"
+#include "Joint2D.hpp"
+#include "IBroadPhase.hpp"
+#include "MeshShape.hpp"
+#include "ChainShape.hpp"
+
+using namespace Break;
+using namespace Break::Physics;
+
+
+namespace
+{
+	// Layout: the header, one body record per live body in slot order, each
+	// followed by the fat AABBs of its proxies when it is not static, the slots
+	// of the awake set, the contacts in world list order, each followed by its
+	// manifold points, the sensor overlaps in array order and the joint states
+	// in world list order.
+	struct SnapshotHeader
+	{
+		s32 bodyCount;
+		s32 awakeCount;
+		s32 contactCount;
+		s32 overlapCount;
+		s32 jointCount;
+		real32 inv_dt0;
+		s32 stepComplete;
+	};
+
+	struct BodyRecord
+	{
+		BodyHandle handle;
+		Transform2D xf;
+		glm::vec2 c0, c;
+		real32 a0, a;
+		real32 alpha0;
+		glm::vec2 linearVelocity;
+		real32 angularVelocity;
+		glm::vec2 force;
+		real32 torque;
+		real32 sleepTime;
+		s32 awake;
+
+		// Number of fat AABBs that follow, zero for static bodies.
+		s32 proxyCount;
+	};
+
+	struct ContactRecord
+	{
+		s32 proxyIdA;
+		s32 proxyIdB;
+
+		// Child indices, which are element indices for meshes and chains.
+		s32 childIndexA;
+		s32 childIndexB;
+		u32 flags;
+		s32 toiCount;
+		real32 toi;
+		real32 friction;
+		real32 restitution;
+		real32 tangentSpeed;
+		glm::vec2 localNormal;
+		glm::vec2 localPoint;
+		s32 type;
+
+		// The narrow-phase caches, so that a restored step repeats exactly.
+		SeparationCache separationCache;
+		SimplexCache simplexCache;
+
+		// Number of manifold points that follow.
+		s32 pointCount;
+	};
+
+	struct OverlapRecord
+	{
+		s32 sensorProxyId;
+		s32 visitorProxyId;
+		s32 sensorIndex;
+		s32 visitorIndex;
+		u32 flags;
+		SimplexCache simplexCache;
+	};
+
+	inline const ContactRecord* GetNextRecord(const ContactRecord* record)
+	{
+		return (const ContactRecord*)((const ManifoldPoint*)(record + 1) + record->pointCount);
+	}
+
+	inline bool IsValidChild(const FixtureProxy* proxy, s32 childIndex)
+	{
+		const Shape* shape = proxy->fixture->GetShape();
+		if (shape->GetType() == Shape::mesh)
+		{
+			return 0 <= childIndex && childIndex < ((const MeshShape*)shape)->GetElementCount();
+		}
+
+		if (shape->GetType() == Shape::chain)
+		{
+			return 0 <= childIndex && childIndex < ((const ChainShape*)shape)->GetEdgeCount();
+		}
+
+		return childIndex == proxy->childIndex;
+	}
+}
+
+WorldSnapshot::WorldSnapshot()
+{
+	m_data = NULL;
+	m_size = 0;
+	m_capacity = 0;
+}
+
+WorldSnapshot::~WorldSnapshot()
+{
+	free(m_data);
+}
+
+void WorldSnapshot::SetData(const void* data, s32 size)
+{
+	assert(size >= 0);
+	m_size = 0;
+	memcpy(Append(size), data, size);
+}
+
+void* WorldSnapshot::Append(s32 size)
+{
+	if (m_size + size > m_capacity)
+	{
+		u8* old = m_data;
+		m_capacity = glm::max(2 * m_capacity, m_size + size);
+		m_data = (u8*)malloc(m_capacity);
+		if (m_size > 0)
+		{
+			memcpy(m_data, old, m_size);
+		}
+		free(old);
+	}
+
+	void* p = m_data + m_size;
+	m_size += size;
+	return p;
+}
+
+void World::SaveSnapshot(WorldSnapshot* snapshot) const
+{
+	assert(IsLocked() == false);
+
+	snapshot->Clear();
+
+	SnapshotHeader* header = (SnapshotHeader*)snapshot->Append(sizeof(SnapshotHeader));
+	header->bodyCount = m_bodyCount;
+	header->awakeCount = m_awakeCount;
+	header->contactCount = m_contactManager.m_contactCount;
+	header->overlapCount = m_contactManager.m_overlapCount;
+	header->jointCount = m_jointCount;
+	header->inv_dt0 = m_inv_dt0;
+	header->stepComplete = m_stepComplete ? 1 : 0;
+
+	const IBroadPhase* broadPhase = m_contactManager.m_broadPhase;
+	for (s32 slot = 0; slot < m_bodies.GetSlotEnd(); ++slot)
+	{
+		if (m_bodies.IsAlive(slot) == false)
+		{
+			continue;
+		}
+
+		const Body* b = m_bodies.GetObject(slot);
+		s32 proxyCount = 0;
+		if (b->m_type != staticBody)
+		{
+			for (const Fixture* f = b->m_fixtureList; f; f = f->m_next)
+			{
+				proxyCount += f->m_proxyCount;
+			}
+		}
+
+		BodyRecord* record = (BodyRecord*)snapshot->Append(sizeof(BodyRecord) + proxyCount * sizeof(AABB));
+		record->handle = m_bodies.GetHandle(slot);
+		record->xf = b->m_xf;
+		record->c0 = b->m_sweep.c0;
+		record->c = b->m_sweep.c;
+		record->a0 = b->m_sweep.a0;
+		record->a = b->m_sweep.a;
+		record->alpha0 = b->m_sweep.alpha0;
+		record->linearVelocity = b->m_linearVelocity;
+		record->angularVelocity = b->m_angularVelocity;
+		record->force = b->m_force;
+		record->torque = b->m_torque;
+		record->sleepTime = b->m_sleepTime;
+		record->awake = (b->m_flags & Body::awakeFlag) ? 1 : 0;
+		record->proxyCount = proxyCount;
+
+		if (proxyCount > 0)
+		{
+			AABB* aabbs = (AABB*)(record + 1);
+			for (const Fixture* f = b->m_fixtureList; f; f = f->m_next)
+			{
+				for (s32 i = 0; i < f->m_proxyCount; ++i)
+				{
+					*aabbs++ = broadPhase->GetFatAABB(f->m_proxies[i].proxyId);
+				}
+			}
+		}
+	}
+
+	s32* awake = (s32*)snapshot->Append(m_awakeCount * sizeof(s32));
+	for (s32 i = 0; i < m_awakeCount; ++i)
+	{
+		awake[i] = m_awakeBodies[i]->m_slotIndex;
+	}
+
+	for (const Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+	{
+		const Manifold& manifold = c->m_manifold;
+		ContactRecord* record = (ContactRecord*)snapshot->Append(sizeof(ContactRecord) + manifold.pointCount * sizeof(ManifoldPoint));
+		record->proxyIdA = c->m_fixtureA->GetProxyId(c->m_indexA);
+		record->proxyIdB = c->m_fixtureB->GetProxyId(c->m_indexB);
+		record->childIndexA = c->m_indexA;
+		record->childIndexB = c->m_indexB;
+		record->flags = c->m_flags;
+		record->toiCount = c->m_toiCount;
+		record->toi = c->m_toi;
+		record->friction = c->m_friction;
+		record->restitution = c->m_restitution;
+		record->tangentSpeed = c->m_tangentSpeed;
+		record->localNormal = manifold.localNormal;
+		record->localPoint = manifold.localPoint;
+		record->type = manifold.type;
+		record->separationCache = c->m_separationCache;
+		record->simplexCache = c->m_simplexCache;
+		record->pointCount = manifold.pointCount;
+		memcpy(record + 1, manifold.points, manifold.pointCount * sizeof(ManifoldPoint));
+	}
+
+	OverlapRecord* overlaps = (OverlapRecord*)snapshot->Append(m_contactManager.m_overlapCount * sizeof(OverlapRecord));
+	for (s32 i = 0; i < m_contactManager.m_overlapCount; ++i)
+	{
+		const SensorOverlap* o = m_contactManager.m_overlaps + i;
+		overlaps[i].sensorProxyId = o->sensor->GetProxyId(o->sensorIndex);
+		overlaps[i].visitorProxyId = o->visitor->GetProxyId(o->visitorIndex);
+		overlaps[i].sensorIndex = o->sensorIndex;
+		overlaps[i].visitorIndex = o->visitorIndex;
+		overlaps[i].flags = o->flags;
+		overlaps[i].simplexCache = o->simplexCache;
+	}
+
+	JointState* joints = (JointState*)snapshot->Append(m_jointCount * sizeof(JointState));
+	for (const Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->SaveState(joints++);
+	}
+}
+
+void World::RestoreContact(Contact* c, const void* data) const
+{
+	const ContactRecord* record = (const ContactRecord*)data;
+	c->m_flags = record->flags;
+	c->m_toiCount = record->toiCount;
+	c->m_toi = record->toi;
+	c->m_toiStamp = m_toiStamp;
+	c->m_friction = record->friction;
+	c->m_restitution = record->restitution;
+	c->m_tangentSpeed = record->tangentSpeed;
+	c->m_manifold.localNormal = record->localNormal;
+	c->m_manifold.localPoint = record->localPoint;
+	c->m_manifold.type = (Manifold::Type)record->type;
+	c->m_separationCache = record->separationCache;
+	c->m_simplexCache = record->simplexCache;
+	c->m_manifold.pointCount = record->pointCount;
+	memcpy(c->m_manifold.points, record + 1, record->pointCount * sizeof(ManifoldPoint));
+}
+
+bool World::RestoreSnapshot(const WorldSnapshot* snapshot)
+{
+	assert(IsLocked() == false);
+	if (IsLocked())
+	{
+		return false;
+	}
+
+	const u8* data = snapshot->m_data;
+	const u8* end = data + snapshot->m_size;
+	if (snapshot->m_size < (s32)sizeof(SnapshotHeader))
+	{
+		return false;
+	}
+
+	const SnapshotHeader* header = (const SnapshotHeader*)data;
+	if (header->bodyCount != m_bodyCount || header->jointCount != m_jointCount)
+	{
+		return false;
+	}
+
+	// Check the bodies and proxies before anything is changed.
+	const u8* bodyData = data + sizeof(SnapshotHeader);
+	const u8* p = bodyData;
+	for (s32 i = 0; i < header->bodyCount; ++i)
+	{
+		if (end - p < (ptrdiff_t)sizeof(BodyRecord))
+		{
+			return false;
+		}
+
+		const BodyRecord* record = (const BodyRecord*)p;
+		const Body* b = m_bodies.Get(record->handle);
+		if (b == NULL)
+		{
+			return false;
+		}
+
+		s32 proxyCount = 0;
+		if (b->m_type != staticBody)
+		{
+			for (const Fixture* f = b->m_fixtureList; f; f = f->m_next)
+			{
+				proxyCount += f->m_proxyCount;
+			}
+		}
+
+		if (proxyCount != record->proxyCount)
+		{
+			return false;
+		}
+
+		p += sizeof(BodyRecord) + record->proxyCount * sizeof(AABB);
+	}
+
+	const s32* awake = (const s32*)p;
+	if (end - p < (ptrdiff_t)(header->awakeCount * sizeof(s32)))
+	{
+		return false;
+	}
+
+	for (s32 i = 0; i < header->awakeCount; ++i)
+	{
+		if (awake[i] < 0 || awake[i] >= m_bodies.GetSlotEnd() || m_bodies.IsAlive(awake[i]) == false)
+		{
+			return false;
+		}
+	}
+
+	// The contact records have different sizes, so they are indexed here.
+	IBroadPhase* broadPhase = m_contactManager.m_broadPhase;
+	const ContactRecord** contacts = (const ContactRecord**)m_stackAllocator.Allocate(header->contactCount * sizeof(ContactRecord*));
+	const ContactRecord* record = (const ContactRecord*)(awake + header->awakeCount);
+	for (s32 i = 0; i < header->contactCount; ++i)
+	{
+		if (end - (const u8*)record < (ptrdiff_t)sizeof(ContactRecord) ||
+			record->pointCount < 0 || record->pointCount > maxManifoldPoints ||
+			record->separationCache.type > SeparationCache::faceB || record->simplexCache.count > 3 ||
+			broadPhase->GetUserData(record->proxyIdA) == NULL ||
+			broadPhase->GetUserData(record->proxyIdB) == NULL ||
+			IsValidChild((const FixtureProxy*)broadPhase->GetUserData(record->proxyIdA), record->childIndexA) == false ||
+			IsValidChild((const FixtureProxy*)broadPhase->GetUserData(record->proxyIdB), record->childIndexB) == false)
+		{
+			m_stackAllocator.Free(contacts);
+			return false;
+		}
+
+		contacts[i] = record;
+		record = GetNextRecord(record);
+	}
+
+	const OverlapRecord* overlaps = (const OverlapRecord*)record;
+	if (header->overlapCount < 0 || end - (const u8*)overlaps < (ptrdiff_t)(header->overlapCount * sizeof(OverlapRecord)))
+	{
+		m_stackAllocator.Free(contacts);
+		return false;
+	}
+
+	for (s32 i = 0; i < header->overlapCount; ++i)
+	{
+		const FixtureProxy* sensorProxy = (const FixtureProxy*)broadPhase->GetUserData(overlaps[i].sensorProxyId);
+		const FixtureProxy* visitorProxy = (const FixtureProxy*)broadPhase->GetUserData(overlaps[i].visitorProxyId);
+		if (sensorProxy == NULL || visitorProxy == NULL || overlaps[i].simplexCache.count > 3 ||
+			IsValidChild(sensorProxy, overlaps[i].sensorIndex) == false ||
+			IsValidChild(visitorProxy, overlaps[i].visitorIndex) == false ||
+			(sensorProxy->fixture->IsSensor() == false && visitorProxy->fixture->IsSensor() == false))
+		{
+			m_stackAllocator.Free(contacts);
+			return false;
+		}
+	}
+
+	const JointState* joints = (const JointState*)(overlaps + header->overlapCount);
+	if ((const u8*)(joints + header->jointCount) != end)
+	{
+		m_stackAllocator.Free(contacts);
+		return false;
+	}
+
+	// Bodies.
+	p = bodyData;
+	for (s32 i = 0; i < header->bodyCount; ++i)
+	{
+		const BodyRecord* record = (const BodyRecord*)p;
+		Body* b = m_bodies.GetObject(record->handle.index);
+		b->m_xf = record->xf;
+		b->m_sweep.c0 = record->c0;
+		b->m_sweep.c = record->c;
+		b->m_sweep.a0 = record->a0;
+		b->m_sweep.a = record->a;
+		b->m_sweep.alpha0 = record->alpha0;
+		b->m_linearVelocity = record->linearVelocity;
+		b->m_angularVelocity = record->angularVelocity;
+		b->m_force = record->force;
+		b->m_torque = record->torque;
+		b->m_sleepTime = record->sleepTime;
+		b->m_toiStamp = m_toiStamp;
+
+		if (record->awake)
+		{
+			b->m_flags |= Body::awakeFlag;
+		}
+		else
+		{
+			b->m_flags &= ~Body::awakeFlag;
+		}
+
+		// The broad-phase is put back as well, otherwise pairs could be found
+		// at other steps and contacts created in another order.
+		const AABB* aabbs = (const AABB*)(record + 1);
+		if (record->proxyCount > 0)
+		{
+			for (Fixture* f = b->m_fixtureList; f; f = f->m_next)
+			{
+				for (s32 j = 0; j < f->m_proxyCount; ++j)
+				{
+					broadPhase->SetFatAABB(f->m_proxies[j].proxyId, *aabbs++);
+				}
+			}
+		}
+
+		p += sizeof(BodyRecord) + record->proxyCount * sizeof(AABB);
+	}
+
+	// The awake set keeps its order since islands are seeded from it.
+	for (s32 i = 0; i < m_awakeCount; ++i)
+	{
+		m_awakeBodies[i]->m_awakeIndex = -1;
+	}
+
+	if (header->awakeCount > m_awakeCapacity)
+	{
+		free(m_awakeBodies);
+		m_awakeCapacity = header->awakeCount;
+		m_awakeBodies = (Body**)malloc(m_awakeCapacity * sizeof(Body*));
+	}
+
+	m_awakeCount = header->awakeCount;
+	for (s32 i = 0; i < m_awakeCount; ++i)
+	{
+		Body* b = m_bodies.GetObject(awake[i]);
+		b->m_awakeIndex = i;
+		m_awakeBodies[i] = b;
+	}
+
+	// Contacts. While the world still has the saved contacts in the saved order,
+	// which is common when rolling back a few frames, they are overwritten in
+	// place. Otherwise they are rebuilt oldest first, so that the world and
+	// body contact lists end up in the saved order.
+	s32 restored = 0;
+	if (m_contactManager.m_contactCount == header->contactCount)
+	{
+		for (Contact* c = m_contactManager.m_contactList; c; c = c->m_next)
+		{
+			if (c->m_fixtureA->GetProxyId(c->m_indexA) != contacts[restored]->proxyIdA ||
+				c->m_fixtureB->GetProxyId(c->m_indexB) != contacts[restored]->proxyIdB ||
+				c->m_indexA != contacts[restored]->childIndexA ||
+				c->m_indexB != contacts[restored]->childIndexB)
+			{
+				break;
+			}
+
+			RestoreContact(c, contacts[restored]);
+			++restored;
+		}
+	}
+
+	if (restored < header->contactCount)
+	{
+		m_contactManager.Clear();
+
+		for (s32 i = header->contactCount - 1; i >= 0; --i)
+		{
+			FixtureProxy* proxyA = (FixtureProxy*)broadPhase->GetUserData(contacts[i]->proxyIdA);
+			FixtureProxy* proxyB = (FixtureProxy*)broadPhase->GetUserData(contacts[i]->proxyIdB);
+			Contact* c = Contact::Create(proxyA->fixture, contacts[i]->childIndexA, proxyB->fixture, contacts[i]->childIndexB, &m_blockAllocator);
+			assert(c != NULL && c->m_fixtureA == proxyA->fixture);
+			m_contactManager.Insert(c);
+			RestoreContact(c, contacts[i]);
+		}
+	}
+
+	m_stackAllocator.Free(contacts);
+
+	// The restored flags decide which contacts wait for filtering.
+	m_contactManager.RequeueFiltering();
+
+	// Sensor overlaps are rebuilt in the saved order, so the events of the
+	// following steps come in the same order.
+	m_contactManager.ClearOverlaps();
+	for (s32 i = 0; i < header->overlapCount; ++i)
+	{
+		FixtureProxy* sensorProxy = (FixtureProxy*)broadPhase->GetUserData(overlaps[i].sensorProxyId);
+		FixtureProxy* visitorProxy = (FixtureProxy*)broadPhase->GetUserData(overlaps[i].visitorProxyId);
+		m_contactManager.CreateOverlap(sensorProxy->fixture, overlaps[i].sensorIndex, visitorProxy->fixture, overlaps[i].visitorIndex);
+		SensorOverlap* o = m_contactManager.m_overlaps + i;
+		o->flags = overlaps[i].flags;
+		o->simplexCache = overlaps[i].simplexCache;
+	}
+
+	// Pending end events belong to the state that was left.
+	m_contactEvents.Clear();
+
+	// Joints.
+	for (Joint* j = m_jointList; j; j = j->m_next)
+	{
+		j->LoadState(joints++);
+	}
+
+	m_inv_dt0 = header->inv_dt0;
+	m_stepComplete = header->stepComplete != 0;
+	return true;
+}
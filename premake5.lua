@@ -64,6 +64,32 @@ project "Break_Physics"
 		defines {"NDEBUG", "COMPILE_DLL"}
 		optimize "On"
 
+project "Break_PhysicsBench"
+	kind "ConsoleApp"
+	language "C++"
+	targetdir "bin/%{cfg.buildcfg}"
+	location "Physics/bench"
+
+	files {"Physics/bench/**.hpp", "Physics/bench/**.cpp"}
+
+	links {"Break_Physics", "Break_Infrastructure"}
+
+	includedirs{"Physics/bench",
+	"Physics/inc",
+	"Infrastructure/inc",
+	"Physics/deps/glm/include"}
+
+	configuration {"linux", "gmake"}
+		buildoptions{"-std=c++11", "-pthread"}
+
+	filter "configurations:Debug"
+		defines {"DEBUG"}
+		flags {"Symbols"}
+
+	filter "configurations:Release"
+		defines {"NDEBUG"}
+		optimize "On"
+
 project "Break_Infrastructure"
 	kind "SharedLib"
 	language "C++"